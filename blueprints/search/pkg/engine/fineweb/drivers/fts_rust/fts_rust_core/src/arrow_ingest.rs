@@ -0,0 +1,205 @@
+//! Arrow record batch ingestion
+//!
+//! Indexes the id and text columns of Arrow record batches, either native
+//! ones or batches handed over through the Arrow C Data Interface.
+//! Documents borrow their strings from the Arrow offset and value
+//! buffers, so tokenization reads the caller's memory directly.
+
+use crate::document::DocumentRef;
+use crate::index::FtsIndex;
+use crate::result::IndexError;
+
+use arrow::array::{Array, ArrayRef, AsArray, StructArray};
+use arrow::datatypes::{DataType, Schema};
+use arrow::ffi::{from_ffi, FFI_ArrowArray, FFI_ArrowSchema};
+use arrow::record_batch::RecordBatch;
+use std::sync::Arc;
+
+/// Index the rows of a record batch
+///
+/// Rows with a null text are skipped; a null ID is indexed as "".
+/// Returns the number of documents indexed.
+pub fn index_record_batch(
+    index: &FtsIndex,
+    batch: &RecordBatch,
+    id_col: &str,
+    text_col: &str,
+) -> Result<usize, IndexError> {
+    let column = |name: &str| {
+        batch
+            .column_by_name(name)
+            .ok_or_else(|| IndexError::Corrupted(format!("no column {}", name)))
+    };
+    let ids = strings(column(id_col)?, id_col)?;
+    let texts = strings(column(text_col)?, text_col)?;
+
+    let docs: Vec<DocumentRef<'_>> = ids
+        .iter()
+        .zip(&texts)
+        .filter_map(|(id, text)| Some(DocumentRef::new(id.unwrap_or(""), (*text)?)))
+        .collect();
+    index.index_batch_refs(&docs)
+}
+
+/// Index a struct array exported through the Arrow C Data Interface
+///
+/// Takes ownership of both structs: their release callbacks run once the
+/// batch has been indexed, or on error. Malformed arrays and null struct
+/// rows are reported as `IndexError::Corrupted`.
+///
+/// # Safety
+/// `array` and `schema` must follow the C Data Interface and describe the
+/// same struct-typed array.
+pub unsafe fn index_ffi(
+    index: &FtsIndex,
+    array: FFI_ArrowArray,
+    schema: FFI_ArrowSchema,
+    id_col: &str,
+    text_col: &str,
+) -> Result<usize, IndexError> {
+    let data = from_ffi(array, &schema).map_err(|e| IndexError::Corrupted(e.to_string()))?;
+    if !matches!(data.data_type(), DataType::Struct(_)) {
+        return Err(IndexError::Corrupted(format!(
+            "expected a struct array (record batch), got {}",
+            data.data_type()
+        )));
+    }
+    // Reject malformed input here, including child offsets and UTF-8: the
+    // conversions below assert on it, string slicing trusts it, and a panic
+    // must not unwind into the C caller
+    data.validate_full()
+        .map_err(|e| IndexError::Corrupted(e.to_string()))?;
+    let (fields, columns, nulls) = StructArray::from(data).into_parts();
+    if nulls.is_some_and(|n| n.null_count() > 0) {
+        return Err(IndexError::Corrupted(
+            "struct array has null rows, which a record batch cannot hold".into(),
+        ));
+    }
+    let batch = RecordBatch::try_new(Arc::new(Schema::new(fields)), columns)
+        .map_err(|e| IndexError::Corrupted(e.to_string()))?;
+    index_record_batch(index, &batch, id_col, text_col)
+}
+
+/// Borrow the values of a Utf8, LargeUtf8 or Utf8View column
+pub(crate) fn strings<'a>(
+    col: &'a ArrayRef,
+    name: &str,
+) -> Result<Vec<Option<&'a str>>, IndexError> {
+    if let Some(a) = col.as_string_opt::<i32>() {
+        Ok(a.iter().collect())
+    } else if let Some(a) = col.as_string_opt::<i64>() {
+        Ok(a.iter().collect())
+    } else if let Some(a) = col.as_string_view_opt() {
+        Ok(a.iter().collect())
+    } else {
+        Err(IndexError::Corrupted(format!(
+            "column {} has type {}, not string",
+            name,
+            col.data_type()
+        )))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use arrow::array::{ArrayData, Int64Array, StringArray};
+    use arrow::buffer::{Buffer, NullBuffer};
+    use arrow::datatypes::{Field, Fields};
+    use tempfile::tempdir;
+
+    #[test]
+    fn test_index_ffi() {
+        let dir = tempdir().unwrap();
+        let schema = Arc::new(Schema::new(vec![
+            Field::new("id", DataType::Utf8, false),
+            Field::new("rank", DataType::Int64, false),
+            Field::new("text", DataType::Utf8, true),
+        ]));
+        let batch = RecordBatch::try_new(
+            schema,
+            vec![
+                Arc::new(StringArray::from(vec!["a", "b", "c"])),
+                Arc::new(Int64Array::from(vec![1, 2, 3])),
+                Arc::new(StringArray::from(vec![
+                    Some("zero copy handoff"),
+                    None,
+                    Some("copy everything"),
+                ])),
+            ],
+        )
+        .unwrap();
+
+        // Round-trip through the C Data Interface as an external caller would
+        let data = StructArray::from(batch).into_data();
+        let array = FFI_ArrowArray::new(&data);
+        let schema = FFI_ArrowSchema::try_from(data.data_type()).unwrap();
+
+        let index = FtsIndex::create(dir.path(), "bmw_simd").unwrap();
+        let n = unsafe { index_ffi(&index, array, schema, "id", "text") }.unwrap();
+        assert_eq!(n, 2);
+
+        index.commit().unwrap();
+        let result = index.search("copy", 10, 0).unwrap();
+        let mut ids: Vec<_> = result.hits.iter().map(|h| h.id.as_str()).collect();
+        ids.sort();
+        assert_eq!(ids, ["a", "c"]);
+    }
+
+    #[test]
+    fn test_index_ffi_null_rows() {
+        let dir = tempdir().unwrap();
+        let fields = vec![
+            Field::new("id", DataType::Utf8, true),
+            Field::new("text", DataType::Utf8, true),
+        ];
+        let columns: Vec<ArrayRef> = vec![
+            Arc::new(StringArray::from(vec![Some("a"), None])),
+            Arc::new(StringArray::from(vec![Some("kept"), None])),
+        ];
+        let nulls = NullBuffer::from(vec![true, false]);
+        let data = StructArray::new(fields.into(), columns, Some(nulls)).into_data();
+        let array = FFI_ArrowArray::new(&data);
+        let schema = FFI_ArrowSchema::try_from(data.data_type()).unwrap();
+
+        // An error, not a panic across the FFI boundary
+        let index = FtsIndex::create(dir.path(), "bmw_simd").unwrap();
+        let result = unsafe { index_ffi(&index, array, schema, "id", "text") };
+        assert!(matches!(result, Err(IndexError::Corrupted(_))));
+    }
+
+    #[test]
+    fn test_index_ffi_malformed_strings() {
+        let dir = tempdir().unwrap();
+        let index = FtsIndex::create(dir.path(), "bmw_simd").unwrap();
+        let id = StringArray::from(vec!["a", "b"]).into_data();
+
+        // Offsets that go backwards, then bytes that are not UTF-8
+        let bad_texts: [(&[i32], &[u8]); 2] = [(&[0, 3, 1], b"abc"), (&[0, 1, 2], b"\xff\xfe")];
+        for (offsets, values) in bad_texts {
+            let text = unsafe {
+                ArrayData::builder(DataType::Utf8)
+                    .len(2)
+                    .add_buffer(Buffer::from_slice_ref(offsets))
+                    .add_buffer(Buffer::from_slice_ref(values))
+                    .build_unchecked()
+            };
+            let fields = Fields::from(vec![
+                Field::new("id", DataType::Utf8, false),
+                Field::new("text", DataType::Utf8, false),
+            ]);
+            let data = unsafe {
+                ArrayData::builder(DataType::Struct(fields))
+                    .len(2)
+                    .child_data(vec![id.clone(), text])
+                    .build_unchecked()
+            };
+            let array = FFI_ArrowArray::new(&data);
+            let schema = FFI_ArrowSchema::try_from(data.data_type()).unwrap();
+
+            let result = unsafe { index_ffi(&index, array, schema, "id", "text") };
+            assert!(matches!(result, Err(IndexError::Corrupted(_))));
+        }
+        assert_eq!(index.doc_count(), 0);
+    }
+}
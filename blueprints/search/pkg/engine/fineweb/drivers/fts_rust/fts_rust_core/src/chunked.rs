@@ -0,0 +1,151 @@
+//! Append-only tables whose clones are frozen copies
+//!
+//! A `Chunked` table stores its entries in fixed-size chunks behind `Arc`s.
+//! Cloning it copies only the chunk pointers, and an append after a clone
+//! copies at most the last chunk, so profiles hand each published snapshot
+//! its own clone of the per-document tables instead of sharing them under
+//! a lock the writer holds while it indexes.
+
+use crate::document::IdTable;
+
+use std::ops::Index;
+use std::sync::Arc;
+
+/// Entries per chunk
+pub const CHUNK_LEN: usize = 1 << 16;
+
+/// Append-only table of `C` chunks, each holding up to `CHUNK_LEN` entries
+#[derive(Debug, Clone, Default)]
+pub struct Chunked<C> {
+    chunks: Vec<Arc<C>>,
+    len: usize,
+}
+
+impl<C: Clone + Default> Chunked<C> {
+    pub fn new() -> Self {
+        Self {
+            chunks: Vec::new(),
+            len: 0,
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    pub fn clear(&mut self) {
+        self.chunks.clear();
+        self.len = 0;
+    }
+
+    /// Append one entry with `push`, which adds it to the chunk it is given.
+    /// That chunk is copied first if a clone still holds it.
+    pub fn push_with(&mut self, push: impl FnOnce(&mut C)) {
+        if self.len == self.chunks.len() * CHUNK_LEN {
+            self.chunks.push(Arc::default());
+        }
+        let last = self.chunks.last_mut().expect("chunk pushed above");
+        push(Arc::make_mut(last));
+        self.len += 1;
+    }
+
+    /// Chunk holding entry `i` and the entry's position in it
+    #[inline]
+    pub fn locate(&self, i: usize) -> (&C, usize) {
+        (&self.chunks[i / CHUNK_LEN], i % CHUNK_LEN)
+    }
+
+    pub fn chunks(&self) -> impl Iterator<Item = &C> {
+        self.chunks.iter().map(|chunk| &**chunk)
+    }
+}
+
+impl<T: Copy + Default> Chunked<Vec<T>> {
+    pub fn push(&mut self, value: T) {
+        self.push_with(|chunk| chunk.push(value));
+    }
+
+    #[inline]
+    pub fn get(&self, i: usize) -> Option<T> {
+        self.chunks.get(i / CHUNK_LEN)?.get(i % CHUNK_LEN).copied()
+    }
+
+    pub fn iter(&self) -> impl Iterator<Item = T> + '_ {
+        self.chunks().flat_map(|chunk| chunk.iter().copied())
+    }
+}
+
+impl<T: Copy + Default> Index<usize> for Chunked<Vec<T>> {
+    type Output = T;
+
+    #[inline]
+    fn index(&self, i: usize) -> &T {
+        let (chunk, i) = self.locate(i);
+        &chunk[i]
+    }
+}
+
+impl Chunked<IdTable> {
+    /// Append the ID of the next doc
+    pub fn push(&mut self, id: &str) {
+        self.push_with(|chunk| chunk.push(id));
+    }
+
+    /// ID of internal doc `doc_id`
+    pub fn get(&self, doc_id: usize) -> &str {
+        let (chunk, i) = self.locate(doc_id);
+        chunk.get(i)
+    }
+
+    pub fn iter(&self) -> impl Iterator<Item = &str> {
+        self.chunks().flat_map(|chunk| chunk.iter())
+    }
+
+    /// Heap bytes used by the table
+    pub fn heap_bytes(&self) -> usize {
+        self.chunks().map(IdTable::heap_bytes).sum()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_clone_is_frozen() {
+        let mut lengths = Chunked::<Vec<u16>>::new();
+        let mut ids = Chunked::<IdTable>::new();
+        for i in 0..CHUNK_LEN + 10 {
+            lengths.push(i as u16);
+            ids.push(&i.to_string());
+        }
+
+        let frozen_lengths = lengths.clone();
+        let frozen_ids = ids.clone();
+        for i in 0..CHUNK_LEN {
+            lengths.push(7);
+            ids.push("new");
+            assert_eq!(lengths.len(), CHUNK_LEN + 11 + i);
+        }
+
+        assert_eq!(frozen_lengths.len(), CHUNK_LEN + 10);
+        assert_eq!(frozen_lengths.get(CHUNK_LEN + 10), None);
+        assert_eq!(frozen_lengths[CHUNK_LEN + 9], (CHUNK_LEN + 9) as u16);
+        assert_eq!(frozen_ids.len(), CHUNK_LEN + 10);
+        assert_eq!(
+            frozen_ids.iter().last(),
+            Some((CHUNK_LEN + 9).to_string().as_str())
+        );
+
+        // The full chunk is still shared; only the last one was copied
+        assert!(Arc::ptr_eq(&lengths.chunks[0], &frozen_lengths.chunks[0]));
+        assert!(!Arc::ptr_eq(&lengths.chunks[1], &frozen_lengths.chunks[1]));
+        assert_eq!(lengths[CHUNK_LEN + 10], 7);
+        assert_eq!(ids.get(2 * CHUNK_LEN + 9), "new");
+        assert_eq!(lengths.iter().count(), 2 * CHUNK_LEN + 10);
+    }
+}
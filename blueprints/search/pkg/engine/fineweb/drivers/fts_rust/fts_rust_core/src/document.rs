@@ -1,6 +1,8 @@
 //! Document types for indexing
 
+use rayon::prelude::*;
 use serde::{Deserialize, Serialize};
+use std::borrow::Cow;
 
 /// A document to be indexed
 #[derive(Debug, Clone, Serialize, Deserialize)]
@@ -33,6 +35,214 @@ impl Document {
     }
 }
 
+/// A borrowed document: indexes straight from the caller's buffer
+/// without copying the ID or text. The optional metadata feeds the
+/// filterable fields (see `filter`).
+#[derive(Debug, Clone, Copy)]
+pub struct DocumentRef<'a> {
+    pub id: &'a str,
+    pub text: &'a str,
+    pub url: Option<&'a str>,
+    pub language: Option<&'a str>,
+    pub date: Option<&'a str>,
+}
+
+impl<'a> DocumentRef<'a> {
+    pub fn new(id: &'a str, text: &'a str) -> Self {
+        Self {
+            id,
+            text,
+            url: None,
+            language: None,
+            date: None,
+        }
+    }
+}
+
+impl<'a> From<&'a Document> for DocumentRef<'a> {
+    fn from(doc: &'a Document) -> Self {
+        let metadata = doc.metadata.as_ref();
+        Self {
+            url: doc.url.as_deref(),
+            language: metadata.and_then(|m| m.language.as_deref()),
+            date: metadata.and_then(|m| m.date.as_deref()),
+            ..Self::new(&doc.id, &doc.text)
+        }
+    }
+}
+
+/// A document deserialized from JSON: strings borrow from the input
+/// unless they contain escapes; other fields are skipped
+#[derive(Debug, Deserialize)]
+pub struct JsonDocument<'a> {
+    #[serde(borrow)]
+    pub id: Cow<'a, str>,
+    #[serde(borrow)]
+    pub text: Cow<'a, str>,
+    #[serde(borrow, default)]
+    pub url: Option<Cow<'a, str>>,
+    #[serde(borrow, default)]
+    pub metadata: Option<JsonMetadata<'a>>,
+}
+
+/// The filterable part of `DocumentMetadata`, borrowed like `JsonDocument`
+#[derive(Debug, Deserialize)]
+pub struct JsonMetadata<'a> {
+    #[serde(borrow, default)]
+    pub language: Option<Cow<'a, str>>,
+    #[serde(borrow, default)]
+    pub date: Option<Cow<'a, str>>,
+}
+
+impl JsonDocument<'_> {
+    pub fn as_doc_ref(&self) -> DocumentRef<'_> {
+        let metadata = self.metadata.as_ref();
+        DocumentRef {
+            url: self.url.as_deref(),
+            language: metadata.and_then(|m| m.language.as_deref()),
+            date: metadata.and_then(|m| m.date.as_deref()),
+            ..DocumentRef::new(&self.id, &self.text)
+        }
+    }
+}
+
+/// Layout of a binary batch. Every field is a u32 (little-endian) byte
+/// length followed by that many bytes of UTF-8.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub enum BinaryFormat {
+    /// id, text
+    #[default]
+    Plain,
+    /// id, text, url, language, date; an empty metadata field is absent
+    WithMetadata,
+}
+
+impl BinaryFormat {
+    /// Format for a `BINARY_*` code
+    pub fn from_code(code: u32) -> Option<Self> {
+        match code {
+            crate::BINARY_PLAIN => Some(Self::Plain),
+            crate::BINARY_WITH_METADATA => Some(Self::WithMetadata),
+            _ => None,
+        }
+    }
+
+    fn fields(self) -> usize {
+        match self {
+            Self::Plain => 2,
+            Self::WithMetadata => 5,
+        }
+    }
+}
+
+/// Parse up to `max_docs` documents from a binary batch. Each document is
+/// its fields in `format` order, each field being:
+///
+///   - len: u32 (little-endian)
+///   - bytes: [u8; len]
+///
+/// Documents borrow from `bytes`. Truncated or non-UTF-8 documents are skipped.
+pub fn parse_binary(bytes: &[u8], max_docs: usize, format: BinaryFormat) -> Vec<DocumentRef<'_>> {
+    // Phase 1: Parse to find document boundaries (fast, sequential)
+    // Pre-allocate (every field takes at least 4 bytes)
+    let fields = format.fields();
+    let mut doc_offsets: Vec<[(usize, usize); 5]> =
+        Vec::with_capacity(max_docs.min(bytes.len() / (4 * fields)));
+    let mut pos = 0;
+
+    'docs: while doc_offsets.len() < max_docs {
+        // Store (start, len) per field - avoid reparsing
+        let mut offsets = [(0, 0); 5];
+        for offset in &mut offsets[..fields] {
+            if pos + 4 > bytes.len() {
+                break 'docs;
+            }
+            let len =
+                u32::from_le_bytes([bytes[pos], bytes[pos + 1], bytes[pos + 2], bytes[pos + 3]])
+                    as usize;
+            *offset = (pos + 4, len);
+            pos += 4 + len;
+        }
+        doc_offsets.push(offsets);
+    }
+
+    // Phase 2: Validate UTF-8 in parallel; documents borrow from `bytes`
+    let field = |(start, len): (usize, usize)| -> Option<&str> {
+        std::str::from_utf8(bytes.get(start..start + len)?).ok()
+    };
+    let metadata = |offset| field(offset).map(|s| (!s.is_empty()).then_some(s));
+
+    const PARSE_CHUNK_SIZE: usize = 10000;
+    doc_offsets
+        .par_chunks(PARSE_CHUNK_SIZE)
+        .flat_map(|chunk| {
+            chunk
+                .iter()
+                .filter_map(|&[id, text, url, language, date]| {
+                    Some(DocumentRef {
+                        url: metadata(url)?,
+                        language: metadata(language)?,
+                        date: metadata(date)?,
+                        ..DocumentRef::new(field(id)?, field(text)?)
+                    })
+                })
+                .collect::<Vec<_>>()
+        })
+        .collect()
+}
+
+/// Compact table of external document IDs: all IDs in one string,
+/// indexed by internal doc ID
+#[derive(Debug, Clone, Default)]
+pub struct IdTable {
+    bytes: String,
+    ends: Vec<usize>,
+}
+
+impl IdTable {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Append the ID of the next doc
+    pub fn push(&mut self, id: &str) {
+        self.bytes.push_str(id);
+        self.ends.push(self.bytes.len());
+    }
+
+    /// ID of internal doc `doc_id`
+    pub fn get(&self, doc_id: usize) -> &str {
+        let start = if doc_id == 0 {
+            0
+        } else {
+            self.ends[doc_id - 1]
+        };
+        &self.bytes[start..self.ends[doc_id]]
+    }
+
+    pub fn len(&self) -> usize {
+        self.ends.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.ends.is_empty()
+    }
+
+    pub fn iter(&self) -> impl Iterator<Item = &str> {
+        (0..self.len()).map(move |i| self.get(i))
+    }
+
+    pub fn clear(&mut self) {
+        self.bytes.clear();
+        self.ends.clear();
+    }
+
+    /// Heap bytes used by the table
+    pub fn heap_bytes(&self) -> usize {
+        self.bytes.capacity() + self.ends.capacity() * std::mem::size_of::<usize>()
+    }
+}
+
 /// Optional document metadata
 #[derive(Debug, Clone, Serialize, Deserialize, Default)]
 pub struct DocumentMetadata {
@@ -49,3 +259,65 @@ pub struct IndexedDocument {
     pub term_freqs: Vec<(String, u16)>,
     pub doc_length: u32,
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_id_table() {
+        let mut ids = IdTable::new();
+        ids.push("a");
+        ids.push("");
+        ids.push("https://example.com/x");
+
+        assert_eq!(ids.len(), 3);
+        assert_eq!(ids.get(0), "a");
+        assert_eq!(ids.get(1), "");
+        assert_eq!(ids.get(2), "https://example.com/x");
+        assert_eq!(
+            ids.iter().collect::<Vec<_>>(),
+            ["a", "", "https://example.com/x"]
+        );
+
+        ids.clear();
+        assert!(ids.is_empty());
+    }
+
+    fn encode(docs: &[&[&str]]) -> Vec<u8> {
+        let mut buf = Vec::new();
+        for field in docs.iter().flat_map(|d| d.iter()) {
+            buf.extend_from_slice(&(field.len() as u32).to_le_bytes());
+            buf.extend_from_slice(field.as_bytes());
+        }
+        buf
+    }
+
+    #[test]
+    fn test_parse_binary_metadata() {
+        let mut bytes = encode(&[
+            &["1", "hello", "https://a.com/x", "en", "2024-01-02"],
+            &["2", "bonjour", "", "fr", ""],
+        ]);
+        // A truncated trailing document is dropped
+        bytes.extend_from_slice(&encode(&[&["3", "cut"]]));
+
+        let docs = parse_binary(&bytes, usize::MAX, BinaryFormat::WithMetadata);
+        assert_eq!(docs.len(), 2);
+        assert_eq!(
+            (docs[0].id, docs[0].url, docs[0].language, docs[0].date),
+            ("1", Some("https://a.com/x"), Some("en"), Some("2024-01-02"))
+        );
+        assert_eq!(
+            (docs[1].text, docs[1].url, docs[1].language, docs[1].date),
+            ("bonjour", None, Some("fr"), None)
+        );
+
+        let bytes = encode(&[&["1", "hello"]]);
+        let plain = parse_binary(&bytes, 10, BinaryFormat::Plain);
+        assert_eq!(
+            (plain[0].id, plain[0].text, plain[0].url),
+            ("1", "hello", None)
+        );
+    }
+}
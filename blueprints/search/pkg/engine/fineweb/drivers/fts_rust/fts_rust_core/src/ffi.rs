@@ -1,13 +1,19 @@
 //! C FFI interface for Go integration
 
-use crate::document::Document;
-use crate::index::FtsIndex;
-
+use crate::document::{parse_binary, BinaryFormat};
+use crate::filter::{Field, Filter};
+use crate::index::{FtsIndex, SourceCursor};
+use crate::ingest::{IngestOptions, IngestSession};
+use crate::json_ingest::index_json;
+use crate::result::{HitBuffer, IndexError, SearchCursor, SearchResult, TotalMode};
+
+use std::cell::RefCell;
 use std::ffi::{CStr, CString};
 use std::os::raw::{c_char, c_int};
 use std::ptr;
 use std::slice;
 use std::sync::Mutex;
+use std::time::{Duration, Instant};
 
 /// Thread-local last error message
 static LAST_ERROR: Mutex<Option<String>> = Mutex::new(None);
@@ -17,6 +23,11 @@ fn set_last_error(msg: impl Into<String>) {
     *LAST_ERROR.lock().unwrap() = Some(msg.into());
 }
 
+thread_local! {
+    /// Hits of the `*_into` searches, reused across calls on each thread
+    static HIT_BUFFER: RefCell<HitBuffer> = RefCell::new(HitBuffer::new());
+}
+
 /// Search hit for FFI
 #[repr(C)]
 pub struct FtsHit {
@@ -35,6 +46,34 @@ pub struct FtsSearchResult {
     pub profile: *mut c_char,
 }
 
+/// Search hit written by `fts_search_into`
+///
+/// The hit's ID is `id_len` bytes at `id_offset` in the ID string table
+/// (not null-terminated).
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct FtsHitRef {
+    /// Rank of the hit in the full result list (`offset` + position)
+    pub ordinal: u32,
+    pub score: f32,
+    pub id_offset: u32,
+    pub id_len: u32,
+}
+
+/// Result summary written by `fts_search_into`
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct FtsSearchInfo {
+    /// Hits written to the buffer
+    pub count: u32,
+    /// Bytes in the ID string table
+    pub id_bytes: u32,
+    pub total: u64,
+    pub duration_ns: u64,
+    /// Buffer size needed for this result page
+    pub required: usize,
+}
+
 /// Memory statistics for FFI
 #[repr(C)]
 pub struct FtsMemoryStats {
@@ -129,6 +168,12 @@ pub unsafe extern "C" fn fts_index_close(idx: *mut FtsIndex) {
 
 /// Index a batch of documents from JSON
 ///
+/// `docs_json` is either a JSON array of `{"id", "text"}` objects or
+/// NDJSON (one object per line), chosen by its first non-whitespace byte.
+/// Strings are deserialized in place where they have no escapes; NDJSON
+/// is split on line boundaries and parsed and indexed in parallel. For
+/// NDJSON the progress `total` is the number of lines.
+///
 /// # Safety
 /// - `idx` must be a valid index pointer
 /// - `docs_json` must be a valid pointer to JSON data
@@ -146,66 +191,146 @@ pub unsafe extern "C" fn fts_index_batch(
     }
 
     let index = &*idx;
-    let json_slice = slice::from_raw_parts(docs_json as *const u8, docs_len);
-    let json_str = match std::str::from_utf8(json_slice) {
-        Ok(s) => s,
-        Err(_) => {
-            set_last_error("Invalid UTF-8 in docs_json");
-            return -2;
+    let json = slice::from_raw_parts(docs_json as *const u8, docs_len);
+    let report = |indexed: u64, total: u64| {
+        if let Some(cb) = progress {
+            cb(indexed, total);
         }
     };
 
-    // Parse JSON array of documents
-    let docs: Vec<Document> = match serde_json::from_str(json_str) {
-        Ok(d) => d,
+    match index_json(index, json, &report) {
+        Ok(n) => n as i64,
+        Err(e @ IndexError::Serialization(_)) => {
+            set_last_error(e.to_string());
+            -2
+        }
         Err(e) => {
-            set_last_error(format!("JSON parse error: {}", e));
-            return -2;
+            set_last_error(e.to_string());
+            -3
         }
-    };
+    }
+}
 
-    let total = docs.len() as u64;
+/// Commit pending changes
+///
+/// # Safety
+/// - `idx` must be a valid index pointer
+#[no_mangle]
+pub unsafe extern "C" fn fts_index_commit(idx: *mut FtsIndex) -> c_int {
+    if idx.is_null() {
+        set_last_error("Null pointer passed to fts_index_commit");
+        return -1;
+    }
 
-    // Report initial progress
-    if let Some(cb) = progress {
-        cb(0, total);
+    let index = &*idx;
+    match index.commit() {
+        Ok(()) => 0,
+        Err(e) => {
+            set_last_error(e.to_string());
+            -1
+        }
     }
+}
 
-    // Index in chunks for progress reporting
-    const CHUNK_SIZE: usize = 1000;
-    let mut indexed = 0u64;
+/// Create or continue a resumable bulk build
+///
+/// If `data_dir` holds a checkpoint, the index saved with it is restored
+/// (dropping anything committed since) and opened, and `*cursor_out`
+/// receives the source cursor JSON (`{"file":..,"row_group":..,"row":..}`,
+/// free with `fts_string_free`).
+/// Otherwise a new index is created and `*cursor_out` is set to null.
+///
+/// # Safety
+/// - `data_dir` and `profile` must be valid null-terminated C strings
+/// - `cursor_out` must be a valid pointer
+#[no_mangle]
+pub unsafe extern "C" fn fts_index_resume(
+    data_dir: *const c_char,
+    profile: *const c_char,
+    cursor_out: *mut *mut c_char,
+) -> *mut FtsIndex {
+    if data_dir.is_null() || profile.is_null() || cursor_out.is_null() {
+        set_last_error("Null pointer passed to fts_index_resume");
+        return ptr::null_mut();
+    }
+    *cursor_out = ptr::null_mut();
+
+    let (data_dir, profile) = match (
+        CStr::from_ptr(data_dir).to_str(),
+        CStr::from_ptr(profile).to_str(),
+    ) {
+        (Ok(d), Ok(p)) => (d, p),
+        _ => {
+            set_last_error("Invalid UTF-8 in data_dir or profile");
+            return ptr::null_mut();
+        }
+    };
 
-    for chunk in docs.chunks(CHUNK_SIZE) {
-        match index.index_batch(chunk) {
-            Ok(n) => {
-                indexed += n as u64;
-                if let Some(cb) = progress {
-                    cb(indexed, total);
-                }
-            }
-            Err(e) => {
-                set_last_error(e.to_string());
-                return -3;
+    match FtsIndex::resume(data_dir, profile) {
+        Ok((index, cursor)) => {
+            if let Some(cursor) = cursor {
+                let json = serde_json::to_string(&cursor).unwrap();
+                *cursor_out = CString::new(json).unwrap().into_raw();
             }
+            Box::into_raw(Box::new(index))
+        }
+        Err(e) => {
+            set_last_error(e.to_string());
+            ptr::null_mut()
         }
     }
+}
+
+/// Commit, durably save, and record `cursor_json` as the resume point
+///
+/// # Safety
+/// - `idx` must be a valid index pointer
+/// - `cursor_json` must be a valid null-terminated C string
+#[no_mangle]
+pub unsafe extern "C" fn fts_index_checkpoint(
+    idx: *mut FtsIndex,
+    cursor_json: *const c_char,
+) -> c_int {
+    if idx.is_null() || cursor_json.is_null() {
+        set_last_error("Null pointer passed to fts_index_checkpoint");
+        return -1;
+    }
+
+    let cursor: SourceCursor = match CStr::from_ptr(cursor_json)
+        .to_str()
+        .map_err(|e| e.to_string())
+        .and_then(|s| serde_json::from_str(s).map_err(|e| e.to_string()))
+    {
+        Ok(c) => c,
+        Err(e) => {
+            set_last_error(format!("Invalid cursor: {}", e));
+            return -2;
+        }
+    };
 
-    indexed as i64
+    let index = &*idx;
+    match index.checkpoint(cursor) {
+        Ok(_) => 0,
+        Err(e) => {
+            set_last_error(e.to_string());
+            -3
+        }
+    }
 }
 
-/// Commit pending changes
+/// Remove the checkpoint of a finished build
 ///
 /// # Safety
 /// - `idx` must be a valid index pointer
 #[no_mangle]
-pub unsafe extern "C" fn fts_index_commit(idx: *mut FtsIndex) -> c_int {
+pub unsafe extern "C" fn fts_index_clear_checkpoint(idx: *mut FtsIndex) -> c_int {
     if idx.is_null() {
-        set_last_error("Null pointer passed to fts_index_commit");
+        set_last_error("Null pointer passed to fts_index_clear_checkpoint");
         return -1;
     }
 
     let index = &*idx;
-    match index.commit() {
+    match index.clear_checkpoint() {
         Ok(()) => 0,
         Err(e) => {
             set_last_error(e.to_string());
@@ -214,6 +339,17 @@ pub unsafe extern "C" fn fts_index_commit(idx: *mut FtsIndex) -> c_int {
     }
 }
 
+/// Free a string returned by the library
+///
+/// # Safety
+/// - `s` must be null or a pointer returned by this library
+#[no_mangle]
+pub unsafe extern "C" fn fts_string_free(s: *mut c_char) {
+    if !s.is_null() {
+        drop(CString::from_raw(s));
+    }
+}
+
 /// Index documents from a binary format for maximum throughput
 ///
 /// Binary format per document:
@@ -222,6 +358,9 @@ pub unsafe extern "C" fn fts_index_commit(idx: *mut FtsIndex) -> c_int {
 ///   - text_len: u32 (little-endian)
 ///   - text: [u8; text_len]
 ///
+/// Safe to call from several threads on the same index: their batches
+/// are indexed concurrently rather than one after another.
+///
 /// # Safety
 /// - `idx` must be a valid index pointer
 /// - `data` must be valid binary data
@@ -235,63 +374,50 @@ pub unsafe extern "C" fn fts_index_batch_binary(
     doc_count: u64,
     progress: FtsProgressFn,
 ) -> i64 {
-    use rayon::prelude::*;
+    fts_index_batch_binary_format(
+        idx,
+        data,
+        data_len,
+        doc_count,
+        crate::BINARY_PLAIN,
+        progress,
+    )
+}
 
+/// Index documents from a binary batch in the given `BINARY_*` format
+///
+/// `BINARY_WITH_METADATA` appends url, language and date fields (each a
+/// u32 length plus bytes, empty = absent) after the text, so profiles
+/// with metadata fields can serve `fts_search_filtered`. Returns -2 for
+/// an unknown format.
+///
+/// # Safety
+/// Same as `fts_index_batch_binary`
+#[no_mangle]
+pub unsafe extern "C" fn fts_index_batch_binary_format(
+    idx: *mut FtsIndex,
+    data: *const u8,
+    data_len: usize,
+    doc_count: u64,
+    format: u32,
+    progress: FtsProgressFn,
+) -> i64 {
     if idx.is_null() || data.is_null() {
         set_last_error("Null pointer passed to fts_index_batch_binary");
         return -1;
     }
+    let format = match BinaryFormat::from_code(format) {
+        Some(f) => f,
+        None => {
+            set_last_error(format!("Unknown binary format: {}", format));
+            return -2;
+        }
+    };
 
     let index = &*idx;
     let bytes = slice::from_raw_parts(data, data_len);
 
-    // Phase 1: Parse to find document boundaries (fast, sequential)
-    // Pre-allocate with exact capacity
-    let mut doc_offsets: Vec<(usize, usize, usize, usize)> = Vec::with_capacity(doc_count as usize);
-    let mut pos = 0;
-
-    while pos + 8 <= bytes.len() && doc_offsets.len() < doc_count as usize {
-        // Read id length
-        if pos + 4 > bytes.len() {
-            break;
-        }
-        let id_len =
-            u32::from_le_bytes([bytes[pos], bytes[pos + 1], bytes[pos + 2], bytes[pos + 3]])
-                as usize;
-        let id_start = pos + 4;
-        pos = id_start + id_len;
-
-        // Read text length
-        if pos + 4 > bytes.len() {
-            break;
-        }
-        let text_len =
-            u32::from_le_bytes([bytes[pos], bytes[pos + 1], bytes[pos + 2], bytes[pos + 3]])
-                as usize;
-        let text_start = pos + 4;
-        pos = text_start + text_len;
-
-        // Store (id_start, id_len, text_start, text_len) - avoid reparsing
-        doc_offsets.push((id_start, id_len, text_start, text_len));
-    }
-
-    // Phase 2: Parse documents in parallel with zero-copy where possible
-    // Use chunks to reduce allocation overhead
-    const PARSE_CHUNK_SIZE: usize = 10000;
-    let docs: Vec<Document> = doc_offsets
-        .par_chunks(PARSE_CHUNK_SIZE)
-        .flat_map(|chunk| {
-            chunk.iter().filter_map(|&(id_start, id_len, text_start, text_len)| {
-                if id_start + id_len > bytes.len() || text_start + text_len > bytes.len() {
-                    return None;
-                }
-                // Use unsafe from_utf8_unchecked for speed - we trust the Go side sends valid UTF-8
-                let id = std::str::from_utf8(&bytes[id_start..id_start + id_len]).ok()?;
-                let text = std::str::from_utf8(&bytes[text_start..text_start + text_len]).ok()?;
-                Some(Document::new(id.to_string(), text.to_string()))
-            }).collect::<Vec<_>>()
-        })
-        .collect();
+    let docs = parse_binary(bytes, doc_count as usize, format);
 
     let total = docs.len() as u64;
 
@@ -300,7 +426,7 @@ pub unsafe extern "C" fn fts_index_batch_binary(
     }
 
     // Index all documents at once for maximum throughput
-    match index.index_batch(&docs) {
+    match index.index_batch_refs(&docs) {
         Ok(n) => {
             if let Some(cb) = progress {
                 cb(n as u64, total);
@@ -314,6 +440,258 @@ pub unsafe extern "C" fn fts_index_batch_binary(
     }
 }
 
+/// Start a streaming ingest session
+///
+/// Chunks pushed with `fts_ingest_push` are parsed and indexed on a
+/// dedicated pool of `threads` threads (0 = number of CPUs) while the
+/// caller prepares the next chunk; at most `queue_depth` chunks wait in
+/// between. End the session with `fts_ingest_finish`, then commit.
+///
+/// # Safety
+/// - `idx` must be a valid index pointer
+#[no_mangle]
+pub unsafe extern "C" fn fts_ingest_begin(
+    idx: *mut FtsIndex,
+    queue_depth: u32,
+    threads: u32,
+) -> *mut IngestSession {
+    fts_ingest_begin_format(idx, queue_depth, threads, crate::BINARY_PLAIN)
+}
+
+/// Start a streaming ingest session whose chunks use the given `BINARY_*`
+/// format (see `fts_index_batch_binary_format`)
+///
+/// # Safety
+/// - `idx` must be a valid index pointer
+#[no_mangle]
+pub unsafe extern "C" fn fts_ingest_begin_format(
+    idx: *mut FtsIndex,
+    queue_depth: u32,
+    threads: u32,
+    format: u32,
+) -> *mut IngestSession {
+    if idx.is_null() {
+        set_last_error("Null pointer passed to fts_ingest_begin");
+        return ptr::null_mut();
+    }
+    let format = match BinaryFormat::from_code(format) {
+        Some(f) => f,
+        None => {
+            set_last_error(format!("Unknown binary format: {}", format));
+            return ptr::null_mut();
+        }
+    };
+
+    let index = &*idx;
+    let opts = IngestOptions {
+        queue_depth: queue_depth as usize,
+        threads: threads as usize,
+        format,
+    };
+    match index.ingest(opts) {
+        Ok(session) => Box::into_raw(Box::new(session)),
+        Err(e) => {
+            set_last_error(e.to_string());
+            ptr::null_mut()
+        }
+    }
+}
+
+/// Queue a chunk of whole documents in the session's binary format
+///
+/// The chunk is copied, so the caller may reuse its buffer on return.
+/// Blocks only while the session queue is full. Returns -3 if indexing an
+/// earlier chunk failed; `fts_ingest_finish` reports the error.
+///
+/// # Safety
+/// - `session` must be a valid pointer returned by `fts_ingest_begin`
+/// - `chunk` must be valid for reads of `chunk_len` bytes
+#[no_mangle]
+pub unsafe extern "C" fn fts_ingest_push(
+    session: *mut IngestSession,
+    chunk: *const u8,
+    chunk_len: usize,
+) -> c_int {
+    if session.is_null() || (chunk.is_null() && chunk_len > 0) {
+        set_last_error("Null pointer passed to fts_ingest_push");
+        return -1;
+    }
+    if chunk_len == 0 {
+        return 0;
+    }
+
+    let session = &*session;
+    match session.push(slice::from_raw_parts(chunk, chunk_len).to_vec()) {
+        Ok(()) => 0,
+        Err(e) => {
+            set_last_error(e.to_string());
+            -3
+        }
+    }
+}
+
+/// Documents indexed so far by a session
+///
+/// # Safety
+/// - `session` must be a valid pointer returned by `fts_ingest_begin`
+#[no_mangle]
+pub unsafe extern "C" fn fts_ingest_indexed(session: *mut IngestSession) -> u64 {
+    if session.is_null() {
+        return 0;
+    }
+    (*session).indexed()
+}
+
+/// Wait for queued chunks to be indexed and free the session
+///
+/// Returns the number of documents indexed, or -3 on error.
+///
+/// # Safety
+/// - `session` must be a valid pointer returned by `fts_ingest_begin`;
+///   it is invalid after this call
+#[no_mangle]
+pub unsafe extern "C" fn fts_ingest_finish(session: *mut IngestSession) -> i64 {
+    if session.is_null() {
+        set_last_error("Null pointer passed to fts_ingest_finish");
+        return -1;
+    }
+
+    match Box::from_raw(session).finish() {
+        Ok(n) => n as i64,
+        Err(e) => {
+            set_last_error(e.to_string());
+            -3
+        }
+    }
+}
+
+/// Index a record batch passed through the Arrow C Data Interface
+///
+/// `schema` and `array` describe a struct array (an exported record batch)
+/// with string columns named "id" and "text"; other columns are ignored.
+/// Text is tokenized straight from the Arrow offset and value buffers,
+/// without a copy. Rows with a null text are skipped.
+///
+/// Ownership of both structs moves to the index: unless a pointer is null
+/// (-1) or the library was built without `arrow-ingest` (-3), their
+/// release callbacks have run and the structs are marked released when
+/// this returns, on success or error. Returns the number of documents
+/// indexed, or -3 on error.
+///
+/// # Safety
+/// - `idx` must be a valid index pointer
+/// - `schema` and `array` must be valid, unreleased C Data Interface structs
+#[cfg(feature = "arrow-ingest")]
+#[no_mangle]
+pub unsafe extern "C" fn fts_index_arrow(
+    idx: *mut FtsIndex,
+    schema: *mut arrow::ffi::FFI_ArrowSchema,
+    array: *mut arrow::ffi::FFI_ArrowArray,
+) -> i64 {
+    if idx.is_null() || schema.is_null() || array.is_null() {
+        set_last_error("Null pointer passed to fts_index_arrow");
+        return -1;
+    }
+
+    // Move both structs out so they are released on every path below
+    let schema = arrow::ffi::FFI_ArrowSchema::from_raw(schema);
+    let array = arrow::ffi::FFI_ArrowArray::from_raw(array);
+
+    match crate::arrow_ingest::index_ffi(&*idx, array, schema, "id", "text") {
+        Ok(n) => n as i64,
+        Err(e) => {
+            set_last_error(e.to_string());
+            -3
+        }
+    }
+}
+
+/// Index a record batch passed through the Arrow C Data Interface
+///
+/// Built without the `arrow-ingest` feature: always fails with -3.
+///
+/// # Safety
+/// Never dereferences its arguments.
+#[cfg(not(feature = "arrow-ingest"))]
+#[no_mangle]
+pub unsafe extern "C" fn fts_index_arrow(
+    _idx: *mut FtsIndex,
+    _schema: *mut std::ffi::c_void,
+    _array: *mut std::ffi::c_void,
+) -> i64 {
+    set_last_error("fts_rust_core was built without the arrow-ingest feature");
+    -3
+}
+
+/// Index the id and text columns of Parquet files
+///
+/// `path` is a file, a directory of `*.parquet` files, or a glob in the
+/// file name (`/data/fineweb/*.parquet`). Row groups are decoded in
+/// parallel on `threads` threads (0 = number of CPUs), reading only the
+/// two columns. `progress(indexed, total_rows)` is called after each
+/// record batch. Returns the number of documents indexed, or a negative
+/// error (-3 also when built without the `parquet-ingest` feature).
+///
+/// # Safety
+/// - `idx` must be a valid index pointer
+/// - `path`, `id_col` and `text_col` must be valid null-terminated C strings
+#[no_mangle]
+pub unsafe extern "C" fn fts_index_parquet(
+    idx: *mut FtsIndex,
+    path: *const c_char,
+    id_col: *const c_char,
+    text_col: *const c_char,
+    threads: u32,
+    progress: FtsProgressFn,
+) -> i64 {
+    if idx.is_null() || path.is_null() || id_col.is_null() || text_col.is_null() {
+        set_last_error("Null pointer passed to fts_index_parquet");
+        return -1;
+    }
+
+    #[cfg(feature = "parquet-ingest")]
+    {
+        use crate::parquet_ingest::{index_parquet, ParquetOptions};
+
+        let (path, id_col, text_col) = match (
+            CStr::from_ptr(path).to_str(),
+            CStr::from_ptr(id_col).to_str(),
+            CStr::from_ptr(text_col).to_str(),
+        ) {
+            (Ok(p), Ok(i), Ok(t)) => (p, i, t),
+            _ => {
+                set_last_error("Invalid UTF-8 in path or column name");
+                return -2;
+            }
+        };
+
+        let opts = ParquetOptions {
+            id_col: id_col.to_string(),
+            text_col: text_col.to_string(),
+            threads: threads as usize,
+        };
+        let report = |indexed: u64, total: u64| {
+            if let Some(cb) = progress {
+                cb(indexed, total);
+            }
+        };
+        match index_parquet(&*idx, path, &opts, &report) {
+            Ok(n) => n as i64,
+            Err(e) => {
+                set_last_error(e.to_string());
+                -3
+            }
+        }
+    }
+
+    #[cfg(not(feature = "parquet-ingest"))]
+    {
+        let _ = (threads, progress);
+        set_last_error("fts_rust_core was built without the parquet-ingest feature");
+        -3
+    }
+}
+
 /// Search the index
 ///
 /// # Safety
@@ -418,6 +796,422 @@ pub unsafe extern "C" fn fts_result_free(result: *mut FtsSearchResult) {
     }
 }
 
+/// Search the index into a caller-provided buffer
+///
+/// Writes `count` `FtsHitRef`s at the start of `buf`, followed by the ID
+/// string table, and the summary to `*out`. Nothing is allocated for the
+/// caller and there is nothing to free. Hit IDs go from the profile's ID
+/// table through a per-thread hit buffer into `buf`, so once that buffer
+/// has grown a query allocates nothing per hit.
+///
+/// Returns 0 on success, or -4 if `buf_len` is smaller than
+/// `out->required` (no hits are written; retry with a larger buffer).
+///
+/// # Safety
+/// - `idx` must be a valid index pointer
+/// - `query` must be a valid null-terminated C string
+/// - `buf` must be valid for writes of `buf_len` bytes (any alignment)
+/// - `out` must be a valid pointer
+#[no_mangle]
+pub unsafe extern "C" fn fts_search_into(
+    idx: *mut FtsIndex,
+    query: *const c_char,
+    limit: u32,
+    offset: u32,
+    buf: *mut u8,
+    buf_len: usize,
+    out: *mut FtsSearchInfo,
+) -> c_int {
+    if idx.is_null() || query.is_null() || out.is_null() || (buf.is_null() && buf_len > 0) {
+        set_last_error("Null pointer passed to fts_search_into");
+        return -1;
+    }
+    *out = FtsSearchInfo::default();
+
+    let index = &*idx;
+    let query_str = match CStr::from_ptr(query).to_str() {
+        Ok(s) => s,
+        Err(_) => {
+            set_last_error("Invalid UTF-8 in query");
+            return -2;
+        }
+    };
+
+    let start = Instant::now();
+    HIT_BUFFER.with_borrow_mut(|hits| {
+        if let Err(e) = index.search_hits(query_str, limit as usize, offset as usize, hits) {
+            set_last_error(e.to_string());
+            return -3;
+        }
+        write_hits(hits, offset, start.elapsed(), buf, buf_len, &mut *out)
+    })
+}
+
+/// Search the hits ranked after a cursor into a caller-provided buffer,
+/// laid out as by `fts_search_into`
+///
+/// `after` is the `next` token of the previous page, or NULL or an empty
+/// string for the first page. Only `limit` hits are collected however deep
+/// the page is, so walking every hit of a query costs no more per page
+/// than the first. `next` receives the token for the following page, or an
+/// empty string once the hits run out. Hit ordinals restart at 0.
+///
+/// Returns -2 for a malformed cursor, -3 if the profile cannot page by
+/// cursor, and -4 if `buf_len` is too small.
+///
+/// # Safety
+/// - `idx` must be a valid index pointer
+/// - `query` must be a valid null-terminated C string
+/// - `after` must be NULL or a valid null-terminated C string
+/// - `buf` must be valid for writes of `buf_len` bytes (any alignment)
+/// - `out` must be a valid pointer
+/// - `next` must be valid for writes of `SEARCH_CURSOR_SIZE` bytes
+#[allow(clippy::too_many_arguments)]
+#[no_mangle]
+pub unsafe extern "C" fn fts_search_after(
+    idx: *mut FtsIndex,
+    query: *const c_char,
+    after: *const c_char,
+    limit: u32,
+    buf: *mut u8,
+    buf_len: usize,
+    out: *mut FtsSearchInfo,
+    next: *mut c_char,
+) -> c_int {
+    if idx.is_null()
+        || query.is_null()
+        || out.is_null()
+        || next.is_null()
+        || (buf.is_null() && buf_len > 0)
+    {
+        set_last_error("Null pointer passed to fts_search_after");
+        return -1;
+    }
+    *out = FtsSearchInfo::default();
+    *next = 0;
+
+    let index = &*idx;
+    let (query_str, after_str) = match (
+        CStr::from_ptr(query).to_str(),
+        if after.is_null() {
+            Ok("")
+        } else {
+            CStr::from_ptr(after).to_str()
+        },
+    ) {
+        (Ok(q), Ok(a)) => (q, a),
+        _ => {
+            set_last_error("Invalid UTF-8 in query or cursor");
+            return -2;
+        }
+    };
+    let cursor = if after_str.is_empty() {
+        None
+    } else {
+        match SearchCursor::decode(after_str) {
+            Some(cursor) => Some(cursor),
+            None => {
+                set_last_error(format!("Invalid search cursor: {}", after_str));
+                return -2;
+            }
+        }
+    };
+
+    let result = match index.search_after(query_str, limit as usize, cursor) {
+        Ok(r) => r,
+        Err(e) => {
+            set_last_error(e.to_string());
+            return -3;
+        }
+    };
+
+    let status = write_result(&result, 0, buf, buf_len, &mut *out);
+    if status == 0 {
+        if let Some(cursor) = result.next {
+            let token = cursor.encode();
+            ptr::copy_nonoverlapping(token.as_ptr(), next as *mut u8, token.len());
+            *next.add(token.len()) = 0;
+        }
+    }
+    status
+}
+
+/// Search the documents matching a metadata filter into a caller-provided
+/// buffer, laid out as by `fts_search_into`
+///
+/// `filter` is an expression over the `lang`, `domain` and `year` fields,
+/// e.g. `lang:en AND NOT domain:example.com`; NULL or an empty string
+/// searches unfiltered. Matching docs are selected before scoring, so
+/// `limit` filtered hits come back without over-fetching.
+///
+/// Returns -2 if the filter does not parse, -3 if the profile does not
+/// index metadata, and -4 if `buf_len` is too small.
+///
+/// # Safety
+/// - `idx` must be a valid index pointer
+/// - `query` must be a valid null-terminated C string
+/// - `filter` must be NULL or a valid null-terminated C string
+/// - `buf` must be valid for writes of `buf_len` bytes (any alignment)
+/// - `out` must be a valid pointer
+#[no_mangle]
+#[allow(clippy::too_many_arguments)]
+pub unsafe extern "C" fn fts_search_filtered(
+    idx: *mut FtsIndex,
+    query: *const c_char,
+    filter: *const c_char,
+    limit: u32,
+    offset: u32,
+    buf: *mut u8,
+    buf_len: usize,
+    out: *mut FtsSearchInfo,
+) -> c_int {
+    if idx.is_null() || query.is_null() || out.is_null() || (buf.is_null() && buf_len > 0) {
+        set_last_error("Null pointer passed to fts_search_filtered");
+        return -1;
+    }
+    *out = FtsSearchInfo::default();
+
+    let index = &*idx;
+    let query_str = match CStr::from_ptr(query).to_str() {
+        Ok(s) => s,
+        Err(_) => {
+            set_last_error("Invalid UTF-8 in query");
+            return -2;
+        }
+    };
+    let filter_str = if filter.is_null() {
+        ""
+    } else {
+        match CStr::from_ptr(filter).to_str() {
+            Ok(s) => s.trim(),
+            Err(_) => {
+                set_last_error("Invalid UTF-8 in filter");
+                return -2;
+            }
+        }
+    };
+
+    let result = if filter_str.is_empty() {
+        index.search(query_str, limit as usize, offset as usize)
+    } else {
+        match Filter::parse(filter_str) {
+            Ok(filter) => {
+                index.search_filtered(query_str, &filter, limit as usize, offset as usize)
+            }
+            Err(e) => {
+                set_last_error(e.to_string());
+                return -2;
+            }
+        }
+    };
+    let result = match result {
+        Ok(r) => r,
+        Err(e) => {
+            set_last_error(e.to_string());
+            return -3;
+        }
+    };
+
+    write_result(&result, offset, buf, buf_len, &mut *out)
+}
+
+/// `write_hits` for a search that built a `SearchResult`
+///
+/// # Safety
+/// `buf` must be valid for writes of `buf_len` bytes
+unsafe fn write_result(
+    result: &SearchResult,
+    offset: u32,
+    buf: *mut u8,
+    buf_len: usize,
+    info: &mut FtsSearchInfo,
+) -> c_int {
+    HIT_BUFFER.with_borrow_mut(|hits| {
+        hits.fill_from(result);
+        write_hits(hits, offset, result.duration, buf, buf_len, info)
+    })
+}
+
+/// Write `hits` to `buf` and `info` for the `*_into` searches
+///
+/// # Safety
+/// `buf` must be valid for writes of `buf_len` bytes
+unsafe fn write_hits(
+    hits: &HitBuffer,
+    offset: u32,
+    duration: Duration,
+    buf: *mut u8,
+    buf_len: usize,
+    info: &mut FtsSearchInfo,
+) -> c_int {
+    let hits_bytes = hits.len() * std::mem::size_of::<FtsHitRef>();
+    let id_bytes = hits.id_bytes();
+    info.total = hits.total;
+    info.duration_ns = duration.as_nanos() as u64;
+    info.required = hits_bytes + id_bytes;
+    if buf_len < info.required {
+        set_last_error(format!(
+            "Search buffer too small: need {} bytes, have {}",
+            info.required, buf_len
+        ));
+        return -4;
+    }
+
+    let refs = buf as *mut FtsHitRef;
+    let ids = buf.add(hits_bytes);
+    let mut id_offset = 0usize;
+    for (i, (score, id)) in hits.iter().enumerate() {
+        refs.add(i).write_unaligned(FtsHitRef {
+            ordinal: offset + i as u32,
+            score,
+            id_offset: id_offset as u32,
+            id_len: id.len() as u32,
+        });
+        ptr::copy_nonoverlapping(id.as_ptr(), ids.add(id_offset), id.len());
+        id_offset += id.len();
+    }
+
+    info.count = hits.len() as u32;
+    info.id_bytes = id_bytes as u32;
+    0
+}
+
+/// Facet counts over every document matching `query`
+///
+/// `fields` lists the fields to count, separated by commas or spaces
+/// (`lang`, `domain`, `year`); NULL or an empty string counts all of them.
+/// Each field keeps its `top_n` most frequent values. With `approximate`,
+/// very broad queries count a sample of the matches and scale it up.
+///
+/// On success `*out` receives JSON (free with `fts_string_free`):
+/// `{"facets":[{"field":"domain","counts":[{"value":..,"count":..}]}],
+/// "matches":..,"approximate":..}`. Returns -2 for an unknown field and
+/// -3 if the profile does not index metadata.
+///
+/// # Safety
+/// - `idx` must be a valid index pointer
+/// - `query` must be a valid null-terminated C string
+/// - `fields` must be NULL or a valid null-terminated C string
+/// - `out` must be a valid pointer
+#[no_mangle]
+pub unsafe extern "C" fn fts_facets(
+    idx: *mut FtsIndex,
+    query: *const c_char,
+    fields: *const c_char,
+    top_n: u32,
+    approximate: bool,
+    out: *mut *mut c_char,
+) -> c_int {
+    if idx.is_null() || query.is_null() || out.is_null() {
+        set_last_error("Null pointer passed to fts_facets");
+        return -1;
+    }
+    *out = ptr::null_mut();
+
+    let index = &*idx;
+    let (query_str, fields_str) = match (
+        CStr::from_ptr(query).to_str(),
+        if fields.is_null() {
+            Ok("")
+        } else {
+            CStr::from_ptr(fields).to_str()
+        },
+    ) {
+        (Ok(q), Ok(f)) => (q, f),
+        _ => {
+            set_last_error("Invalid UTF-8 in query or fields");
+            return -2;
+        }
+    };
+
+    let mut selected = Vec::new();
+    for name in fields_str.split([',', ' ']).filter(|name| !name.is_empty()) {
+        match Field::parse(name) {
+            Some(field) => selected.push(field),
+            None => {
+                set_last_error(format!("Unknown facet field: {}", name));
+                return -2;
+            }
+        }
+    }
+    if selected.is_empty() {
+        selected.extend(Field::ALL);
+    }
+
+    match index.facets(query_str, &selected, top_n as usize, approximate) {
+        Ok(result) => {
+            let json = serde_json::to_string(&result).unwrap();
+            *out = CString::new(json).unwrap().into_raw();
+            0
+        }
+        Err(e) => {
+            set_last_error(e.to_string());
+            -3
+        }
+    }
+}
+
+/// Count the documents matching `query`
+///
+/// `mode` is `exact`, `lower_bound` (the largest term's document
+/// frequency, read without touching postings) or `estimate` (sampled from
+/// the postings); NULL means `exact`. The count goes to `*out`.
+///
+/// Returns -2 for an unknown mode and -3 if the profile cannot count.
+///
+/// # Safety
+/// - `idx` must be a valid index pointer
+/// - `query` must be a valid null-terminated C string
+/// - `mode` must be NULL or a valid null-terminated C string
+/// - `out` must be a valid pointer
+#[no_mangle]
+pub unsafe extern "C" fn fts_count(
+    idx: *mut FtsIndex,
+    query: *const c_char,
+    mode: *const c_char,
+    out: *mut u64,
+) -> c_int {
+    if idx.is_null() || query.is_null() || out.is_null() {
+        set_last_error("Null pointer passed to fts_count");
+        return -1;
+    }
+    *out = 0;
+
+    let index = &*idx;
+    let (query_str, mode_str) = match (
+        CStr::from_ptr(query).to_str(),
+        if mode.is_null() {
+            Ok("exact")
+        } else {
+            CStr::from_ptr(mode).to_str()
+        },
+    ) {
+        (Ok(q), Ok(m)) => (q, m),
+        _ => {
+            set_last_error("Invalid UTF-8 in query or mode");
+            return -2;
+        }
+    };
+    let mode = match TotalMode::parse(mode_str) {
+        Some(mode) => mode,
+        None => {
+            set_last_error(format!("Unknown total mode: {}", mode_str));
+            return -2;
+        }
+    };
+
+    match index.count_hits(query_str, mode) {
+        Ok(count) => {
+            *out = count;
+            0
+        }
+        Err(e) => {
+            set_last_error(e.to_string());
+            -3
+        }
+    }
+}
+
 /// Get memory statistics
 ///
 /// # Safety
@@ -563,6 +1357,85 @@ mod tests {
 
             fts_result_free(search_result);
 
+            // Search into a caller buffer: too small first, then exact
+            let mut info = FtsSearchInfo::default();
+            let status = fts_search_into(idx, query.as_ptr(), 10, 0, ptr::null_mut(), 0, &mut info);
+            assert_eq!(status, -4);
+            assert_eq!(info.count, 0);
+            assert_eq!(info.required, std::mem::size_of::<FtsHitRef>() + 1);
+
+            let mut buf = vec![0u8; info.required];
+            let status = fts_search_into(
+                idx,
+                query.as_ptr(),
+                10,
+                0,
+                buf.as_mut_ptr(),
+                buf.len(),
+                &mut info,
+            );
+            assert_eq!(status, 0);
+            assert_eq!(info.count, 1);
+            let hit = (buf.as_ptr() as *const FtsHitRef).read_unaligned();
+            assert_eq!(hit.ordinal, 0);
+            let id_start = std::mem::size_of::<FtsHitRef>() + hit.id_offset as usize;
+            assert_eq!(&buf[id_start..id_start + hit.id_len as usize], b"1");
+
+            // Walk "world" one hit per page
+            let query = CString::new("world").unwrap();
+            let mut next = [0 as c_char; crate::SEARCH_CURSOR_SIZE];
+            let mut ids = Vec::new();
+            loop {
+                let after = next;
+                let status = fts_search_after(
+                    idx,
+                    query.as_ptr(),
+                    after.as_ptr(),
+                    1,
+                    buf.as_mut_ptr(),
+                    buf.len(),
+                    &mut info,
+                    next.as_mut_ptr(),
+                );
+                assert_eq!(status, 0);
+                if info.count == 1 {
+                    let hit = (buf.as_ptr() as *const FtsHitRef).read_unaligned();
+                    let id_start = std::mem::size_of::<FtsHitRef>() + hit.id_offset as usize;
+                    ids.push(buf[id_start..id_start + hit.id_len as usize].to_vec());
+                }
+                if next[0] == 0 {
+                    break;
+                }
+            }
+            ids.sort();
+            assert_eq!(ids, vec![b"1".to_vec(), b"2".to_vec()]);
+            let bad = CString::new("zz").unwrap();
+            let status = fts_search_after(
+                idx,
+                query.as_ptr(),
+                bad.as_ptr(),
+                1,
+                buf.as_mut_ptr(),
+                buf.len(),
+                &mut info,
+                next.as_mut_ptr(),
+            );
+            assert_eq!(status, -2);
+
+            // Count
+            let query = CString::new("world hello").unwrap();
+            let mut count = 0u64;
+            assert_eq!(fts_count(idx, query.as_ptr(), ptr::null(), &mut count), 0);
+            assert_eq!(count, 2);
+            let mode = CString::new("lower_bound").unwrap();
+            assert_eq!(fts_count(idx, query.as_ptr(), mode.as_ptr(), &mut count), 0);
+            assert_eq!(count, 2);
+            let mode = CString::new("most").unwrap();
+            assert_eq!(
+                fts_count(idx, query.as_ptr(), mode.as_ptr(), &mut count),
+                -2
+            );
+
             // Memory stats
             let stats = fts_memory_stats(idx);
             assert_eq!(stats.docs_indexed, 2);
@@ -571,4 +1444,122 @@ mod tests {
             fts_index_close(idx);
         }
     }
+
+    #[test]
+    fn test_ffi_search_filtered() {
+        let dir = tempdir().unwrap();
+        let data_dir = CString::new(dir.path().to_str().unwrap()).unwrap();
+        let profile = CString::new("roaring_bm25").unwrap();
+
+        unsafe {
+            let idx = fts_index_create(data_dir.as_ptr(), profile.as_ptr());
+            assert!(!idx.is_null());
+
+            let docs_json = r#"[
+                {"id":"1","text":"hello world","url":"https://a.com/x","metadata":{"language":"en"}},
+                {"id":"2","text":"hello again","url":"https://b.com/y","metadata":{"language":"fr","date":"2024-01-01"}},
+                {"id":"3","text":"hello there"}
+            ]"#;
+            let n = fts_index_batch(
+                idx,
+                docs_json.as_ptr() as *const c_char,
+                docs_json.len(),
+                None,
+            );
+            assert_eq!(n, 3);
+            assert_eq!(fts_index_commit(idx), 0);
+
+            let query = CString::new("hello").unwrap();
+            let mut buf = vec![0u8; 1024];
+            let mut info = FtsSearchInfo::default();
+            let mut search = |filter: &str| {
+                let filter = CString::new(filter).unwrap();
+                let status = fts_search_filtered(
+                    idx,
+                    query.as_ptr(),
+                    filter.as_ptr(),
+                    10,
+                    0,
+                    buf.as_mut_ptr(),
+                    buf.len(),
+                    &mut info,
+                );
+                (status, info.count)
+            };
+            assert_eq!(search(""), (0, 3));
+            assert_eq!(search("lang:fr OR domain:a.com"), (0, 2));
+            assert_eq!(search("year:2024"), (0, 1));
+            assert_eq!(search("NOT year:2024"), (0, 2));
+            assert_eq!(search("colour:red"), (-2, 0));
+
+            let mut json: *mut c_char = ptr::null_mut();
+            let fields = CString::new("lang, domain").unwrap();
+            let status = fts_facets(idx, query.as_ptr(), fields.as_ptr(), 1, false, &mut json);
+            assert_eq!(status, 0);
+            let facets: serde_json::Value =
+                serde_json::from_str(CStr::from_ptr(json).to_str().unwrap()).unwrap();
+            fts_string_free(json);
+            assert_eq!(facets["matches"], 3);
+            assert_eq!(facets["facets"][0]["field"], "lang");
+            assert_eq!(facets["facets"][0]["counts"][0]["value"], "en");
+            assert_eq!(facets["facets"][1]["counts"].as_array().unwrap().len(), 1);
+
+            let fields = CString::new("colour").unwrap();
+            let status = fts_facets(idx, query.as_ptr(), fields.as_ptr(), 1, false, &mut json);
+            assert_eq!(status, -2);
+            assert!(json.is_null());
+
+            fts_index_close(idx);
+        }
+    }
+
+    #[test]
+    fn test_ffi_ingest_metadata() {
+        let dir = tempdir().unwrap();
+        let data_dir = CString::new(dir.path().to_str().unwrap()).unwrap();
+        let profile = CString::new("roaring_bm25").unwrap();
+
+        let mut chunk = Vec::new();
+        for doc in [
+            ["1", "hello world", "https://a.com/x", "en", ""],
+            ["2", "hello again", "https://b.com/y", "fr", "2024-01-01"],
+        ] {
+            for field in doc {
+                chunk.extend_from_slice(&(field.len() as u32).to_le_bytes());
+                chunk.extend_from_slice(field.as_bytes());
+            }
+        }
+
+        unsafe {
+            let idx = fts_index_create(data_dir.as_ptr(), profile.as_ptr());
+            assert!(!idx.is_null());
+
+            assert!(fts_ingest_begin_format(idx, 1, 1, 7).is_null());
+            let session = fts_ingest_begin_format(idx, 1, 1, crate::BINARY_WITH_METADATA);
+            assert!(!session.is_null());
+            assert_eq!(fts_ingest_push(session, chunk.as_ptr(), chunk.len()), 0);
+            assert_eq!(fts_ingest_finish(session), 2);
+            assert_eq!(fts_index_commit(idx), 0);
+
+            let query = CString::new("hello").unwrap();
+            let mut buf = vec![0u8; 1024];
+            let mut info = FtsSearchInfo::default();
+            for (filter, count) in [("lang:fr", 1), ("domain:a.com", 1), ("year:2024", 1)] {
+                let filter = CString::new(filter).unwrap();
+                let status = fts_search_filtered(
+                    idx,
+                    query.as_ptr(),
+                    filter.as_ptr(),
+                    10,
+                    0,
+                    buf.as_mut_ptr(),
+                    buf.len(),
+                    &mut info,
+                );
+                assert_eq!((status, info.count), (0, count));
+            }
+
+            fts_index_close(idx);
+        }
+    }
 }
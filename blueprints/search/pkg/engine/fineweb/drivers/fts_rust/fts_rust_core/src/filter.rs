@@ -0,0 +1,595 @@
+//! Metadata filters
+//!
+//! Low-cardinality document metadata (language, URL domain and year) is
+//! indexed at ingest as one roaring bitmap of doc IDs per value. A filter
+//! expression such as `lang:en AND (year:2023 OR year:2024) AND NOT
+//! domain:example.com` evaluates to the bitmap of matching docs, which
+//! profiles intersect with their postings before scoring anything.
+//!
+//! Grammar: terms are `field:value`; `AND` binds tighter than `OR`,
+//! `NOT` negates the following term or group, and adjacent terms are
+//! ANDed. Keywords are case-insensitive; values are matched lowercased.
+//!
+//! The same bitmaps give facet counts: each value's count is the
+//! cardinality of its bitmap ANDed with the match bitmap, so no doc ID
+//! is ever enumerated.
+
+use crate::document::DocumentRef;
+use crate::result::{Facet, FacetCount, FacetResult, IndexError, SearchError};
+
+use rayon::prelude::*;
+use roaring::RoaringBitmap;
+use std::collections::HashMap;
+use std::io::{Read, Write};
+use std::sync::Arc;
+
+/// A filterable metadata field
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Field {
+    /// `metadata.language`
+    Language,
+    /// Host of the URL, without a leading `www.`
+    Domain,
+    /// Leading four digits of `metadata.date`
+    Year,
+}
+
+impl Field {
+    pub const ALL: [Field; 3] = [Field::Language, Field::Domain, Field::Year];
+
+    pub fn parse(s: &str) -> Option<Self> {
+        match s.to_lowercase().as_str() {
+            "lang" | "language" => Some(Self::Language),
+            "domain" | "host" => Some(Self::Domain),
+            "year" => Some(Self::Year),
+            _ => None,
+        }
+    }
+
+    pub fn as_str(&self) -> &'static str {
+        match self {
+            Self::Language => "lang",
+            Self::Domain => "domain",
+            Self::Year => "year",
+        }
+    }
+
+    /// The indexed value of this field for `doc`, if it has one
+    pub fn value(&self, doc: &DocumentRef<'_>) -> Option<String> {
+        match self {
+            Self::Language => doc
+                .language
+                .map(str::trim)
+                .filter(|lang| !lang.is_empty())
+                .map(str::to_lowercase),
+            Self::Domain => doc.url.and_then(domain),
+            Self::Year => doc
+                .date
+                .and_then(|date| date.trim().get(..4))
+                .filter(|year| year.bytes().all(|b| b.is_ascii_digit()))
+                .map(str::to_string),
+        }
+    }
+}
+
+/// Host of `url`, lowercased, without scheme, credentials, port or `www.`
+fn domain(url: &str) -> Option<String> {
+    let rest = url.trim();
+    let rest = rest.find("://").map_or(rest, |i| &rest[i + 3..]);
+    let authority = rest.split(['/', '?', '#']).next().unwrap_or("");
+    let host = authority.rsplit('@').next().unwrap_or("");
+    let host = host.split(':').next().unwrap_or("").to_lowercase();
+    let host = host
+        .strip_prefix("www.")
+        .map(str::to_string)
+        .unwrap_or(host);
+    if host.is_empty() {
+        None
+    } else {
+        Some(host)
+    }
+}
+
+/// Matches above which approximate facets count a sample instead
+const FACET_SAMPLE_MIN: u64 = 1 << 20;
+/// Matches an approximate facet sample aims for
+const FACET_SAMPLE_TARGET: u64 = 1 << 18;
+/// Doc IDs per sampled block
+const FACET_SAMPLE_BLOCK: u32 = 4096;
+
+/// Per-value doc bitmaps for each filterable field
+///
+/// A clone shares each bitmap until either copy adds a doc to it.
+#[derive(Debug, Clone, Default)]
+pub struct FieldIndex {
+    /// Bitmaps by value, one map per `Field::ALL` entry
+    values: [HashMap<String, Arc<RoaringBitmap>>; 3],
+    /// Docs covered: doc IDs below this are known to the index, with or
+    /// without metadata (the universe `NOT` complements against)
+    doc_count: u32,
+}
+
+impl FieldIndex {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Record the metadata of `doc`, indexed as `doc_id`
+    pub fn insert(&mut self, doc_id: u32, doc: &DocumentRef<'_>) {
+        for (field, values) in Field::ALL.iter().zip(&mut self.values) {
+            if let Some(value) = field.value(doc) {
+                Arc::make_mut(values.entry(value).or_default()).insert(doc_id);
+            }
+        }
+        self.doc_count = self.doc_count.max(doc_id + 1);
+    }
+
+    /// Cover exactly the docs below `doc_count`: later docs (e.g. pending
+    /// ones that were never saved) are dropped, and earlier docs without
+    /// metadata are covered
+    pub fn resize(&mut self, doc_count: u32) {
+        if doc_count < self.doc_count {
+            for docs in self.values.iter_mut().flat_map(HashMap::values_mut) {
+                Arc::make_mut(docs).remove_range(doc_count..);
+            }
+            for values in &mut self.values {
+                values.retain(|_, docs| !docs.is_empty());
+            }
+        }
+        self.doc_count = doc_count;
+    }
+
+    pub fn doc_count(&self) -> u32 {
+        self.doc_count
+    }
+
+    /// Docs whose `field` is `value`
+    pub fn get(&self, field: Field, value: &str) -> Option<&RoaringBitmap> {
+        self.values[field as usize].get(value).map(|docs| &**docs)
+    }
+
+    /// Values of `field` with their docs, in no particular order
+    pub fn values(&self, field: Field) -> impl Iterator<Item = (&str, &RoaringBitmap)> {
+        self.values[field as usize]
+            .iter()
+            .map(|(value, docs)| (value.as_str(), &**docs))
+    }
+
+    /// Docs matching `filter`
+    pub fn eval(&self, filter: &Filter) -> RoaringBitmap {
+        match filter {
+            Filter::Term(field, value) => self.get(*field, value).cloned().unwrap_or_default(),
+            Filter::And(filters) => {
+                let mut docs = self.eval(&filters[0]);
+                for filter in &filters[1..] {
+                    if docs.is_empty() {
+                        break;
+                    }
+                    docs &= self.eval(filter);
+                }
+                docs
+            }
+            Filter::Or(filters) => {
+                let mut docs = RoaringBitmap::new();
+                for filter in filters {
+                    docs |= self.eval(filter);
+                }
+                docs
+            }
+            Filter::Not(filter) => {
+                let mut docs = RoaringBitmap::new();
+                docs.insert_range(0..self.doc_count);
+                docs -= self.eval(filter);
+                docs
+            }
+        }
+    }
+
+    /// Count the values of `fields` among `matches`, keeping the `top_n`
+    /// most frequent of each. With `approximate`, broad match sets are
+    /// counted on a sample of doc-ID blocks and scaled up.
+    pub fn facets(
+        &self,
+        matches: &RoaringBitmap,
+        fields: &[Field],
+        top_n: usize,
+        approximate: bool,
+    ) -> FacetResult {
+        let sample = if approximate { sample(matches) } else { None };
+        let (counted, scale) = match &sample {
+            Some((docs, scale)) => (docs, *scale),
+            None => (matches, 1.0),
+        };
+
+        let facets = fields
+            .iter()
+            .map(|&field| {
+                let values: Vec<_> = self.values(field).collect();
+                let mut counts: Vec<FacetCount> = values
+                    .par_iter()
+                    .filter_map(|&(value, docs)| {
+                        let count = docs.intersection_len(counted);
+                        (count > 0).then(|| FacetCount {
+                            value: value.to_string(),
+                            count: (count as f64 * scale).round() as u64,
+                        })
+                    })
+                    .collect();
+                counts.sort_unstable_by(|a, b| b.count.cmp(&a.count).then(a.value.cmp(&b.value)));
+                counts.truncate(top_n);
+                Facet {
+                    field: field.as_str().to_string(),
+                    counts,
+                }
+            })
+            .collect();
+
+        FacetResult {
+            facets,
+            matches: matches.len(),
+            approximate: sample.is_some(),
+        }
+    }
+
+    pub fn clear(&mut self) {
+        *self = Self::default();
+    }
+
+    /// Serialized size of the bitmaps plus a rough value overhead
+    pub fn heap_bytes(&self) -> usize {
+        self.values
+            .iter()
+            .flatten()
+            .map(|(value, docs)| value.len() + 32 + docs.serialized_size())
+            .sum()
+    }
+
+    /// Write the index: doc count, then per field a value count and
+    /// length-prefixed values, each followed by its serialized bitmap
+    pub fn write_to<W: Write>(&self, writer: &mut W) -> Result<(), IndexError> {
+        writer.write_all(&self.doc_count.to_le_bytes())?;
+        let mut bitmap_bytes = Vec::new();
+        for values in &self.values {
+            writer.write_all(&(values.len() as u32).to_le_bytes())?;
+            for (value, docs) in values {
+                writer.write_all(&(value.len() as u32).to_le_bytes())?;
+                writer.write_all(value.as_bytes())?;
+                bitmap_bytes.clear();
+                docs.serialize_into(&mut bitmap_bytes)?;
+                writer.write_all(&(bitmap_bytes.len() as u64).to_le_bytes())?;
+                writer.write_all(&bitmap_bytes)?;
+            }
+        }
+        Ok(())
+    }
+
+    /// Read an index written by `write_to`
+    pub fn read_from<R: Read>(reader: &mut R) -> Result<Self, IndexError> {
+        let mut buf4 = [0u8; 4];
+        let mut buf8 = [0u8; 8];
+        let mut index = Self::new();
+
+        reader.read_exact(&mut buf4)?;
+        index.doc_count = u32::from_le_bytes(buf4);
+        for values in &mut index.values {
+            reader.read_exact(&mut buf4)?;
+            let count = u32::from_le_bytes(buf4);
+            for _ in 0..count {
+                reader.read_exact(&mut buf4)?;
+                let mut value = vec![0u8; u32::from_le_bytes(buf4) as usize];
+                reader.read_exact(&mut value)?;
+                let value = String::from_utf8(value)
+                    .map_err(|_| IndexError::Corrupted("Invalid UTF-8".into()))?;
+
+                reader.read_exact(&mut buf8)?;
+                let mut bitmap_bytes = vec![0u8; u64::from_le_bytes(buf8) as usize];
+                reader.read_exact(&mut bitmap_bytes)?;
+                let docs = RoaringBitmap::deserialize_from(&bitmap_bytes[..])
+                    .map_err(|_| IndexError::Corrupted("Invalid bitmap".into()))?;
+                values.insert(value, Arc::new(docs));
+            }
+        }
+        Ok(index)
+    }
+}
+
+/// Every `stride`-th block of doc IDs, intersected with `matches`, and
+/// the factor scaling its counts up to the whole set. `None` when the
+/// matches are few enough to count exactly, or too clustered in doc-ID
+/// space for evenly spaced blocks to represent them.
+fn sample(matches: &RoaringBitmap) -> Option<(RoaringBitmap, f64)> {
+    let total = matches.len();
+    if total <= FACET_SAMPLE_MIN {
+        return None;
+    }
+    let stride = FACET_SAMPLE_BLOCK * (total / FACET_SAMPLE_TARGET) as u32;
+    let last = matches.max()?;
+
+    let mut docs = RoaringBitmap::new();
+    let mut start = 0u32;
+    while start <= last {
+        docs.insert_range(start..start.saturating_add(FACET_SAMPLE_BLOCK));
+        match start.checked_add(stride) {
+            Some(next) => start = next,
+            None => break,
+        }
+    }
+    docs &= matches;
+
+    if docs.len() < FACET_SAMPLE_TARGET / 4 {
+        return None;
+    }
+    let scale = total as f64 / docs.len() as f64;
+    Some((docs, scale))
+}
+
+/// A parsed filter expression
+#[derive(Debug, Clone, PartialEq)]
+pub enum Filter {
+    /// `field:value`
+    Term(Field, String),
+    /// All of (never empty)
+    And(Vec<Filter>),
+    /// Any of (never empty)
+    Or(Vec<Filter>),
+    Not(Box<Filter>),
+}
+
+impl Filter {
+    /// Parse a filter expression (see the module docs)
+    pub fn parse(expr: &str) -> Result<Self, SearchError> {
+        let tokens = lex(expr)?;
+        let mut parser = Parser { tokens, pos: 0 };
+        let filter = parser.or()?;
+        match parser.tokens.get(parser.pos) {
+            None => Ok(filter),
+            Some(token) => Err(invalid(format!("unexpected {:?}", token))),
+        }
+    }
+}
+
+#[derive(Debug, PartialEq)]
+enum Token {
+    And,
+    Or,
+    Not,
+    Open,
+    Close,
+    Term(Field, String),
+}
+
+fn invalid(msg: String) -> SearchError {
+    SearchError::InvalidQuery(format!("filter: {}", msg))
+}
+
+fn lex(expr: &str) -> Result<Vec<Token>, SearchError> {
+    let mut tokens = Vec::new();
+    let mut rest = expr.trim_start();
+    while let Some(c) = rest.chars().next() {
+        let len = match c {
+            '(' => {
+                tokens.push(Token::Open);
+                1
+            }
+            ')' => {
+                tokens.push(Token::Close);
+                1
+            }
+            _ => {
+                let len = rest
+                    .find(|c: char| c.is_whitespace() || c == '(' || c == ')')
+                    .unwrap_or(rest.len());
+                let word = &rest[..len];
+                tokens.push(match word.to_uppercase().as_str() {
+                    "AND" => Token::And,
+                    "OR" => Token::Or,
+                    "NOT" => Token::Not,
+                    _ => {
+                        let (name, value) = word
+                            .split_once(':')
+                            .filter(|(_, value)| !value.is_empty())
+                            .ok_or_else(|| {
+                                invalid(format!("expected field:value, got {:?}", word))
+                            })?;
+                        let field = Field::parse(name)
+                            .ok_or_else(|| invalid(format!("unknown field {:?}", name)))?;
+                        Token::Term(field, value.to_lowercase())
+                    }
+                });
+                len
+            }
+        };
+        rest = rest[len..].trim_start();
+    }
+    Ok(tokens)
+}
+
+/// Recursive descent over `or := and (OR and)*`, `and := unary (AND? unary)*`,
+/// `unary := NOT unary | ( or ) | term`
+struct Parser {
+    tokens: Vec<Token>,
+    pos: usize,
+}
+
+impl Parser {
+    fn peek(&self) -> Option<&Token> {
+        self.tokens.get(self.pos)
+    }
+
+    fn or(&mut self) -> Result<Filter, SearchError> {
+        let mut filters = vec![self.and()?];
+        while self.peek() == Some(&Token::Or) {
+            self.pos += 1;
+            filters.push(self.and()?);
+        }
+        Ok(if filters.len() == 1 {
+            filters.pop().unwrap()
+        } else {
+            Filter::Or(filters)
+        })
+    }
+
+    fn and(&mut self) -> Result<Filter, SearchError> {
+        let mut filters = vec![self.unary()?];
+        loop {
+            match self.peek() {
+                Some(Token::And) => self.pos += 1,
+                Some(Token::Not | Token::Open | Token::Term(..)) => {}
+                _ => break,
+            }
+            filters.push(self.unary()?);
+        }
+        Ok(if filters.len() == 1 {
+            filters.pop().unwrap()
+        } else {
+            Filter::And(filters)
+        })
+    }
+
+    fn unary(&mut self) -> Result<Filter, SearchError> {
+        let token = self
+            .tokens
+            .get(self.pos)
+            .ok_or_else(|| invalid("unexpected end of expression".into()))?;
+        self.pos += 1;
+        match token {
+            Token::Not => Ok(Filter::Not(Box::new(self.unary()?))),
+            Token::Open => {
+                let filter = self.or()?;
+                if self.peek() != Some(&Token::Close) {
+                    return Err(invalid("missing )".into()));
+                }
+                self.pos += 1;
+                Ok(filter)
+            }
+            Token::Term(field, value) => Ok(Filter::Term(*field, value.clone())),
+            token => Err(invalid(format!("unexpected {:?}", token))),
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn doc<'a>(url: &'a str, language: &'a str, date: &'a str) -> DocumentRef<'a> {
+        DocumentRef {
+            url: Some(url),
+            language: Some(language),
+            date: Some(date),
+            ..DocumentRef::new("", "")
+        }
+    }
+
+    #[test]
+    fn test_field_values() {
+        let d = doc(
+            "HTTPS://user@www.Example.com:8080/a?b",
+            " EN ",
+            "2024-03-01",
+        );
+        assert_eq!(Field::Domain.value(&d).as_deref(), Some("example.com"));
+        assert_eq!(Field::Language.value(&d).as_deref(), Some("en"));
+        assert_eq!(Field::Year.value(&d).as_deref(), Some("2024"));
+
+        let d = doc("", "", "March 2024");
+        assert_eq!(Field::Domain.value(&d), None);
+        assert_eq!(Field::Language.value(&d), None);
+        assert_eq!(Field::Year.value(&d), None);
+    }
+
+    #[test]
+    fn test_parse() {
+        let term = |field, value: &str| Filter::Term(field, value.to_string());
+        assert_eq!(
+            Filter::parse("Lang:EN year:2024 or NOT (domain:a.com)").unwrap(),
+            Filter::Or(vec![
+                Filter::And(vec![term(Field::Language, "en"), term(Field::Year, "2024")]),
+                Filter::Not(Box::new(term(Field::Domain, "a.com"))),
+            ])
+        );
+        for bad in [
+            "",
+            "lang",
+            "lang:",
+            "color:red",
+            "(lang:en",
+            "lang:en)",
+            "AND lang:en",
+        ] {
+            assert!(Filter::parse(bad).is_err(), "{:?}", bad);
+        }
+    }
+
+    #[test]
+    fn test_eval_and_roundtrip() {
+        let mut index = FieldIndex::new();
+        index.insert(0, &doc("https://a.com/x", "en", "2023-01-01"));
+        index.insert(1, &doc("https://b.org/", "de", "2024-05-05"));
+        index.insert(2, &doc("http://www.a.com", "en", "2024-12-31"));
+        index.insert(4, &doc("https://c.net", "fr", ""));
+        index.resize(4);
+
+        let eval = |index: &FieldIndex, expr: &str| {
+            index
+                .eval(&Filter::parse(expr).unwrap())
+                .iter()
+                .collect::<Vec<_>>()
+        };
+        assert_eq!(eval(&index, "domain:a.com"), [0, 2]);
+        assert_eq!(eval(&index, "lang:en AND year:2024"), [2]);
+        assert_eq!(eval(&index, "lang:de OR year:2023"), [0, 1]);
+        assert_eq!(eval(&index, "NOT lang:en"), [1, 3]);
+        assert_eq!(eval(&index, "lang:fr"), Vec::<u32>::new());
+
+        let mut bytes = Vec::new();
+        index.write_to(&mut bytes).unwrap();
+        let loaded = FieldIndex::read_from(&mut &bytes[..]).unwrap();
+        assert_eq!(loaded.doc_count(), 4);
+        assert_eq!(eval(&loaded, "NOT (lang:en year:2024)"), [0, 1, 3]);
+    }
+
+    #[test]
+    fn test_facets() {
+        let mut index = FieldIndex::new();
+        index.insert(0, &doc("https://a.com", "en", "2024"));
+        index.insert(1, &doc("https://b.com", "en", "2023"));
+        index.insert(2, &doc("https://a.com", "de", "2024"));
+        index.insert(3, &doc("https://c.com", "en", "2024"));
+        let matches: RoaringBitmap = [0, 2, 3].into_iter().collect();
+
+        let result = index.facets(&matches, &[Field::Domain, Field::Year], 1, true);
+        assert_eq!(result.matches, 3);
+        assert!(!result.approximate);
+        assert_eq!(result.facets[0].field, "domain");
+        assert_eq!(
+            result.facets[0].counts,
+            [FacetCount {
+                value: "a.com".into(),
+                count: 2
+            }]
+        );
+        assert_eq!(result.facets[1].counts[0].count, 3);
+
+        // Broad matches: the sample extrapolates close to the exact counts
+        let mut index = FieldIndex::new();
+        let mut en = RoaringBitmap::new();
+        en.insert_range(0..1_500_000);
+        let mut de = RoaringBitmap::new();
+        de.insert_range(1_500_000..2_000_000);
+        index.values[Field::Language as usize].insert("en".into(), Arc::new(en));
+        index.values[Field::Language as usize].insert("de".into(), Arc::new(de));
+        index.resize(2_000_000);
+        let mut matches = RoaringBitmap::new();
+        matches.insert_range(0..2_000_000);
+
+        let exact = index.facets(&matches, &[Field::Language], 10, false);
+        let approx = index.facets(&matches, &[Field::Language], 10, true);
+        assert!(approx.approximate);
+        for (exact, approx) in exact.facets[0].counts.iter().zip(&approx.facets[0].counts) {
+            assert_eq!(exact.value, approx.value);
+            let error = (exact.count as f64 - approx.count as f64).abs() / exact.count as f64;
+            assert!(error < 0.05, "{:?} vs {:?}", exact, approx);
+        }
+    }
+}
@@ -1,18 +1,88 @@
 //! FtsIndex - Main index wrapper
 
-use crate::document::Document;
+use crate::document::{Document, DocumentRef};
+use crate::filter::{Field, Filter};
+use crate::ingest::{IngestOptions, IngestSession};
 use crate::profiles::{create_profile, ProfileType, SearchProfile};
-use crate::result::{IndexError, MemoryStats, SearchError, SearchResult};
+use crate::result::{
+    FacetResult, HitBuffer, IndexError, MemoryStats, SearchCursor, SearchError, SearchResult,
+    TotalMode,
+};
+use crate::segments::sync_dir;
 
 use parking_lot::RwLock;
+use serde::{Deserialize, Serialize};
 use std::path::{Path, PathBuf};
+use std::sync::Arc;
+
+/// Checkpoint manifest, replaced atomically by each checkpoint
+const CHECKPOINT_FILE: &str = "checkpoint.json";
+/// Profile files are saved here first, then renamed into place
+const CHECKPOINT_STAGING_DIR: &str = ".checkpoint";
+/// Each checkpoint hard-links the saved index files into
+/// `<prefix><generation>`, which later commits never touch
+const CHECKPOINT_GENERATION_PREFIX: &str = ".checkpoint-";
+
+/// Position in the ingest source to continue from after a checkpoint
+/// (e.g. the next parquet file / row group / row to read)
+#[derive(Debug, Clone, Default, PartialEq, Eq, Serialize, Deserialize)]
+pub struct SourceCursor {
+    /// Source file (or other opaque source name)
+    pub file: String,
+    /// Row group within `file`
+    #[serde(default)]
+    pub row_group: u64,
+    /// Row within the row group
+    #[serde(default)]
+    pub row: u64,
+}
+
+/// A durable build checkpoint
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct Checkpoint {
+    /// Profile the index was built with
+    pub profile: String,
+    /// Documents in the saved index
+    pub doc_count: u64,
+    /// Where ingestion continues
+    pub cursor: SourceCursor,
+    /// Directory of index files saved with this checkpoint; 0 for
+    /// checkpoints that predate generations and resume from the live files
+    #[serde(default)]
+    pub generation: u64,
+}
+
+/// Writable profile, shared with ingest sessions. Batches hold the read
+/// lock when the profile supports concurrent writes; commit and the rest
+/// hold the write lock.
+pub(crate) type SharedWriter = Arc<RwLock<Box<dyn SearchProfile>>>;
+
+/// Index `docs` into a loaded writer: alongside other callers if the
+/// profile supports shared writes, otherwise under the exclusive lock
+pub(crate) fn write_batch(
+    writer: &SharedWriter,
+    docs: &[DocumentRef<'_>],
+) -> Result<usize, IndexError> {
+    if let Some(result) = writer.read().index_batch_shared(docs) {
+        return result;
+    }
+    writer.write().index_batch_refs(docs)
+}
 
 /// Main FTS index
+///
+/// Writes go to a private writer profile; searches run against the last
+/// published generation, an immutable profile swapped in by each commit.
+/// Readers only take the generation lock long enough to clone its `Arc`,
+/// so queries keep flowing while a batch is indexed or committed, and an
+/// old generation is dropped when its last in-flight search finishes.
 pub struct FtsIndex {
     /// Data directory
     data_dir: PathBuf,
-    /// Current profile
-    profile: RwLock<Box<dyn SearchProfile>>,
+    /// Profile receiving writes
+    writer: SharedWriter,
+    /// Generation served to searches
+    published: RwLock<Arc<dyn SearchProfile>>,
     /// Profile type
     profile_type: ProfileType,
 }
@@ -31,10 +101,12 @@ impl FtsIndex {
         // Initialize profile with data directory
         // This is needed for profiles like Tantivy that write to disk immediately
         profile.init(&data_dir)?;
+        let published = profile.snapshot()?;
 
         Ok(Self {
             data_dir,
-            profile: RwLock::new(profile),
+            writer: Arc::new(RwLock::new(profile)),
+            published: RwLock::new(Arc::from(published)),
             profile_type,
         })
     }
@@ -48,12 +120,18 @@ impl FtsIndex {
 
         // Try to detect profile from existing files
         let profile_type = Self::detect_profile(&data_dir)?;
+        Self::open_as(data_dir, profile_type)
+    }
+
+    fn open_as(data_dir: PathBuf, profile_type: ProfileType) -> Result<Self, IndexError> {
         let mut profile = create_profile(profile_type);
         profile.load(&data_dir)?;
+        let published = profile.snapshot()?;
 
         Ok(Self {
             data_dir,
-            profile: RwLock::new(profile),
+            writer: Arc::new(RwLock::new(profile)),
+            published: RwLock::new(Arc::from(published)),
             profile_type,
         })
     }
@@ -72,7 +150,7 @@ impl FtsIndex {
             Ok(ProfileType::Tantivy)
         } else if data_dir.join("turbo.idx").exists() {
             Ok(ProfileType::Turbo)
-        } else if data_dir.join("ultra.idx").exists() {
+        } else if data_dir.join("ultra.manifest").exists() || data_dir.join("ultra.idx").exists() {
             Ok(ProfileType::Ultra)
         } else {
             // Default to ultra for best throughput
@@ -90,42 +168,288 @@ impl FtsIndex {
         self.profile_type
     }
 
-    /// Index a batch of documents
+    /// Index a batch of documents. They become searchable at the next commit.
     pub fn index_batch(&self, docs: &[Document]) -> Result<usize, IndexError> {
-        self.profile.write().index_batch(docs)
+        let refs: Vec<DocumentRef<'_>> = docs.iter().map(DocumentRef::from).collect();
+        self.index_batch_refs(&refs)
     }
 
-    /// Commit pending changes
+    /// Index a batch of borrowed documents (no copy of the text).
+    ///
+    /// May be called from several threads at once: profiles that support
+    /// shared writes index the batches concurrently, reserving doc IDs
+    /// atomically; the others take them one at a time.
+    pub fn index_batch_refs(&self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
+        write_batch(&self.writer, docs)
+    }
+
+    /// Start a streaming ingest session: chunks pushed to it are parsed and
+    /// indexed on a dedicated thread pool while the caller reads more input
+    pub fn ingest(&self, opts: IngestOptions) -> Result<IngestSession, IndexError> {
+        IngestSession::begin(Arc::clone(&self.writer), opts)
+    }
+
+    /// Commit pending changes and publish them to searches
     pub fn commit(&self) -> Result<(), IndexError> {
-        let mut profile = self.profile.write();
-        profile.commit()?;
-        profile.save(&self.data_dir)?;
+        self.with_writer(|profile| {
+            profile.commit()?;
+            self.save(profile)?;
+            self.publish(profile)
+        })
+    }
+
+    /// Save the writer's committed state to `data_dir`.
+    ///
+    /// Profile files are written to a staging directory and renamed into
+    /// place (segmented profiles save in place, as their saves only add
+    /// files and rename). Either way a file in `data_dir` is never
+    /// rewritten, so the links a checkpoint keeps to it stay intact.
+    fn save(&self, profile: &dyn SearchProfile) -> Result<(), IndexError> {
+        if profile.atomic_save() {
+            profile.save(&self.data_dir)?;
+        } else {
+            let staging = self.data_dir.join(CHECKPOINT_STAGING_DIR);
+            if staging.exists() {
+                std::fs::remove_dir_all(&staging)?;
+            }
+            std::fs::create_dir_all(&staging)?;
+            profile.save(&staging)?;
+            for entry in std::fs::read_dir(&staging)? {
+                let entry = entry?;
+                std::fs::rename(entry.path(), self.data_dir.join(entry.file_name()))?;
+            }
+            std::fs::remove_dir(&staging)?;
+        }
+        sync_dir(&self.data_dir)
+    }
+
+    /// Run `f` on the writable profile with exclusive access
+    fn with_writer<T>(
+        &self,
+        f: impl FnOnce(&mut dyn SearchProfile) -> Result<T, IndexError>,
+    ) -> Result<T, IndexError> {
+        f(self.writer.write().as_mut())
+    }
+
+    /// Replace the searched generation with a snapshot of the writer's
+    /// committed state
+    fn publish(&self, writer: &dyn SearchProfile) -> Result<(), IndexError> {
+        *self.published.write() = Arc::from(writer.snapshot()?);
         Ok(())
     }
 
-    /// Search the index
+    /// The current generation; stays valid for as long as it is held
+    fn generation(&self) -> Arc<dyn SearchProfile> {
+        Arc::clone(&self.published.read())
+    }
+
+    /// Create or continue a resumable bulk build.
+    ///
+    /// If `data_dir` holds a checkpoint, the index saved with it is restored
+    /// (dropping anything committed since) and opened, and the source cursor
+    /// to continue from is returned. Otherwise a new index is created and the
+    /// cursor is `None` (start from the beginning).
+    pub fn resume(
+        data_dir: impl AsRef<Path>,
+        profile_name: &str,
+    ) -> Result<(Self, Option<SourceCursor>), IndexError> {
+        let data_dir = data_dir.as_ref().to_path_buf();
+        let checkpoint = match Self::read_checkpoint(&data_dir)? {
+            Some(cp) => cp,
+            None => return Ok((Self::create(data_dir, profile_name)?, None)),
+        };
+
+        let profile_type = ProfileType::parse(&checkpoint.profile)
+            .ok_or_else(|| IndexError::UnknownProfile(checkpoint.profile.clone()))?;
+        if ProfileType::parse(profile_name) != Some(profile_type) {
+            return Err(IndexError::Corrupted(format!(
+                "checkpoint was written by profile {}, not {}",
+                checkpoint.profile, profile_name
+            )));
+        }
+
+        if checkpoint.generation > 0 {
+            restore_generation(&data_dir, checkpoint.generation)?;
+        }
+        let index = Self::open_as(data_dir, profile_type)?;
+        if index.doc_count() != checkpoint.doc_count {
+            // Without a generation the live files may be ahead of the cursor
+            return Err(IndexError::Corrupted(format!(
+                "index has {} docs but checkpoint recorded {}",
+                index.doc_count(),
+                checkpoint.doc_count
+            )));
+        }
+
+        Ok((index, Some(checkpoint.cursor)))
+    }
+
+    /// Commit and durably save everything indexed so far, then record
+    /// `cursor` as the point to resume from.
+    ///
+    /// The saved files are hard-linked into a new generation directory and
+    /// `checkpoint.json`, which names it, is replaced last. A crash at any
+    /// point leaves the previous checkpoint and its files intact, and later
+    /// commits cannot move the index away from the recorded cursor.
+    pub fn checkpoint(&self, cursor: SourceCursor) -> Result<Checkpoint, IndexError> {
+        self.with_writer(|profile| {
+            profile.commit()?;
+            self.save(profile)?;
+            self.publish(profile)?;
+
+            let previous = Self::read_checkpoint(&self.data_dir)?.map_or(0, |cp| cp.generation);
+            let generation = previous + 1;
+            let saved = generation_dir(&self.data_dir, generation);
+            if saved.exists() {
+                // Left over from a checkpoint that crashed before being recorded
+                std::fs::remove_dir_all(&saved)?;
+            }
+            link_files(&self.data_dir, &saved)?;
+
+            let checkpoint = Checkpoint {
+                profile: self.profile_type.as_str().to_string(),
+                doc_count: profile.doc_count(),
+                cursor,
+                generation,
+            };
+            let bytes = serde_json::to_vec(&checkpoint)
+                .map_err(|e| IndexError::Serialization(e.to_string()))?;
+
+            let tmp_path = self.data_dir.join(format!("{}.tmp", CHECKPOINT_FILE));
+            {
+                let mut file = std::fs::File::create(&tmp_path)?;
+                std::io::Write::write_all(&mut file, &bytes)?;
+                file.sync_all()?;
+            }
+            std::fs::rename(&tmp_path, self.data_dir.join(CHECKPOINT_FILE))?;
+            sync_dir(&self.data_dir)?;
+
+            remove_generations(&self.data_dir, Some(generation))?;
+            Ok(checkpoint)
+        })
+    }
+
+    /// Last recorded checkpoint, if any
+    pub fn last_checkpoint(&self) -> Result<Option<Checkpoint>, IndexError> {
+        Self::read_checkpoint(&self.data_dir)
+    }
+
+    /// Forget checkpoints once the build has finished
+    pub fn clear_checkpoint(&self) -> Result<(), IndexError> {
+        match std::fs::remove_file(self.data_dir.join(CHECKPOINT_FILE)) {
+            Ok(()) => {}
+            Err(e) if e.kind() == std::io::ErrorKind::NotFound => {}
+            Err(e) => return Err(e.into()),
+        }
+        remove_generations(&self.data_dir, None)
+    }
+
+    fn read_checkpoint(data_dir: &Path) -> Result<Option<Checkpoint>, IndexError> {
+        let bytes = match std::fs::read(data_dir.join(CHECKPOINT_FILE)) {
+            Ok(b) => b,
+            Err(e) if e.kind() == std::io::ErrorKind::NotFound => return Ok(None),
+            Err(e) => return Err(e.into()),
+        };
+        serde_json::from_slice(&bytes)
+            .map(Some)
+            .map_err(|e| IndexError::Corrupted(format!("checkpoint: {}", e)))
+    }
+
+    /// Search the committed documents. Never waits for indexing.
     pub fn search(
         &self,
         query: &str,
         limit: usize,
         offset: usize,
     ) -> Result<SearchResult, SearchError> {
-        self.profile.read().search(query, limit, offset)
+        self.generation().search(query, limit, offset)
+    }
+
+    /// Search the committed documents into `out`, reusing its storage
+    /// (see `SearchProfile::search_hits`). Never waits for indexing.
+    pub fn search_hits(
+        &self,
+        query: &str,
+        limit: usize,
+        offset: usize,
+        out: &mut HitBuffer,
+    ) -> Result<(), SearchError> {
+        self.generation().search_hits(query, limit, offset, out)
+    }
+
+    /// Search the committed documents, with `total` counted per `mode`
+    /// instead of the hit count
+    pub fn search_with_total(
+        &self,
+        query: &str,
+        limit: usize,
+        offset: usize,
+        mode: TotalMode,
+    ) -> Result<SearchResult, SearchError> {
+        let generation = self.generation();
+        let mut result = generation.search(query, limit, offset)?;
+        let count = generation.count_hits(query, mode)?;
+        result.total = count.max((offset + result.hits.len()) as u64);
+        Ok(result)
     }
 
-    /// Get memory statistics
+    /// Search the committed documents ranked after `after`, or from the
+    /// top without one. Pass each result's `next` to walk every hit.
+    pub fn search_after(
+        &self,
+        query: &str,
+        limit: usize,
+        after: Option<SearchCursor>,
+    ) -> Result<SearchResult, SearchError> {
+        self.generation().search_after(query, limit, after)
+    }
+
+    /// Count the committed documents matching `query`
+    pub fn count_hits(&self, query: &str, mode: TotalMode) -> Result<u64, SearchError> {
+        self.generation().count_hits(query, mode)
+    }
+
+    /// Search the committed documents matching a metadata filter
+    pub fn search_filtered(
+        &self,
+        query: &str,
+        filter: &Filter,
+        limit: usize,
+        offset: usize,
+    ) -> Result<SearchResult, SearchError> {
+        self.generation()
+            .search_filtered(query, filter, limit, offset)
+    }
+
+    /// Facet counts over every committed document matching `query`
+    pub fn facets(
+        &self,
+        query: &str,
+        fields: &[Field],
+        top_n: usize,
+        approximate: bool,
+    ) -> Result<FacetResult, SearchError> {
+        self.generation().facets(query, fields, top_n, approximate)
+    }
+
+    /// Memory statistics of the published generation
     pub fn memory_stats(&self) -> MemoryStats {
-        self.profile.read().memory_stats()
+        self.generation().memory_stats()
     }
 
-    /// Get document count
+    /// Committed document count
     pub fn doc_count(&self) -> u64 {
-        self.profile.read().doc_count()
+        self.generation().doc_count()
     }
 
-    /// Clear the index
+    /// Clear the index, for writers and searches alike
     pub fn clear(&self) {
-        self.profile.write().clear();
+        let mut writer = self.writer.write();
+        writer.clear();
+        let empty = writer
+            .snapshot()
+            .unwrap_or_else(|_| create_profile(self.profile_type));
+        *self.published.write() = Arc::from(empty);
     }
 
     /// Get data directory
@@ -134,6 +458,86 @@ impl FtsIndex {
     }
 }
 
+/// Directory holding the files of checkpoint `generation`
+fn generation_dir(data_dir: &Path, generation: u64) -> PathBuf {
+    data_dir.join(format!("{}{:06}", CHECKPOINT_GENERATION_PREFIX, generation))
+}
+
+/// Whether a top-level entry of `data_dir` belongs to the index itself,
+/// rather than to checkpoint bookkeeping (dot directories, manifests)
+fn is_index_entry(name: &std::ffi::OsStr) -> bool {
+    let name = name.to_string_lossy();
+    !name.starts_with('.') && !name.starts_with(CHECKPOINT_FILE)
+}
+
+/// Hard-link the index files under `src` into `dst`, syncing each file and
+/// directory so the links outlive a crash
+fn link_files(src: &Path, dst: &Path) -> Result<(), IndexError> {
+    link_entries(src, dst, is_index_entry)
+}
+
+fn link_entries(
+    src: &Path,
+    dst: &Path,
+    keep: fn(&std::ffi::OsStr) -> bool,
+) -> Result<(), IndexError> {
+    std::fs::create_dir_all(dst)?;
+    for entry in std::fs::read_dir(src)? {
+        let entry = entry?;
+        if !keep(&entry.file_name()) {
+            continue;
+        }
+        let target = dst.join(entry.file_name());
+        if entry.file_type()?.is_dir() {
+            // Below the top level everything belongs to the profile
+            link_entries(&entry.path(), &target, |_| true)?;
+        } else {
+            std::fs::hard_link(entry.path(), &target)?;
+            std::fs::File::open(&target)?.sync_all()?;
+        }
+    }
+    sync_dir(dst)
+}
+
+/// Replace the live index files with those of checkpoint `generation`
+fn restore_generation(data_dir: &Path, generation: u64) -> Result<(), IndexError> {
+    let saved = generation_dir(data_dir, generation);
+    if !saved.is_dir() {
+        return Err(IndexError::Corrupted(format!(
+            "checkpoint files missing: {}",
+            saved.display()
+        )));
+    }
+    for entry in std::fs::read_dir(data_dir)? {
+        let entry = entry?;
+        if !is_index_entry(&entry.file_name()) {
+            continue;
+        }
+        if entry.file_type()?.is_dir() {
+            std::fs::remove_dir_all(entry.path())?;
+        } else {
+            std::fs::remove_file(entry.path())?;
+        }
+    }
+    link_files(&saved, data_dir)
+}
+
+/// Remove checkpoint generation directories other than `keep`
+fn remove_generations(data_dir: &Path, keep: Option<u64>) -> Result<(), IndexError> {
+    let keep = keep.map(|generation| generation_dir(data_dir, generation));
+    for entry in std::fs::read_dir(data_dir)? {
+        let entry = entry?;
+        let is_generation = entry
+            .file_name()
+            .to_string_lossy()
+            .starts_with(CHECKPOINT_GENERATION_PREFIX);
+        if is_generation && Some(entry.path()) != keep {
+            std::fs::remove_dir_all(entry.path())?;
+        }
+    }
+    Ok(())
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -164,6 +568,134 @@ mod tests {
         assert_eq!(result.hits.len(), 2);
     }
 
+    #[test]
+    fn test_checkpoint_resume() {
+        for profile in [ProfileType::BmwSimd, ProfileType::Ultra] {
+            let dir = tempdir().unwrap();
+            let name = profile.as_str();
+
+            let (index, cursor) = FtsIndex::resume(dir.path(), name).unwrap();
+            assert!(cursor.is_none());
+
+            index
+                .index_batch(&[
+                    Document::new("1", "hello world"),
+                    Document::new("2", "world peace"),
+                ])
+                .unwrap();
+            let next = SourceCursor {
+                file: "part-0001.parquet".into(),
+                row_group: 3,
+                row: 0,
+            };
+            let cp = index.checkpoint(next.clone()).unwrap();
+            assert_eq!(cp.doc_count, 2);
+
+            // Committed but not checkpointed: rolled back on resume
+            index
+                .index_batch(&[Document::new("3", "hello again")])
+                .unwrap();
+            index.commit().unwrap();
+            // Not committed at all: lost on "crash"
+            index
+                .index_batch(&[Document::new("4", "hello there")])
+                .unwrap();
+            drop(index);
+
+            let (index, cursor) = FtsIndex::resume(dir.path(), name).unwrap();
+            assert_eq!(cursor, Some(next.clone()));
+            assert_eq!(index.doc_count(), 2);
+            assert_eq!(index.search("hello", 10, 0).unwrap().hits.len(), 1);
+
+            // A later checkpoint replaces the earlier generation
+            index
+                .index_batch(&[Document::new("3", "hello again")])
+                .unwrap();
+            let cp = index.checkpoint(next).unwrap();
+            assert_eq!((cp.doc_count, cp.generation), (3, 2));
+            assert!(!generation_dir(dir.path(), 1).exists());
+            drop(index);
+
+            let (index, _) = FtsIndex::resume(dir.path(), name).unwrap();
+            assert_eq!(index.search("hello", 10, 0).unwrap().hits.len(), 2);
+            index.clear_checkpoint().unwrap();
+            assert!(index.last_checkpoint().unwrap().is_none());
+            assert!(!generation_dir(dir.path(), 2).exists());
+        }
+    }
+
+    #[test]
+    fn test_search_during_indexing() {
+        for profile in [
+            ProfileType::BmwSimd,
+            ProfileType::RoaringBm25,
+            ProfileType::Ensemble,
+            ProfileType::Seismic,
+            ProfileType::Tantivy,
+            ProfileType::Turbo,
+            ProfileType::Ultra,
+        ] {
+            let dir = tempdir().unwrap();
+            let index = FtsIndex::create(dir.path(), profile.as_str()).unwrap();
+            index
+                .index_batch(&[Document::new("1", "hello world")])
+                .unwrap();
+            index.commit().unwrap();
+
+            // Uncommitted documents stay invisible
+            index
+                .index_batch(&[Document::new("2", "hello again")])
+                .unwrap();
+            assert_eq!(index.search("hello", 10, 0).unwrap().hits.len(), 1);
+
+            // Searches never wait for the writer
+            let generation = index.generation();
+            {
+                let _writer = index.writer.write();
+                assert_eq!(index.search("hello", 10, 0).unwrap().hits.len(), 1);
+            }
+
+            index.commit().unwrap();
+            assert_eq!(index.search("hello", 10, 0).unwrap().hits.len(), 2);
+            // A held generation keeps answering from its own state, even
+            // once the writer is cleared
+            assert_eq!(generation.search("hello", 10, 0).unwrap().hits.len(), 1);
+            index.clear();
+            assert_eq!(index.search("hello", 10, 0).unwrap().hits.len(), 0);
+            assert_eq!(generation.search("hello", 10, 0).unwrap().hits.len(), 1);
+            assert_eq!(generation.doc_count(), 1, "Profile {}", profile.as_str());
+        }
+    }
+
+    #[test]
+    fn test_concurrent_writers() {
+        for profile in ProfileType::all() {
+            let dir = tempdir().unwrap();
+            let index = FtsIndex::create(dir.path(), profile.as_str()).unwrap();
+
+            std::thread::scope(|s| {
+                for t in 0..4 {
+                    let index = &index;
+                    s.spawn(move || {
+                        for b in 0..10 {
+                            let docs: Vec<_> = (0..25)
+                                .map(|i| {
+                                    Document::new(format!("{}-{}-{}", t, b, i), "shared writer")
+                                })
+                                .collect();
+                            assert_eq!(index.index_batch(&docs).unwrap(), 25);
+                        }
+                    });
+                }
+            });
+            index.commit().unwrap();
+
+            assert_eq!(index.doc_count(), 1000, "Profile {}", profile.as_str());
+            let result = index.search("writer", 10, 0).unwrap();
+            assert!(!result.hits.is_empty(), "Profile {}", profile.as_str());
+        }
+    }
+
     #[test]
     fn test_all_profiles() {
         for profile in ProfileType::all() {
@@ -184,6 +716,132 @@ mod tests {
                 "Profile {} failed",
                 profile.as_str()
             );
+
+            // search_hits yields the same page without building hits
+            let mut out = HitBuffer::new();
+            index.search_hits("test", 10, 0, &mut out).unwrap();
+            let hits: Vec<_> = out.iter().map(|(s, id)| (s, id.to_string())).collect();
+            let expected: Vec<_> = result
+                .hits
+                .iter()
+                .map(|h| (h.score, h.id.clone()))
+                .collect();
+            assert_eq!(hits, expected, "Profile {}", profile.as_str());
+        }
+    }
+
+    #[test]
+    fn test_search_filtered() {
+        let dir = tempdir().unwrap();
+        let index = FtsIndex::create(dir.path(), "roaring_bm25").unwrap();
+        let docs = vec![
+            Document::new("1", "hello world").with_url("https://a.com/1"),
+            Document::new("2", "hello there").with_url("https://b.com/2"),
+        ];
+        index.index_batch(&docs).unwrap();
+        index.commit().unwrap();
+
+        let filter = Filter::parse("domain:b.com").unwrap();
+        let result = index.search_filtered("hello", &filter, 10, 0).unwrap();
+        assert_eq!(result.hits.len(), 1);
+        assert_eq!(result.hits[0].id, "2");
+
+        // Profiles without metadata bitmaps reject filters
+        let dir = tempdir().unwrap();
+        let index = FtsIndex::create(dir.path(), "bmw_simd").unwrap();
+        assert!(index.search_filtered("hello", &filter, 10, 0).is_err());
+    }
+
+    #[test]
+    fn test_search_after() {
+        let docs: Vec<Document> = (0..100)
+            .map(|i| {
+                let text = match i % 4 {
+                    0 => "walk the whole result list",
+                    1 => "walk walk list",
+                    2 => "result",
+                    _ => "unrelated",
+                };
+                Document::new(i.to_string(), text)
+            })
+            .collect();
+
+        for profile in [
+            "ultra",
+            "turbo",
+            "bmw_simd",
+            "ensemble",
+            "roaring_bm25",
+            "seismic",
+        ] {
+            let dir = tempdir().unwrap();
+            let index = FtsIndex::create(dir.path(), profile).unwrap();
+            index.index_batch(&docs).unwrap();
+            index.commit().unwrap();
+
+            let all = index.search("walk result", 100, 0).unwrap();
+            assert_eq!(all.hits.len(), 75, "{}", profile);
+
+            let mut walked = Vec::new();
+            let mut after = None;
+            loop {
+                let page = index.search_after("walk result", 10, after).unwrap();
+                assert!(page.hits.len() <= 10);
+                walked.extend(page.hits.into_iter().map(|hit| hit.id));
+                after = page.next;
+                if after.is_none() {
+                    break;
+                }
+            }
+            let expected: Vec<String> = all.hits.into_iter().map(|hit| hit.id).collect();
+            assert_eq!(walked, expected, "{}", profile);
+        }
+    }
+
+    #[test]
+    fn test_count_hits() {
+        let docs: Vec<Document> = (0..300)
+            .map(|i| {
+                let text = match i % 3 {
+                    0 => "alpha beta",
+                    1 => "alpha gamma",
+                    _ => "delta",
+                };
+                Document::new(i.to_string(), text)
+            })
+            .collect();
+
+        for profile in [
+            "ultra",
+            "turbo",
+            "bmw_simd",
+            "ensemble",
+            "roaring_bm25",
+            "seismic",
+        ] {
+            let dir = tempdir().unwrap();
+            let index = FtsIndex::create(dir.path(), profile).unwrap();
+            index.index_batch(&docs).unwrap();
+            index.commit().unwrap();
+
+            let count = |query, mode| index.count_hits(query, mode).unwrap();
+            assert_eq!(count("beta gamma", TotalMode::Exact), 200, "{}", profile);
+            assert_eq!(count("alpha beta", TotalMode::Exact), 200, "{}", profile);
+            assert_eq!(
+                count("alpha beta", TotalMode::LowerBound),
+                200,
+                "{}",
+                profile
+            );
+            assert_eq!(count("missing", TotalMode::Estimate), 0, "{}", profile);
+            let estimate = count("beta gamma delta", TotalMode::Estimate);
+            assert!((250..=300).contains(&estimate), "{}: {}", profile, estimate);
+
+            let result = index
+                .search_with_total("alpha", 10, 0, TotalMode::Exact)
+                .unwrap();
+            assert_eq!(result.hits.len(), 10);
+            assert_eq!(result.total, 200, "{}", profile);
         }
     }
 }
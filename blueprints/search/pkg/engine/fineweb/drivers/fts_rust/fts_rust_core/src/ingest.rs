@@ -0,0 +1,159 @@
+//! Streaming ingestion sessions
+//!
+//! A session owns a bounded queue of binary-format chunks (see
+//! `document::parse_binary`) and a worker thread that parses and indexes
+//! them on a dedicated thread pool. `push` returns as soon as the chunk is
+//! queued and blocks only while the queue is full, so the producer keeps
+//! reading input while earlier chunks are being indexed.
+
+use crate::document::{parse_binary, BinaryFormat};
+use crate::index::{write_batch, SharedWriter};
+use crate::result::IndexError;
+
+use crossbeam_channel::{bounded, Sender};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
+use std::thread::JoinHandle;
+
+/// Ingest session configuration
+#[derive(Debug, Clone, Copy)]
+pub struct IngestOptions {
+    /// Chunks that may wait in the queue before `push` blocks
+    pub queue_depth: usize,
+    /// Indexing threads (0 = number of CPUs)
+    pub threads: usize,
+    /// Layout of the pushed chunks
+    pub format: BinaryFormat,
+}
+
+impl Default for IngestOptions {
+    fn default() -> Self {
+        Self {
+            queue_depth: 4,
+            threads: 0,
+            format: BinaryFormat::Plain,
+        }
+    }
+}
+
+/// A running ingest pipeline: a bounded chunk queue and its indexing worker
+pub struct IngestSession {
+    sender: Option<Sender<Vec<u8>>>,
+    worker: Option<JoinHandle<Result<(), IndexError>>>,
+    indexed: Arc<AtomicU64>,
+}
+
+impl IngestSession {
+    pub(crate) fn begin(writer: SharedWriter, opts: IngestOptions) -> Result<Self, IndexError> {
+        let pool = rayon::ThreadPoolBuilder::new()
+            .num_threads(opts.threads)
+            .thread_name(|i| format!("fts-ingest-{}", i))
+            .build()
+            .map_err(|e| IndexError::Io(std::io::Error::other(e.to_string())))?;
+
+        let (sender, receiver) = bounded::<Vec<u8>>(opts.queue_depth.max(1));
+        let indexed = Arc::new(AtomicU64::new(0));
+        let counter = Arc::clone(&indexed);
+
+        let worker = std::thread::Builder::new()
+            .name("fts-ingest".into())
+            .spawn(move || {
+                // Returning drops the receiver, which fails further pushes
+                for chunk in receiver {
+                    let n = pool.install(|| {
+                        let docs = parse_binary(&chunk, usize::MAX, opts.format);
+                        write_batch(&writer, &docs)
+                    })?;
+                    counter.fetch_add(n as u64, Ordering::Relaxed);
+                }
+                Ok(())
+            })?;
+
+        Ok(Self {
+            sender: Some(sender),
+            worker: Some(worker),
+            indexed,
+        })
+    }
+
+    /// Queue a chunk of whole documents, blocking while the queue is full.
+    /// Fails if indexing an earlier chunk failed (`finish` returns the error).
+    pub fn push(&self, chunk: Vec<u8>) -> Result<(), IndexError> {
+        let sender = self.sender.as_ref().expect("session finished");
+        sender
+            .send(chunk)
+            .map_err(|_| IndexError::Io(std::io::Error::other("ingest worker stopped")))
+    }
+
+    /// Documents indexed so far
+    pub fn indexed(&self) -> u64 {
+        self.indexed.load(Ordering::Relaxed)
+    }
+
+    /// Wait for all queued chunks to be indexed and return the document
+    /// count. Documents still need `FtsIndex::commit` to become searchable
+    /// on disk, as with `index_batch`.
+    pub fn finish(mut self) -> Result<u64, IndexError> {
+        self.stop()?;
+        Ok(self.indexed())
+    }
+
+    fn stop(&mut self) -> Result<(), IndexError> {
+        drop(self.sender.take());
+        match self.worker.take() {
+            Some(worker) => worker
+                .join()
+                .map_err(|_| IndexError::Io(std::io::Error::other("ingest worker panicked")))?,
+            None => Ok(()),
+        }
+    }
+}
+
+impl Drop for IngestSession {
+    fn drop(&mut self) {
+        let _ = self.stop();
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use crate::index::FtsIndex;
+    use crate::ingest::IngestOptions;
+    use tempfile::tempdir;
+
+    fn encode(docs: &[(&str, &str)]) -> Vec<u8> {
+        let mut buf = Vec::new();
+        for (id, text) in docs {
+            buf.extend_from_slice(&(id.len() as u32).to_le_bytes());
+            buf.extend_from_slice(id.as_bytes());
+            buf.extend_from_slice(&(text.len() as u32).to_le_bytes());
+            buf.extend_from_slice(text.as_bytes());
+        }
+        buf
+    }
+
+    #[test]
+    fn test_ingest_session() {
+        let dir = tempdir().unwrap();
+        let index = FtsIndex::create(dir.path(), "bmw_simd").unwrap();
+
+        let session = index
+            .ingest(IngestOptions {
+                queue_depth: 1,
+                threads: 2,
+                ..Default::default()
+            })
+            .unwrap();
+        session
+            .push(encode(&[("1", "hello world"), ("2", "world peace")]))
+            .unwrap();
+        session.push(encode(&[("3", "hello again")])).unwrap();
+        assert_eq!(session.finish().unwrap(), 3);
+
+        index.commit().unwrap();
+        let result = index.search("hello", 10, 0).unwrap();
+        let mut ids: Vec<_> = result.hits.iter().map(|h| h.id.as_str()).collect();
+        ids.sort();
+        assert_eq!(ids, ["1", "3"]);
+    }
+}
@@ -0,0 +1,192 @@
+//! JSON and NDJSON ingestion
+//!
+//! Documents are deserialized with borrowed strings, so IDs and texts
+//! without escapes point into the caller's buffer. NDJSON input is split
+//! on line boundaries. Every piece is validated in parallel before any is
+//! indexed, so malformed input leaves the index untouched. Pieces are then
+//! parsed again and indexed piece by piece, so only the pieces being
+//! indexed are held as documents.
+
+use crate::document::{DocumentRef, JsonDocument};
+use crate::index::FtsIndex;
+use crate::result::IndexError;
+
+use parking_lot::Mutex;
+use rayon::prelude::*;
+
+/// Target bytes per NDJSON chunk
+const NDJSON_CHUNK_BYTES: usize = 4 << 20;
+
+/// Documents per indexing call for JSON arrays
+const ARRAY_CHUNK_DOCS: usize = 1000;
+
+/// Index a JSON array of documents or NDJSON (one document per line)
+///
+/// The format is chosen by the first non-whitespace byte: `[` starts an
+/// array, anything else is read as NDJSON. `progress(indexed, total)` is
+/// called after each chunk, one call at a time; `total` is the number of
+/// documents (blank NDJSON lines are not counted). Returns the number of
+/// documents indexed.
+pub fn index_json(
+    index: &FtsIndex,
+    bytes: &[u8],
+    progress: &(dyn Fn(u64, u64) + Sync),
+) -> Result<u64, IndexError> {
+    match bytes.iter().find(|b| !b.is_ascii_whitespace()) {
+        Some(b'[') => index_array(index, bytes, progress),
+        _ => index_ndjson(index, bytes, progress),
+    }
+}
+
+fn index_array(
+    index: &FtsIndex,
+    bytes: &[u8],
+    progress: &(dyn Fn(u64, u64) + Sync),
+) -> Result<u64, IndexError> {
+    let docs: Vec<JsonDocument<'_>> = serde_json::from_slice(bytes).map_err(parse_error)?;
+    let total = docs.len() as u64;
+    progress(0, total);
+
+    let mut indexed = 0u64;
+    for chunk in docs.chunks(ARRAY_CHUNK_DOCS) {
+        let refs: Vec<DocumentRef<'_>> = chunk.iter().map(JsonDocument::as_doc_ref).collect();
+        indexed += index.index_batch_refs(&refs)? as u64;
+        progress(indexed, total);
+    }
+    Ok(indexed)
+}
+
+fn index_ndjson(
+    index: &FtsIndex,
+    bytes: &[u8],
+    progress: &(dyn Fn(u64, u64) + Sync),
+) -> Result<u64, IndexError> {
+    let chunks = line_chunks(bytes, NDJSON_CHUNK_BYTES);
+
+    // Check every document before indexing any, as index_array does. Each
+    // one is dropped once checked (borrowed strings make this cheap), so
+    // only the per-chunk counts are kept.
+    let counts = chunks
+        .par_iter()
+        .map(|chunk| {
+            let mut n = 0u64;
+            for doc in serde_json::Deserializer::from_slice(chunk).into_iter::<JsonDocument<'_>>() {
+                doc.map_err(parse_error)?;
+                n += 1;
+            }
+            Ok(n)
+        })
+        .collect::<Result<Vec<u64>, IndexError>>()?;
+    let total = counts.iter().sum();
+    progress(0, total);
+
+    // Serializes progress callbacks and keeps the count monotonic
+    let indexed = Mutex::new(0u64);
+    chunks.par_iter().try_for_each(|chunk| {
+        let docs = serde_json::Deserializer::from_slice(chunk)
+            .into_iter::<JsonDocument<'_>>()
+            .collect::<Result<Vec<_>, _>>()
+            .map_err(parse_error)?;
+        let refs: Vec<DocumentRef<'_>> = docs.iter().map(JsonDocument::as_doc_ref).collect();
+        let n = index.index_batch_refs(&refs)?;
+
+        let mut indexed = indexed.lock();
+        *indexed += n as u64;
+        progress(*indexed, total);
+        Ok::<_, IndexError>(())
+    })?;
+
+    Ok(indexed.into_inner())
+}
+
+/// Split `bytes` into pieces of about `target` bytes that end on a newline
+fn line_chunks(bytes: &[u8], target: usize) -> Vec<&[u8]> {
+    let mut chunks = Vec::with_capacity(bytes.len() / target + 1);
+    let mut rest = bytes;
+    while !rest.is_empty() {
+        let end = if rest.len() <= target {
+            rest.len()
+        } else {
+            rest[target..]
+                .iter()
+                .position(|&b| b == b'\n')
+                .map_or(rest.len(), |i| target + i + 1)
+        };
+        let (chunk, tail) = rest.split_at(end);
+        chunks.push(chunk);
+        rest = tail;
+    }
+    chunks
+}
+
+fn parse_error(e: serde_json::Error) -> IndexError {
+    IndexError::Serialization(format!("JSON parse error: {}", e))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use tempfile::tempdir;
+
+    #[test]
+    fn test_line_chunks() {
+        let data = b"{\"a\":1}\n{\"b\":2}\n{\"c\":3}";
+        let chunks = line_chunks(data, 4);
+        assert_eq!(chunks.len(), 3);
+        assert_eq!(chunks[0], b"{\"a\":1}\n");
+        assert_eq!(chunks[2], b"{\"c\":3}");
+        assert_eq!(chunks.concat(), data);
+    }
+
+    #[test]
+    fn test_index_ndjson() {
+        let dir = tempdir().unwrap();
+        let index = FtsIndex::create(dir.path(), "bmw_simd").unwrap();
+
+        let data = b"{\"id\":\"1\",\"text\":\"hello world\",\"url\":\"u\"}\n\n\
+                     {\"id\":\"2\",\"text\":\"esc\\u0061ped hello\"}\n\
+                     {\"id\":\"3\",\"text\":\"goodbye\"}\n";
+        let seen = Mutex::new(Vec::new());
+        let n = index_json(&index, data, &|done, total| seen.lock().push((done, total))).unwrap();
+        assert_eq!(n, 3);
+        // The blank line is not counted
+        assert_eq!(seen.into_inner(), [(0, 3), (3, 3)]);
+
+        index.commit().unwrap();
+        let result = index.search("hello", 10, 0).unwrap();
+        let mut ids: Vec<_> = result.hits.iter().map(|h| h.id.as_str()).collect();
+        ids.sort();
+        assert_eq!(ids, ["1", "2"]);
+        assert_eq!(index.search("escaped", 10, 0).unwrap().hits.len(), 1);
+    }
+
+    #[test]
+    fn test_index_json_array() {
+        let dir = tempdir().unwrap();
+        let index = FtsIndex::create(dir.path(), "bmw_simd").unwrap();
+
+        let data = br#" [{"id":"a","text":"one two"},{"id":"b","text":"two three"}]"#;
+        assert_eq!(index_json(&index, data, &|_, _| {}).unwrap(), 2);
+        assert!(index_json(&index, b"{\"id\":1}", &|_, _| {}).is_err());
+    }
+
+    #[test]
+    fn test_index_ndjson_malformed_indexes_nothing() {
+        let dir = tempdir().unwrap();
+        let index = FtsIndex::create(dir.path(), "bmw_simd").unwrap();
+
+        let mut data = Vec::new();
+        for i in 0..150_000 {
+            data.extend_from_slice(
+                format!("{{\"id\":\"{i}\",\"text\":\"hello world\"}}\n").as_bytes(),
+            );
+        }
+        assert!(data.len() > NDJSON_CHUNK_BYTES);
+        data.extend_from_slice(b"{\"id\":\"bad\",\"text\":\n");
+        assert!(index_json(&index, &data, &|_, _| {}).is_err());
+
+        index.commit().unwrap();
+        assert_eq!(index.doc_count(), 0);
+        assert!(index.search("hello", 10, 0).unwrap().hits.is_empty());
+    }
+}
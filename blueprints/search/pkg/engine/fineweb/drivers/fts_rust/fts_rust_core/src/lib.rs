@@ -6,17 +6,28 @@
 //! - `ensemble`: FST + Roaring + Block-Max WAND combined
 //! - `seismic`: Learned sparse retrieval with geometry-cohesive blocks
 
+#[cfg(feature = "arrow-ingest")]
+pub mod arrow_ingest;
+pub mod chunked;
 pub mod document;
 pub mod ffi;
+pub mod filter;
 pub mod index;
+pub mod ingest;
+pub mod json_ingest;
+pub mod mapped;
+#[cfg(feature = "parquet-ingest")]
+pub mod parquet_ingest;
 pub mod profiles;
 pub mod result;
+pub mod segments;
 pub mod tokenizer;
 
-pub use document::Document;
-pub use index::FtsIndex;
+pub use document::{BinaryFormat, Document};
+pub use index::{Checkpoint, FtsIndex, SourceCursor};
+pub use ingest::{IngestOptions, IngestSession};
 pub use profiles::{ProfileType, SearchProfile};
-pub use result::{MemoryStats, SearchHit, SearchResult};
+pub use result::{HitBuffer, MemoryStats, SearchHit, SearchResult};
 
 /// Library version
 pub const VERSION: &str = env!("CARGO_PKG_VERSION");
@@ -26,3 +37,12 @@ pub const MAX_BATCH_SIZE: usize = 10_000;
 
 /// Default segment size for memory-bounded indexing
 pub const DEFAULT_SEGMENT_SIZE: usize = 100_000;
+
+/// Bytes for a search cursor token, including the terminating NUL
+pub const SEARCH_CURSOR_SIZE: usize = 17;
+
+/// Binary batch format code: id, text
+pub const BINARY_PLAIN: u32 = 0;
+
+/// Binary batch format code: id, text, url, language, date
+pub const BINARY_WITH_METADATA: u32 = 1;
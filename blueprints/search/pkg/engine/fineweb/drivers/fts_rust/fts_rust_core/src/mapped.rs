@@ -0,0 +1,233 @@
+//! Memory-mapped index files
+//!
+//! A mappable file is a sequence of sections, each a little-endian array
+//! of plain numbers starting on an 8-byte boundary. Section lengths come
+//! from counts in a header section, so reader and writer walk the same
+//! layout. `MappedFile` hands out slices that point straight into the
+//! mapping: opening an index costs a few page faults instead of a parse,
+//! and its pages live in the OS page cache rather than on the heap.
+//!
+//! Mapped files are never modified in place. Profiles write new files
+//! and rename them into place, so a mapping stays valid for as long as
+//! it is held, even after its file has been replaced or unlinked.
+
+use crate::result::IndexError;
+
+use memmap2::Mmap;
+use std::fs::File;
+use std::io::{self, Write};
+use std::marker::PhantomData;
+use std::path::Path;
+
+/// Alignment of every section
+const SECTION_ALIGN: u64 = 8;
+
+mod sealed {
+    pub trait Sealed {}
+}
+
+/// Numbers that can be viewed in place: no padding, every bit pattern
+/// valid, alignment at most `SECTION_ALIGN`
+pub trait Plain: Copy + sealed::Sealed {
+    /// Write `values` in little-endian byte order
+    fn write_le<W: Write>(values: &[Self], out: &mut W) -> io::Result<()>;
+}
+
+macro_rules! plain {
+    ($($t:ty),*) => {$(
+        impl sealed::Sealed for $t {}
+
+        impl Plain for $t {
+            fn write_le<W: Write>(values: &[Self], out: &mut W) -> io::Result<()> {
+                if cfg!(target_endian = "little") {
+                    // SAFETY: plain numbers have no padding bytes
+                    let bytes = unsafe {
+                        std::slice::from_raw_parts(
+                            values.as_ptr().cast::<u8>(),
+                            std::mem::size_of_val(values),
+                        )
+                    };
+                    out.write_all(bytes)
+                } else {
+                    values.iter().try_for_each(|v| out.write_all(&v.to_le_bytes()))
+                }
+            }
+        }
+    )*};
+}
+
+plain!(u8, u16, u32, u64, f32);
+
+/// A section of `T`s within a `MappedFile`
+#[derive(Debug)]
+pub struct Section<T> {
+    offset: usize,
+    len: usize,
+    _values: PhantomData<T>,
+}
+
+impl<T> Clone for Section<T> {
+    fn clone(&self) -> Self {
+        *self
+    }
+}
+
+impl<T> Copy for Section<T> {}
+
+impl<T> Section<T> {
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+}
+
+/// A read-only mapping of an index file
+pub struct MappedFile {
+    mmap: Mmap,
+}
+
+impl MappedFile {
+    pub fn open(path: &Path) -> Result<Self, IndexError> {
+        if cfg!(target_endian = "big") {
+            return Err(IndexError::Io(io::Error::new(
+                io::ErrorKind::Unsupported,
+                "mapped index files need a little-endian host",
+            )));
+        }
+        let file = File::open(path)?;
+        // SAFETY: index files are only ever replaced, never written in place
+        let mmap = unsafe { Mmap::map(&file)? };
+        Ok(Self { mmap })
+    }
+
+    /// The whole file
+    pub fn bytes(&self) -> &[u8] {
+        &self.mmap
+    }
+
+    /// Size of the mapping in bytes
+    pub fn len(&self) -> usize {
+        self.mmap.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.mmap.is_empty()
+    }
+
+    /// Walk the sections from the start of the file
+    pub fn sections(&self) -> SectionReader<'_> {
+        SectionReader { file: self, pos: 0 }
+    }
+
+    /// View a section in place
+    pub fn get<T: Plain>(&self, section: &Section<T>) -> &[T] {
+        let size = section.len * std::mem::size_of::<T>();
+        assert!(
+            section.offset + size <= self.mmap.len(),
+            "section out of bounds"
+        );
+        // SAFETY: in bounds (checked above); the mapping is page-aligned and
+        // the offset a multiple of SECTION_ALIGN; every bit pattern of T is valid
+        unsafe {
+            std::slice::from_raw_parts(self.mmap.as_ptr().add(section.offset).cast(), section.len)
+        }
+    }
+}
+
+/// Reads the section layout of a `MappedFile`, checking it fits the file
+pub struct SectionReader<'a> {
+    file: &'a MappedFile,
+    pos: u64,
+}
+
+impl SectionReader<'_> {
+    /// The next section, holding `len` values of `T`
+    pub fn next<T: Plain>(&mut self, len: u64) -> Result<Section<T>, IndexError> {
+        let offset = self.pos.next_multiple_of(SECTION_ALIGN);
+        let end = len
+            .checked_mul(std::mem::size_of::<T>() as u64)
+            .and_then(|size| offset.checked_add(size))
+            .filter(|&end| end <= self.file.len() as u64)
+            .ok_or_else(|| IndexError::Corrupted("mapped section past end of file".into()))?;
+        self.pos = end;
+        Ok(Section {
+            offset: offset as usize,
+            len: len as usize,
+            _values: PhantomData,
+        })
+    }
+}
+
+/// Writes a mappable file section by section
+pub struct SectionWriter<W: Write> {
+    out: W,
+    pos: u64,
+}
+
+impl<W: Write> SectionWriter<W> {
+    pub fn new(out: W) -> Self {
+        Self { out, pos: 0 }
+    }
+
+    /// Start the next section; fill it with `extend`
+    pub fn begin(&mut self) -> io::Result<()> {
+        let padding = self.pos.next_multiple_of(SECTION_ALIGN) - self.pos;
+        self.out
+            .write_all(&[0u8; SECTION_ALIGN as usize][..padding as usize])?;
+        self.pos += padding;
+        Ok(())
+    }
+
+    /// Append values to the current section
+    pub fn extend<T: Plain>(&mut self, values: &[T]) -> io::Result<()> {
+        T::write_le(values, &mut self.out)?;
+        self.pos += std::mem::size_of_val(values) as u64;
+        Ok(())
+    }
+
+    /// Write a whole section
+    pub fn section<T: Plain>(&mut self, values: &[T]) -> io::Result<()> {
+        self.begin()?;
+        self.extend(values)
+    }
+
+    pub fn into_inner(self) -> W {
+        self.out
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use tempfile::tempdir;
+
+    #[test]
+    fn test_sections_roundtrip() {
+        let dir = tempdir().unwrap();
+        let path = dir.path().join("t.map");
+
+        let mut writer = SectionWriter::new(Vec::new());
+        writer.section(b"MAG").unwrap();
+        writer.section(&[3u64, 2]).unwrap();
+        writer.section(&[1u16, 2, 3]).unwrap();
+        writer.begin().unwrap();
+        writer.extend(&[7u32]).unwrap();
+        writer.extend(&[8u32]).unwrap();
+        std::fs::write(&path, writer.into_inner()).unwrap();
+
+        let file = MappedFile::open(&path).unwrap();
+        let mut sections = file.sections();
+        assert_eq!(file.get(&sections.next::<u8>(3).unwrap()), b"MAG");
+        let header = file.get(&sections.next::<u64>(2).unwrap()).to_vec();
+        assert_eq!(header, [3, 2]);
+        assert_eq!(
+            file.get(&sections.next::<u16>(header[0]).unwrap()),
+            [1, 2, 3]
+        );
+        assert_eq!(file.get(&sections.next::<u32>(header[1]).unwrap()), [7, 8]);
+        assert!(sections.next::<u64>(1).is_err());
+    }
+}
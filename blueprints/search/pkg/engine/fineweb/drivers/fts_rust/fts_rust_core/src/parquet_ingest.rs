@@ -0,0 +1,259 @@
+//! Native Parquet ingestion
+//!
+//! Reads the id and text columns of one or more Parquet files straight
+//! into the index: row groups are decoded in parallel, only the two
+//! columns are read (projection pushdown), and documents borrow their
+//! strings from the decoded Arrow buffers (see `arrow_ingest`).
+
+use crate::arrow_ingest::index_record_batch;
+use crate::index::FtsIndex;
+use crate::result::IndexError;
+
+use parking_lot::Mutex;
+use parquet::arrow::arrow_reader::ParquetRecordBatchReaderBuilder;
+use parquet::arrow::ProjectionMask;
+use rayon::prelude::*;
+use std::fs::File;
+use std::path::{Path, PathBuf};
+
+/// Rows per decoded record batch
+const BATCH_ROWS: usize = 8192;
+
+/// Parquet ingestion options
+#[derive(Debug, Clone)]
+pub struct ParquetOptions {
+    /// Column holding the external document ID
+    pub id_col: String,
+    /// Column holding the text to index
+    pub text_col: String,
+    /// Decoding threads (0 = number of CPUs)
+    pub threads: usize,
+}
+
+impl Default for ParquetOptions {
+    fn default() -> Self {
+        Self {
+            id_col: "id".into(),
+            text_col: "text".into(),
+            threads: 0,
+        }
+    }
+}
+
+/// One unit of parallel work
+struct RowGroup {
+    file: PathBuf,
+    index: usize,
+}
+
+/// Index every row of the Parquet files matched by `pattern` (a file, a
+/// directory of `*.parquet` files, or a `*`/`?` glob in the file name).
+///
+/// `progress(indexed, total_rows)` is called after each record batch,
+/// one call at a time. Rows with a null text are skipped; a null ID is
+/// indexed as "". Documents are added in row-group completion order.
+/// Returns the number of documents indexed.
+pub fn index_parquet(
+    index: &FtsIndex,
+    pattern: &str,
+    opts: &ParquetOptions,
+    progress: &(dyn Fn(u64, u64) + Sync),
+) -> Result<u64, IndexError> {
+    let files = expand_pattern(pattern)?;
+    if files.is_empty() {
+        return Err(IndexError::NotFound(pattern.to_string()));
+    }
+
+    let mut row_groups = Vec::new();
+    let mut total_rows = 0u64;
+    for file in files {
+        let builder = open(&file)?;
+        for (i, rg) in builder.metadata().row_groups().iter().enumerate() {
+            total_rows += rg.num_rows() as u64;
+            row_groups.push(RowGroup {
+                file: file.clone(),
+                index: i,
+            });
+        }
+    }
+
+    let pool = rayon::ThreadPoolBuilder::new()
+        .num_threads(opts.threads)
+        .build()
+        .map_err(|e| IndexError::Io(std::io::Error::other(e.to_string())))?;
+
+    // Serializes progress callbacks and keeps the count monotonic
+    let indexed = Mutex::new(0u64);
+    pool.install(|| {
+        row_groups.par_iter().try_for_each(|rg| {
+            index_row_group(index, rg, opts, &mut |n| {
+                let mut indexed = indexed.lock();
+                *indexed += n;
+                progress(*indexed, total_rows);
+            })
+        })
+    })?;
+
+    Ok(indexed.into_inner())
+}
+
+fn index_row_group(
+    index: &FtsIndex,
+    rg: &RowGroup,
+    opts: &ParquetOptions,
+    on_batch: &mut dyn FnMut(u64),
+) -> Result<(), IndexError> {
+    let builder = open(&rg.file)?;
+    let schema = builder.schema().clone();
+    let column = |name: &str| {
+        schema.index_of(name).map_err(|_| {
+            IndexError::Corrupted(format!("{}: no column {}", rg.file.display(), name))
+        })
+    };
+    let (id_idx, text_idx) = (column(&opts.id_col)?, column(&opts.text_col)?);
+
+    let mask = ProjectionMask::roots(builder.parquet_schema(), [id_idx, text_idx]);
+
+    let reader = builder
+        .with_row_groups(vec![rg.index])
+        .with_projection(mask)
+        .with_batch_size(BATCH_ROWS)
+        .build()
+        .map_err(|e| parquet_error(&rg.file, e))?;
+
+    for batch in reader {
+        let batch = batch.map_err(|e| IndexError::Corrupted(e.to_string()))?;
+        let n = index_record_batch(index, &batch, &opts.id_col, &opts.text_col)?;
+        on_batch(n as u64);
+    }
+    Ok(())
+}
+
+fn open(path: &Path) -> Result<ParquetRecordBatchReaderBuilder<File>, IndexError> {
+    ParquetRecordBatchReaderBuilder::try_new(File::open(path)?).map_err(|e| parquet_error(path, e))
+}
+
+fn parquet_error(path: &Path, e: parquet::errors::ParquetError) -> IndexError {
+    IndexError::Corrupted(format!("{}: {}", path.display(), e))
+}
+
+/// Files matched by a path, a directory, or a glob in the last component
+fn expand_pattern(pattern: &str) -> Result<Vec<PathBuf>, IndexError> {
+    let path = Path::new(pattern);
+    let (dir, name_pattern) = if path.is_dir() {
+        (path, "*.parquet")
+    } else if pattern.contains(['*', '?']) {
+        let name = path.file_name().and_then(|n| n.to_str()).unwrap_or("");
+        let dir = path.parent().filter(|p| !p.as_os_str().is_empty());
+        (dir.unwrap_or(Path::new(".")), name)
+    } else {
+        return Ok(vec![path.to_path_buf()]);
+    };
+
+    let mut files = Vec::new();
+    for entry in std::fs::read_dir(dir)? {
+        let entry = entry?;
+        let matched = entry
+            .file_name()
+            .to_str()
+            .is_some_and(|n| wildcard_match(name_pattern.as_bytes(), n.as_bytes()));
+        if matched && entry.file_type()?.is_file() {
+            files.push(entry.path());
+        }
+    }
+    files.sort();
+    Ok(files)
+}
+
+/// Match `*` (any run) and `?` (one byte) wildcards
+fn wildcard_match(pattern: &[u8], name: &[u8]) -> bool {
+    let (mut p, mut n) = (0, 0);
+    let mut star: Option<(usize, usize)> = None;
+    while n < name.len() {
+        if p < pattern.len() && (pattern[p] == b'?' || pattern[p] == name[n]) {
+            p += 1;
+            n += 1;
+        } else if p < pattern.len() && pattern[p] == b'*' {
+            star = Some((p, n));
+            p += 1;
+        } else if let Some((sp, sn)) = star {
+            p = sp + 1;
+            n = sn + 1;
+            star = Some((sp, sn + 1));
+        } else {
+            return false;
+        }
+    }
+    pattern[p..].iter().all(|&c| c == b'*')
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use arrow::array::StringArray;
+    use arrow::datatypes::{DataType, Field, Schema};
+    use arrow::record_batch::RecordBatch;
+    use parquet::arrow::ArrowWriter;
+    use parquet::file::properties::WriterProperties;
+    use std::sync::Arc;
+    use tempfile::tempdir;
+
+    #[test]
+    fn test_wildcard_match() {
+        assert!(wildcard_match(b"*.parquet", b"000_00000.parquet"));
+        assert!(wildcard_match(b"part-?.parquet", b"part-1.parquet"));
+        assert!(!wildcard_match(b"*.parquet", b"data.json"));
+    }
+
+    #[test]
+    fn test_index_parquet() {
+        let dir = tempdir().unwrap();
+        let schema = Arc::new(Schema::new(vec![
+            Field::new("text", DataType::Utf8, true),
+            Field::new("url", DataType::Utf8, true),
+            Field::new("id", DataType::Utf8, true),
+        ]));
+        let batch = RecordBatch::try_new(
+            schema.clone(),
+            vec![
+                Arc::new(StringArray::from(vec![
+                    Some("hello world"),
+                    Some("world peace"),
+                    None,
+                    Some("hello again"),
+                ])),
+                Arc::new(StringArray::from(vec!["u1", "u2", "u3", "u4"])),
+                Arc::new(StringArray::from(vec!["1", "2", "3", "4"])),
+            ],
+        )
+        .unwrap();
+
+        // Two rows per row group
+        let props = WriterProperties::builder()
+            .set_max_row_group_size(2)
+            .build();
+        let file = File::create(dir.path().join("part-0.parquet")).unwrap();
+        let mut writer = ArrowWriter::try_new(file, schema, Some(props)).unwrap();
+        writer.write(&batch).unwrap();
+        writer.close().unwrap();
+
+        let index = FtsIndex::create(dir.path().join("idx"), "bmw_simd").unwrap();
+        let pattern = dir.path().join("*.parquet");
+        let last = Mutex::new((0, 0));
+        let n = index_parquet(
+            &index,
+            pattern.to_str().unwrap(),
+            &ParquetOptions::default(),
+            &|done, total| *last.lock() = (done, total),
+        )
+        .unwrap();
+        assert_eq!(n, 3);
+        assert_eq!(*last.lock(), (3, 4));
+
+        index.commit().unwrap();
+        let result = index.search("hello", 10, 0).unwrap();
+        let mut ids: Vec<_> = result.hits.iter().map(|h| h.id.as_str()).collect();
+        ids.sort();
+        assert_eq!(ids, ["1", "4"]);
+    }
+}
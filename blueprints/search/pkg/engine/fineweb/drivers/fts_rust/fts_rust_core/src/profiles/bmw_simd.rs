@@ -1,69 +1,269 @@
-//! Block-Max WAND with SIMD-accelerated posting intersection
-
-use crate::document::Document;
-use crate::profiles::{Bm25Params, ProfileType, SearchProfile};
-use crate::result::{IndexError, MemoryStats, SearchError, SearchHit, SearchResult};
-use crate::tokenizer::FastTokenizer;
+//! Block-Max WAND with SIMD-accelerated block scoring
+//!
+//! Queries run document-at-a-time: each query term has a cursor into its
+//! posting blocks, and the cursors advance together in doc ID order. A
+//! pivot is chosen from the terms' whole-list score bounds; the blocks
+//! that could hold it are then bounded without being decoded (a shallow
+//! move), and whole runs of documents are skipped whenever those block
+//! bounds can't beat the current top-k threshold. Blocks that survive are
+//! scored eight postings at a time.
+
+use crate::chunked::Chunked;
+use crate::document::{DocumentRef, IdTable};
+use crate::profiles::{
+    count_matches, Bm25Params, Parts, ProfileType, SearchProfile, TermDocs, TopK,
+};
+use crate::result::{
+    HitBuffer, IndexError, MemoryStats, SearchCursor, SearchError, SearchResult, TotalMode,
+};
+use crate::tokenizer::{invert, FastTokenizer, TermInterner, TokenizedDoc};
 
 use parking_lot::RwLock;
-use rayon::prelude::*;
-use std::cmp::Reverse;
-use std::collections::{BinaryHeap, HashMap};
 use std::fs::File;
 use std::io::{BufReader, BufWriter, Read, Write};
 use std::path::Path;
+use std::sync::Arc;
 use std::time::Instant;
+use wide::f32x8;
 
 /// Block size for SIMD alignment (128 docs per block)
 const BLOCK_SIZE: usize = 128;
 
-/// Type alias for pending document data: (doc_id, term_freqs, doc_length)
-type PendingDoc = (String, HashMap<String, u16>, u32);
+/// Postings scored per SIMD operation
+const LANES: usize = 8;
 
-/// Term metadata
-#[derive(Debug, Clone)]
+/// Term metadata (no blocks for terms seen only in pending docs)
+#[derive(Debug, Clone, Default)]
 struct TermMeta {
     /// Document frequency
     df: u32,
-    /// Index into postings array
-    posting_offset: usize,
-    /// Number of blocks
-    num_blocks: usize,
+    /// Posting blocks, replaced whole when a commit adds to the term
+    blocks: Arc<[PostingBlock]>,
     /// Precomputed IDF
     idf: f32,
 }
 
 /// A block of postings (128 docs)
-#[derive(Debug, Clone)]
+///
+/// The block's score bound is kept as its largest term frequency and
+/// shortest document rather than as a score: BM25 grows with the former
+/// and shrinks with the latter, so the pair bounds every posting in the
+/// block under whatever collection statistics later commits bring.
+#[derive(Debug, Clone, Default)]
 struct PostingBlock {
-    /// Document IDs in this block
+    /// Document IDs in this block (ascending)
     doc_ids: Vec<u32>,
     /// Term frequencies
     freqs: Vec<u16>,
-    /// Maximum BM25 score in this block (for pruning)
-    max_score: f32,
+    /// Largest term frequency in the block
+    max_tf: u16,
+    /// Length of the shortest document in the block
+    min_len: u16,
 }
 
 impl PostingBlock {
-    fn new() -> Self {
+    fn new(doc_ids: Vec<u32>, freqs: Vec<u16>, doc_lengths: &Chunked<Vec<u16>>) -> Self {
+        let max_tf = freqs.iter().copied().max().unwrap_or(0);
+        let min_len = doc_ids
+            .iter()
+            .map(|&d| doc_lengths.get(d as usize).unwrap_or(0))
+            .min()
+            .unwrap_or(0);
+        Self {
+            doc_ids,
+            freqs,
+            max_tf,
+            min_len,
+        }
+    }
+
+    fn last_doc(&self) -> u32 {
+        self.doc_ids.last().copied().unwrap_or(0)
+    }
+}
+
+impl TermDocs for PostingBlock {
+    fn df(&self) -> u64 {
+        self.doc_ids.len() as u64
+    }
+
+    fn nth(&self, i: u64) -> u32 {
+        self.doc_ids[i as usize]
+    }
+
+    fn contains(&self, doc: u32) -> bool {
+        self.doc_ids.binary_search(&doc).is_ok()
+    }
+
+    fn for_each_doc(&self, f: &mut dyn FnMut(u32)) {
+        self.doc_ids.iter().for_each(|&doc| f(doc))
+    }
+}
+
+/// BM25 for one query term, with collection statistics fixed for a query
+#[derive(Debug, Clone, Copy)]
+struct TermScorer {
+    idf: f32,
+    /// k1 + 1
+    tf_scale: f32,
+    /// k1 * (1 - b)
+    norm_base: f32,
+    /// k1 * b / avg_doc_len
+    norm_len: f32,
+}
+
+impl TermScorer {
+    fn new(bm25: Bm25Params, df: u32, total_docs: f32, avg_doc_len: f32) -> Self {
+        let df = df as f32;
         Self {
-            doc_ids: Vec::with_capacity(BLOCK_SIZE),
-            freqs: Vec::with_capacity(BLOCK_SIZE),
-            max_score: 0.0,
+            idf: ((total_docs - df + 0.5) / (df + 0.5) + 1.0).ln(),
+            tf_scale: bm25.k1 + 1.0,
+            norm_base: bm25.k1 * (1.0 - bm25.b),
+            norm_len: bm25.k1 * bm25.b / avg_doc_len,
         }
     }
+
+    #[inline]
+    fn score(&self, tf: f32, doc_len: f32) -> f32 {
+        self.idf * tf * self.tf_scale / (tf + self.norm_base + self.norm_len * doc_len)
+    }
+
+    /// Upper bound on the score of any posting in `block`
+    fn block_max(&self, block: &PostingBlock) -> f32 {
+        self.score(block.max_tf as f32, block.min_len as f32)
+    }
+
+    /// Score every posting in `block` into `out`, `LANES` at a time
+    fn score_block(
+        &self,
+        block: &PostingBlock,
+        doc_lengths: &Chunked<Vec<u16>>,
+        out: &mut Vec<f32>,
+    ) {
+        out.clear();
+        let idf = f32x8::splat(self.idf);
+        let tf_scale = f32x8::splat(self.tf_scale);
+        let norm_base = f32x8::splat(self.norm_base);
+        let norm_len = f32x8::splat(self.norm_len);
+
+        let mut docs = block.doc_ids.chunks_exact(LANES);
+        let mut freqs = block.freqs.chunks_exact(LANES);
+        for (d, f) in (&mut docs).zip(&mut freqs) {
+            let tf: [f32; LANES] = std::array::from_fn(|i| f[i] as f32);
+            let len: [f32; LANES] = std::array::from_fn(|i| doc_lengths[d[i] as usize] as f32);
+            let tf = f32x8::from(tf);
+            let scores = idf * tf * tf_scale / (tf + norm_base + norm_len * f32x8::from(len));
+            out.extend_from_slice(&scores.to_array());
+        }
+        for (&doc_id, &freq) in docs.remainder().iter().zip(freqs.remainder()) {
+            out.push(self.score(freq as f32, doc_lengths[doc_id as usize] as f32));
+        }
+    }
+}
+
+/// A query term's position in its posting blocks
+struct Cursor<'a> {
+    blocks: &'a [PostingBlock],
+    scorer: TermScorer,
+    /// Upper bound on the term's score in any document
+    max_score: f32,
+    /// Current block, and position within it
+    block: usize,
+    pos: usize,
+    /// Scores of block `decoded`'s postings
+    scores: Vec<f32>,
+    decoded: Option<usize>,
+}
+
+impl<'a> Cursor<'a> {
+    fn new(blocks: &'a [PostingBlock], scorer: TermScorer) -> Self {
+        let max_score = blocks
+            .iter()
+            .map(|b| scorer.block_max(b))
+            .fold(0.0, f32::max);
+        Self {
+            blocks,
+            scorer,
+            max_score,
+            block: 0,
+            pos: 0,
+            scores: Vec::with_capacity(BLOCK_SIZE),
+            decoded: None,
+        }
+    }
+
+    /// Current document (`u32::MAX` once exhausted)
+    #[inline]
+    fn doc(&self) -> u32 {
+        self.blocks
+            .get(self.block)
+            .map_or(u32::MAX, |b| b.doc_ids[self.pos])
+    }
+
+    /// First block from the current one whose last document is >= `target`
+    fn block_for(&self, target: u32) -> usize {
+        self.block + self.blocks[self.block..].partition_point(|b| b.last_doc() < target)
+    }
+
+    /// Score bound and last document of the block that could hold
+    /// `target`, found without moving the cursor or decoding the block
+    fn shallow(&self, target: u32) -> (f32, u32) {
+        match self.blocks.get(self.block_for(target)) {
+            Some(block) => (self.scorer.block_max(block), block.last_doc()),
+            None => (0.0, u32::MAX),
+        }
+    }
+
+    /// Move to the first document >= `target`, skipping whole blocks
+    fn seek(&mut self, target: u32) {
+        if self.doc() >= target {
+            return;
+        }
+        let block = self.block_for(target);
+        if block != self.block {
+            self.block = block;
+            self.pos = 0;
+        }
+        if let Some(b) = self.blocks.get(block) {
+            self.pos += b.doc_ids[self.pos..].partition_point(|&d| d < target);
+        }
+    }
+
+    /// Move to the next document
+    fn advance(&mut self) {
+        self.pos += 1;
+        if self.pos == self.blocks[self.block].doc_ids.len() {
+            self.block += 1;
+            self.pos = 0;
+        }
+    }
+
+    /// Score of the current document, scoring its whole block on first use
+    fn score(&mut self, doc_lengths: &Chunked<Vec<u16>>) -> f32 {
+        if self.decoded != Some(self.block) {
+            self.scorer
+                .score_block(&self.blocks[self.block], doc_lengths, &mut self.scores);
+            self.decoded = Some(self.block);
+        }
+        self.scores[self.pos]
+    }
 }
 
 /// Block-Max WAND profile
+///
+/// The term dictionary is copied on write and the length and ID tables are
+/// chunked, so `snapshot` keeps their committed state for the price of a
+/// few pointers; it copies the term interner, which `add_pending` writes.
+/// A snapshot takes none of the writer's locks.
 pub struct BmwSimdProfile {
-    /// Term dictionary: term -> metadata
-    term_dict: RwLock<HashMap<String, TermMeta>>,
-    /// Posting blocks
-    postings: RwLock<Vec<PostingBlock>>,
+    /// Interned terms
+    terms: RwLock<TermInterner>,
+    /// Term metadata, indexed by term ID
+    term_dict: RwLock<Arc<Vec<TermMeta>>>,
     /// Document lengths (for BM25)
-    doc_lengths: RwLock<Vec<u16>>,
+    doc_lengths: RwLock<Chunked<Vec<u16>>>,
     /// Document IDs (external)
-    doc_ids: RwLock<Vec<String>>,
+    doc_ids: RwLock<Chunked<IdTable>>,
     /// Total document count
     doc_count: RwLock<u64>,
     /// Sum of all document lengths
@@ -73,16 +273,16 @@ pub struct BmwSimdProfile {
     /// Tokenizer
     tokenizer: FastTokenizer,
     /// Pending documents (not yet committed)
-    pending: RwLock<Vec<PendingDoc>>,
+    pending: RwLock<Vec<TokenizedDoc>>,
 }
 
 impl BmwSimdProfile {
     pub fn new() -> Self {
         Self {
-            term_dict: RwLock::new(HashMap::new()),
-            postings: RwLock::new(Vec::new()),
-            doc_lengths: RwLock::new(Vec::new()),
-            doc_ids: RwLock::new(Vec::new()),
+            terms: RwLock::new(TermInterner::new()),
+            term_dict: RwLock::new(Arc::new(Vec::new())),
+            doc_lengths: RwLock::new(Chunked::new()),
+            doc_ids: RwLock::new(Chunked::new()),
             doc_count: RwLock::new(0),
             total_doc_length: RwLock::new(0),
             bm25: Bm25Params::default(),
@@ -98,179 +298,180 @@ impl BmwSimdProfile {
             return;
         }
 
+        // Copied here if a snapshot still holds the dictionary
         let mut term_dict = self.term_dict.write();
-        let mut postings = self.postings.write();
+        let term_dict = Arc::make_mut(&mut term_dict);
         let mut doc_lengths = self.doc_lengths.write();
-        let mut doc_ids = self.doc_ids.write();
         let mut doc_count = self.doc_count.write();
         let mut total_doc_length = self.total_doc_length.write();
 
         let base_doc_id = *doc_count as u32;
 
-        // Collect all term -> [(doc_id, freq)] mappings
-        let mut term_postings: HashMap<String, Vec<(u32, u16)>> = HashMap::new();
-
-        for (i, (ext_id, term_freqs, doc_len)) in pending.iter().enumerate() {
-            let doc_id = base_doc_id + i as u32;
+        // Every pending doc's terms are interned by now
+        let term_count = self.terms.read().len();
+        term_dict.resize_with(term_count, TermMeta::default);
 
-            doc_ids.push(ext_id.clone());
-            doc_lengths.push(*doc_len as u16);
-            *total_doc_length += *doc_len as u64;
-
-            for (term, freq) in term_freqs {
-                term_postings
-                    .entry(term.clone())
-                    .or_default()
-                    .push((doc_id, *freq));
-            }
+        for doc in pending.iter() {
+            doc_lengths.push(doc.doc_len as u16);
+            *total_doc_length += doc.doc_len as u64;
         }
 
+        // (term, doc, freq) postings grouped by term
+        let term_postings = invert(&pending, base_doc_id);
+
         *doc_count += pending.len() as u64;
 
         let total_docs = *doc_count as f32;
-        let avg_doc_len = if *doc_count > 0 {
-            *total_doc_length as f32 / *doc_count as f32
-        } else {
-            1.0
-        };
-
-        // Build blocks for each term
-        for (term, posts) in term_postings {
-            let df = posts.len() as u32;
-            let idf = ((total_docs - df as f32 + 0.5) / (df as f32 + 0.5) + 1.0).ln();
-
-            let posting_offset = postings.len();
-            let mut num_blocks = 0;
 
-            // Create blocks of BLOCK_SIZE
-            for chunk in posts.chunks(BLOCK_SIZE) {
-                let mut block = PostingBlock::new();
-                let mut max_score = 0.0f32;
-
-                for &(doc_id, freq) in chunk {
-                    let doc_len = doc_lengths[doc_id as usize] as f32;
-                    let score =
-                        self.bm25
-                            .score(freq as f32, df as f32, doc_len, avg_doc_len, total_docs);
-                    max_score = max_score.max(score);
-
-                    block.doc_ids.push(doc_id);
-                    block.freqs.push(freq);
-                }
+        // Re-block old + new postings of each term in this commit; the
+        // other terms keep their blocks
+        let mut posts = Vec::new();
+        for run in term_postings.chunk_by(|a, b| a.0 == b.0) {
+            let meta = &mut term_dict[run[0].0 as usize];
+            posts.clear();
+            posts.extend(
+                meta.blocks
+                    .iter()
+                    .flat_map(|b| b.doc_ids.iter().copied().zip(b.freqs.iter().copied())),
+            );
+            posts.extend(run.iter().map(|&(_, doc_id, freq)| (doc_id, freq)));
 
-                block.max_score = max_score;
-                postings.push(block);
-                num_blocks += 1;
-            }
+            let df = posts.len() as u32;
+            meta.df = df;
+            meta.idf = ((total_docs - df as f32 + 0.5) / (df as f32 + 0.5) + 1.0).ln();
 
-            term_dict.insert(
-                term,
-                TermMeta {
-                    df,
-                    posting_offset,
-                    num_blocks,
-                    idf,
-                },
-            );
+            // Create blocks of BLOCK_SIZE
+            meta.blocks = posts
+                .chunks(BLOCK_SIZE)
+                .map(|chunk| {
+                    PostingBlock::new(
+                        chunk.iter().map(|&(doc_id, _)| doc_id).collect(),
+                        chunk.iter().map(|&(_, freq)| freq).collect(),
+                        &doc_lengths,
+                    )
+                })
+                .collect();
         }
     }
 
-    /// Search using Block-Max WAND algorithm
-    fn search_bmw(&self, query_terms: &[String], limit: usize, offset: usize) -> Vec<SearchHit> {
-        let term_dict = self.term_dict.read();
-        let postings = self.postings.read();
+    /// Search using document-at-a-time Block-Max WAND
+    fn search_bmw(
+        &self,
+        query_terms: &[String],
+        limit: usize,
+        offset: usize,
+        after: Option<SearchCursor>,
+        out: &mut HitBuffer,
+    ) {
+        let terms = self.terms.read();
+        let term_dict = Arc::clone(&self.term_dict.read());
         let doc_lengths = self.doc_lengths.read();
         let doc_ids = self.doc_ids.read();
         let doc_count = *self.doc_count.read();
 
-        if doc_count == 0 || query_terms.is_empty() {
-            return Vec::new();
+        let k = limit + offset;
+        if doc_count == 0 || query_terms.is_empty() || k == 0 {
+            return;
         }
 
         let total_docs = doc_count as f32;
         let total_doc_length = *self.total_doc_length.read();
         let avg_doc_len = total_doc_length as f32 / doc_count as f32;
 
-        // Collect query term info
-        let mut query_info: Vec<(&str, &TermMeta, f32)> = Vec::new();
-        for term in query_terms {
-            if let Some(meta) = term_dict.get(term) {
-                // Upper bound score for this term (using max possible TF)
-                let upper_bound = meta.idf * (self.bm25.k1 + 1.0);
-                query_info.push((term, meta, upper_bound));
-            }
-        }
-
-        if query_info.is_empty() {
-            return Vec::new();
-        }
-
-        // Sort by upper bound descending for efficiency
-        query_info.sort_by(|a, b| b.2.partial_cmp(&a.2).unwrap());
+        let mut cursors: Vec<Cursor<'_>> = query_terms
+            .iter()
+            .filter_map(|term| term_dict.get(terms.lookup(term)? as usize))
+            .filter(|meta| !meta.blocks.is_empty())
+            .map(|meta| {
+                Cursor::new(
+                    &meta.blocks,
+                    TermScorer::new(self.bm25, meta.df, total_docs, avg_doc_len),
+                )
+            })
+            .collect();
 
-        // Top-k heap (min-heap for efficient replacement)
-        let k = limit + offset;
-        let mut top_k: BinaryHeap<Reverse<(ordered_float::OrderedFloat<f32>, u32)>> =
-            BinaryHeap::with_capacity(k + 1);
+        // Documents come in ascending order, so a later one must score
+        // above the threshold to enter the top k
+        let mut top_k = TopK::new(k, after);
         let mut threshold = 0.0f32;
 
-        // Iterate through all documents using block-max pruning
-        // Simplified: iterate blocks and score documents
-        let mut scored: HashMap<u32, f32> = HashMap::new();
+        loop {
+            cursors.sort_unstable_by_key(Cursor::doc);
 
-        for (_term, meta, _) in &query_info {
-            for block_idx in 0..meta.num_blocks {
-                let block = &postings[meta.posting_offset + block_idx];
+            // Pivot: the first cursor at which the terms' score bounds add
+            // up to more than the threshold. No document before the pivot's
+            // can qualify, as it only holds terms before the pivot.
+            let mut bound = 0.0f32;
+            let pivot = cursors.iter().position(|c| {
+                bound += c.max_score;
+                bound > threshold
+            });
+            let mut pivot = match pivot {
+                Some(p) => p,
+                None => break,
+            };
+            let pivot_doc = cursors[pivot].doc();
+            if pivot_doc == u32::MAX {
+                break;
+            }
+            while pivot + 1 < cursors.len() && cursors[pivot + 1].doc() == pivot_doc {
+                pivot += 1;
+            }
 
-                // Skip block if max score can't beat threshold
-                if block.max_score < threshold && !top_k.is_empty() {
-                    continue;
+            // Shallow move: bound the pivot by the blocks that could hold it
+            let mut block_bound = 0.0f32;
+            let mut next_doc = cursors.get(pivot + 1).map_or(u32::MAX, Cursor::doc);
+            for cursor in &cursors[..=pivot] {
+                let (max_score, last_doc) = cursor.shallow(pivot_doc);
+                block_bound += max_score;
+                next_doc = next_doc.min(last_doc.saturating_add(1));
+            }
+
+            if block_bound <= threshold {
+                // Nothing up to the end of the first of those blocks can
+                // qualify either: skip there
+                for cursor in &mut cursors[..=pivot] {
+                    cursor.seek(next_doc);
+                }
+            } else if cursors[0].doc() == pivot_doc {
+                // Every term up to the pivot is on the pivot doc: score it
+                let mut score = 0.0f32;
+                for cursor in &mut cursors[..=pivot] {
+                    score += cursor.score(&doc_lengths);
+                    cursor.advance();
                 }
 
-                // Score documents in block
-                for (i, &doc_id) in block.doc_ids.iter().enumerate() {
-                    let freq = block.freqs[i];
-                    let doc_len = doc_lengths[doc_id as usize] as f32;
-                    let score = self.bm25.score(
-                        freq as f32,
-                        meta.df as f32,
-                        doc_len,
-                        avg_doc_len,
-                        total_docs,
-                    );
-                    *scored.entry(doc_id).or_insert(0.0) += score;
+                top_k.push(score, pivot_doc);
+                threshold = top_k.threshold();
+            } else {
+                // Bring the terms before the pivot up to the pivot doc
+                for cursor in &mut cursors[..pivot] {
+                    cursor.seek(pivot_doc);
                 }
             }
         }
 
-        // Build final top-k
-        for (doc_id, score) in scored {
-            let entry = Reverse((ordered_float::OrderedFloat(score), doc_id));
-            if top_k.len() < k {
-                top_k.push(entry);
-                if top_k.len() == k {
-                    threshold = top_k.peek().unwrap().0 .0.into_inner();
-                }
-            } else if score > threshold {
-                top_k.pop();
-                top_k.push(entry);
-                threshold = top_k.peek().unwrap().0 .0.into_inner();
-            }
+        top_k.into_hits(offset, limit, out, |doc_id, ids| {
+            ids.push_str(doc_ids.get(doc_id as usize))
+        })
+    }
+
+    /// Tokenize `docs` and queue them for the next commit (thread-safe)
+    fn add_pending(&self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
+        // Tokenize in parallel into interned term IDs
+        let tokenized = self.tokenizer.tokenize_interned(docs, &self.terms);
+
+        // Pending docs get the next doc IDs in order, so IDs are interned now
+        // (the lock is held until they are in the pending buffer)
+        let mut doc_ids = self.doc_ids.write();
+        for doc in docs {
+            doc_ids.push(doc.id);
         }
 
-        // Extract results
-        let mut results: Vec<_> = top_k
-            .into_sorted_vec()
-            .into_iter()
-            .skip(offset)
-            .take(limit)
-            .map(|Reverse((score, doc_id))| {
-                SearchHit::new(doc_ids[doc_id as usize].clone(), score.into_inner())
-            })
-            .collect();
+        let count = tokenized.len();
+        self.pending.write().extend(tokenized);
 
-        results.reverse(); // Highest score first
-        results
+        Ok(count)
     }
 }
 
@@ -289,21 +490,12 @@ impl SearchProfile for BmwSimdProfile {
         ProfileType::BmwSimd
     }
 
-    fn index_batch(&mut self, docs: &[Document]) -> Result<usize, IndexError> {
-        // Tokenize in parallel
-        let tokenized: Vec<_> = docs
-            .par_iter()
-            .map(|doc| {
-                let term_freqs = self.tokenizer.tokenize_with_freqs(&doc.text);
-                let doc_len: u32 = term_freqs.values().map(|&v| v as u32).sum();
-                (doc.id.clone(), term_freqs, doc_len)
-            })
-            .collect();
-
-        let count = tokenized.len();
-        self.pending.write().extend(tokenized);
+    fn index_batch_refs(&mut self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
+        self.add_pending(docs)
+    }
 
-        Ok(count)
+    fn index_batch_shared(&self, docs: &[DocumentRef<'_>]) -> Option<Result<usize, IndexError>> {
+        Some(self.add_pending(docs))
     }
 
     fn commit(&mut self) -> Result<(), IndexError> {
@@ -319,32 +511,72 @@ impl SearchProfile for BmwSimdProfile {
         offset: usize,
     ) -> Result<SearchResult, SearchError> {
         let start = Instant::now();
+        let mut out = HitBuffer::new();
+        self.search_hits(query, limit, offset, &mut out)?;
+        Ok(out.to_result(self.name(), start.elapsed()))
+    }
+
+    fn search_hits(
+        &self,
+        query: &str,
+        limit: usize,
+        offset: usize,
+        out: &mut HitBuffer,
+    ) -> Result<(), SearchError> {
+        out.clear();
         let query_terms = self.tokenizer.tokenize_query(query);
 
-        let hits = self.search_bmw(&query_terms, limit, offset);
-        let total = hits.len() as u64;
+        self.search_bmw(&query_terms, limit, offset, None, out);
+        out.total = out.len() as u64;
+        Ok(())
+    }
+
+    fn search_after(
+        &self,
+        query: &str,
+        limit: usize,
+        after: Option<SearchCursor>,
+    ) -> Result<SearchResult, SearchError> {
+        let start = Instant::now();
+        let query_terms = self.tokenizer.tokenize_query(query);
 
-        Ok(SearchResult {
-            hits,
-            total,
-            duration: start.elapsed(),
-            profile: self.name().to_string(),
-        })
+        let mut out = HitBuffer::new();
+        self.search_bmw(&query_terms, limit, 0, after, &mut out);
+        out.total = out.len() as u64;
+        Ok(out.to_result(self.name(), start.elapsed()))
+    }
+
+    fn count_hits(&self, query: &str, mode: TotalMode) -> Result<u64, SearchError> {
+        let mut query_terms = self.tokenizer.tokenize_query(query);
+        query_terms.sort_unstable();
+        query_terms.dedup();
+
+        let terms = self.terms.read();
+        let term_dict = Arc::clone(&self.term_dict.read());
+        let parts: Vec<Parts<'_>> = query_terms
+            .iter()
+            .filter_map(|term| term_dict.get(terms.lookup(term)? as usize))
+            .map(|meta| Parts::new(meta.blocks.iter().map(|block| block as &dyn TermDocs)))
+            .collect();
+        let parts: Vec<&dyn TermDocs> = parts.iter().map(|p| p as &dyn TermDocs).collect();
+        Ok(count_matches(&parts, *self.doc_count.read(), mode))
     }
 
     fn memory_stats(&self) -> MemoryStats {
-        let term_dict = self.term_dict.read();
-        let postings = self.postings.read();
+        let terms = self.terms.read();
+        let term_dict = Arc::clone(&self.term_dict.read());
         let doc_lengths = self.doc_lengths.read();
         let doc_ids = self.doc_ids.read();
 
-        let term_dict_bytes = term_dict.len() * (32 + std::mem::size_of::<TermMeta>());
-        let postings_bytes: usize = postings
+        let term_dict_bytes =
+            terms.heap_bytes() + term_dict.capacity() * std::mem::size_of::<TermMeta>();
+        let postings_bytes: usize = term_dict
             .iter()
+            .flat_map(|meta| meta.blocks.iter())
             .map(|b| b.doc_ids.len() * 4 + b.freqs.len() * 2 + 4)
             .sum();
         let doc_lengths_bytes = doc_lengths.len() * 2;
-        let doc_ids_bytes: usize = doc_ids.iter().map(|s| s.len()).sum();
+        let doc_ids_bytes = doc_ids.heap_bytes();
 
         MemoryStats {
             index_bytes: (term_dict_bytes + postings_bytes + doc_lengths_bytes + doc_ids_bytes)
@@ -365,49 +597,59 @@ impl SearchProfile for BmwSimdProfile {
         writer.write_all(&1u32.to_le_bytes())?; // version
 
         // Serialize data
-        let term_dict = self.term_dict.read();
-        let postings = self.postings.read();
+        let terms = self.terms.read();
+        let term_dict = Arc::clone(&self.term_dict.read());
         let doc_lengths = self.doc_lengths.read();
         let doc_ids = self.doc_ids.read();
         let doc_count = *self.doc_count.read();
         let total_doc_length = *self.total_doc_length.read();
+        let posting_count: usize = term_dict.iter().map(|meta| meta.blocks.len()).sum();
 
         // Write counts
         writer.write_all(&(term_dict.len() as u64).to_le_bytes())?;
-        writer.write_all(&(postings.len() as u64).to_le_bytes())?;
+        writer.write_all(&(posting_count as u64).to_le_bytes())?;
         writer.write_all(&doc_count.to_le_bytes())?;
         writer.write_all(&total_doc_length.to_le_bytes())?;
 
-        // Write term dict
-        for (term, meta) in term_dict.iter() {
-            let term_bytes = term.as_bytes();
+        // Write term dict; the terms' blocks are stored back to back
+        let mut posting_offset = 0u64;
+        for (id, meta) in term_dict.iter().enumerate() {
+            let term_bytes = terms.term(id as u32).as_bytes();
             writer.write_all(&(term_bytes.len() as u32).to_le_bytes())?;
             writer.write_all(term_bytes)?;
             writer.write_all(&meta.df.to_le_bytes())?;
-            writer.write_all(&(meta.posting_offset as u64).to_le_bytes())?;
-            writer.write_all(&(meta.num_blocks as u32).to_le_bytes())?;
+            writer.write_all(&posting_offset.to_le_bytes())?;
+            writer.write_all(&(meta.blocks.len() as u32).to_le_bytes())?;
             writer.write_all(&meta.idf.to_le_bytes())?;
+            posting_offset += meta.blocks.len() as u64;
         }
 
-        // Write postings
-        for block in postings.iter() {
-            writer.write_all(&(block.doc_ids.len() as u32).to_le_bytes())?;
-            for &doc_id in &block.doc_ids {
-                writer.write_all(&doc_id.to_le_bytes())?;
-            }
-            for &freq in &block.freqs {
-                writer.write_all(&freq.to_le_bytes())?;
+        // Write postings, each block with its score maximum under the
+        // current statistics. Load derives its own bounds; the maxima keep
+        // the file readable by older versions.
+        let total_docs = doc_count as f32;
+        let avg_doc_len = total_doc_length as f32 / doc_count.max(1) as f32;
+        for meta in term_dict.iter() {
+            let scorer = TermScorer::new(self.bm25, meta.df, total_docs, avg_doc_len);
+            for block in meta.blocks.iter() {
+                writer.write_all(&(block.doc_ids.len() as u32).to_le_bytes())?;
+                for &doc_id in &block.doc_ids {
+                    writer.write_all(&doc_id.to_le_bytes())?;
+                }
+                for &freq in &block.freqs {
+                    writer.write_all(&freq.to_le_bytes())?;
+                }
+                writer.write_all(&scorer.block_max(block).to_le_bytes())?;
             }
-            writer.write_all(&block.max_score.to_le_bytes())?;
         }
 
         // Write doc lengths
-        for &len in doc_lengths.iter() {
+        for len in doc_lengths.iter() {
             writer.write_all(&len.to_le_bytes())?;
         }
 
-        // Write doc IDs
-        for id in doc_ids.iter() {
+        // Write doc IDs (pending docs' IDs are not saved)
+        for id in doc_ids.iter().take(doc_count as usize) {
             let id_bytes = id.as_bytes();
             writer.write_all(&(id_bytes.len() as u32).to_le_bytes())?;
             writer.write_all(id_bytes)?;
@@ -442,8 +684,10 @@ impl SearchProfile for BmwSimdProfile {
         reader.read_exact(&mut buf8)?;
         let total_doc_length = u64::from_le_bytes(buf8);
 
-        // Read term dict
-        let mut term_dict = HashMap::with_capacity(term_count as usize);
+        // Read term dict (blocks are attached once read)
+        let mut term_ids = Vec::with_capacity(term_count as usize);
+        let mut term_dict = Vec::with_capacity(term_count as usize);
+        let mut block_ranges = Vec::with_capacity(term_count as usize);
         let mut buf4 = [0u8; 4];
 
         for _ in 0..term_count {
@@ -463,19 +707,19 @@ impl SearchProfile for BmwSimdProfile {
             reader.read_exact(&mut buf4)?;
             let idf = f32::from_le_bytes(buf4);
 
-            term_dict.insert(
-                term,
-                TermMeta {
-                    df,
-                    posting_offset,
-                    num_blocks,
-                    idf,
-                },
-            );
+            term_ids.push((term, term_dict.len()));
+            block_ranges.push(posting_offset..posting_offset + num_blocks);
+            term_dict.push(TermMeta {
+                df,
+                blocks: Arc::default(),
+                idf,
+            });
         }
+        let terms = TermInterner::from_ids(term_ids)
+            .ok_or_else(|| IndexError::Corrupted("Duplicate term".into()))?;
 
-        // Read postings
-        let mut postings = Vec::with_capacity(posting_count as usize);
+        // Read postings (bounded once doc lengths are read)
+        let mut blocks = Vec::with_capacity(posting_count as usize);
         for _ in 0..posting_count {
             reader.read_exact(&mut buf4)?;
             let block_size = u32::from_le_bytes(buf4) as usize;
@@ -493,39 +737,45 @@ impl SearchProfile for BmwSimdProfile {
                 freqs.push(u16::from_le_bytes(buf2));
             }
 
+            // Stored block maximum, superseded by the block's bounds
             reader.read_exact(&mut buf4)?;
-            let max_score = f32::from_le_bytes(buf4);
 
-            postings.push(PostingBlock {
-                doc_ids,
-                freqs,
-                max_score,
-            });
+            blocks.push((doc_ids, freqs));
         }
 
         // Read doc lengths
-        let mut doc_lengths = Vec::with_capacity(doc_count as usize);
+        let mut doc_lengths = Chunked::<Vec<u16>>::new();
         let mut buf2 = [0u8; 2];
         for _ in 0..doc_count {
             reader.read_exact(&mut buf2)?;
             doc_lengths.push(u16::from_le_bytes(buf2));
         }
+        let mut postings: Vec<PostingBlock> = blocks
+            .into_iter()
+            .map(|(doc_ids, freqs)| PostingBlock::new(doc_ids, freqs, &doc_lengths))
+            .collect();
+        for (meta, range) in term_dict.iter_mut().zip(block_ranges) {
+            let blocks = postings
+                .get_mut(range)
+                .ok_or_else(|| IndexError::Corrupted("Invalid posting offset".into()))?;
+            meta.blocks = blocks.iter_mut().map(std::mem::take).collect();
+        }
 
         // Read doc IDs
-        let mut doc_ids = Vec::with_capacity(doc_count as usize);
+        let mut doc_ids = Chunked::<IdTable>::new();
+        let mut id_bytes = Vec::new();
         for _ in 0..doc_count {
             reader.read_exact(&mut buf4)?;
-            let id_len = u32::from_le_bytes(buf4) as usize;
-            let mut id_bytes = vec![0u8; id_len];
+            id_bytes.resize(u32::from_le_bytes(buf4) as usize, 0);
             reader.read_exact(&mut id_bytes)?;
             doc_ids.push(
-                String::from_utf8(id_bytes)
+                std::str::from_utf8(&id_bytes)
                     .map_err(|_| IndexError::Corrupted("Invalid UTF-8".into()))?,
             );
         }
 
-        *self.term_dict.write() = term_dict;
-        *self.postings.write() = postings;
+        *self.terms.write() = terms;
+        *self.term_dict.write() = Arc::new(term_dict);
         *self.doc_lengths.write() = doc_lengths;
         *self.doc_ids.write() = doc_ids;
         *self.doc_count.write() = doc_count;
@@ -539,52 +789,30 @@ impl SearchProfile for BmwSimdProfile {
     }
 
     fn clear(&mut self) {
-        self.term_dict.write().clear();
-        self.postings.write().clear();
-        self.doc_lengths.write().clear();
-        self.doc_ids.write().clear();
-        *self.doc_count.write() = 0;
-        *self.total_doc_length.write() = 0;
-        self.pending.write().clear();
-    }
-}
-
-mod ordered_float {
-    #[derive(Debug, Clone, Copy, PartialEq)]
-    pub struct OrderedFloat<T>(pub T);
-
-    impl<T: PartialOrd> Ord for OrderedFloat<T> {
-        fn cmp(&self, other: &Self) -> std::cmp::Ordering {
-            self.0
-                .partial_cmp(&other.0)
-                .unwrap_or(std::cmp::Ordering::Equal)
-        }
-    }
-
-    impl<T: PartialOrd> PartialOrd for OrderedFloat<T> {
-        fn partial_cmp(&self, other: &Self) -> Option<std::cmp::Ordering> {
-            Some(self.cmp(other))
-        }
+        *self = Self::new();
     }
 
-    impl<T: PartialEq> Eq for OrderedFloat<T> {}
-
-    impl OrderedFloat<f32> {
-        pub fn into_inner(self) -> f32 {
-            self.0
-        }
-    }
-
-    impl From<OrderedFloat<f32>> for f32 {
-        fn from(val: OrderedFloat<f32>) -> Self {
-            val.0
-        }
+    /// Shares the committed term dictionary and table chunks
+    fn snapshot(&self) -> Result<Box<dyn SearchProfile>, IndexError> {
+        Ok(Box::new(Self {
+            terms: RwLock::new(self.terms.read().clone()),
+            term_dict: RwLock::new(Arc::clone(&self.term_dict.read())),
+            doc_lengths: RwLock::new(self.doc_lengths.read().clone()),
+            doc_ids: RwLock::new(self.doc_ids.read().clone()),
+            doc_count: RwLock::new(*self.doc_count.read()),
+            total_doc_length: RwLock::new(*self.total_doc_length.read()),
+            bm25: self.bm25,
+            tokenizer: FastTokenizer::default(),
+            pending: RwLock::new(Vec::new()),
+        }))
     }
 }
 
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::document::Document;
+    use std::collections::HashMap;
 
     #[test]
     fn test_index_and_search() {
@@ -606,4 +834,88 @@ mod tests {
         assert!(ids.contains(&"1"));
         assert!(ids.contains(&"3"));
     }
+
+    #[test]
+    fn test_matches_exhaustive_scoring() {
+        // Skewed term frequencies across enough documents for many blocks,
+        // committed in batches so block bounds outlive their statistics
+        let words = ["alpha", "beta", "gamma", "delta", "omega"];
+        let mut rng = 7u64;
+        let mut texts = Vec::new();
+        for _ in 0..3000 {
+            let mut text = String::new();
+            for _ in 0..1 + rng % 12 {
+                rng = rng
+                    .wrapping_mul(6364136223846793005)
+                    .wrapping_add(1442695040888963407);
+                let w = (rng >> 33) % 31;
+                text.push_str(words[(w.trailing_ones() as usize).min(4)]);
+                text.push_str(" filler ");
+            }
+            texts.push(text);
+        }
+
+        let mut profile = BmwSimdProfile::new();
+        for (batch, chunk) in texts.chunks(1000).enumerate() {
+            let docs: Vec<_> = chunk
+                .iter()
+                .enumerate()
+                .map(|(i, t)| Document::new(format!("{}", batch * 1000 + i), t.as_str()))
+                .collect();
+            profile.index_batch(&docs).unwrap();
+            profile.commit().unwrap();
+
+            // Re-blocked terms keep no stale blocks
+            for meta in profile.term_dict.read().iter() {
+                assert_eq!(meta.blocks.len(), (meta.df as usize).div_ceil(BLOCK_SIZE));
+            }
+        }
+
+        let bm25 = Bm25Params::default();
+        let tokenizer = FastTokenizer::default();
+        let freqs: Vec<_> = texts
+            .iter()
+            .map(|t| tokenizer.tokenize_with_freqs(t))
+            .collect();
+        let len = |f: &HashMap<String, u16>| f.values().map(|&tf| tf as f32).sum::<f32>();
+        let avg_len = freqs.iter().map(len).sum::<f32>() / texts.len() as f32;
+
+        for query in ["alpha", "alpha delta", "gamma omega beta", "delta omega"] {
+            let query_terms: Vec<_> = tokenizer
+                .tokenize_query(query)
+                .into_iter()
+                .map(|term| {
+                    let df = freqs.iter().filter(|f| f.contains_key(&term)).count();
+                    (term, df as f32)
+                })
+                .collect();
+            let mut expected: Vec<f32> = freqs
+                .iter()
+                .map(|doc| {
+                    query_terms
+                        .iter()
+                        .filter_map(|(term, df)| {
+                            let tf = *doc.get(term)? as f32;
+                            let n = texts.len() as f32;
+                            Some(bm25.score(tf, *df, len(doc), avg_len, n))
+                        })
+                        .sum()
+                })
+                .filter(|&score| score > 0.0)
+                .collect();
+            expected.sort_by(|a, b| b.partial_cmp(a).unwrap());
+
+            let hits = profile.search(query, 10, 5).unwrap().hits;
+            assert_eq!(hits.len(), 10, "{}", query);
+            for (hit, want) in hits.iter().zip(&expected[5..]) {
+                assert!(
+                    (hit.score - want).abs() < 1e-4,
+                    "{}: {} vs {}",
+                    query,
+                    hit.score,
+                    want
+                );
+            }
+        }
+    }
 }
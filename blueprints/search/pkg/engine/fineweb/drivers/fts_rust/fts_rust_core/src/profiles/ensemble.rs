@@ -1,26 +1,25 @@
 //! Ensemble profile: FST + Roaring + Block-Max WAND
 
-use crate::document::Document;
-use crate::profiles::{Bm25Params, ProfileType, SearchProfile};
-use crate::result::{IndexError, MemoryStats, SearchError, SearchHit, SearchResult};
-use crate::tokenizer::FastTokenizer;
-
-use fst::{Map, MapBuilder};
+use crate::chunked::Chunked;
+use crate::document::{DocumentRef, IdTable};
+use crate::profiles::{count_matches, Bm25Params, ProfileType, SearchProfile, TermDocs, TopK};
+use crate::result::{
+    HitBuffer, IndexError, MemoryStats, SearchCursor, SearchError, SearchResult, TotalMode,
+};
+use crate::tokenizer::{invert, FastTokenizer, TermInterner, TokenizedDoc};
+
+use fst::{Map, MapBuilder, Streamer};
 use parking_lot::RwLock;
-use rayon::prelude::*;
 use roaring::RoaringBitmap;
-use std::cmp::Reverse;
-use std::collections::{BinaryHeap, HashMap};
+use std::collections::HashMap;
 use std::fs::File;
 use std::io::{BufReader, BufWriter, Read, Write};
 use std::path::Path;
+use std::sync::Arc;
 use std::time::Instant;
 
 const BLOCK_SIZE: usize = 128;
 
-/// Type alias for pending document data
-type PendingDoc = (String, HashMap<String, u16>, u32);
-
 /// Posting block with max score
 #[derive(Debug, Clone)]
 struct PostingBlock {
@@ -29,8 +28,8 @@ struct PostingBlock {
     max_score: f32,
 }
 
-/// Compressed posting list
-#[derive(Debug, Clone)]
+/// Compressed posting list (empty for terms seen only in pending docs)
+#[derive(Debug, Clone, Default)]
 struct CompressedPosting {
     /// Roaring bitmap for doc IDs
     bitmap: RoaringBitmap,
@@ -43,18 +42,25 @@ struct CompressedPosting {
 }
 
 /// Ensemble profile combining FST, Roaring, and Block-Max WAND
+///
+/// Committed terms live only in the FST, which maps each term to its
+/// posting list. The interner holds just the terms of pending documents
+/// and is emptied at every commit, once they are merged into the FST.
+///
+/// Each commit builds a new FST and copies the posting lists it touches,
+/// and the length and ID tables are chunked, so `snapshot` shares their
+/// committed state without sharing a lock with the writer.
 pub struct EnsembleProfile {
-    /// FST for term dictionary (memory-mapped when loaded from disk)
-    fst_data: RwLock<Option<Vec<u8>>>,
-    fst_map: RwLock<Option<Map<Vec<u8>>>>,
-    /// In-memory term -> posting offset mapping (for building)
-    term_offsets: RwLock<HashMap<String, usize>>,
-    /// Posting lists
-    postings: RwLock<Vec<CompressedPosting>>,
+    /// Term dictionary: term -> posting list index (`None` until a commit)
+    fst_map: RwLock<Option<Arc<Map<Vec<u8>>>>>,
+    /// Terms of pending documents, by pending term ID
+    terms: RwLock<TermInterner>,
+    /// Posting lists, indexed by the FST's values
+    postings: RwLock<Arc<Vec<Arc<CompressedPosting>>>>,
     /// Document lengths
-    doc_lengths: RwLock<Vec<u16>>,
+    doc_lengths: RwLock<Chunked<Vec<u16>>>,
     /// Document IDs
-    doc_ids: RwLock<Vec<String>>,
+    doc_ids: RwLock<Chunked<IdTable>>,
     /// Document count
     doc_count: RwLock<u64>,
     /// Total document length
@@ -63,61 +69,73 @@ pub struct EnsembleProfile {
     bm25: Bm25Params,
     /// Tokenizer
     tokenizer: FastTokenizer,
-    /// Pending documents
-    pending: RwLock<Vec<PendingDoc>>,
-    /// Whether FST needs rebuild
-    fst_dirty: RwLock<bool>,
+    /// Pending documents (their IDs are already in the ID table)
+    pending: RwLock<Vec<TokenizedDoc>>,
 }
 
 impl EnsembleProfile {
     pub fn new() -> Self {
         Self {
-            fst_data: RwLock::new(None),
             fst_map: RwLock::new(None),
-            term_offsets: RwLock::new(HashMap::new()),
-            postings: RwLock::new(Vec::new()),
-            doc_lengths: RwLock::new(Vec::new()),
-            doc_ids: RwLock::new(Vec::new()),
+            terms: RwLock::new(TermInterner::new()),
+            postings: RwLock::new(Arc::new(Vec::new())),
+            doc_lengths: RwLock::new(Chunked::new()),
+            doc_ids: RwLock::new(Chunked::new()),
             doc_count: RwLock::new(0),
             total_doc_length: RwLock::new(0),
             bm25: Bm25Params::default(),
             tokenizer: FastTokenizer::default(),
             pending: RwLock::new(Vec::new()),
-            fst_dirty: RwLock::new(true),
         }
     }
 
-    fn build_index(&self) {
+    fn build_index(&self) -> Result<(), IndexError> {
         let pending = self.pending.read();
         if pending.is_empty() {
-            return;
+            return Ok(());
         }
 
-        let mut term_offsets = self.term_offsets.write();
+        let mut fst_map = self.fst_map.write();
+        // Copied here if a snapshot still holds the lists
         let mut postings = self.postings.write();
+        let postings = Arc::make_mut(&mut postings);
         let mut doc_lengths = self.doc_lengths.write();
-        let mut doc_ids = self.doc_ids.write();
         let mut doc_count = self.doc_count.write();
         let mut total_doc_length = self.total_doc_length.write();
+        let interner = self.terms.read();
 
         let base_doc_id = *doc_count as u32;
 
-        // Collect term -> postings
-        let mut term_posts: HashMap<String, Vec<(u32, u16)>> = HashMap::new();
-
-        for (i, (ext_id, tfs, doc_len)) in pending.iter().enumerate() {
-            let doc_id = base_doc_id + i as u32;
-            doc_ids.push(ext_id.clone());
-            doc_lengths.push(*doc_len as u16);
-            *total_doc_length += *doc_len as u64;
-
-            for (term, freq) in tfs {
-                term_posts
-                    .entry(term.clone())
-                    .or_default()
-                    .push((doc_id, *freq));
+        // Map pending term IDs to posting lists; terms new to the FST get
+        // the next posting lists
+        let mut posting_ids = vec![0u32; interner.len()];
+        let mut new_terms = Vec::new();
+        for (id, posting_id) in posting_ids.iter_mut().enumerate() {
+            let term = interner.term(id as u32);
+            match fst_map.as_ref().and_then(|m| m.get(term)) {
+                Some(existing) => *posting_id = existing as u32,
+                None => {
+                    *posting_id = (postings.len() + new_terms.len()) as u32;
+                    new_terms.push((term, *posting_id as u64));
+                }
             }
         }
+        if !new_terms.is_empty() {
+            new_terms.sort_unstable();
+            let merged = merge_fst(fst_map.as_deref(), &new_terms)
+                .map_err(|e| IndexError::Serialization(format!("FST build failed: {}", e)))?;
+            *fst_map = Some(Arc::new(merged));
+            let term_count = postings.len() + new_terms.len();
+            postings.resize_with(term_count, Arc::default);
+        }
+
+        for doc in pending.iter() {
+            doc_lengths.push(doc.doc_len as u16);
+            *total_doc_length += doc.doc_len as u64;
+        }
+
+        // (term, doc, freq) postings grouped by term
+        let term_posts = invert(&pending, base_doc_id);
 
         *doc_count += pending.len() as u64;
         let total_docs = *doc_count as f32;
@@ -128,13 +146,12 @@ impl EnsembleProfile {
         };
 
         // Build compressed postings with blocks
-        for (term, posts) in term_posts {
+        for posts in term_posts.chunk_by(|a, b| a.0 == b.0) {
             let df = posts.len() as u32;
-            let idf = ((total_docs - df as f32 + 0.5) / (df as f32 + 0.5) + 1.0).ln();
 
             // Build Roaring bitmap
             let mut bitmap = RoaringBitmap::new();
-            for &(doc_id, _) in &posts {
+            for &(_, doc_id, _) in posts {
                 bitmap.insert(doc_id);
             }
 
@@ -147,7 +164,7 @@ impl EnsembleProfile {
                     max_score: 0.0,
                 };
 
-                for &(doc_id, freq) in chunk {
+                for &(_, doc_id, freq) in chunk {
                     let doc_len = doc_lengths[doc_id as usize] as f32;
                     let score =
                         self.bm25
@@ -160,59 +177,17 @@ impl EnsembleProfile {
                 blocks.push(block);
             }
 
-            // Check if term already exists
-            if let Some(&offset) = term_offsets.get(&term) {
-                // Merge into existing posting
-                let existing = &mut postings[offset];
-                existing.bitmap |= &bitmap;
-                existing.blocks.extend(blocks);
-                existing.df += df;
-                // Recalculate IDF
-                existing.idf =
-                    ((total_docs - existing.df as f32 + 0.5) / (existing.df as f32 + 0.5) + 1.0)
-                        .ln();
-            } else {
-                // New term
-                let offset = postings.len();
-                term_offsets.insert(term, offset);
-                postings.push(CompressedPosting {
-                    bitmap,
-                    blocks,
-                    df,
-                    idf,
-                });
-            }
-        }
-
-        *self.fst_dirty.write() = true;
-    }
-
-    fn rebuild_fst(&self) {
-        if !*self.fst_dirty.read() {
-            return;
-        }
-
-        let term_offsets = self.term_offsets.read();
-        if term_offsets.is_empty() {
-            return;
-        }
-
-        // Sort terms for FST
-        let mut terms: Vec<_> = term_offsets.iter().collect();
-        terms.sort_by_key(|(k, _)| k.as_bytes());
-
-        // Build FST
-        let mut builder = MapBuilder::memory();
-        for (term, &offset) in &terms {
-            builder.insert(term, offset as u64).unwrap();
+            // Merge into the term's posting (empty for a new term)
+            let existing = Arc::make_mut(&mut postings[posting_ids[posts[0].0 as usize] as usize]);
+            existing.bitmap |= &bitmap;
+            existing.blocks.extend(blocks);
+            existing.df += df;
+            // Recalculate IDF
+            existing.idf =
+                ((total_docs - existing.df as f32 + 0.5) / (existing.df as f32 + 0.5) + 1.0).ln();
         }
-        let fst_bytes = builder.into_inner().unwrap();
 
-        let fst = Map::new(fst_bytes.clone()).unwrap();
-
-        *self.fst_data.write() = Some(fst_bytes);
-        *self.fst_map.write() = Some(fst);
-        *self.fst_dirty.write() = false;
+        Ok(())
     }
 
     fn search_ensemble(
@@ -220,31 +195,30 @@ impl EnsembleProfile {
         query_terms: &[String],
         limit: usize,
         offset: usize,
-    ) -> Vec<SearchHit> {
-        // Ensure FST is built
-        self.rebuild_fst();
-
-        let _fst_map = self.fst_map.read();
-        let postings = self.postings.read();
+        after: Option<SearchCursor>,
+        out: &mut HitBuffer,
+    ) {
+        let fst_map = self.fst_map.read().clone();
+        let postings = Arc::clone(&self.postings.read());
         let doc_lengths = self.doc_lengths.read();
         let doc_ids = self.doc_ids.read();
         let doc_count = *self.doc_count.read();
 
-        if doc_count == 0 || query_terms.is_empty() {
-            return Vec::new();
-        }
+        let fst_map = match fst_map.as_deref() {
+            Some(map) if doc_count > 0 && !query_terms.is_empty() => map,
+            _ => return,
+        };
 
         let total_docs = doc_count as f32;
         let total_doc_length = *self.total_doc_length.read();
         let avg_doc_len = total_doc_length as f32 / doc_count as f32;
 
-        // Look up terms in FST
-        let term_offsets = self.term_offsets.read();
+        // Look up posting lists in the FST
         let mut query_postings: Vec<(&CompressedPosting, f32)> = Vec::new();
 
         for term in query_terms {
-            if let Some(&offset) = term_offsets.get(term) {
-                let posting = &postings[offset];
+            let posting = fst_map.get(term).and_then(|id| postings.get(id as usize));
+            if let Some(posting) = posting.map(|p| &**p).filter(|p| p.df > 0) {
                 // Upper bound score
                 let upper_bound = posting.idf * (self.bm25.k1 + 1.0);
                 query_postings.push((posting, upper_bound));
@@ -252,25 +226,20 @@ impl EnsembleProfile {
         }
 
         if query_postings.is_empty() {
-            return Vec::new();
+            return;
         }
 
         // Sort by upper bound for efficiency
         query_postings.sort_by(|a, b| b.1.partial_cmp(&a.1).unwrap());
 
-        // Score using Block-Max WAND
-        let k = limit + offset;
-        let mut top_k: BinaryHeap<Reverse<(OrderedFloat, u32)>> = BinaryHeap::with_capacity(k + 1);
-        let mut threshold = 0.0f32;
+        // Accumulate every posting's BM25 contribution per document; a doc's
+        // score is only final once all terms are summed, so blocks cannot
+        // be skipped against the top-k threshold here
+        let mut top_k = TopK::new(limit + offset, after);
         let mut scored: HashMap<u32, f32> = HashMap::new();
 
         for (posting, _) in &query_postings {
             for block in &posting.blocks {
-                // Skip if block can't beat threshold
-                if block.max_score < threshold && !top_k.is_empty() {
-                    continue;
-                }
-
                 for (i, &doc_id) in block.doc_ids.iter().enumerate() {
                     let freq = block.freqs[i];
                     let doc_len = doc_lengths[doc_id as usize] as f32;
@@ -288,31 +257,29 @@ impl EnsembleProfile {
 
         // Build top-k
         for (doc_id, score) in scored {
-            let entry = Reverse((OrderedFloat(score), doc_id));
-            if top_k.len() < k {
-                top_k.push(entry);
-                if top_k.len() == k {
-                    threshold = top_k.peek().unwrap().0 .0 .0;
-                }
-            } else if score > threshold {
-                top_k.pop();
-                top_k.push(entry);
-                threshold = top_k.peek().unwrap().0 .0 .0;
-            }
+            top_k.push(score, doc_id);
         }
 
-        let mut results: Vec<_> = top_k
-            .into_sorted_vec()
-            .into_iter()
-            .skip(offset)
-            .take(limit)
-            .map(|Reverse((score, doc_id))| {
-                SearchHit::new(doc_ids[doc_id as usize].clone(), score.0)
-            })
-            .collect();
+        top_k.into_hits(offset, limit, out, |doc_id, ids| {
+            ids.push_str(doc_ids.get(doc_id as usize))
+        })
+    }
+
+    /// Tokenize `docs` and queue them for the next commit (thread-safe)
+    fn add_pending(&self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
+        let tokenized = self.tokenizer.tokenize_interned(docs, &self.terms);
+
+        // Pending docs get the next doc IDs in order, so IDs are interned now
+        // (the lock is held until they are in the pending buffer)
+        let mut doc_ids = self.doc_ids.write();
+        for doc in docs {
+            doc_ids.push(doc.id);
+        }
+
+        let count = tokenized.len();
+        self.pending.write().extend(tokenized);
 
-        results.reverse();
-        results
+        Ok(count)
     }
 }
 
@@ -331,24 +298,17 @@ impl SearchProfile for EnsembleProfile {
         ProfileType::Ensemble
     }
 
-    fn index_batch(&mut self, docs: &[Document]) -> Result<usize, IndexError> {
-        let tokenized: Vec<_> = docs
-            .par_iter()
-            .map(|doc| {
-                let term_freqs = self.tokenizer.tokenize_with_freqs(&doc.text);
-                let doc_len: u32 = term_freqs.values().map(|&v| v as u32).sum();
-                (doc.id.clone(), term_freqs, doc_len)
-            })
-            .collect();
-
-        let count = tokenized.len();
-        self.pending.write().extend(tokenized);
+    fn index_batch_refs(&mut self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
+        self.add_pending(docs)
+    }
 
-        Ok(count)
+    fn index_batch_shared(&self, docs: &[DocumentRef<'_>]) -> Option<Result<usize, IndexError>> {
+        Some(self.add_pending(docs))
     }
 
     fn commit(&mut self) -> Result<(), IndexError> {
-        self.build_index();
+        self.build_index()?;
+        self.terms.write().clear();
         self.pending.write().clear();
         Ok(())
     }
@@ -360,27 +320,66 @@ impl SearchProfile for EnsembleProfile {
         offset: usize,
     ) -> Result<SearchResult, SearchError> {
         let start = Instant::now();
+        let mut out = HitBuffer::new();
+        self.search_hits(query, limit, offset, &mut out)?;
+        Ok(out.to_result(self.name(), start.elapsed()))
+    }
+
+    fn search_hits(
+        &self,
+        query: &str,
+        limit: usize,
+        offset: usize,
+        out: &mut HitBuffer,
+    ) -> Result<(), SearchError> {
+        out.clear();
         let query_terms = self.tokenizer.tokenize_query(query);
-        let hits = self.search_ensemble(&query_terms, limit, offset);
-        let total = hits.len() as u64;
-
-        Ok(SearchResult {
-            hits,
-            total,
-            duration: start.elapsed(),
-            profile: self.name().to_string(),
-        })
+        self.search_ensemble(&query_terms, limit, offset, None, out);
+        out.total = out.len() as u64;
+        Ok(())
+    }
+
+    fn search_after(
+        &self,
+        query: &str,
+        limit: usize,
+        after: Option<SearchCursor>,
+    ) -> Result<SearchResult, SearchError> {
+        let start = Instant::now();
+        let query_terms = self.tokenizer.tokenize_query(query);
+        let mut out = HitBuffer::new();
+        self.search_ensemble(&query_terms, limit, 0, after, &mut out);
+        out.total = out.len() as u64;
+        Ok(out.to_result(self.name(), start.elapsed()))
+    }
+
+    fn count_hits(&self, query: &str, mode: TotalMode) -> Result<u64, SearchError> {
+        let mut query_terms = self.tokenizer.tokenize_query(query);
+        query_terms.sort_unstable();
+        query_terms.dedup();
+
+        let fst_map = self.fst_map.read().clone();
+        let postings = Arc::clone(&self.postings.read());
+        let terms: Vec<&dyn TermDocs> = match fst_map.as_deref() {
+            Some(map) => query_terms
+                .iter()
+                .filter_map(|term| postings.get(map.get(term)? as usize))
+                .map(|posting| &posting.bitmap as &dyn TermDocs)
+                .collect(),
+            None => Vec::new(),
+        };
+        Ok(count_matches(&terms, *self.doc_count.read(), mode))
     }
 
     fn memory_stats(&self) -> MemoryStats {
-        let term_offsets = self.term_offsets.read();
-        let postings = self.postings.read();
-        let fst_data = self.fst_data.read();
+        let terms = self.terms.read();
+        let postings = Arc::clone(&self.postings.read());
+        let fst_map = self.fst_map.read().clone();
         let doc_lengths = self.doc_lengths.read();
         let doc_ids = self.doc_ids.read();
 
-        let fst_bytes = fst_data.as_ref().map(|d| d.len()).unwrap_or(0);
-        let term_dict_bytes = term_offsets.len() * 40 + fst_bytes;
+        let fst_bytes = fst_map.as_ref().map_or(0, |m| m.as_fst().as_bytes().len());
+        let term_dict_bytes = terms.heap_bytes() + fst_bytes;
 
         let postings_bytes: usize = postings
             .iter()
@@ -396,7 +395,7 @@ impl SearchProfile for EnsembleProfile {
             .sum();
 
         let doc_lengths_bytes = doc_lengths.len() * 2;
-        let doc_ids_bytes: usize = doc_ids.iter().map(|s| s.len()).sum();
+        let doc_ids_bytes = doc_ids.heap_bytes();
 
         MemoryStats {
             index_bytes: (term_dict_bytes + postings_bytes + doc_lengths_bytes + doc_ids_bytes)
@@ -409,45 +408,30 @@ impl SearchProfile for EnsembleProfile {
     }
 
     fn save(&self, path: &Path) -> Result<(), IndexError> {
-        // Ensure FST is built
-        self.rebuild_fst();
-
         let file = File::create(path.join("ensemble.idx"))?;
         let mut writer = BufWriter::new(file);
 
         // Header
         writer.write_all(b"ENSM")?;
-        writer.write_all(&1u32.to_le_bytes())?;
+        writer.write_all(&2u32.to_le_bytes())?;
 
-        let term_offsets = self.term_offsets.read();
-        let postings = self.postings.read();
-        let fst_data = self.fst_data.read();
+        let postings = Arc::clone(&self.postings.read());
+        let fst_map = self.fst_map.read().clone();
         let doc_lengths = self.doc_lengths.read();
         let doc_ids = self.doc_ids.read();
         let doc_count = *self.doc_count.read();
         let total_doc_length = *self.total_doc_length.read();
 
-        // Counts
-        writer.write_all(&(term_offsets.len() as u64).to_le_bytes())?;
+        // Counts (the FST holds one term per posting list)
+        writer.write_all(&(postings.len() as u64).to_le_bytes())?;
         writer.write_all(&(postings.len() as u64).to_le_bytes())?;
         writer.write_all(&doc_count.to_le_bytes())?;
         writer.write_all(&total_doc_length.to_le_bytes())?;
 
-        // FST data
-        if let Some(fst) = fst_data.as_ref() {
-            writer.write_all(&(fst.len() as u64).to_le_bytes())?;
-            writer.write_all(fst)?;
-        } else {
-            writer.write_all(&0u64.to_le_bytes())?;
-        }
-
-        // Term offsets
-        for (term, &offset) in term_offsets.iter() {
-            let term_bytes = term.as_bytes();
-            writer.write_all(&(term_bytes.len() as u32).to_le_bytes())?;
-            writer.write_all(term_bytes)?;
-            writer.write_all(&(offset as u64).to_le_bytes())?;
-        }
+        // FST data (the term dictionary)
+        let fst_bytes = fst_map.as_ref().map_or(&[][..], |m| m.as_fst().as_bytes());
+        writer.write_all(&(fst_bytes.len() as u64).to_le_bytes())?;
+        writer.write_all(fst_bytes)?;
 
         // Postings
         for posting in postings.iter() {
@@ -476,12 +460,12 @@ impl SearchProfile for EnsembleProfile {
         }
 
         // Doc lengths
-        for &len in doc_lengths.iter() {
+        for len in doc_lengths.iter() {
             writer.write_all(&len.to_le_bytes())?;
         }
 
         // Doc IDs
-        for id in doc_ids.iter() {
+        for id in doc_ids.iter().take(doc_count as usize) {
             let id_bytes = id.as_bytes();
             writer.write_all(&(id_bytes.len() as u32).to_le_bytes())?;
             writer.write_all(id_bytes)?;
@@ -505,7 +489,8 @@ impl SearchProfile for EnsembleProfile {
         let mut buf4 = [0u8; 4];
         let mut buf8 = [0u8; 8];
 
-        reader.read_exact(&mut buf4)?; // version
+        reader.read_exact(&mut buf4)?;
+        let version = u32::from_le_bytes(buf4);
 
         reader.read_exact(&mut buf8)?;
         let term_count = u64::from_le_bytes(buf8);
@@ -527,9 +512,11 @@ impl SearchProfile for EnsembleProfile {
             None
         };
 
-        // Term offsets
-        let mut term_offsets = HashMap::with_capacity(term_count as usize);
-        for _ in 0..term_count {
+        // Version 1 follows the FST with a term list, which is what it
+        // looked terms up in; rebuild the FST from that
+        let mut term_offsets = Vec::new();
+        let listed_terms = if version < 2 { term_count } else { 0 };
+        for _ in 0..listed_terms {
             reader.read_exact(&mut buf4)?;
             let term_len = u32::from_le_bytes(buf4) as usize;
             let mut term_bytes = vec![0u8; term_len];
@@ -537,8 +524,7 @@ impl SearchProfile for EnsembleProfile {
             let term = String::from_utf8(term_bytes)
                 .map_err(|_| IndexError::Corrupted("Invalid UTF-8".into()))?;
             reader.read_exact(&mut buf8)?;
-            let offset = u64::from_le_bytes(buf8) as usize;
-            term_offsets.insert(term, offset);
+            term_offsets.push((term, u64::from_le_bytes(buf8)));
         }
 
         // Postings
@@ -588,46 +574,59 @@ impl SearchProfile for EnsembleProfile {
                 });
             }
 
-            postings.push(CompressedPosting {
+            postings.push(Arc::new(CompressedPosting {
                 bitmap,
                 blocks,
                 df,
                 idf,
-            });
+            }));
         }
 
         // Doc lengths
-        let mut doc_lengths = Vec::with_capacity(doc_count as usize);
+        let mut doc_lengths = Chunked::<Vec<u16>>::new();
         for _ in 0..doc_count {
             reader.read_exact(&mut buf2)?;
             doc_lengths.push(u16::from_le_bytes(buf2));
         }
 
         // Doc IDs
-        let mut doc_ids = Vec::with_capacity(doc_count as usize);
+        let mut doc_ids = Chunked::<IdTable>::new();
+        let mut id_bytes = Vec::new();
         for _ in 0..doc_count {
             reader.read_exact(&mut buf4)?;
-            let id_len = u32::from_le_bytes(buf4) as usize;
-            let mut id_bytes = vec![0u8; id_len];
+            id_bytes.resize(u32::from_le_bytes(buf4) as usize, 0);
             reader.read_exact(&mut id_bytes)?;
             doc_ids.push(
-                String::from_utf8(id_bytes)
+                std::str::from_utf8(&id_bytes)
                     .map_err(|_| IndexError::Corrupted("Invalid UTF-8".into()))?,
             );
         }
 
-        // Rebuild FST map
-        let fst_map = fst_data.as_ref().and_then(|d| Map::new(d.clone()).ok());
+        let fst_map = if version < 2 {
+            term_offsets.sort_unstable();
+            let terms: Vec<_> = term_offsets
+                .iter()
+                .map(|(t, id)| (t.as_str(), *id))
+                .collect();
+            Some(
+                merge_fst(None, &terms)
+                    .map_err(|_| IndexError::Corrupted("Invalid term offsets".into()))?,
+            )
+        } else {
+            fst_data
+                .map(Map::new)
+                .transpose()
+                .map_err(|_| IndexError::Corrupted("Invalid FST".into()))?
+        };
 
-        *self.fst_data.write() = fst_data;
-        *self.fst_map.write() = fst_map;
-        *self.term_offsets.write() = term_offsets;
-        *self.postings.write() = postings;
+        *self.fst_map.write() = fst_map.map(Arc::new);
+        self.terms.write().clear();
+        *self.postings.write() = Arc::new(postings);
         *self.doc_lengths.write() = doc_lengths;
         *self.doc_ids.write() = doc_ids;
         *self.doc_count.write() = doc_count;
         *self.total_doc_length.write() = total_doc_length;
-        *self.fst_dirty.write() = false;
+        self.pending.write().clear();
 
         Ok(())
     }
@@ -637,41 +636,54 @@ impl SearchProfile for EnsembleProfile {
     }
 
     fn clear(&mut self) {
-        *self.fst_data.write() = None;
-        *self.fst_map.write() = None;
-        self.term_offsets.write().clear();
-        self.postings.write().clear();
-        self.doc_lengths.write().clear();
-        self.doc_ids.write().clear();
-        *self.doc_count.write() = 0;
-        *self.total_doc_length.write() = 0;
-        self.pending.write().clear();
-        *self.fst_dirty.write() = true;
+        *self = Self::new();
     }
-}
 
-#[derive(Debug, Clone, Copy, PartialEq)]
-struct OrderedFloat(f32);
-
-impl Ord for OrderedFloat {
-    fn cmp(&self, other: &Self) -> std::cmp::Ordering {
-        self.0
-            .partial_cmp(&other.0)
-            .unwrap_or(std::cmp::Ordering::Equal)
+    /// Shares the FST, the committed posting lists and the table chunks;
+    /// pending terms are not needed to search
+    fn snapshot(&self) -> Result<Box<dyn SearchProfile>, IndexError> {
+        Ok(Box::new(Self {
+            fst_map: RwLock::new(self.fst_map.read().clone()),
+            terms: RwLock::new(TermInterner::new()),
+            postings: RwLock::new(Arc::clone(&self.postings.read())),
+            doc_lengths: RwLock::new(self.doc_lengths.read().clone()),
+            doc_ids: RwLock::new(self.doc_ids.read().clone()),
+            doc_count: RwLock::new(*self.doc_count.read()),
+            total_doc_length: RwLock::new(*self.total_doc_length.read()),
+            bm25: self.bm25,
+            tokenizer: FastTokenizer::default(),
+            pending: RwLock::new(Vec::new()),
+        }))
     }
 }
 
-impl PartialOrd for OrderedFloat {
-    fn partial_cmp(&self, other: &Self) -> Option<std::cmp::Ordering> {
-        Some(self.cmp(other))
+/// Build an FST holding `old`'s entries plus `new_terms`, which must be
+/// sorted and absent from `old`. Streams `old` rather than collecting it.
+fn merge_fst(
+    old: Option<&Map<Vec<u8>>>,
+    new_terms: &[(&str, u64)],
+) -> Result<Map<Vec<u8>>, fst::Error> {
+    let mut builder = MapBuilder::memory();
+    let mut new_terms = new_terms.iter().peekable();
+    if let Some(old) = old {
+        let mut stream = old.stream();
+        while let Some((key, id)) = stream.next() {
+            while let Some(&(term, new_id)) = new_terms.next_if(|(t, _)| t.as_bytes() < key) {
+                builder.insert(term, new_id)?;
+            }
+            builder.insert(key, id)?;
+        }
+    }
+    for &(term, id) in new_terms {
+        builder.insert(term, id)?;
     }
+    Map::new(builder.into_inner()?)
 }
 
-impl Eq for OrderedFloat {}
-
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::document::Document;
 
     #[test]
     fn test_ensemble_index_search() {
@@ -691,4 +703,49 @@ mod tests {
         let ids: Vec<_> = result.hits.iter().map(|h| h.id.as_str()).collect();
         assert!(ids.contains(&"1") || ids.contains(&"3"));
     }
+
+    #[test]
+    fn test_fst_dictionary_across_commits() {
+        let mut profile = EnsembleProfile::new();
+        profile
+            .index_batch(&[
+                Document::new("1", "zebra apple"),
+                Document::new("2", "mango apple"),
+            ])
+            .unwrap();
+        profile.commit().unwrap();
+        profile
+            .index_batch(&[
+                Document::new("3", "banana apple"),
+                Document::new("4", "zebra yak"),
+            ])
+            .unwrap();
+        profile.commit().unwrap();
+
+        // Committed terms live only in the FST
+        assert!(profile.terms.read().is_empty());
+        assert_eq!(profile.fst_map.read().as_ref().unwrap().len(), 5);
+
+        let ids = |p: &EnsembleProfile, q: &str| {
+            let mut ids: Vec<_> = p
+                .search(q, 10, 0)
+                .unwrap()
+                .hits
+                .into_iter()
+                .map(|h| h.id)
+                .collect();
+            ids.sort();
+            ids
+        };
+        assert_eq!(ids(&profile, "apple"), ["1", "2", "3"]);
+        assert_eq!(ids(&profile, "zebra"), ["1", "4"]);
+        assert_eq!(ids(&profile, "banana"), ["3"]);
+
+        let dir = tempfile::tempdir().unwrap();
+        profile.save(dir.path()).unwrap();
+        let mut loaded = EnsembleProfile::new();
+        loaded.load(dir.path()).unwrap();
+        assert_eq!(ids(&loaded, "apple"), ["1", "2", "3"]);
+        assert_eq!(ids(&loaded, "yak"), ["4"]);
+    }
 }
@@ -16,8 +16,15 @@ pub use tantivy_profile::TantivyProfile;
 pub use turbo::TurboProfile;
 pub use ultra::UltraProfile;
 
-use crate::document::Document;
-use crate::result::{IndexError, MemoryStats, SearchError, SearchResult};
+use crate::document::{Document, DocumentRef};
+use crate::filter::{Field, Filter};
+use crate::result::{
+    FacetResult, HitBuffer, IndexError, MemoryStats, SearchCursor, SearchError, SearchResult,
+    TotalMode,
+};
+use roaring::RoaringBitmap;
+use std::cmp::{Ordering, Reverse};
+use std::collections::BinaryHeap;
 use std::path::Path;
 use std::str::FromStr;
 
@@ -99,7 +106,23 @@ pub trait SearchProfile: Send + Sync {
     }
 
     /// Index a batch of documents
-    fn index_batch(&mut self, docs: &[Document]) -> Result<usize, IndexError>;
+    fn index_batch(&mut self, docs: &[Document]) -> Result<usize, IndexError> {
+        let refs: Vec<DocumentRef<'_>> = docs.iter().map(DocumentRef::from).collect();
+        self.index_batch_refs(&refs)
+    }
+
+    /// Index a batch of borrowed documents. Profiles tokenize from the
+    /// borrowed text and copy only the IDs (into their ID table).
+    fn index_batch_refs(&mut self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError>;
+
+    /// Index a batch through a shared reference, concurrently with other
+    /// calls. Profiles that support it reserve each batch's doc IDs
+    /// atomically and return `Some`; the default returns `None` without
+    /// indexing anything, and the caller uses `index_batch_refs` instead.
+    fn index_batch_shared(&self, docs: &[DocumentRef<'_>]) -> Option<Result<usize, IndexError>> {
+        let _ = docs;
+        None
+    }
 
     /// Commit pending changes to disk
     fn commit(&mut self) -> Result<(), IndexError>;
@@ -108,6 +131,85 @@ pub trait SearchProfile: Send + Sync {
     fn search(&self, query: &str, limit: usize, offset: usize)
         -> Result<SearchResult, SearchError>;
 
+    /// Search like `search`, replacing the contents of `out` instead of
+    /// building a `SearchResult`. Profiles copy hit IDs from their ID
+    /// table straight into `out`, so a reused buffer allocates nothing per
+    /// hit; the default goes through `search`.
+    fn search_hits(
+        &self,
+        query: &str,
+        limit: usize,
+        offset: usize,
+        out: &mut HitBuffer,
+    ) -> Result<(), SearchError> {
+        out.fill_from(&self.search(query, limit, offset)?);
+        Ok(())
+    }
+
+    /// Search the hits ranked after `after`, or from the top without one.
+    /// The collector only holds `limit` hits however deep the page is;
+    /// the result's `next` continues from its last hit. The default
+    /// supports only the first page.
+    fn search_after(
+        &self,
+        query: &str,
+        limit: usize,
+        after: Option<SearchCursor>,
+    ) -> Result<SearchResult, SearchError> {
+        match after {
+            None => self.search(query, limit, 0),
+            Some(_) => Err(SearchError::InvalidQuery(format!(
+                "profile {} does not support cursors",
+                self.name()
+            ))),
+        }
+    }
+
+    /// Search only the docs matching `filter`. Profiles that index
+    /// document metadata intersect the filter's docs with their postings
+    /// before scoring; the default rejects filtered queries.
+    fn search_filtered(
+        &self,
+        query: &str,
+        filter: &Filter,
+        limit: usize,
+        offset: usize,
+    ) -> Result<SearchResult, SearchError> {
+        let _ = (query, filter, limit, offset);
+        Err(SearchError::InvalidQuery(format!(
+            "profile {} does not support filters",
+            self.name()
+        )))
+    }
+
+    /// Count the `top_n` most frequent values of each of `fields` among
+    /// all docs matching `query`, without ranking them. `approximate`
+    /// lets broad queries count a sample. The default rejects the request.
+    fn facets(
+        &self,
+        query: &str,
+        fields: &[Field],
+        top_n: usize,
+        approximate: bool,
+    ) -> Result<FacetResult, SearchError> {
+        let _ = (query, fields, top_n, approximate);
+        Err(SearchError::InvalidQuery(format!(
+            "profile {} does not support facets",
+            self.name()
+        )))
+    }
+
+    /// Count the committed docs matching any term of `query`, exactly or
+    /// cheaply from postings statistics (see `count_matches`). The default
+    /// rejects the request.
+    fn count_hits(&self, query: &str, mode: TotalMode) -> Result<u64, SearchError> {
+        let _ = (query, mode);
+        Err(SearchError::InvalidQuery(format!(
+            "profile {} does not count hits",
+            self.name()
+        )))
+    }
+
     /// Get memory statistics
     fn memory_stats(&self) -> MemoryStats;
 
@@ -117,11 +219,23 @@ pub trait SearchProfile: Send + Sync {
     /// Load index from disk
     fn load(&mut self, path: &Path) -> Result<(), IndexError>;
 
+    /// Whether `save` only adds new files and then switches to them with an
+    /// atomic rename, so a crash mid-save leaves the previous state intact
+    /// and `FtsIndex` can save in place instead of through a staging copy
+    fn atomic_save(&self) -> bool {
+        false
+    }
+
     /// Number of indexed documents
     fn doc_count(&self) -> u64;
 
     /// Clear the index
     fn clear(&mut self);
+
+    /// A read-only view of the committed state that stays valid while this
+    /// profile keeps indexing. It shares no lock with the profile, so its
+    /// searches never wait on a commit or on `add_documents`.
+    fn snapshot(&self) -> Result<Box<dyn SearchProfile>, IndexError>;
 }
 
 /// Create a profile by type
@@ -160,3 +274,334 @@ impl Bm25Params {
         idf * tf_component
     }
 }
+
+/// Score ordered for the top-k heap (scores are never NaN)
+#[derive(Debug, Clone, Copy, PartialEq)]
+struct Score(f32);
+
+impl Eq for Score {}
+
+impl Ord for Score {
+    fn cmp(&self, other: &Self) -> Ordering {
+        self.0.partial_cmp(&other.0).unwrap_or(Ordering::Equal)
+    }
+}
+
+impl PartialOrd for Score {
+    fn partial_cmp(&self, other: &Self) -> Option<Ordering> {
+        Some(self.cmp(other))
+    }
+}
+
+/// Collects the best `k` hits, ranked as `SearchCursor` orders them
+///
+/// A min-heap keeps the worst hit on top for replacement. With a cursor,
+/// hits ranked at or before it are dropped on entry, so a deep page costs
+/// the same heap work as the first.
+pub(crate) struct TopK {
+    heap: BinaryHeap<Reverse<(Score, Reverse<u32>)>>,
+    k: usize,
+    after: Option<SearchCursor>,
+}
+
+impl TopK {
+    pub fn new(k: usize, after: Option<SearchCursor>) -> Self {
+        Self {
+            heap: BinaryHeap::with_capacity(k + 1),
+            k,
+            after,
+        }
+    }
+
+    pub fn is_full(&self) -> bool {
+        self.heap.len() >= self.k
+    }
+
+    /// Lowest kept score once full (0 until then); a later hit must beat
+    /// it, or tie it with a lower doc ID
+    #[inline]
+    pub fn threshold(&self) -> f32 {
+        match self.heap.peek() {
+            Some(Reverse((score, _))) if self.is_full() => score.0,
+            _ => 0.0,
+        }
+    }
+
+    #[inline]
+    pub fn push(&mut self, score: f32, doc: u32) {
+        if self.after.is_some_and(|cursor| !cursor.admits(score, doc)) {
+            return;
+        }
+        let entry = Reverse((Score(score), Reverse(doc)));
+        if self.heap.len() < self.k {
+            self.heap.push(entry);
+        } else if self.heap.peek().is_some_and(|worst| entry < *worst) {
+            self.heap.pop();
+            self.heap.push(entry);
+        }
+    }
+
+    /// Append hits `offset..offset + limit` to `out`, best first, with
+    /// `write_id` appending each doc's external ID to the ID string, and
+    /// set `out.next` to the cursor after the last one when the page is
+    /// full. The heap is sorted in place, so no page is collected.
+    pub fn into_hits(
+        self,
+        offset: usize,
+        limit: usize,
+        out: &mut HitBuffer,
+        mut write_id: impl FnMut(u32, &mut String),
+    ) {
+        let mut last = None;
+        let mut count = 0;
+        for Reverse((score, Reverse(doc))) in self
+            .heap
+            .into_sorted_vec()
+            .into_iter()
+            .skip(offset)
+            .take(limit)
+        {
+            out.push_with(score.0, |ids| write_id(doc, ids));
+            last = Some(SearchCursor::new(score.0, doc));
+            count += 1;
+        }
+        out.next = last.filter(|_| count == limit);
+    }
+}
+
+/// Docs sampled from each query term's postings by `count_matches`
+const COUNT_SAMPLE: u64 = 256;
+
+/// The doc IDs of one query term's postings, for counting matches
+pub(crate) trait TermDocs {
+    /// Document frequency
+    fn df(&self) -> u64;
+
+    /// The `i`th doc ID in ascending order (`i < df`)
+    fn nth(&self, i: u64) -> u32;
+
+    fn contains(&self, doc: u32) -> bool;
+
+    fn for_each_doc(&self, f: &mut dyn FnMut(u32));
+}
+
+impl TermDocs for &[u32] {
+    fn df(&self) -> u64 {
+        self.len() as u64
+    }
+
+    fn nth(&self, i: u64) -> u32 {
+        self[i as usize]
+    }
+
+    fn contains(&self, doc: u32) -> bool {
+        self.binary_search(&doc).is_ok()
+    }
+
+    fn for_each_doc(&self, f: &mut dyn FnMut(u32)) {
+        self.iter().for_each(|&doc| f(doc))
+    }
+}
+
+impl TermDocs for RoaringBitmap {
+    fn df(&self) -> u64 {
+        self.len()
+    }
+
+    fn nth(&self, i: u64) -> u32 {
+        self.select(i as u32).unwrap_or(u32::MAX)
+    }
+
+    fn contains(&self, doc: u32) -> bool {
+        RoaringBitmap::contains(self, doc)
+    }
+
+    fn for_each_doc(&self, f: &mut dyn FnMut(u32)) {
+        self.iter().for_each(f)
+    }
+}
+
+/// A term's postings split into parts that cover ascending, disjoint
+/// doc-ID ranges (blocks, segments, saved and in-memory runs)
+pub(crate) struct Parts<'a> {
+    parts: Vec<&'a dyn TermDocs>,
+    /// Cumulative df at the end of each part
+    ends: Vec<u64>,
+}
+
+impl<'a> Parts<'a> {
+    pub fn new(parts: impl IntoIterator<Item = &'a dyn TermDocs>) -> Self {
+        let parts: Vec<_> = parts.into_iter().filter(|part| part.df() > 0).collect();
+        let ends = parts
+            .iter()
+            .scan(0, |end, part| {
+                *end += part.df();
+                Some(*end)
+            })
+            .collect();
+        Self { parts, ends }
+    }
+}
+
+impl TermDocs for Parts<'_> {
+    fn df(&self) -> u64 {
+        self.ends.last().copied().unwrap_or(0)
+    }
+
+    fn nth(&self, i: u64) -> u32 {
+        let p = self.ends.partition_point(|&end| end <= i);
+        let start = if p == 0 { 0 } else { self.ends[p - 1] };
+        self.parts[p].nth(i - start)
+    }
+
+    fn contains(&self, doc: u32) -> bool {
+        // The first part whose last doc is not below `doc`
+        let p = self
+            .parts
+            .partition_point(|part| part.nth(part.df() - 1) < doc);
+        self.parts.get(p).is_some_and(|part| part.contains(doc))
+    }
+
+    fn for_each_doc(&self, f: &mut dyn FnMut(u32)) {
+        for part in &self.parts {
+            part.for_each_doc(f);
+        }
+    }
+}
+
+/// Count the docs in the union of `terms` (the distinct query terms'
+/// postings) out of `doc_count` docs
+///
+/// `Exact` collects every doc ID in a bitmap. `LowerBound` is the largest
+/// df. `Estimate` samples evenly spaced docs from each term and checks the
+/// other terms for them: a doc in `c` of the lists is counted `1/c` times
+/// from each, so the union is the sum over terms of df times the sample's
+/// mean `1/c`. This follows term correlation, unlike independence.
+pub(crate) fn count_matches(terms: &[&dyn TermDocs], doc_count: u64, mode: TotalMode) -> u64 {
+    let terms: Vec<&dyn TermDocs> = terms.iter().copied().filter(|t| t.df() > 0).collect();
+    let max_df = terms.iter().map(|t| t.df()).max().unwrap_or(0);
+    let sum_df: u64 = terms.iter().map(|t| t.df()).sum();
+    if terms.len() <= 1 || mode == TotalMode::LowerBound {
+        return max_df;
+    }
+
+    if mode == TotalMode::Exact || sum_df <= COUNT_SAMPLE * terms.len() as u64 {
+        let mut docs = RoaringBitmap::new();
+        for term in &terms {
+            term.for_each_doc(&mut |doc| {
+                docs.insert(doc);
+            });
+        }
+        return docs.len();
+    }
+
+    let mut estimate = 0.0f64;
+    for (i, term) in terms.iter().enumerate() {
+        let df = term.df();
+        let samples = df.min(COUNT_SAMPLE);
+        let share: f64 = (0..samples)
+            .map(|s| {
+                let doc = term.nth(s * df / samples);
+                let lists = 1 + terms
+                    .iter()
+                    .enumerate()
+                    .filter(|&(j, other)| j != i && other.contains(doc))
+                    .count();
+                1.0 / lists as f64
+            })
+            .sum();
+        estimate += df as f64 * share / samples as f64;
+    }
+    (estimate.round() as u64).clamp(max_df, sum_df.min(doc_count).max(max_df))
+}
+
+/// Union size of terms with document frequencies `dfs` out of `doc_count`
+/// docs, assuming the terms occur independently
+pub(crate) fn estimate_independent(dfs: &[u64], doc_count: u64) -> u64 {
+    if doc_count == 0 {
+        return 0;
+    }
+    let missing: f64 = dfs
+        .iter()
+        .map(|&df| 1.0 - df.min(doc_count) as f64 / doc_count as f64)
+        .product();
+    let max_df = dfs.iter().copied().max().unwrap_or(0);
+    ((doc_count as f64 * (1.0 - missing)).round() as u64).max(max_df)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_top_k_cursor() {
+        // Many ties, offered in no particular order
+        let hits: Vec<(f32, u32)> = (0..100u32)
+            .map(|d| (((d * 7) % 10) as f32, d * 37 % 101))
+            .collect();
+        let mut all = TopK::new(hits.len(), None);
+        for &(score, doc) in &hits {
+            all.push(score, doc);
+        }
+        let mut all_hits = HitBuffer::new();
+        all.into_hits(0, hits.len(), &mut all_hits, |doc, ids| {
+            ids.push_str(&doc.to_string())
+        });
+
+        let mut walked = Vec::new();
+        let mut after = None;
+        let mut page_hits = HitBuffer::new();
+        loop {
+            let mut page = TopK::new(7, after);
+            for &(score, doc) in &hits {
+                page.push(score, doc);
+            }
+            page_hits.clear();
+            page.into_hits(0, 7, &mut page_hits, |doc, ids| {
+                ids.push_str(&doc.to_string())
+            });
+            walked.extend(page_hits.iter().map(|(_, id)| id.to_string()));
+            match page_hits.next {
+                Some(cursor) => {
+                    after = SearchCursor::decode(&cursor.encode());
+                    assert_eq!(after, Some(cursor));
+                }
+                None => break,
+            }
+        }
+
+        let all: Vec<_> = all_hits.iter().map(|(_, id)| id.to_string()).collect();
+        assert_eq!(walked, all);
+        assert!(SearchCursor::decode("not a cursor").is_none());
+    }
+
+    #[test]
+    fn test_count_matches() {
+        // Correlated terms: `b` lies almost entirely inside `a`
+        let a: Vec<u32> = (0..10_000).collect();
+        let b: Vec<u32> = (0..10_000).step_by(2).chain(10_000..10_500).collect();
+        let c: RoaringBitmap = (20_000..21_000).collect();
+        let (a, b) = (a.as_slice(), b.as_slice());
+        let terms: [&dyn TermDocs; 3] = [&a, &b, &c];
+
+        assert_eq!(count_matches(&terms, 100_000, TotalMode::Exact), 11_500);
+        assert_eq!(
+            count_matches(&terms, 100_000, TotalMode::LowerBound),
+            10_000
+        );
+        let estimate = count_matches(&terms, 100_000, TotalMode::Estimate);
+        assert!((11_000..=12_000).contains(&estimate), "{}", estimate);
+
+        // Independence overcounts the overlap
+        assert!(estimate_independent(&[10_000, 5_500, 1_000], 100_000) > 15_000);
+
+        // Split postings count as one term
+        let (low, high) = (&a[..4_000], &a[4_000..]);
+        let split = Parts::new([&low as &dyn TermDocs, &high]);
+        assert_eq!(split.df(), 10_000);
+        assert_eq!(split.nth(4_000), 4_000);
+        assert!(split.contains(9_999) && !split.contains(10_000));
+        let terms: [&dyn TermDocs; 2] = [&split, &b];
+        assert_eq!(count_matches(&terms, 100_000, TotalMode::Exact), 10_500);
+    }
+}
@@ -1,44 +1,57 @@
 //! Roaring Bitmaps with BM25 scoring profile
 
-use crate::document::Document;
-use crate::profiles::{Bm25Params, ProfileType, SearchProfile};
-use crate::result::{IndexError, MemoryStats, SearchError, SearchHit, SearchResult};
+use crate::chunked::Chunked;
+use crate::document::{DocumentRef, IdTable};
+use crate::filter::{Field, FieldIndex, Filter};
+use crate::profiles::{count_matches, Bm25Params, ProfileType, SearchProfile, TermDocs, TopK};
+use crate::result::{
+    FacetResult, HitBuffer, IndexError, MemoryStats, SearchCursor, SearchError, SearchResult,
+    TotalMode,
+};
 use crate::tokenizer::FastTokenizer;
 
 use parking_lot::RwLock;
 use rayon::prelude::*;
 use roaring::RoaringBitmap;
-use std::cmp::Reverse;
-use std::collections::{BinaryHeap, HashMap};
+use std::collections::HashMap;
 use std::fs::File;
 use std::io::{BufReader, BufWriter, Read, Write};
 use std::path::Path;
+use std::sync::Arc;
 use std::time::Instant;
 
-/// Type alias for pending document data
-type PendingDoc = (String, HashMap<String, u16>, u32);
+/// Type alias for pending document data: (term_freqs, doc_length)
+/// (external IDs go straight into the ID table)
+type PendingDoc = (HashMap<String, u16>, u32);
 
-/// Term metadata for Roaring profile
-#[derive(Debug, Clone)]
-struct TermMeta {
+/// A term's committed postings
+#[derive(Debug, Clone, Default)]
+struct TermPostings {
     /// Document frequency
     df: u32,
     /// Precomputed IDF
     idf: f32,
+    /// Documents containing the term
+    bitmap: RoaringBitmap,
+    /// Term frequency per document, by doc ID
+    freqs: Vec<(u32, u16)>,
 }
 
 /// Roaring Bitmaps + BM25 profile
+///
+/// The posting map, each term's postings and the metadata bitmaps are
+/// copied on write, and the length and ID tables are chunked, so
+/// `snapshot` shares their committed state without sharing a lock with
+/// the writer.
 pub struct RoaringBm25Profile {
-    /// Term dictionary
-    term_dict: RwLock<HashMap<String, TermMeta>>,
-    /// Posting lists using Roaring bitmaps
-    postings: RwLock<HashMap<String, RoaringBitmap>>,
-    /// Term frequencies: term -> [freq per doc]
-    term_freqs: RwLock<HashMap<String, Vec<(u32, u16)>>>,
+    /// Posting lists by term
+    postings: RwLock<Arc<HashMap<String, Arc<TermPostings>>>>,
     /// Document lengths
-    doc_lengths: RwLock<Vec<u16>>,
+    doc_lengths: RwLock<Chunked<Vec<u16>>>,
     /// External document IDs
-    doc_ids: RwLock<Vec<String>>,
+    doc_ids: RwLock<Chunked<IdTable>>,
+    /// Metadata bitmaps for filtered search, covering pending docs too
+    fields: RwLock<FieldIndex>,
     /// Document count
     doc_count: RwLock<u64>,
     /// Total document length
@@ -54,11 +67,10 @@ pub struct RoaringBm25Profile {
 impl RoaringBm25Profile {
     pub fn new() -> Self {
         Self {
-            term_dict: RwLock::new(HashMap::new()),
-            postings: RwLock::new(HashMap::new()),
-            term_freqs: RwLock::new(HashMap::new()),
-            doc_lengths: RwLock::new(Vec::new()),
-            doc_ids: RwLock::new(Vec::new()),
+            postings: RwLock::new(Arc::new(HashMap::new())),
+            doc_lengths: RwLock::new(Chunked::new()),
+            doc_ids: RwLock::new(Chunked::new()),
+            fields: RwLock::new(FieldIndex::new()),
             doc_count: RwLock::new(0),
             total_doc_length: RwLock::new(0),
             bm25: Bm25Params::default(),
@@ -73,11 +85,10 @@ impl RoaringBm25Profile {
             return;
         }
 
-        let mut term_dict = self.term_dict.write();
+        // Copied here if a snapshot still holds the map
         let mut postings = self.postings.write();
-        let mut term_freqs = self.term_freqs.write();
+        let postings = Arc::make_mut(&mut postings);
         let mut doc_lengths = self.doc_lengths.write();
-        let mut doc_ids = self.doc_ids.write();
         let mut doc_count = self.doc_count.write();
         let mut total_doc_length = self.total_doc_length.write();
 
@@ -86,9 +97,8 @@ impl RoaringBm25Profile {
         // Collect postings
         let mut new_postings: HashMap<String, Vec<(u32, u16)>> = HashMap::new();
 
-        for (i, (ext_id, tfs, doc_len)) in pending.iter().enumerate() {
+        for (i, (tfs, doc_len)) in pending.iter().enumerate() {
             let doc_id = base_doc_id + i as u32;
-            doc_ids.push(ext_id.clone());
             doc_lengths.push(*doc_len as u16);
             *total_doc_length += *doc_len as u64;
 
@@ -105,118 +115,125 @@ impl RoaringBm25Profile {
 
         // Merge into main index
         for (term, posts) in new_postings {
-            let bitmap = postings.entry(term.clone()).or_default();
-            let freqs = term_freqs.entry(term.clone()).or_default();
+            let entry = Arc::make_mut(postings.entry(term).or_default());
 
             for (doc_id, freq) in posts {
-                bitmap.insert(doc_id);
-                freqs.push((doc_id, freq));
+                entry.bitmap.insert(doc_id);
+                entry.freqs.push((doc_id, freq));
             }
 
             // Update term metadata
-            let df = bitmap.len() as u32;
-            let idf = ((total_docs - df as f32 + 0.5) / (df as f32 + 0.5) + 1.0).ln();
-            term_dict.insert(term, TermMeta { df, idf });
+            entry.df = entry.bitmap.len() as u32;
+            entry.idf = ((total_docs - entry.df as f32 + 0.5) / (entry.df as f32 + 0.5) + 1.0).ln();
         }
     }
 
+    /// Score the docs matching any query term, restricted to `filter`
     fn search_roaring(
         &self,
         query_terms: &[String],
+        filter: Option<&RoaringBitmap>,
         limit: usize,
         offset: usize,
-    ) -> Vec<SearchHit> {
-        let term_dict = self.term_dict.read();
-        let postings = self.postings.read();
-        let term_freqs = self.term_freqs.read();
+        after: Option<SearchCursor>,
+        out: &mut HitBuffer,
+    ) {
+        let postings = Arc::clone(&self.postings.read());
         let doc_lengths = self.doc_lengths.read();
         let doc_ids = self.doc_ids.read();
         let doc_count = *self.doc_count.read();
 
         if doc_count == 0 || query_terms.is_empty() {
-            return Vec::new();
+            return;
         }
 
         let total_docs = doc_count as f32;
         let total_doc_length = *self.total_doc_length.read();
         let avg_doc_len = total_doc_length as f32 / doc_count as f32;
 
-        // Collect bitmaps for query terms
-        let mut query_bitmaps: Vec<(&RoaringBitmap, &str, &TermMeta)> = Vec::new();
-        for term in query_terms {
-            if let (Some(bitmap), Some(meta)) = (postings.get(term), term_dict.get(term)) {
-                query_bitmaps.push((bitmap, term, meta));
-            }
-        }
+        // Collect postings for query terms
+        let query_postings: Vec<&TermPostings> = query_terms
+            .iter()
+            .filter_map(|term| postings.get(term))
+            .map(|p| &**p)
+            .collect();
 
-        if query_bitmaps.is_empty() {
-            return Vec::new();
+        if query_postings.is_empty() {
+            return;
         }
 
-        // Intersect bitmaps (OR for multiple query terms)
-        let mut result_bitmap = query_bitmaps[0].0.clone();
-        for (bitmap, _, _) in query_bitmaps.iter().skip(1) {
-            result_bitmap |= *bitmap;
+        // Union the query terms' bitmaps (OR semantics), then drop the docs
+        // the filter excludes so only survivors are scored
+        let mut result_bitmap = query_postings[0].bitmap.clone();
+        for p in query_postings.iter().skip(1) {
+            result_bitmap |= &p.bitmap;
+        }
+        if let Some(filter) = filter {
+            result_bitmap &= filter;
         }
 
         // Score documents
-        let k = limit + offset;
-        let mut top_k: BinaryHeap<Reverse<(OrderedFloat, u32)>> = BinaryHeap::with_capacity(k + 1);
-
-        // Build freq lookup for efficiency
-        let freq_lookups: HashMap<&str, HashMap<u32, u16>> = query_bitmaps
-            .iter()
-            .map(|(_, term, _)| {
-                let lookup: HashMap<u32, u16> = term_freqs
-                    .get(*term)
-                    .map(|v| v.iter().cloned().collect())
-                    .unwrap_or_default();
-                (*term, lookup)
-            })
-            .collect();
+        let mut top_k = TopK::new(limit + offset, after);
 
+        // Freq lists are sorted by doc ID, so each lookup is a binary search
         for doc_id in result_bitmap.iter() {
             let doc_len = doc_lengths[doc_id as usize] as f32;
             let mut score = 0.0f32;
 
-            for (_, term, meta) in &query_bitmaps {
-                if let Some(freq_map) = freq_lookups.get(term) {
-                    if let Some(&freq) = freq_map.get(&doc_id) {
-                        score += self.bm25.score(
-                            freq as f32,
-                            meta.df as f32,
-                            doc_len,
-                            avg_doc_len,
-                            total_docs,
-                        );
-                    }
+            for p in &query_postings {
+                if let Ok(i) = p.freqs.binary_search_by_key(&doc_id, |&(doc, _)| doc) {
+                    score += self.bm25.score(
+                        p.freqs[i].1 as f32,
+                        p.df as f32,
+                        doc_len,
+                        avg_doc_len,
+                        total_docs,
+                    );
                 }
             }
 
-            let entry = Reverse((OrderedFloat(score), doc_id));
-            if top_k.len() < k {
-                top_k.push(entry);
-            } else if let Some(Reverse((min_score, _))) = top_k.peek() {
-                if score > min_score.0 {
-                    top_k.pop();
-                    top_k.push(entry);
-                }
-            }
+            top_k.push(score, doc_id);
         }
 
-        // Extract results
-        let mut results: Vec<_> = top_k
-            .into_sorted_vec()
-            .into_iter()
-            .skip(offset)
-            .take(limit)
-            .map(|Reverse((score, doc_id))| {
-                SearchHit::new(doc_ids[doc_id as usize].clone(), score.0)
+        top_k.into_hits(offset, limit, out, |doc_id, ids| {
+            ids.push_str(doc_ids.get(doc_id as usize))
+        })
+    }
+
+    /// Committed docs containing any query term
+    fn matches(&self, query_terms: &[String]) -> RoaringBitmap {
+        let postings = Arc::clone(&self.postings.read());
+        let mut matches = RoaringBitmap::new();
+        for p in query_terms.iter().filter_map(|term| postings.get(term)) {
+            matches |= &p.bitmap;
+        }
+        matches
+    }
+
+    /// Tokenize `docs` and queue them for the next commit (thread-safe)
+    fn add_pending(&self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
+        let tokenized: Vec<_> = docs
+            .par_iter()
+            .map(|doc| {
+                let term_freqs = self.tokenizer.tokenize_with_freqs(doc.text);
+                let doc_len: u32 = term_freqs.values().map(|&v| v as u32).sum();
+                (term_freqs, doc_len)
             })
             .collect();
 
-        results.reverse();
-        results
+        // Pending docs get the next doc IDs in order, so IDs are interned now
+        // (the lock is held until they are in the pending buffer)
+        let mut doc_ids = self.doc_ids.write();
+        let mut fields = self.fields.write();
+        for doc in docs {
+            fields.insert(doc_ids.len() as u32, doc);
+            doc_ids.push(doc.id);
+        }
+
+        let count = tokenized.len();
+        self.pending.write().extend(tokenized);
+
+        Ok(count)
     }
 }
 
@@ -235,20 +252,12 @@ impl SearchProfile for RoaringBm25Profile {
         ProfileType::RoaringBm25
     }
 
-    fn index_batch(&mut self, docs: &[Document]) -> Result<usize, IndexError> {
-        let tokenized: Vec<_> = docs
-            .par_iter()
-            .map(|doc| {
-                let term_freqs = self.tokenizer.tokenize_with_freqs(&doc.text);
-                let doc_len: u32 = term_freqs.values().map(|&v| v as u32).sum();
-                (doc.id.clone(), term_freqs, doc_len)
-            })
-            .collect();
-
-        let count = tokenized.len();
-        self.pending.write().extend(tokenized);
+    fn index_batch_refs(&mut self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
+        self.add_pending(docs)
+    }
 
-        Ok(count)
+    fn index_batch_shared(&self, docs: &[DocumentRef<'_>]) -> Option<Result<usize, IndexError>> {
+        Some(self.add_pending(docs))
     }
 
     fn commit(&mut self) -> Result<(), IndexError> {
@@ -264,37 +273,107 @@ impl SearchProfile for RoaringBm25Profile {
         offset: usize,
     ) -> Result<SearchResult, SearchError> {
         let start = Instant::now();
+        let mut out = HitBuffer::new();
+        self.search_hits(query, limit, offset, &mut out)?;
+        Ok(out.to_result(self.name(), start.elapsed()))
+    }
+
+    fn search_hits(
+        &self,
+        query: &str,
+        limit: usize,
+        offset: usize,
+        out: &mut HitBuffer,
+    ) -> Result<(), SearchError> {
+        out.clear();
         let query_terms = self.tokenizer.tokenize_query(query);
-        let hits = self.search_roaring(&query_terms, limit, offset);
-        let total = hits.len() as u64;
-
-        Ok(SearchResult {
-            hits,
-            total,
-            duration: start.elapsed(),
-            profile: self.name().to_string(),
-        })
+        self.search_roaring(&query_terms, None, limit, offset, None, out);
+        out.total = out.len() as u64;
+        Ok(())
+    }
+
+    fn search_after(
+        &self,
+        query: &str,
+        limit: usize,
+        after: Option<SearchCursor>,
+    ) -> Result<SearchResult, SearchError> {
+        let start = Instant::now();
+        let query_terms = self.tokenizer.tokenize_query(query);
+        let mut out = HitBuffer::new();
+        self.search_roaring(&query_terms, None, limit, 0, after, &mut out);
+        out.total = out.len() as u64;
+        Ok(out.to_result(self.name(), start.elapsed()))
+    }
+
+    fn search_filtered(
+        &self,
+        query: &str,
+        filter: &Filter,
+        limit: usize,
+        offset: usize,
+    ) -> Result<SearchResult, SearchError> {
+        let start = Instant::now();
+        let docs = self.fields.read().eval(filter);
+        let mut out = HitBuffer::new();
+        if !docs.is_empty() {
+            let query_terms = self.tokenizer.tokenize_query(query);
+            self.search_roaring(&query_terms, Some(&docs), limit, offset, None, &mut out);
+        }
+        out.total = out.len() as u64;
+        Ok(out.to_result(self.name(), start.elapsed()))
+    }
+
+    fn facets(
+        &self,
+        query: &str,
+        fields: &[Field],
+        top_n: usize,
+        approximate: bool,
+    ) -> Result<FacetResult, SearchError> {
+        let matches = self.matches(&self.tokenizer.tokenize_query(query));
+        Ok(self
+            .fields
+            .read()
+            .facets(&matches, fields, top_n, approximate))
+    }
+
+    fn count_hits(&self, query: &str, mode: TotalMode) -> Result<u64, SearchError> {
+        let mut query_terms = self.tokenizer.tokenize_query(query);
+        query_terms.sort_unstable();
+        query_terms.dedup();
+        if mode == TotalMode::Exact {
+            return Ok(self.matches(&query_terms).len());
+        }
+
+        let postings = Arc::clone(&self.postings.read());
+        let terms: Vec<&dyn TermDocs> = query_terms
+            .iter()
+            .filter_map(|term| postings.get(term))
+            .map(|p| &p.bitmap as &dyn TermDocs)
+            .collect();
+        Ok(count_matches(&terms, *self.doc_count.read(), mode))
     }
 
     fn memory_stats(&self) -> MemoryStats {
-        let term_dict = self.term_dict.read();
-        let postings = self.postings.read();
-        let term_freqs = self.term_freqs.read();
+        let postings = Arc::clone(&self.postings.read());
         let doc_lengths = self.doc_lengths.read();
         let doc_ids = self.doc_ids.read();
 
-        let term_dict_bytes = term_dict.len() * (32 + std::mem::size_of::<TermMeta>());
-        let postings_bytes: usize = postings.values().map(|b| b.serialized_size()).sum();
-        let term_freqs_bytes: usize = term_freqs.values().map(|v| v.len() * 6).sum();
+        let term_dict_bytes = postings.len() * (32 + std::mem::size_of::<TermPostings>());
+        let postings_bytes: usize = postings.values().map(|p| p.bitmap.serialized_size()).sum();
+        let term_freqs_bytes: usize = postings.values().map(|p| p.freqs.len() * 6).sum();
         let doc_lengths_bytes = doc_lengths.len() * 2;
-        let doc_ids_bytes: usize = doc_ids.iter().map(|s| s.len()).sum();
+        let doc_ids_bytes = doc_ids.heap_bytes();
+        let fields_bytes = self.fields.read().heap_bytes();
 
         MemoryStats {
             index_bytes: (term_dict_bytes
                 + postings_bytes
                 + term_freqs_bytes
                 + doc_lengths_bytes
-                + doc_ids_bytes) as u64,
+                + doc_ids_bytes
+                + fields_bytes) as u64,
             term_dict_bytes: term_dict_bytes as u64,
             postings_bytes: (postings_bytes + term_freqs_bytes) as u64,
             docs_indexed: *self.doc_count.read(),
@@ -308,63 +387,56 @@ impl SearchProfile for RoaringBm25Profile {
 
         // Write header
         writer.write_all(b"ROAR")?;
-        writer.write_all(&1u32.to_le_bytes())?;
+        writer.write_all(&2u32.to_le_bytes())?;
 
-        let term_dict = self.term_dict.read();
-        let postings = self.postings.read();
-        let term_freqs = self.term_freqs.read();
+        let postings = Arc::clone(&self.postings.read());
         let doc_lengths = self.doc_lengths.read();
         let doc_ids = self.doc_ids.read();
         let doc_count = *self.doc_count.read();
         let total_doc_length = *self.total_doc_length.read();
 
         // Write counts
-        writer.write_all(&(term_dict.len() as u64).to_le_bytes())?;
+        writer.write_all(&(postings.len() as u64).to_le_bytes())?;
         writer.write_all(&doc_count.to_le_bytes())?;
         writer.write_all(&total_doc_length.to_le_bytes())?;
 
         // Write term dict + postings + freqs
-        for (term, meta) in term_dict.iter() {
+        for (term, p) in postings.iter() {
             let term_bytes = term.as_bytes();
             writer.write_all(&(term_bytes.len() as u32).to_le_bytes())?;
             writer.write_all(term_bytes)?;
-            writer.write_all(&meta.df.to_le_bytes())?;
-            writer.write_all(&meta.idf.to_le_bytes())?;
+            writer.write_all(&p.df.to_le_bytes())?;
+            writer.write_all(&p.idf.to_le_bytes())?;
 
             // Write bitmap
-            if let Some(bitmap) = postings.get(term) {
-                let mut bitmap_bytes = Vec::new();
-                bitmap.serialize_into(&mut bitmap_bytes).unwrap();
-                writer.write_all(&(bitmap_bytes.len() as u64).to_le_bytes())?;
-                writer.write_all(&bitmap_bytes)?;
-            } else {
-                writer.write_all(&0u64.to_le_bytes())?;
-            }
+            let mut bitmap_bytes = Vec::new();
+            p.bitmap.serialize_into(&mut bitmap_bytes).unwrap();
+            writer.write_all(&(bitmap_bytes.len() as u64).to_le_bytes())?;
+            writer.write_all(&bitmap_bytes)?;
 
             // Write freqs
-            if let Some(freqs) = term_freqs.get(term) {
-                writer.write_all(&(freqs.len() as u64).to_le_bytes())?;
-                for (doc_id, freq) in freqs {
-                    writer.write_all(&doc_id.to_le_bytes())?;
-                    writer.write_all(&freq.to_le_bytes())?;
-                }
-            } else {
-                writer.write_all(&0u64.to_le_bytes())?;
+            writer.write_all(&(p.freqs.len() as u64).to_le_bytes())?;
+            for (doc_id, freq) in &p.freqs {
+                writer.write_all(&doc_id.to_le_bytes())?;
+                writer.write_all(&freq.to_le_bytes())?;
             }
         }
 
         // Write doc lengths
-        for &len in doc_lengths.iter() {
+        for len in doc_lengths.iter() {
             writer.write_all(&len.to_le_bytes())?;
         }
 
         // Write doc IDs
-        for id in doc_ids.iter() {
+        for id in doc_ids.iter().take(doc_count as usize) {
             let id_bytes = id.as_bytes();
             writer.write_all(&(id_bytes.len() as u32).to_le_bytes())?;
             writer.write_all(id_bytes)?;
         }
 
+        // Write metadata bitmaps (version 2)
+        self.fields.read().write_to(&mut writer)?;
+
         writer.flush()?;
         Ok(())
     }
@@ -383,7 +455,8 @@ impl SearchProfile for RoaringBm25Profile {
         let mut buf8 = [0u8; 8];
         let mut buf2 = [0u8; 2];
 
-        reader.read_exact(&mut buf4)?; // version
+        reader.read_exact(&mut buf4)?;
+        let version = u32::from_le_bytes(buf4);
 
         reader.read_exact(&mut buf8)?;
         let term_count = u64::from_le_bytes(buf8);
@@ -392,9 +465,7 @@ impl SearchProfile for RoaringBm25Profile {
         reader.read_exact(&mut buf8)?;
         let total_doc_length = u64::from_le_bytes(buf8);
 
-        let mut term_dict = HashMap::with_capacity(term_count as usize);
         let mut postings = HashMap::with_capacity(term_count as usize);
-        let mut term_freqs = HashMap::with_capacity(term_count as usize);
 
         for _ in 0..term_count {
             reader.read_exact(&mut buf4)?;
@@ -409,17 +480,15 @@ impl SearchProfile for RoaringBm25Profile {
             reader.read_exact(&mut buf4)?;
             let idf = f32::from_le_bytes(buf4);
 
-            term_dict.insert(term.clone(), TermMeta { df, idf });
-
             // Read bitmap
             reader.read_exact(&mut buf8)?;
             let bitmap_len = u64::from_le_bytes(buf8) as usize;
+            let mut bitmap = RoaringBitmap::new();
             if bitmap_len > 0 {
                 let mut bitmap_bytes = vec![0u8; bitmap_len];
                 reader.read_exact(&mut bitmap_bytes)?;
-                let bitmap = RoaringBitmap::deserialize_from(&bitmap_bytes[..])
+                bitmap = RoaringBitmap::deserialize_from(&bitmap_bytes[..])
                     .map_err(|_| IndexError::Corrupted("Invalid bitmap".into()))?;
-                postings.insert(term.clone(), bitmap);
             }
 
             // Read freqs
@@ -433,34 +502,48 @@ impl SearchProfile for RoaringBm25Profile {
                 let freq = u16::from_le_bytes(buf2);
                 freqs.push((doc_id, freq));
             }
-            term_freqs.insert(term, freqs);
+            let entry = TermPostings {
+                df,
+                idf,
+                bitmap,
+                freqs,
+            };
+            postings.insert(term, Arc::new(entry));
         }
 
         // Read doc lengths
-        let mut doc_lengths = Vec::with_capacity(doc_count as usize);
+        let mut doc_lengths = Chunked::<Vec<u16>>::new();
         for _ in 0..doc_count {
             reader.read_exact(&mut buf2)?;
             doc_lengths.push(u16::from_le_bytes(buf2));
         }
 
         // Read doc IDs
-        let mut doc_ids = Vec::with_capacity(doc_count as usize);
+        let mut doc_ids = Chunked::<IdTable>::new();
+        let mut id_bytes = Vec::new();
         for _ in 0..doc_count {
             reader.read_exact(&mut buf4)?;
-            let id_len = u32::from_le_bytes(buf4) as usize;
-            let mut id_bytes = vec![0u8; id_len];
+            id_bytes.resize(u32::from_le_bytes(buf4) as usize, 0);
             reader.read_exact(&mut id_bytes)?;
             doc_ids.push(
-                String::from_utf8(id_bytes)
+                std::str::from_utf8(&id_bytes)
                     .map_err(|_| IndexError::Corrupted("Invalid UTF-8".into()))?,
             );
         }
 
-        *self.term_dict.write() = term_dict;
-        *self.postings.write() = postings;
-        *self.term_freqs.write() = term_freqs;
+        // Version 1 files predate metadata: their docs match no field value.
+        // Fields may also hold pending docs saved before their commit.
+        let mut fields = if version >= 2 {
+            FieldIndex::read_from(&mut reader)?
+        } else {
+            FieldIndex::new()
+        };
+        fields.resize(doc_count as u32);
+
+        *self.postings.write() = Arc::new(postings);
         *self.doc_lengths.write() = doc_lengths;
         *self.doc_ids.write() = doc_ids;
+        *self.fields.write() = fields;
         *self.doc_count.write() = doc_count;
         *self.total_doc_length.write() = total_doc_length;
 
@@ -472,39 +555,29 @@ impl SearchProfile for RoaringBm25Profile {
     }
 
     fn clear(&mut self) {
-        self.term_dict.write().clear();
-        self.postings.write().clear();
-        self.term_freqs.write().clear();
-        self.doc_lengths.write().clear();
-        self.doc_ids.write().clear();
-        *self.doc_count.write() = 0;
-        *self.total_doc_length.write() = 0;
-        self.pending.write().clear();
+        *self = Self::new();
     }
-}
-
-#[derive(Debug, Clone, Copy, PartialEq)]
-struct OrderedFloat(f32);
-
-impl Ord for OrderedFloat {
-    fn cmp(&self, other: &Self) -> std::cmp::Ordering {
-        self.0
-            .partial_cmp(&other.0)
-            .unwrap_or(std::cmp::Ordering::Equal)
-    }
-}
 
-impl PartialOrd for OrderedFloat {
-    fn partial_cmp(&self, other: &Self) -> Option<std::cmp::Ordering> {
-        Some(self.cmp(other))
+    /// Shares the committed postings, metadata bitmaps and table chunks
+    fn snapshot(&self) -> Result<Box<dyn SearchProfile>, IndexError> {
+        Ok(Box::new(Self {
+            postings: RwLock::new(Arc::clone(&self.postings.read())),
+            doc_lengths: RwLock::new(self.doc_lengths.read().clone()),
+            doc_ids: RwLock::new(self.doc_ids.read().clone()),
+            fields: RwLock::new(self.fields.read().clone()),
+            doc_count: RwLock::new(*self.doc_count.read()),
+            total_doc_length: RwLock::new(*self.total_doc_length.read()),
+            bm25: self.bm25,
+            tokenizer: FastTokenizer::default(),
+            pending: RwLock::new(Vec::new()),
+        }))
     }
 }
 
-impl Eq for OrderedFloat {}
-
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::document::{Document, DocumentMetadata};
 
     #[test]
     fn test_roaring_index_search() {
@@ -521,4 +594,69 @@ mod tests {
         let result = profile.search("quick dog", 10, 0).unwrap();
         assert!(result.hits.len() >= 2);
     }
+
+    #[test]
+    fn test_filtered_search() {
+        let doc = |id: &str, text: &str, url: &str, lang: &str, date: &str| Document {
+            metadata: Some(DocumentMetadata {
+                language: Some(lang.into()),
+                date: Some(date.into()),
+                source: None,
+            }),
+            ..Document::new(id, text).with_url(url)
+        };
+        let docs = vec![
+            doc(
+                "1",
+                "rust search engine",
+                "https://a.com/1",
+                "en",
+                "2023-01-01",
+            ),
+            doc(
+                "2",
+                "rust rust search",
+                "https://b.org/2",
+                "de",
+                "2024-02-02",
+            ),
+            doc(
+                "3",
+                "search engine news",
+                "https://www.a.com/3",
+                "en",
+                "2024-03-03",
+            ),
+            Document::new("4", "rust search without metadata"),
+        ];
+
+        let mut profile = RoaringBm25Profile::new();
+        profile.index_batch(&docs[..2]).unwrap();
+        profile.commit().unwrap();
+        profile.index_batch(&docs[2..]).unwrap();
+        profile.commit().unwrap();
+
+        let ids = |profile: &RoaringBm25Profile, expr: &str| {
+            let filter = Filter::parse(expr).unwrap();
+            let result = profile
+                .search_filtered("rust search", &filter, 10, 0)
+                .unwrap();
+            result.hits.into_iter().map(|h| h.id).collect::<Vec<_>>()
+        };
+        let all = profile.search("rust search", 10, 0).unwrap();
+        assert_eq!(all.hits[0].id, "2");
+        assert!(all.hits.windows(2).all(|w| w[0].score >= w[1].score));
+
+        assert_eq!(ids(&profile, "domain:a.com"), ["1", "3"]);
+        assert_eq!(ids(&profile, "lang:en AND year:2024"), ["3"]);
+        assert_eq!(ids(&profile, "NOT lang:en"), ["2", "4"]);
+        assert!(ids(&profile, "lang:fr").is_empty());
+
+        let dir = tempfile::tempdir().unwrap();
+        profile.save(dir.path()).unwrap();
+        let mut loaded = RoaringBm25Profile::new();
+        loaded.load(dir.path()).unwrap();
+        assert_eq!(ids(&loaded, "domain:b.org OR year:2023"), ["2", "1"]);
+        assert_eq!(ids(&loaded, "NOT lang:en"), ["2", "4"]);
+    }
 }
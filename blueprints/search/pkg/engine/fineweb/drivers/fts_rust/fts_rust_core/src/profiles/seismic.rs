@@ -1,71 +1,252 @@
-//! Seismic profile: Learned sparse retrieval with geometry-cohesive blocks
-
-use crate::document::Document;
-use crate::profiles::{Bm25Params, ProfileType, SearchProfile};
-use crate::result::{IndexError, MemoryStats, SearchError, SearchHit, SearchResult};
-use crate::tokenizer::FastTokenizer;
+//! Seismic profile: learned-sparse-style retrieval over BM25-weighted
+//! sparse vectors
+//!
+//! Each document is a sparse vector of BM25 term weights. A term's posting
+//! list keeps the documents it weighs most in (static pruning) and groups
+//! them into geometry-cohesive blocks: seeds are spread over the list and
+//! every document joins the seed it shares the most weight with. Each
+//! block carries a summary, the largest weight of each term in the block,
+//! trimmed to the terms carrying most of its mass and quantized to a byte
+//! per term. Summaries always keep the list's own term.
+//!
+//! A query walks its terms' lists, rarest first. Summary dot products
+//! bound the scores in each block, eight blocks at a time; blocks are
+//! visited best bound first, and the rest of a list is skipped once the
+//! bounds fall below the top-k threshold. Documents in visited blocks are
+//! scored exactly, once each, from a forward index.
+//!
+//! As in Seismic, retrieval is approximate: pruned postings and trimmed
+//! summaries can hide a document from the lists of terms it is weak in.
+
+use crate::chunked::Chunked;
+use crate::document::{DocumentRef, IdTable};
+use crate::profiles::{Bm25Params, ProfileType, SearchProfile, TopK};
+use crate::result::{
+    HitBuffer, IndexError, MemoryStats, SearchCursor, SearchError, SearchResult, TotalMode,
+};
+use crate::tokenizer::{invert, term_hash, FastTokenizer, TermInterner, TokenizedDoc};
 
 use parking_lot::RwLock;
 use rayon::prelude::*;
-use std::cmp::Reverse;
-use std::collections::{BinaryHeap, HashMap};
+use rustc_hash::{FxHashMap, FxHashSet};
+use std::cmp::Ordering;
 use std::fs::File;
 use std::io::{BufReader, BufWriter, Read, Write};
 use std::path::Path;
+use std::sync::Arc;
 use std::time::Instant;
+use wide::f32x8;
 
-/// Embedding dimension for learned representations
-const EMBED_DIM: usize = 32;
+/// Postings kept per term and commit, heaviest first (static pruning)
+const MAX_POSTINGS: usize = 2048;
 
-/// Block size for geometry-cohesive partitioning
-const SEISMIC_BLOCK_SIZE: usize = 256;
+/// Target documents per block
+const BLOCK_DOCS: usize = 128;
 
-/// Type alias for pending document data
-type PendingDoc = (String, HashMap<String, u16>, u32);
+/// Heaviest terms of a document used to cluster and summarize it
+const SIGNATURE_TERMS: usize = 16;
 
-/// A geometry-cohesive block
-#[derive(Debug, Clone)]
+/// Share of a block summary's weight that is kept (alpha pruning)
+const SUMMARY_MASS: f32 = 0.5;
+
+/// Blocks are visited while their bound is at least this share of the
+/// top-k threshold; below 1 it leaves a margin for trimmed summaries
+const HEAP_FACTOR: f32 = 0.9;
+
+/// Blocks bounded per SIMD operation
+const LANES: usize = 8;
+
+/// Documents checked to estimate a query's match count
+const COUNT_SAMPLE_DOCS: u64 = 4096;
+
+/// A document's heaviest terms and their weights, by term ID
+type Signature = Vec<(u32, f32)>;
+
+/// A geometry-cohesive block of one term's postings
+#[derive(Debug, Clone, Default)]
 struct SeismicBlock {
-    /// Document IDs in this block
+    /// Documents in the block (ascending)
     doc_ids: Vec<u32>,
-    /// Term frequencies for BM25 fallback
-    term_freqs: Vec<Vec<(String, u16)>>,
-    /// Document lengths
-    doc_lengths: Vec<u16>,
-    /// Block centroid (learned embedding)
-    centroid: [f32; EMBED_DIM],
-    /// Maximum score potential in this block
-    max_score: f32,
+    /// Summary terms (ascending)
+    summary_terms: Vec<u32>,
+    /// Largest weight of each summary term in the block, in steps of
+    /// `summary_scale` (rounded up)
+    summary_values: Vec<u8>,
+    summary_scale: f32,
 }
 
 impl SeismicBlock {
+    /// A block of `doc_ids`, summarized from their signatures plus the
+    /// largest weight `term_max` of the list's term `term`
+    fn new(
+        doc_ids: Vec<u32>,
+        term: u32,
+        term_max: f32,
+        signatures: &[Signature],
+        base_doc: u32,
+    ) -> Self {
+        let mut weights: FxHashMap<u32, f32> = FxHashMap::default();
+        for &doc in &doc_ids {
+            for &(t, w) in &signatures[(doc - base_doc) as usize] {
+                let max = weights.entry(t).or_insert(0.0);
+                *max = max.max(w);
+            }
+        }
+        weights.remove(&term);
+
+        // Alpha pruning: keep the heaviest terms carrying SUMMARY_MASS of
+        // the summary's weight
+        let mut entries: Vec<(u32, f32)> = weights.into_iter().collect();
+        entries.sort_unstable_by(|a, b| b.1.total_cmp(&a.1));
+        let total = term_max + entries.iter().map(|e| e.1).sum::<f32>();
+        let mut mass = term_max;
+        let kept = entries
+            .iter()
+            .take_while(|e| {
+                let keep = mass < SUMMARY_MASS * total;
+                mass += e.1;
+                keep
+            })
+            .count();
+        entries.truncate(kept);
+        entries.push((term, term_max));
+        entries.sort_unstable_by_key(|e| e.0);
+
+        let max = entries.iter().map(|e| e.1).fold(0.0, f32::max);
+        let scale = if max > 0.0 { max / 255.0 } else { 1.0 };
+        Self {
+            doc_ids,
+            summary_terms: entries.iter().map(|e| e.0).collect(),
+            summary_values: entries
+                .iter()
+                .map(|e| (e.1 / scale).ceil().min(255.0) as u8)
+                .collect(),
+            summary_scale: scale,
+        }
+    }
+
+    /// Quantized summary weight of `term` (0 if trimmed)
+    #[inline]
+    fn summary(&self, term: u32) -> f32 {
+        match self.summary_terms.binary_search(&term) {
+            Ok(i) => self.summary_values[i] as f32,
+            Err(_) => 0.0,
+        }
+    }
+}
+
+/// A term's posting list
+#[derive(Debug, Clone, Default)]
+struct TermList {
+    /// Document frequency (before pruning)
+    df: u32,
+    blocks: Vec<SeismicBlock>,
+}
+
+/// Committed documents' term frequencies, for exact scoring; one chunk of
+/// the profile's chunked forward table
+#[derive(Debug, Clone)]
+struct ForwardIndex {
+    /// Start of each document's entries, then the end of the last
+    offsets: Vec<usize>,
+    /// Term IDs (ascending within a document) and their frequencies
+    terms: Vec<u32>,
+    freqs: Vec<u16>,
+    doc_lengths: Vec<u16>,
+}
+
+impl ForwardIndex {
     fn new() -> Self {
         Self {
-            doc_ids: Vec::with_capacity(SEISMIC_BLOCK_SIZE),
-            term_freqs: Vec::with_capacity(SEISMIC_BLOCK_SIZE),
-            doc_lengths: Vec::with_capacity(SEISMIC_BLOCK_SIZE),
-            centroid: [0.0; EMBED_DIM],
-            max_score: 0.0,
+            offsets: vec![0],
+            terms: Vec::new(),
+            freqs: Vec::new(),
+            doc_lengths: Vec::new(),
         }
     }
 
-    fn len(&self) -> usize {
-        self.doc_ids.len()
+    fn push(&mut self, terms: &mut [(u32, u16)], doc_len: u32) {
+        terms.sort_unstable_by_key(|&(term, _)| term);
+        self.terms.extend(terms.iter().map(|&(term, _)| term));
+        self.freqs.extend(terms.iter().map(|&(_, freq)| freq));
+        self.offsets.push(self.terms.len());
+        self.doc_lengths.push(doc_len as u16);
+    }
+
+    /// Terms and frequencies of `doc`
+    fn doc(&self, doc: u32) -> (&[u32], &[u16]) {
+        let range = self.offsets[doc as usize]..self.offsets[doc as usize + 1];
+        (&self.terms[range.clone()], &self.freqs[range])
+    }
+
+    /// BM25 score of `doc` for `(term ID, df)` query terms
+    fn score(&self, doc: u32, query: &[(u32, u32)], bm25: Bm25Params, stats: (f32, f32)) -> f32 {
+        let (avg_doc_len, total_docs) = stats;
+        let (terms, freqs) = self.doc(doc);
+        let doc_len = self.doc_lengths[doc as usize] as f32;
+        query
+            .iter()
+            .filter_map(|&(term, df)| {
+                let i = terms.binary_search(&term).ok()?;
+                Some(bm25.score(freqs[i] as f32, df as f32, doc_len, avg_doc_len, total_docs))
+            })
+            .sum()
+    }
+
+    fn heap_bytes(&self) -> usize {
+        self.offsets.capacity() * std::mem::size_of::<usize>()
+            + self.terms.capacity() * 4
+            + self.freqs.capacity() * 2
+            + self.doc_lengths.capacity() * 2
+    }
+}
+
+impl Default for ForwardIndex {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Chunked<ForwardIndex> {
+    fn push(&mut self, terms: &mut [(u32, u16)], doc_len: u32) {
+        self.push_with(|chunk| chunk.push(terms, doc_len));
+    }
+
+    fn doc(&self, doc: u32) -> (&[u32], &[u16]) {
+        let (chunk, i) = self.locate(doc as usize);
+        chunk.doc(i as u32)
     }
 
-    fn is_full(&self) -> bool {
-        self.len() >= SEISMIC_BLOCK_SIZE
+    fn doc_len(&self, doc: u32) -> u16 {
+        let (chunk, i) = self.locate(doc as usize);
+        chunk.doc_lengths[i]
+    }
+
+    fn score(&self, doc: u32, query: &[(u32, u32)], bm25: Bm25Params, stats: (f32, f32)) -> f32 {
+        let (chunk, i) = self.locate(doc as usize);
+        chunk.score(i as u32, query, bm25, stats)
+    }
+
+    fn heap_bytes(&self) -> usize {
+        self.chunks().map(ForwardIndex::heap_bytes).sum()
     }
 }
 
 /// Seismic profile with geometry-cohesive block partitioning
+///
+/// Posting lists are copied on write and the forward and ID tables are
+/// chunked, so `snapshot` keeps their committed state for the price of a
+/// few pointers; it copies the term interner, which `add_pending` writes.
+/// A snapshot takes none of the writer's locks.
 pub struct SeismicProfile {
-    /// Blocks organized by geometry
-    blocks: RwLock<Vec<SeismicBlock>>,
-    /// Term dictionary for IDF
-    term_dict: RwLock<HashMap<String, u32>>,
+    /// Interned terms
+    terms: RwLock<TermInterner>,
+    /// Posting lists, indexed by term ID
+    lists: RwLock<Arc<Vec<Arc<TermList>>>>,
+    /// Committed documents' term frequencies
+    forward: RwLock<Chunked<ForwardIndex>>,
     /// Document IDs mapping
-    doc_ids: RwLock<Vec<String>>,
+    doc_ids: RwLock<Chunked<IdTable>>,
     /// Document count
     doc_count: RwLock<u64>,
     /// Total document length
@@ -74,66 +255,23 @@ pub struct SeismicProfile {
     bm25: Bm25Params,
     /// Tokenizer
     tokenizer: FastTokenizer,
-    /// Pending documents
-    pending: RwLock<Vec<PendingDoc>>,
-    /// Current block being filled
-    current_block: RwLock<SeismicBlock>,
+    /// Pending documents (their IDs are already in the ID table)
+    pending: RwLock<Vec<TokenizedDoc>>,
 }
 
 impl SeismicProfile {
     pub fn new() -> Self {
         Self {
-            blocks: RwLock::new(Vec::new()),
-            term_dict: RwLock::new(HashMap::new()),
-            doc_ids: RwLock::new(Vec::new()),
+            terms: RwLock::new(TermInterner::new()),
+            lists: RwLock::new(Arc::new(Vec::new())),
+            forward: RwLock::new(Chunked::new()),
+            doc_ids: RwLock::new(Chunked::new()),
             doc_count: RwLock::new(0),
             total_doc_length: RwLock::new(0),
             bm25: Bm25Params::default(),
             tokenizer: FastTokenizer::default(),
             pending: RwLock::new(Vec::new()),
-            current_block: RwLock::new(SeismicBlock::new()),
-        }
-    }
-
-    /// Generate a simple embedding from term frequencies
-    /// In production, this would use a learned model
-    fn generate_embedding(term_freqs: &HashMap<String, u16>) -> [f32; EMBED_DIM] {
-        let mut embedding = [0.0f32; EMBED_DIM];
-
-        for (term, freq) in term_freqs {
-            // Simple hash-based embedding
-            let hash = Self::hash_term(term);
-            let idx = (hash as usize) % EMBED_DIM;
-            embedding[idx] += *freq as f32;
-        }
-
-        // L2 normalize
-        let norm: f32 = embedding.iter().map(|x| x * x).sum::<f32>().sqrt();
-        if norm > 0.0 {
-            for x in &mut embedding {
-                *x /= norm;
-            }
-        }
-
-        embedding
-    }
-
-    fn hash_term(term: &str) -> u64 {
-        let mut hash = 5381u64;
-        for byte in term.bytes() {
-            hash = hash.wrapping_mul(33).wrapping_add(byte as u64);
-        }
-        hash
-    }
-
-    /// Compute cosine similarity between embeddings
-    #[inline]
-    fn cosine_similarity(a: &[f32; EMBED_DIM], b: &[f32; EMBED_DIM]) -> f32 {
-        let mut dot = 0.0f32;
-        for i in 0..EMBED_DIM {
-            dot += a[i] * b[i];
         }
-        dot
     }
 
     fn build_index(&self) {
@@ -142,75 +280,86 @@ impl SeismicProfile {
             return;
         }
 
-        let mut blocks = self.blocks.write();
-        let mut term_dict = self.term_dict.write();
-        let mut doc_ids = self.doc_ids.write();
+        // Copied here if a snapshot still holds the lists
+        let mut lists = self.lists.write();
+        let lists = Arc::make_mut(&mut lists);
+        let mut forward = self.forward.write();
         let mut doc_count = self.doc_count.write();
         let mut total_doc_length = self.total_doc_length.write();
-        let mut current_block = self.current_block.write();
 
         let base_doc_id = *doc_count as u32;
 
-        for (i, (ext_id, tfs, doc_len)) in pending.iter().enumerate() {
-            let doc_id = base_doc_id + i as u32;
-            doc_ids.push(ext_id.clone());
-            *total_doc_length += *doc_len as u64;
+        // Every pending doc's terms are interned by now
+        let term_count = self.terms.read().len();
+        lists.resize_with(term_count, Arc::default);
 
-            // Update term dictionary
-            for term in tfs.keys() {
-                *term_dict.entry(term.clone()).or_insert(0) += 1;
-            }
-
-            // Generate embedding
-            let embedding = Self::generate_embedding(tfs);
-
-            // Convert term_freqs to vec
-            let tf_vec: Vec<(String, u16)> = tfs.iter().map(|(k, v)| (k.clone(), *v)).collect();
-
-            // Add to current block
-            current_block.doc_ids.push(doc_id);
-            current_block.term_freqs.push(tf_vec);
-            current_block.doc_lengths.push(*doc_len as u16);
+        for doc in pending.iter() {
+            forward.push(&mut doc.terms.clone(), doc.doc_len);
+            *total_doc_length += doc.doc_len as u64;
+        }
+        *doc_count += pending.len() as u64;
 
-            // Update centroid (running average)
-            let n = current_block.len() as f32;
-            for (j, &emb_val) in embedding.iter().enumerate().take(EMBED_DIM) {
-                current_block.centroid[j] = current_block.centroid[j] * (n - 1.0) / n + emb_val / n;
-            }
+        // (term, doc, freq) postings grouped by term
+        let term_postings = invert(&pending, base_doc_id);
+        let runs: Vec<_> = term_postings.chunk_by(|a, b| a.0 == b.0).collect();
+        for run in &runs {
+            Arc::make_mut(&mut lists[run[0].0 as usize]).df += run.len() as u32;
+        }
 
-            // Finalize block if full
-            if current_block.is_full() {
-                let total_docs = (*doc_count + i as u64 + 1) as f32;
-                let avg_doc_len = *total_doc_length as f32 / total_docs;
+        let total_docs = *doc_count as f32;
+        let avg_doc_len = *total_doc_length as f32 / total_docs;
+        let weight = |freq: u16, df: u32, doc_len: u32| {
+            self.bm25.score(
+                freq as f32,
+                df as f32,
+                doc_len as f32,
+                avg_doc_len,
+                total_docs,
+            )
+        };
+        let dfs: &[Arc<TermList>] = lists;
 
-                // Calculate max score for block
-                let mut max_score = 0.0f32;
-                for (tfs, &doc_len) in current_block
-                    .term_freqs
+        // Each new document's heaviest terms
+        let signatures: Vec<Signature> = pending
+            .par_iter()
+            .map(|doc| {
+                let mut signature: Signature = doc
+                    .terms
                     .iter()
-                    .zip(current_block.doc_lengths.iter())
-                {
-                    let mut score = 0.0f32;
-                    for (term, freq) in tfs {
-                        let df = *term_dict.get(term).unwrap_or(&1) as f32;
-                        score += self.bm25.score(
-                            *freq as f32,
-                            df,
-                            doc_len as f32,
-                            avg_doc_len,
-                            total_docs,
-                        );
-                    }
-                    max_score = max_score.max(score);
+                    .map(|&(term, freq)| (term, weight(freq, dfs[term as usize].df, doc.doc_len)))
+                    .collect();
+                if signature.len() > SIGNATURE_TERMS {
+                    signature
+                        .select_nth_unstable_by(SIGNATURE_TERMS - 1, |a, b| b.1.total_cmp(&a.1));
+                    signature.truncate(SIGNATURE_TERMS);
                 }
-                current_block.max_score = max_score;
+                signature.sort_unstable_by_key(|e| e.0);
+                signature
+            })
+            .collect();
 
-                let completed_block = std::mem::replace(&mut *current_block, SeismicBlock::new());
-                blocks.push(completed_block);
-            }
-        }
+        // Block each term's new postings
+        let blocks: Vec<Vec<SeismicBlock>> = runs
+            .par_iter()
+            .map(|run| {
+                let term = run[0].0;
+                let df = dfs[term as usize].df;
+                let postings = run
+                    .iter()
+                    .map(|&(_, doc_id, freq)| {
+                        let doc_len = pending[(doc_id - base_doc_id) as usize].doc_len;
+                        (doc_id, weight(freq, df, doc_len))
+                    })
+                    .collect();
+                cluster(term, postings, &signatures, base_doc_id)
+            })
+            .collect();
 
-        *doc_count += pending.len() as u64;
+        for (run, blocks) in runs.iter().zip(blocks) {
+            Arc::make_mut(&mut lists[run[0].0 as usize])
+                .blocks
+                .extend(blocks);
+        }
     }
 
     fn search_seismic(
@@ -218,134 +367,260 @@ impl SeismicProfile {
         query_terms: &[String],
         limit: usize,
         offset: usize,
-    ) -> Vec<SearchHit> {
-        let blocks = self.blocks.read();
-        let term_dict = self.term_dict.read();
+        after: Option<SearchCursor>,
+        out: &mut HitBuffer,
+    ) {
+        let terms = self.terms.read();
+        let lists = Arc::clone(&self.lists.read());
+        let forward = self.forward.read();
         let doc_ids = self.doc_ids.read();
-        let current_block = self.current_block.read();
         let doc_count = *self.doc_count.read();
 
-        if doc_count == 0 || query_terms.is_empty() {
-            return Vec::new();
+        let k = limit + offset;
+        if doc_count == 0 || query_terms.is_empty() || k == 0 {
+            return;
         }
 
         let total_docs = doc_count as f32;
         let total_doc_length = *self.total_doc_length.read();
-        let avg_doc_len = if doc_count > 0 {
-            total_doc_length as f32 / doc_count as f32
-        } else {
-            1.0
-        };
-
-        // Generate query embedding
-        let query_tfs: HashMap<String, u16> = query_terms.iter().map(|t| (t.clone(), 1)).collect();
-        let query_embedding = Self::generate_embedding(&query_tfs);
+        let stats = (total_doc_length as f32 / total_docs, total_docs);
 
-        // Score blocks by centroid similarity
-        let mut block_scores: Vec<(usize, f32)> = blocks
+        // Query terms with postings, rarest (heaviest) first
+        let mut query: Vec<(u32, &TermList)> = query_terms
             .iter()
-            .enumerate()
-            .map(|(i, block)| {
-                (
-                    i,
-                    Self::cosine_similarity(&query_embedding, &block.centroid),
-                )
+            .filter_map(|term| {
+                let id = terms.lookup(term)?;
+                Some((id, &**lists.get(id as usize)?))
             })
+            .filter(|(_, list)| list.df > 0)
             .collect();
+        query.sort_by_key(|(_, list)| list.df);
+        let query_ids: Vec<u32> = query.iter().map(|&(id, _)| id).collect();
+        let query_dfs: Vec<(u32, u32)> = query.iter().map(|&(id, list)| (id, list.df)).collect();
+
+        let mut top_k = TopK::new(k, after);
+        let mut visited: FxHashSet<u32> = FxHashSet::default();
+        let mut bounds = Vec::new();
+        let mut order = Vec::new();
+
+        for (_, list) in &query {
+            // Visit blocks best bound first, until the bounds fall short
+            summary_bounds(&list.blocks, &query_ids, &mut bounds);
+            order.clear();
+            order.extend(0..list.blocks.len());
+            order.sort_unstable_by(|&a, &b| bounds[b].total_cmp(&bounds[a]));
+
+            for &b in &order {
+                if top_k.is_full() && bounds[b] < top_k.threshold() * HEAP_FACTOR {
+                    break;
+                }
+                for &doc_id in &list.blocks[b].doc_ids {
+                    if !visited.insert(doc_id) {
+                        continue;
+                    }
+                    let score = forward.score(doc_id, &query_dfs, self.bm25, stats);
+                    top_k.push(score, doc_id);
+                }
+            }
+        }
 
-        // Sort by similarity descending
-        block_scores.sort_by(|a, b| b.1.partial_cmp(&a.1).unwrap());
+        top_k.into_hits(offset, limit, out, |doc_id, ids| {
+            ids.push_str(doc_ids.get(doc_id as usize))
+        })
+    }
 
-        // Top-k heap
-        let k = limit + offset;
-        let mut top_k: BinaryHeap<Reverse<(OrderedFloat, u32)>> = BinaryHeap::with_capacity(k + 1);
-        let mut threshold = 0.0f32;
+    /// Tokenize `docs` and queue them for the next commit (thread-safe)
+    fn add_pending(&self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
+        let tokenized = self.tokenizer.tokenize_interned(docs, &self.terms);
 
-        // Process blocks in order of centroid similarity
-        for (block_idx, _block_sim) in block_scores {
-            let block = &blocks[block_idx];
+        // Pending docs get the next doc IDs in order, so IDs are interned now
+        // (the lock is held until they are in the pending buffer)
+        let mut doc_ids = self.doc_ids.write();
+        for doc in docs {
+            doc_ids.push(doc.id);
+        }
 
-            // Prune block if max score can't beat threshold
-            if block.max_score < threshold && top_k.len() >= k {
-                continue;
-            }
+        let count = tokenized.len();
+        self.pending.write().extend(tokenized);
 
-            // Score documents in block
-            for (i, &internal_doc_id) in block.doc_ids.iter().enumerate() {
-                let tfs = &block.term_freqs[i];
-                let doc_len = block.doc_lengths[i] as f32;
-
-                let mut score = 0.0f32;
-                for query_term in query_terms {
-                    // Find term in document
-                    if let Some((_, freq)) = tfs.iter().find(|(t, _)| t == query_term) {
-                        let df = *term_dict.get(query_term).unwrap_or(&1) as f32;
-                        score +=
-                            self.bm25
-                                .score(*freq as f32, df, doc_len, avg_doc_len, total_docs);
-                    }
+        Ok(count)
+    }
+
+    /// Load a version 1 index (hashed 32-dim embeddings over fixed-size
+    /// blocks) by reindexing the term frequencies it kept per document
+    fn load_v1(&mut self, reader: &mut impl Read) -> Result<(), IndexError> {
+        const V1_EMBED_DIM: usize = 32;
+
+        let mut buf1 = [0u8; 1];
+        let mut buf2 = [0u8; 2];
+        let mut buf4 = [0u8; 4];
+        let mut buf8 = [0u8; 8];
+
+        let mut counts = [0u64; 4];
+        for count in &mut counts {
+            reader.read_exact(&mut buf8)?;
+            *count = u64::from_le_bytes(buf8);
+        }
+        let [block_count, term_count, doc_count, _] = counts;
+
+        // Term dict (document frequencies are recounted)
+        for _ in 0..term_count {
+            read_term(reader)?;
+            reader.read_exact(&mut buf4)?;
+        }
+
+        // Blocks, then the partial block, hold every document in order
+        let mut terms = TermInterner::new();
+        let mut docs = Vec::with_capacity(doc_count as usize);
+        for block in 0..=block_count {
+            if block == block_count {
+                reader.read_exact(&mut buf1)?;
+                if buf1[0] != 1 {
+                    break;
                 }
+            }
 
-                if score > 0.0 {
-                    let entry = Reverse((OrderedFloat(score), internal_doc_id));
-                    if top_k.len() < k {
-                        top_k.push(entry);
-                        if top_k.len() == k {
-                            threshold = top_k.peek().unwrap().0 .0 .0;
-                        }
-                    } else if score > threshold {
-                        top_k.pop();
-                        top_k.push(entry);
-                        threshold = top_k.peek().unwrap().0 .0 .0;
-                    }
+            reader.read_exact(&mut buf4)?;
+            let block_size = u32::from_le_bytes(buf4) as usize;
+            for _ in 0..block_size {
+                reader.read_exact(&mut buf4)?; // doc ID
+            }
+            for _ in 0..block_size {
+                reader.read_exact(&mut buf4)?;
+                let mut doc = TokenizedDoc::default();
+                for _ in 0..u32::from_le_bytes(buf4) {
+                    let term = read_term(reader)?;
+                    reader.read_exact(&mut buf2)?;
+                    let freq = u16::from_le_bytes(buf2);
+                    doc.terms
+                        .push((terms.intern(term_hash(term.as_bytes()), &term), freq));
+                    doc.doc_len += freq as u32;
                 }
+                docs.push(doc);
             }
+            // Doc lengths, centroid and max score
+            let mut rest = vec![0u8; block_size * 2 + V1_EMBED_DIM * 4 + 4];
+            reader.read_exact(&mut rest)?;
+        }
+        if docs.len() as u64 != doc_count {
+            return Err(IndexError::Corrupted("Document count mismatch".into()));
         }
 
-        // Also check current (unflushed) block
-        if !current_block.doc_ids.is_empty() {
-            for (i, &internal_doc_id) in current_block.doc_ids.iter().enumerate() {
-                let tfs = &current_block.term_freqs[i];
-                let doc_len = current_block.doc_lengths[i] as f32;
+        let mut doc_ids = Chunked::<IdTable>::new();
+        let mut id_bytes = Vec::new();
+        for _ in 0..doc_count {
+            reader.read_exact(&mut buf4)?;
+            id_bytes.resize(u32::from_le_bytes(buf4) as usize, 0);
+            reader.read_exact(&mut id_bytes)?;
+            doc_ids.push(
+                std::str::from_utf8(&id_bytes)
+                    .map_err(|_| IndexError::Corrupted("Invalid UTF-8".into()))?,
+            );
+        }
 
-                let mut score = 0.0f32;
-                for query_term in query_terms {
-                    if let Some((_, freq)) = tfs.iter().find(|(t, _)| t == query_term) {
-                        let df = *term_dict.get(query_term).unwrap_or(&1) as f32;
-                        score +=
-                            self.bm25
-                                .score(*freq as f32, df, doc_len, avg_doc_len, total_docs);
-                    }
-                }
+        self.clear();
+        *self.terms.write() = terms;
+        *self.doc_ids.write() = doc_ids;
+        *self.pending.write() = docs;
+        self.build_index();
+        self.pending.write().clear();
 
-                if score > 0.0 {
-                    let entry = Reverse((OrderedFloat(score), internal_doc_id));
-                    if top_k.len() < k {
-                        top_k.push(entry);
-                    } else if score > threshold {
-                        top_k.pop();
-                        top_k.push(entry);
-                        threshold = top_k.peek().unwrap().0 .0 .0;
-                    }
-                }
+        Ok(())
+    }
+}
+
+/// Prune one term's postings from a commit to the heaviest, then split
+/// them into geometry-cohesive blocks
+fn cluster(
+    term: u32,
+    mut postings: Vec<(u32, f32)>,
+    signatures: &[Signature],
+    base_doc: u32,
+) -> Vec<SeismicBlock> {
+    if postings.len() > MAX_POSTINGS {
+        postings.select_nth_unstable_by(MAX_POSTINGS - 1, |a, b| b.1.total_cmp(&a.1));
+        postings.truncate(MAX_POSTINGS);
+        postings.sort_unstable_by_key(|p| p.0);
+    }
+    let signature = |doc: u32| &signatures[(doc - base_doc) as usize][..];
+
+    // Seeds spread over the list; each document joins the seed it shares
+    // the most weight with (on a tie, the one for its stretch of the list)
+    let num_blocks = postings.len().div_ceil(BLOCK_DOCS);
+    let seeds: Vec<&[(u32, f32)]> = (0..num_blocks)
+        .map(|b| signature(postings[b * postings.len() / num_blocks].0))
+        .collect();
+    let mut members = vec![Vec::new(); num_blocks];
+    for (i, &(doc_id, weight)) in postings.iter().enumerate() {
+        let doc = signature(doc_id);
+        let mut best = i * num_blocks / postings.len();
+        let mut best_dot = dot(doc, seeds[best]);
+        for (b, seed) in seeds.iter().enumerate() {
+            let d = dot(doc, seed);
+            if d > best_dot {
+                best = b;
+                best_dot = d;
             }
         }
+        members[best].push((doc_id, weight));
+    }
 
-        let mut results: Vec<_> = top_k
-            .into_sorted_vec()
-            .into_iter()
-            .skip(offset)
-            .take(limit)
-            .map(|Reverse((score, doc_id))| {
-                SearchHit::new(doc_ids[doc_id as usize].clone(), score.0)
-            })
-            .collect();
+    members
+        .into_iter()
+        .filter(|m| !m.is_empty())
+        .map(|m| {
+            let term_max = m.iter().map(|p| p.1).fold(0.0, f32::max);
+            let doc_ids = m.into_iter().map(|p| p.0).collect();
+            SeismicBlock::new(doc_ids, term, term_max, signatures, base_doc)
+        })
+        .collect()
+}
+
+/// Dot product of two sparse vectors sorted by term
+fn dot(a: &[(u32, f32)], b: &[(u32, f32)]) -> f32 {
+    let (mut i, mut j) = (0, 0);
+    let mut sum = 0.0;
+    while i < a.len() && j < b.len() {
+        match a[i].0.cmp(&b[j].0) {
+            Ordering::Less => i += 1,
+            Ordering::Greater => j += 1,
+            Ordering::Equal => {
+                sum += a[i].1 * b[j].1;
+                i += 1;
+                j += 1;
+            }
+        }
+    }
+    sum
+}
 
-        results.reverse();
-        results
+/// Score bounds of `blocks` for query terms `query`: summary dot products
+/// with the (binary) query vector, `LANES` blocks at a time
+fn summary_bounds(blocks: &[SeismicBlock], query: &[u32], out: &mut Vec<f32>) {
+    out.clear();
+    for chunk in blocks.chunks(LANES) {
+        let mut dot = f32x8::splat(0.0);
+        for &term in query {
+            let values: [f32; LANES] =
+                std::array::from_fn(|i| chunk.get(i).map_or(0.0, |b| b.summary(term)));
+            dot = dot + f32x8::from(values);
+        }
+        let scales: [f32; LANES] =
+            std::array::from_fn(|i| chunk.get(i).map_or(0.0, |b| b.summary_scale));
+        let bounds = (dot * f32x8::from(scales)).to_array();
+        out.extend_from_slice(&bounds[..chunk.len()]);
     }
 }
 
+/// Read a length-prefixed UTF-8 term
+fn read_term(reader: &mut impl Read) -> Result<String, IndexError> {
+    let mut buf4 = [0u8; 4];
+    reader.read_exact(&mut buf4)?;
+    let mut term_bytes = vec![0u8; u32::from_le_bytes(buf4) as usize];
+    reader.read_exact(&mut term_bytes)?;
+    String::from_utf8(term_bytes).map_err(|_| IndexError::Corrupted("Invalid UTF-8".into()))
+}
+
 impl Default for SeismicProfile {
     fn default() -> Self {
         Self::new()
@@ -361,20 +636,12 @@ impl SearchProfile for SeismicProfile {
         ProfileType::Seismic
     }
 
-    fn index_batch(&mut self, docs: &[Document]) -> Result<usize, IndexError> {
-        let tokenized: Vec<_> = docs
-            .par_iter()
-            .map(|doc| {
-                let term_freqs = self.tokenizer.tokenize_with_freqs(&doc.text);
-                let doc_len: u32 = term_freqs.values().map(|&v| v as u32).sum();
-                (doc.id.clone(), term_freqs, doc_len)
-            })
-            .collect();
-
-        let count = tokenized.len();
-        self.pending.write().extend(tokenized);
+    fn index_batch_refs(&mut self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
+        self.add_pending(docs)
+    }
 
-        Ok(count)
+    fn index_batch_shared(&self, docs: &[DocumentRef<'_>]) -> Option<Result<usize, IndexError>> {
+        Some(self.add_pending(docs))
     }
 
     fn commit(&mut self) -> Result<(), IndexError> {
@@ -390,52 +657,100 @@ impl SearchProfile for SeismicProfile {
         offset: usize,
     ) -> Result<SearchResult, SearchError> {
         let start = Instant::now();
+        let mut out = HitBuffer::new();
+        self.search_hits(query, limit, offset, &mut out)?;
+        Ok(out.to_result(self.name(), start.elapsed()))
+    }
+
+    fn search_hits(
+        &self,
+        query: &str,
+        limit: usize,
+        offset: usize,
+        out: &mut HitBuffer,
+    ) -> Result<(), SearchError> {
+        out.clear();
         let query_terms = self.tokenizer.tokenize_query(query);
-        let hits = self.search_seismic(&query_terms, limit, offset);
-        let total = hits.len() as u64;
-
-        Ok(SearchResult {
-            hits,
-            total,
-            duration: start.elapsed(),
-            profile: self.name().to_string(),
-        })
+        self.search_seismic(&query_terms, limit, offset, None, out);
+        out.total = out.len() as u64;
+        Ok(())
     }
 
-    fn memory_stats(&self) -> MemoryStats {
-        let blocks = self.blocks.read();
-        let term_dict = self.term_dict.read();
-        let doc_ids = self.doc_ids.read();
-        let current_block = self.current_block.read();
+    fn search_after(
+        &self,
+        query: &str,
+        limit: usize,
+        after: Option<SearchCursor>,
+    ) -> Result<SearchResult, SearchError> {
+        let start = Instant::now();
+        let query_terms = self.tokenizer.tokenize_query(query);
+        let mut out = HitBuffer::new();
+        self.search_seismic(&query_terms, limit, 0, after, &mut out);
+        out.total = out.len() as u64;
+        Ok(out.to_result(self.name(), start.elapsed()))
+    }
 
-        let blocks_bytes: usize = blocks
+    /// Lists are pruned, so counts come from the forward index: `Exact`
+    /// scans it and `Estimate` checks evenly spaced documents
+    fn count_hits(&self, query: &str, mode: TotalMode) -> Result<u64, SearchError> {
+        let query_terms = self.tokenizer.tokenize_query(query);
+        let terms = self.terms.read();
+        let lists = Arc::clone(&self.lists.read());
+        let mut query: Vec<(u32, u64)> = query_terms
             .iter()
-            .map(|b| {
-                b.doc_ids.len() * 4
-                    + b.term_freqs.iter().map(|v| v.len() * 20).sum::<usize>()
-                    + b.doc_lengths.len() * 2
-                    + EMBED_DIM * 4
-                    + 4
+            .filter_map(|term| {
+                let id = terms.lookup(term)?;
+                Some((id, lists.get(id as usize)?.df as u64))
             })
-            .sum();
+            .filter(|&(_, df)| df > 0)
+            .collect();
+        query.sort_unstable();
+        query.dedup();
 
-        let current_block_bytes = current_block.doc_ids.len() * 4
-            + current_block
-                .term_freqs
+        let max_df = query.iter().map(|&(_, df)| df).max().unwrap_or(0);
+        if query.len() <= 1 || mode == TotalMode::LowerBound {
+            return Ok(max_df);
+        }
+
+        let forward = self.forward.read();
+        let matches = |doc: u64| {
+            let (doc_terms, _) = forward.doc(doc as u32);
+            query
                 .iter()
-                .map(|v| v.len() * 20)
-                .sum::<usize>()
-            + current_block.doc_lengths.len() * 2
-            + EMBED_DIM * 4;
+                .any(|(id, _)| doc_terms.binary_search(id).is_ok())
+        };
+        let docs = *self.doc_count.read();
+        if mode == TotalMode::Exact {
+            return Ok((0..docs).filter(|&doc| matches(doc)).count() as u64);
+        }
 
-        let term_dict_bytes = term_dict.len() * 36;
-        let doc_ids_bytes: usize = doc_ids.iter().map(|s| s.len()).sum();
+        let samples = docs.min(COUNT_SAMPLE_DOCS);
+        let hits = (0..samples).filter(|s| matches(s * docs / samples)).count();
+        let sum_df: u64 = query.iter().map(|&(_, df)| df).sum();
+        let estimate = (docs as f64 * hits as f64 / samples as f64).round() as u64;
+        Ok(estimate.clamp(max_df, sum_df.min(docs).max(max_df)))
+    }
+
+    fn memory_stats(&self) -> MemoryStats {
+        let terms = self.terms.read();
+        let lists = Arc::clone(&self.lists.read());
+        let forward = self.forward.read();
+        let doc_ids = self.doc_ids.read();
+
+        let term_dict_bytes =
+            terms.heap_bytes() + lists.capacity() * std::mem::size_of::<TermList>();
+        let blocks_bytes: usize = lists
+            .iter()
+            .flat_map(|list| &list.blocks)
+            .map(|b| b.doc_ids.len() * 4 + b.summary_terms.len() * 5 + 4)
+            .sum();
+        let postings_bytes = blocks_bytes + forward.heap_bytes();
+        let doc_ids_bytes = doc_ids.heap_bytes();
 
         MemoryStats {
-            index_bytes: (blocks_bytes + current_block_bytes + term_dict_bytes + doc_ids_bytes)
-                as u64,
+            index_bytes: (term_dict_bytes + postings_bytes + doc_ids_bytes) as u64,
             term_dict_bytes: term_dict_bytes as u64,
-            postings_bytes: (blocks_bytes + current_block_bytes) as u64,
+            postings_bytes: postings_bytes as u64,
             docs_indexed: *self.doc_count.read(),
             mmap_bytes: 0,
         }
@@ -447,80 +762,55 @@ impl SearchProfile for SeismicProfile {
 
         // Header
         writer.write_all(b"SEIS")?;
-        writer.write_all(&1u32.to_le_bytes())?;
+        writer.write_all(&2u32.to_le_bytes())?;
 
-        let blocks = self.blocks.read();
-        let term_dict = self.term_dict.read();
+        let terms = self.terms.read();
+        let lists = Arc::clone(&self.lists.read());
+        let forward = self.forward.read();
         let doc_ids = self.doc_ids.read();
-        let current_block = self.current_block.read();
         let doc_count = *self.doc_count.read();
         let total_doc_length = *self.total_doc_length.read();
 
-        // Counts
-        writer.write_all(&(blocks.len() as u64).to_le_bytes())?;
-        writer.write_all(&(term_dict.len() as u64).to_le_bytes())?;
+        // Counts (terms interned since the last commit have no list yet)
+        writer.write_all(&(lists.len() as u64).to_le_bytes())?;
         writer.write_all(&doc_count.to_le_bytes())?;
         writer.write_all(&total_doc_length.to_le_bytes())?;
 
-        // Term dict
-        for (term, &df) in term_dict.iter() {
-            let term_bytes = term.as_bytes();
+        // Posting lists
+        for (id, list) in lists.iter().enumerate() {
+            let term_bytes = terms.term(id as u32).as_bytes();
             writer.write_all(&(term_bytes.len() as u32).to_le_bytes())?;
             writer.write_all(term_bytes)?;
-            writer.write_all(&df.to_le_bytes())?;
-        }
+            writer.write_all(&list.df.to_le_bytes())?;
+            writer.write_all(&(list.blocks.len() as u32).to_le_bytes())?;
 
-        // Helper to write a block
-        let write_block =
-            |writer: &mut BufWriter<File>, block: &SeismicBlock| -> std::io::Result<()> {
+            for block in &list.blocks {
                 writer.write_all(&(block.doc_ids.len() as u32).to_le_bytes())?;
-
                 for &doc_id in &block.doc_ids {
                     writer.write_all(&doc_id.to_le_bytes())?;
                 }
-
-                for tfs in &block.term_freqs {
-                    writer.write_all(&(tfs.len() as u32).to_le_bytes())?;
-                    for (term, freq) in tfs {
-                        let term_bytes = term.as_bytes();
-                        writer.write_all(&(term_bytes.len() as u32).to_le_bytes())?;
-                        writer.write_all(term_bytes)?;
-                        writer.write_all(&freq.to_le_bytes())?;
-                    }
+                writer.write_all(&(block.summary_terms.len() as u32).to_le_bytes())?;
+                for &term in &block.summary_terms {
+                    writer.write_all(&term.to_le_bytes())?;
                 }
-
-                for &len in &block.doc_lengths {
-                    writer.write_all(&len.to_le_bytes())?;
-                }
-
-                for &c in &block.centroid {
-                    writer.write_all(&c.to_le_bytes())?;
-                }
-
-                writer.write_all(&block.max_score.to_le_bytes())?;
-                Ok(())
-            };
-
-        // Write blocks
-        for block in blocks.iter() {
-            write_block(&mut writer, block)?;
+                writer.write_all(&block.summary_values)?;
+                writer.write_all(&block.summary_scale.to_le_bytes())?;
+            }
         }
 
-        // Write current block
-        writer.write_all(
-            &(if current_block.doc_ids.is_empty() {
-                0u8
-            } else {
-                1u8
-            })
-            .to_le_bytes(),
-        )?;
-        if !current_block.doc_ids.is_empty() {
-            write_block(&mut writer, &current_block)?;
+        // Forward index
+        for doc in 0..doc_count as u32 {
+            let (terms, freqs) = forward.doc(doc);
+            writer.write_all(&forward.doc_len(doc).to_le_bytes())?;
+            writer.write_all(&(terms.len() as u32).to_le_bytes())?;
+            for (&term, &freq) in terms.iter().zip(freqs) {
+                writer.write_all(&term.to_le_bytes())?;
+                writer.write_all(&freq.to_le_bytes())?;
+            }
         }
 
-        // Write doc IDs
-        for id in doc_ids.iter() {
+        // Doc IDs (pending docs' IDs are not saved)
+        for id in doc_ids.iter().take(doc_count as usize) {
             let id_bytes = id.as_bytes();
             writer.write_all(&(id_bytes.len() as u32).to_le_bytes())?;
             writer.write_all(id_bytes)?;
@@ -540,14 +830,15 @@ impl SearchProfile for SeismicProfile {
             return Err(IndexError::Corrupted("Invalid magic".into()));
         }
 
-        let mut buf1 = [0u8; 1];
+        let mut buf2 = [0u8; 2];
         let mut buf4 = [0u8; 4];
         let mut buf8 = [0u8; 8];
 
-        reader.read_exact(&mut buf4)?; // version
+        reader.read_exact(&mut buf4)?;
+        if u32::from_le_bytes(buf4) < 2 {
+            return self.load_v1(&mut reader);
+        }
 
-        reader.read_exact(&mut buf8)?;
-        let block_count = u64::from_le_bytes(buf8);
         reader.read_exact(&mut buf8)?;
         let term_count = u64::from_le_bytes(buf8);
         reader.read_exact(&mut buf8)?;
@@ -555,110 +846,92 @@ impl SearchProfile for SeismicProfile {
         reader.read_exact(&mut buf8)?;
         let total_doc_length = u64::from_le_bytes(buf8);
 
-        // Term dict
-        let mut term_dict = HashMap::with_capacity(term_count as usize);
+        // Posting lists
+        let mut term_ids = Vec::with_capacity(term_count as usize);
+        let mut lists = Vec::with_capacity(term_count as usize);
         for _ in 0..term_count {
-            reader.read_exact(&mut buf4)?;
-            let term_len = u32::from_le_bytes(buf4) as usize;
-            let mut term_bytes = vec![0u8; term_len];
-            reader.read_exact(&mut term_bytes)?;
-            let term = String::from_utf8(term_bytes)
-                .map_err(|_| IndexError::Corrupted("Invalid UTF-8".into()))?;
+            let term = read_term(&mut reader)?;
             reader.read_exact(&mut buf4)?;
             let df = u32::from_le_bytes(buf4);
-            term_dict.insert(term, df);
-        }
-
-        // Helper to read a block
-        let read_block = |reader: &mut BufReader<File>| -> Result<SeismicBlock, IndexError> {
-            let mut buf2 = [0u8; 2];
-            let mut buf4 = [0u8; 4];
-
             reader.read_exact(&mut buf4)?;
-            let block_size = u32::from_le_bytes(buf4) as usize;
+            let block_count = u32::from_le_bytes(buf4) as usize;
 
-            let mut doc_ids = Vec::with_capacity(block_size);
-            for _ in 0..block_size {
+            let mut blocks = Vec::with_capacity(block_count);
+            for _ in 0..block_count {
                 reader.read_exact(&mut buf4)?;
-                doc_ids.push(u32::from_le_bytes(buf4));
-            }
+                let block_size = u32::from_le_bytes(buf4) as usize;
+                let mut doc_ids = Vec::with_capacity(block_size);
+                for _ in 0..block_size {
+                    reader.read_exact(&mut buf4)?;
+                    let doc_id = u32::from_le_bytes(buf4);
+                    if doc_id as u64 >= doc_count {
+                        return Err(IndexError::Corrupted("Invalid doc ID".into()));
+                    }
+                    doc_ids.push(doc_id);
+                }
 
-            let mut term_freqs = Vec::with_capacity(block_size);
-            for _ in 0..block_size {
                 reader.read_exact(&mut buf4)?;
-                let tf_count = u32::from_le_bytes(buf4) as usize;
-                let mut tfs = Vec::with_capacity(tf_count);
-                for _ in 0..tf_count {
+                let summary_size = u32::from_le_bytes(buf4) as usize;
+                let mut summary_terms = Vec::with_capacity(summary_size);
+                for _ in 0..summary_size {
                     reader.read_exact(&mut buf4)?;
-                    let term_len = u32::from_le_bytes(buf4) as usize;
-                    let mut term_bytes = vec![0u8; term_len];
-                    reader.read_exact(&mut term_bytes)?;
-                    let term = String::from_utf8(term_bytes)
-                        .map_err(|_| IndexError::Corrupted("Invalid UTF-8".into()))?;
-                    reader.read_exact(&mut buf2)?;
-                    let freq = u16::from_le_bytes(buf2);
-                    tfs.push((term, freq));
+                    summary_terms.push(u32::from_le_bytes(buf4));
                 }
-                term_freqs.push(tfs);
+                let mut summary_values = vec![0u8; summary_size];
+                reader.read_exact(&mut summary_values)?;
+                reader.read_exact(&mut buf4)?;
+                let summary_scale = f32::from_le_bytes(buf4);
+
+                blocks.push(SeismicBlock {
+                    doc_ids,
+                    summary_terms,
+                    summary_values,
+                    summary_scale,
+                });
             }
 
-            let mut doc_lengths = Vec::with_capacity(block_size);
-            for _ in 0..block_size {
-                reader.read_exact(&mut buf2)?;
-                doc_lengths.push(u16::from_le_bytes(buf2));
-            }
+            term_ids.push((term, lists.len()));
+            lists.push(Arc::new(TermList { df, blocks }));
+        }
+        let terms = TermInterner::from_ids(term_ids)
+            .ok_or_else(|| IndexError::Corrupted("Duplicate term".into()))?;
 
-            let mut centroid = [0.0f32; EMBED_DIM];
-            for c in &mut centroid {
+        // Forward index
+        let mut forward = Chunked::<ForwardIndex>::new();
+        let mut doc_terms = Vec::new();
+        for _ in 0..doc_count {
+            reader.read_exact(&mut buf2)?;
+            let doc_len = u16::from_le_bytes(buf2) as u32;
+            reader.read_exact(&mut buf4)?;
+            doc_terms.clear();
+            for _ in 0..u32::from_le_bytes(buf4) {
                 reader.read_exact(&mut buf4)?;
-                *c = f32::from_le_bytes(buf4);
+                reader.read_exact(&mut buf2)?;
+                doc_terms.push((u32::from_le_bytes(buf4), u16::from_le_bytes(buf2)));
             }
-
-            reader.read_exact(&mut buf4)?;
-            let max_score = f32::from_le_bytes(buf4);
-
-            Ok(SeismicBlock {
-                doc_ids,
-                term_freqs,
-                doc_lengths,
-                centroid,
-                max_score,
-            })
-        };
-
-        // Read blocks
-        let mut blocks = Vec::with_capacity(block_count as usize);
-        for _ in 0..block_count {
-            blocks.push(read_block(&mut reader)?);
+            forward.push(&mut doc_terms, doc_len);
         }
 
-        // Read current block
-        reader.read_exact(&mut buf1)?;
-        let current_block = if buf1[0] == 1 {
-            read_block(&mut reader)?
-        } else {
-            SeismicBlock::new()
-        };
-
-        // Read doc IDs
-        let mut doc_ids = Vec::with_capacity(doc_count as usize);
+        // Doc IDs
+        let mut doc_ids = Chunked::<IdTable>::new();
+        let mut id_bytes = Vec::new();
         for _ in 0..doc_count {
             reader.read_exact(&mut buf4)?;
-            let id_len = u32::from_le_bytes(buf4) as usize;
-            let mut id_bytes = vec![0u8; id_len];
+            id_bytes.resize(u32::from_le_bytes(buf4) as usize, 0);
             reader.read_exact(&mut id_bytes)?;
             doc_ids.push(
-                String::from_utf8(id_bytes)
+                std::str::from_utf8(&id_bytes)
                     .map_err(|_| IndexError::Corrupted("Invalid UTF-8".into()))?,
             );
         }
 
-        *self.blocks.write() = blocks;
-        *self.term_dict.write() = term_dict;
+        *self.terms.write() = terms;
+        *self.lists.write() = Arc::new(lists);
+        *self.forward.write() = forward;
         *self.doc_ids.write() = doc_ids;
         *self.doc_count.write() = doc_count;
         *self.total_doc_length.write() = total_doc_length;
-        *self.current_block.write() = current_block;
+        self.pending.write().clear();
 
         Ok(())
     }
@@ -668,38 +941,29 @@ impl SearchProfile for SeismicProfile {
     }
 
     fn clear(&mut self) {
-        self.blocks.write().clear();
-        self.term_dict.write().clear();
-        self.doc_ids.write().clear();
-        *self.doc_count.write() = 0;
-        *self.total_doc_length.write() = 0;
-        self.pending.write().clear();
-        *self.current_block.write() = SeismicBlock::new();
+        *self = Self::new();
     }
-}
-
-#[derive(Debug, Clone, Copy, PartialEq)]
-struct OrderedFloat(f32);
-
-impl Ord for OrderedFloat {
-    fn cmp(&self, other: &Self) -> std::cmp::Ordering {
-        self.0
-            .partial_cmp(&other.0)
-            .unwrap_or(std::cmp::Ordering::Equal)
-    }
-}
 
-impl PartialOrd for OrderedFloat {
-    fn partial_cmp(&self, other: &Self) -> Option<std::cmp::Ordering> {
-        Some(self.cmp(other))
+    /// Shares the committed posting lists and table chunks
+    fn snapshot(&self) -> Result<Box<dyn SearchProfile>, IndexError> {
+        Ok(Box::new(Self {
+            terms: RwLock::new(self.terms.read().clone()),
+            lists: RwLock::new(Arc::clone(&self.lists.read())),
+            forward: RwLock::new(self.forward.read().clone()),
+            doc_ids: RwLock::new(self.doc_ids.read().clone()),
+            doc_count: RwLock::new(*self.doc_count.read()),
+            total_doc_length: RwLock::new(*self.total_doc_length.read()),
+            bm25: self.bm25,
+            tokenizer: FastTokenizer::default(),
+            pending: RwLock::new(Vec::new()),
+        }))
     }
 }
 
-impl Eq for OrderedFloat {}
-
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::document::Document;
 
     #[test]
     fn test_seismic_index_search() {
@@ -716,4 +980,97 @@ mod tests {
         let result = profile.search("machine learning", 10, 0).unwrap();
         assert!(result.hits.len() >= 2);
     }
+
+    /// Top-`k` BM25 scores over `texts`, scoring every document
+    fn exhaustive(texts: &[String], query: &str, k: usize) -> Vec<f32> {
+        let tokenizer = FastTokenizer::default();
+        let bm25 = Bm25Params::default();
+        let freqs: Vec<_> = texts
+            .iter()
+            .map(|t| tokenizer.tokenize_with_freqs(t))
+            .collect();
+        let lens: Vec<f32> = freqs
+            .iter()
+            .map(|f| f.values().map(|&tf| tf as f32).sum())
+            .collect();
+        let avg_len = lens.iter().sum::<f32>() / texts.len() as f32;
+
+        let query_terms: Vec<_> = tokenizer
+            .tokenize_query(query)
+            .into_iter()
+            .map(|term| {
+                let df = freqs.iter().filter(|f| f.contains_key(&term)).count();
+                (term, df as f32)
+            })
+            .collect();
+        let mut scores: Vec<f32> = freqs
+            .iter()
+            .zip(&lens)
+            .map(|(doc, &len)| {
+                query_terms
+                    .iter()
+                    .filter_map(|(term, df)| {
+                        let tf = *doc.get(term)? as f32;
+                        Some(bm25.score(tf, *df, len, avg_len, texts.len() as f32))
+                    })
+                    .sum()
+            })
+            .filter(|&score| score > 0.0)
+            .collect();
+        scores.sort_by(|a, b| b.total_cmp(a));
+        scores.truncate(k);
+        scores
+    }
+
+    #[test]
+    fn test_recall_against_exhaustive() {
+        // Zipf-like vocabulary over enough documents for many blocks
+        let mut rng = 11u64;
+        let mut texts = Vec::new();
+        for _ in 0..4000 {
+            let mut words = Vec::new();
+            for _ in 0..4 + rng % 20 {
+                rng = rng
+                    .wrapping_mul(6364136223846793005)
+                    .wrapping_add(1442695040888963407);
+                let rank = 300 / (1 + (rng >> 33) % 300);
+                words.push(format!("w{}", rank));
+            }
+            texts.push(words.join(" "));
+        }
+
+        let mut profile = SeismicProfile::new();
+        for (batch, chunk) in texts.chunks(2000).enumerate() {
+            let docs: Vec<_> = chunk
+                .iter()
+                .enumerate()
+                .map(|(i, t)| Document::new(format!("{}", batch * 2000 + i), t.as_str()))
+                .collect();
+            profile.index_batch(&docs).unwrap();
+            profile.commit().unwrap();
+        }
+
+        for query in ["w1", "w7", "w3 w20", "w2 w5 w60"] {
+            let expected = exhaustive(&texts, query, 10);
+            let hits = profile.search(query, 10, 0).unwrap().hits;
+            assert_eq!(hits.len(), 10, "{}", query);
+            // Hits are scored exactly, so recall shows in their scores
+            let cutoff = expected[9] - 1e-4;
+            let found = hits.iter().filter(|h| h.score >= cutoff).count();
+            assert!(found >= 9, "{}: {} of 10", query, found);
+            assert!(hits.windows(2).all(|w| w[0].score >= w[1].score));
+        }
+
+        let dir = tempfile::tempdir().unwrap();
+        profile.save(dir.path()).unwrap();
+        let mut loaded = SeismicProfile::new();
+        loaded.load(dir.path()).unwrap();
+        for query in ["w1", "w3 w20"] {
+            let scores = |p: &SeismicProfile| -> Vec<f32> {
+                let hits = p.search(query, 10, 0).unwrap().hits;
+                hits.iter().map(|h| h.score).collect()
+            };
+            assert_eq!(scores(&loaded), scores(&profile));
+        }
+    }
 }
@@ -2,15 +2,15 @@
 //!
 //! Uses the Tantivy library directly for maximum throughput and reliability.
 
-use crate::document::Document;
-use crate::profiles::{ProfileType, SearchProfile};
-use crate::result::{IndexError, MemoryStats, SearchError, SearchHit, SearchResult};
+use crate::document::DocumentRef;
+use crate::profiles::{estimate_independent, ProfileType, SearchProfile};
+use crate::result::{IndexError, MemoryStats, SearchError, SearchHit, SearchResult, TotalMode};
 
 use parking_lot::RwLock;
 use std::path::Path;
 use std::time::Instant;
 
-use tantivy::collector::TopDocs;
+use tantivy::collector::{Count, TopDocs};
 use tantivy::query::QueryParser;
 use tantivy::schema::{
     Field, IndexRecordOption, Schema, TextFieldIndexing, TextOptions, STORED, STRING,
@@ -138,29 +138,11 @@ impl TantivyProfile {
 
         Ok(())
     }
-}
-
-impl Default for TantivyProfile {
-    fn default() -> Self {
-        Self::new()
-    }
-}
-
-impl SearchProfile for TantivyProfile {
-    fn name(&self) -> &'static str {
-        "tantivy"
-    }
 
-    fn profile_type(&self) -> ProfileType {
-        ProfileType::Tantivy
-    }
-
-    fn init(&mut self, data_dir: &Path) -> Result<(), IndexError> {
-        *self.data_dir.write() = Some(data_dir.to_path_buf());
-        self.init_index(data_dir)
-    }
-
-    fn index_batch(&mut self, docs: &[Document]) -> Result<usize, IndexError> {
+    /// Add `docs` to the writer. `IndexWriter::add_document` takes `&self`,
+    /// so concurrent batches share the writer lock; only the periodic
+    /// commit needs it exclusively.
+    fn add_docs(&self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
         // Check if initialized
         if self.index.is_none() {
             return Err(IndexError::NotFound(
@@ -168,54 +150,48 @@ impl SearchProfile for TantivyProfile {
             ));
         }
 
-        let mut writer_guard = self.writer.write();
-        let writer = writer_guard
-            .as_mut()
-            .ok_or_else(|| IndexError::NotFound("Writer not initialized".into()))?;
+        let pending = {
+            let writer_guard = self.writer.read();
+            let writer = writer_guard
+                .as_ref()
+                .ok_or_else(|| IndexError::NotFound("Writer not initialized".into()))?;
 
-        let mut count = 0;
-        for doc in docs {
-            let mut tantivy_doc = TantivyDocument::new();
-            tantivy_doc.add_text(self.id_field, &doc.id);
-            tantivy_doc.add_text(self.text_field, &doc.text);
+            for doc in docs {
+                let mut tantivy_doc = TantivyDocument::new();
+                tantivy_doc.add_text(self.id_field, doc.id);
+                tantivy_doc.add_text(self.text_field, doc.text);
 
-            writer
-                .add_document(tantivy_doc)
-                .map_err(|e| IndexError::Io(std::io::Error::other(e.to_string())))?;
-            count += 1;
-        }
+                writer
+                    .add_document(tantivy_doc)
+                    .map_err(|e| IndexError::Io(std::io::Error::other(e.to_string())))?;
+            }
 
-        // Update pending count
-        let mut pending = self.pending_count.write();
-        *pending += count;
+            // Counted before the writer lock is released, so a commit
+            // never misses documents it has already written
+            let mut pending = self.pending_count.write();
+            *pending += docs.len();
+            *pending
+        };
 
         // Auto-commit if threshold reached
-        if *pending >= self.config.commit_interval {
-            writer
-                .commit()
-                .map_err(|e| IndexError::Io(std::io::Error::other(e.to_string())))?;
-            *self.doc_count.write() += *pending as u64;
-            *pending = 0;
-
-            // Reload reader
-            if let Some(reader) = self.reader.write().as_mut() {
-                let _ = reader.reload();
-            }
+        if pending >= self.config.commit_interval {
+            self.commit_writer()?;
         }
 
-        Ok(count)
+        Ok(docs.len())
     }
 
-    fn commit(&mut self) -> Result<(), IndexError> {
+    /// Commit the writer and reload the reader
+    fn commit_writer(&self) -> Result<(), IndexError> {
         let mut writer_guard = self.writer.write();
         if let Some(writer) = writer_guard.as_mut() {
             writer
                 .commit()
                 .map_err(|e| IndexError::Io(std::io::Error::other(e.to_string())))?;
 
-            let pending = *self.pending_count.read();
-            *self.doc_count.write() += pending as u64;
-            *self.pending_count.write() = 0;
+            let mut pending = self.pending_count.write();
+            *self.doc_count.write() += *pending as u64;
+            *pending = 0;
         }
 
         // Reload reader
@@ -225,6 +201,39 @@ impl SearchProfile for TantivyProfile {
 
         Ok(())
     }
+}
+
+impl Default for TantivyProfile {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl SearchProfile for TantivyProfile {
+    fn name(&self) -> &'static str {
+        "tantivy"
+    }
+
+    fn profile_type(&self) -> ProfileType {
+        ProfileType::Tantivy
+    }
+
+    fn init(&mut self, data_dir: &Path) -> Result<(), IndexError> {
+        *self.data_dir.write() = Some(data_dir.to_path_buf());
+        self.init_index(data_dir)
+    }
+
+    fn index_batch_refs(&mut self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
+        self.add_docs(docs)
+    }
+
+    fn index_batch_shared(&self, docs: &[DocumentRef<'_>]) -> Option<Result<usize, IndexError>> {
+        Some(self.add_docs(docs))
+    }
+
+    fn commit(&mut self) -> Result<(), IndexError> {
+        self.commit_writer()
+    }
 
     fn search(
         &self,
@@ -278,6 +287,44 @@ impl SearchProfile for TantivyProfile {
             total,
             duration: start.elapsed(),
             profile: self.name().to_string(),
+            next: None,
+        })
+    }
+
+    fn count_hits(&self, query: &str, mode: TotalMode) -> Result<u64, SearchError> {
+        let reader_guard = self.reader.read();
+        let reader = reader_guard.as_ref().ok_or(SearchError::NotReady)?;
+
+        let searcher = reader.searcher();
+        let query_parser = QueryParser::for_index(
+            self.index.as_ref().ok_or(SearchError::NotReady)?,
+            vec![self.text_field],
+        );
+
+        let parsed_query = query_parser
+            .parse_query(query)
+            .map_err(|e| SearchError::InvalidQuery(e.to_string()))?;
+
+        if mode == TotalMode::Exact {
+            let count = searcher
+                .search(&parsed_query, &Count)
+                .map_err(|e: tantivy::TantivyError| SearchError::Internal(e.to_string()))?;
+            return Ok(count as u64);
+        }
+
+        let mut terms = Vec::new();
+        parsed_query.query_terms(&mut |term, _| terms.push(term.clone()));
+        terms.sort();
+        terms.dedup();
+        let dfs = terms
+            .iter()
+            .map(|term| searcher.doc_freq(term))
+            .collect::<Result<Vec<u64>, _>>()
+            .map_err(|e: tantivy::TantivyError| SearchError::Internal(e.to_string()))?;
+
+        Ok(match mode {
+            TotalMode::Estimate => estimate_independent(&dfs, searcher.num_docs()),
+            _ => dfs.iter().copied().max().unwrap_or(0),
         })
     }
 
@@ -347,6 +394,33 @@ impl SearchProfile for TantivyProfile {
         *self.doc_count.write() = 0;
         *self.pending_count.write() = 0;
     }
+
+    fn snapshot(&self) -> Result<Box<dyn SearchProfile>, IndexError> {
+        // Nothing to search before `init`
+        let index = match self.index.clone() {
+            Some(index) => index,
+            None => return Ok(Box::new(Self::with_config(self.config.clone()))),
+        };
+        // A manually reloaded reader pins the segments of the last commit
+        let reader = index
+            .reader_builder()
+            .reload_policy(ReloadPolicy::Manual)
+            .try_into()
+            .map_err(|e| IndexError::Io(std::io::Error::other(e.to_string())))?;
+
+        Ok(Box::new(Self {
+            index: Some(index),
+            writer: RwLock::new(None),
+            reader: RwLock::new(Some(reader)),
+            schema: self.schema.clone(),
+            id_field: self.id_field,
+            text_field: self.text_field,
+            config: self.config.clone(),
+            pending_count: RwLock::new(0),
+            doc_count: RwLock::new(*self.doc_count.read()),
+            data_dir: RwLock::new(self.data_dir.read().clone()),
+        }))
+    }
 }
 
 #[derive(serde::Serialize, serde::Deserialize)]
@@ -357,6 +431,7 @@ struct TantivyMeta {
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::document::Document;
     use tempfile::tempdir;
 
     #[test]
@@ -6,21 +6,28 @@
 //! - SIMD BM25 scoring
 //! - Parallel tokenization and inversion
 //! - Memory-efficient segment writing
-
-use crate::document::Document;
-use crate::profiles::{Bm25Params, ProfileType, SearchProfile};
-use crate::result::{IndexError, MemoryStats, SearchError, SearchHit, SearchResult};
-use crate::tokenizer::FastTokenizer;
+//! - Saved index memory-mapped and searched in place
+
+use crate::document::{DocumentRef, IdTable};
+use crate::mapped::{MappedFile, Section, SectionWriter};
+use crate::profiles::{
+    count_matches, Bm25Params, Parts, ProfileType, SearchProfile, TermDocs, TopK,
+};
+use crate::result::{
+    HitBuffer, IndexError, MemoryStats, SearchCursor, SearchError, SearchResult, TotalMode,
+};
+use crate::tokenizer::{invert, FastTokenizer, TermInterner, TokenizedDoc};
 
 use parking_lot::RwLock;
 use rayon::prelude::*;
 use roaring::RoaringBitmap;
-use std::cmp::Reverse;
-use std::collections::{BinaryHeap, HashMap};
+use std::collections::HashMap;
 use std::fs::File;
-use std::io::{BufReader, BufWriter, Read, Write};
+use std::io::{BufReader, BufWriter, Read};
+use std::ops::Range;
 use std::path::Path;
 use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
 use std::time::Instant;
 
 /// Block size for SIMD alignment
@@ -29,6 +36,13 @@ const BLOCK_SIZE: usize = 256;
 /// Segment size before flush (docs per segment)
 const SEGMENT_SIZE: usize = 500_000;
 
+/// Index file, replaced as a whole by each save
+const INDEX_FILE: &str = "turbo.idx";
+const INDEX_TMP_FILE: &str = "turbo.idx.tmp";
+const INDEX_MAGIC: &[u8; 4] = b"TRB2";
+/// Unaligned format, read into memory
+const INDEX_MAGIC_V1: &[u8; 4] = b"TURB";
+
 /// Turbo configuration
 #[derive(Debug, Clone)]
 pub struct TurboConfig {
@@ -75,8 +89,8 @@ impl PostingBlock {
     }
 }
 
-/// Compressed posting list
-#[derive(Debug, Clone)]
+/// Compressed posting list (empty for terms seen only in pending docs)
+#[derive(Debug, Clone, Default)]
 struct CompressedPosting {
     /// Roaring bitmap for fast intersection
     bitmap: RoaringBitmap,
@@ -88,16 +102,154 @@ struct CompressedPosting {
     idf: f32,
 }
 
+/// The `i`th of consecutive ranges given by their end offsets
+fn span(ends: &[u64], i: usize) -> Option<Range<usize>> {
+    let start = if i == 0 { 0 } else { *ends.get(i - 1)? };
+    Some(start as usize..*ends.get(i)? as usize)
+}
+
+/// Saved index searched in place (format TRB2)
+///
+/// Layout, one section each: magic; header (term, posting and block
+/// counts, doc count, total doc length, term bytes, ID bytes); term end
+/// offsets and term bytes, sorted by term; per-term posting and block end
+/// offsets; per-block posting end offsets and max scores; doc IDs;
+/// frequencies; doc lengths; external ID end offsets and ID bytes.
+struct MappedIndex {
+    file: MappedFile,
+    doc_count: u64,
+    total_doc_length: u64,
+    term_ends: Section<u64>,
+    term_bytes: Section<u8>,
+    posting_ends: Section<u64>,
+    block_ends: Section<u64>,
+    block_posting_ends: Section<u64>,
+    block_maxes: Section<f32>,
+    doc_ids: Section<u32>,
+    freqs: Section<u16>,
+    doc_lengths: Section<u16>,
+    id_ends: Section<u64>,
+    id_bytes: Section<u8>,
+}
+
+impl MappedIndex {
+    fn open(file: MappedFile) -> Result<Self, IndexError> {
+        let mut sections = file.sections();
+        if file.get(&sections.next::<u8>(4)?) != INDEX_MAGIC {
+            return Err(IndexError::Corrupted("Invalid magic".into()));
+        }
+        let header = file.get(&sections.next::<u64>(7)?);
+        let (term_count, posting_count, block_count) = (header[0], header[1], header[2]);
+        let (doc_count, total_doc_length) = (header[3], header[4]);
+        let (term_bytes, id_bytes) = (header[5], header[6]);
+
+        Ok(Self {
+            term_ends: sections.next(term_count)?,
+            term_bytes: sections.next(term_bytes)?,
+            posting_ends: sections.next(term_count)?,
+            block_ends: sections.next(term_count)?,
+            block_posting_ends: sections.next(block_count)?,
+            block_maxes: sections.next(block_count)?,
+            doc_ids: sections.next(posting_count)?,
+            freqs: sections.next(posting_count)?,
+            doc_lengths: sections.next(doc_count)?,
+            id_ends: sections.next(doc_count)?,
+            id_bytes: sections.next(id_bytes)?,
+            file,
+            doc_count,
+            total_doc_length,
+        })
+    }
+
+    fn term_count(&self) -> usize {
+        self.term_ends.len()
+    }
+
+    fn term(&self, t: usize) -> &[u8] {
+        span(self.file.get(&self.term_ends), t)
+            .and_then(|range| self.file.get(&self.term_bytes).get(range))
+            .unwrap_or_default()
+    }
+
+    /// Position of `term` in the sorted term table
+    fn find(&self, term: &str) -> Option<usize> {
+        let (mut lo, mut hi) = (0, self.term_count());
+        while lo < hi {
+            let mid = lo + (hi - lo) / 2;
+            match self.term(mid).cmp(term.as_bytes()) {
+                std::cmp::Ordering::Less => lo = mid + 1,
+                std::cmp::Ordering::Greater => hi = mid,
+                std::cmp::Ordering::Equal => return Some(mid),
+            }
+        }
+        None
+    }
+
+    /// Document frequency of term `t`
+    fn df(&self, t: usize) -> u32 {
+        span(self.file.get(&self.posting_ends), t).map_or(0, |range| range.len() as u32)
+    }
+
+    /// Doc IDs of term `t`, across its blocks
+    fn doc_ids(&self, t: usize) -> &[u32] {
+        span(self.file.get(&self.posting_ends), t)
+            .and_then(|range| self.file.get(&self.doc_ids).get(range))
+            .unwrap_or_default()
+    }
+
+    /// Posting blocks of term `t`: doc IDs, frequencies and max score
+    fn blocks(&self, t: usize) -> impl Iterator<Item = (&[u32], &[u16], f32)> + '_ {
+        let posting_ends = self.file.get(&self.block_posting_ends);
+        let maxes = self.file.get(&self.block_maxes);
+        let doc_ids = self.file.get(&self.doc_ids);
+        let freqs = self.file.get(&self.freqs);
+        span(self.file.get(&self.block_ends), t)
+            .unwrap_or_default()
+            .filter_map(move |b| {
+                let range = span(posting_ends, b)?;
+                Some((
+                    doc_ids.get(range.clone())?,
+                    freqs.get(range)?,
+                    *maxes.get(b)?,
+                ))
+            })
+    }
+
+    fn doc_lengths(&self) -> &[u16] {
+        self.file.get(&self.doc_lengths)
+    }
+
+    /// External ID of doc `doc_id`
+    fn id(&self, doc_id: usize) -> &str {
+        span(self.file.get(&self.id_ends), doc_id)
+            .and_then(|range| self.file.get(&self.id_bytes).get(range))
+            .and_then(|bytes| std::str::from_utf8(bytes).ok())
+            .unwrap_or_default()
+    }
+}
+
+/// A query term's postings: saved ones in the mapping, newer in memory
+struct TermPostings<'a> {
+    mapped: Option<(&'a MappedIndex, usize)>,
+    memory: Option<&'a CompressedPosting>,
+    df: u32,
+    upper_bound: f32,
+}
+
 /// Turbo profile for maximum throughput
 pub struct TurboProfile {
-    /// Term dictionary
-    term_dict: RwLock<HashMap<String, usize>>,
-    /// Posting lists
+    /// Terms of the in-memory and pending docs
+    terms: RwLock<TermInterner>,
+    /// Posting lists of the docs from `mem_base` on, indexed by term ID
     postings: RwLock<Vec<CompressedPosting>>,
-    /// Document lengths
+    /// Document lengths, indexed by doc ID - `mem_base`
     doc_lengths: RwLock<Vec<u16>>,
-    /// Document IDs (external)
-    doc_ids: RwLock<Vec<String>>,
+    /// Document IDs (external), indexed by doc ID - `mem_base`
+    doc_ids: RwLock<IdTable>,
+    /// Saved index, searched in place; covers the docs below `mem_base`
+    mapped: RwLock<Option<Arc<MappedIndex>>>,
+    /// First doc ID held in memory
+    mem_base: AtomicU64,
     /// Document count
     doc_count: AtomicU64,
     /// Total document length
@@ -112,13 +264,6 @@ pub struct TurboProfile {
     pending: RwLock<Vec<TokenizedDoc>>,
 }
 
-/// Pre-tokenized document
-struct TokenizedDoc {
-    id: String,
-    term_freqs: HashMap<String, u16>,
-    doc_len: u32,
-}
-
 impl TurboProfile {
     pub fn new() -> Self {
         Self::with_config(TurboConfig::default())
@@ -126,10 +271,12 @@ impl TurboProfile {
 
     pub fn with_config(config: TurboConfig) -> Self {
         Self {
-            term_dict: RwLock::new(HashMap::with_capacity(1_000_000)),
+            terms: RwLock::new(TermInterner::new()),
             postings: RwLock::new(Vec::with_capacity(1_000_000)),
             doc_lengths: RwLock::new(Vec::with_capacity(10_000_000)),
-            doc_ids: RwLock::new(Vec::with_capacity(10_000_000)),
+            doc_ids: RwLock::new(IdTable::new()),
+            mapped: RwLock::new(None),
+            mem_base: AtomicU64::new(0),
             doc_count: AtomicU64::new(0),
             total_doc_length: AtomicU64::new(0),
             bm25: Bm25Params::default(),
@@ -139,19 +286,31 @@ impl TurboProfile {
         }
     }
 
-    /// Parallel tokenization using rayon
-    fn tokenize_parallel(&self, docs: &[Document]) -> Vec<TokenizedDoc> {
-        docs.par_iter()
-            .map(|doc| {
-                let term_freqs = self.tokenizer.tokenize_with_freqs(&doc.text);
-                let doc_len: u32 = term_freqs.values().map(|&v| v as u32).sum();
-                TokenizedDoc {
-                    id: doc.id.clone(),
-                    term_freqs,
-                    doc_len,
-                }
-            })
-            .collect()
+    /// Tokenize `docs` into the pending buffer, flushing it into postings
+    /// once it reaches the segment size. Callable from several threads.
+    fn add_pending(&self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
+        // Parallel tokenization into interned term IDs
+        let tokenized = self.tokenizer.tokenize_interned(docs, &self.terms);
+        let count = tokenized.len();
+
+        // Pending docs get the next doc IDs in order, so IDs are interned now.
+        // Both locks are held so concurrent batches cannot interleave.
+        let pending_len = {
+            let mut doc_ids = self.doc_ids.write();
+            for doc in docs {
+                doc_ids.push(doc.id);
+            }
+            let mut pending = self.pending.write();
+            pending.extend(tokenized);
+            pending.len()
+        };
+
+        // Auto-flush if buffer is large
+        if pending_len >= self.config.segment_size {
+            self.build_from_pending();
+        }
+
+        Ok(count)
     }
 
     /// Build index from pending documents
@@ -161,36 +320,28 @@ impl TurboProfile {
             return;
         }
 
-        let mut term_dict = self.term_dict.write();
         let mut postings = self.postings.write();
         let mut doc_lengths = self.doc_lengths.write();
-        let mut doc_ids = self.doc_ids.write();
 
         let base_doc_id = self.doc_count.load(Ordering::Relaxed) as u32;
+        let mem_base = self.mem_base.load(Ordering::Relaxed) as usize;
         let pending_count = pending.len();
 
+        // Every pending doc's terms are interned by now
+        let term_count = self.terms.read().len();
+        postings.resize_with(term_count, CompressedPosting::default);
+
         // Pre-allocate for all pending docs
         doc_lengths.reserve(pending_count);
-        doc_ids.reserve(pending_count);
-
-        // Collect term -> postings mapping
-        let mut term_posts: HashMap<String, Vec<(u32, u16)>> = HashMap::with_capacity(100_000);
-
-        for (i, tdoc) in pending.iter().enumerate() {
-            let doc_id = base_doc_id + i as u32;
-            doc_ids.push(tdoc.id.clone());
+        for tdoc in pending.iter() {
             doc_lengths.push(tdoc.doc_len as u16);
             self.total_doc_length
                 .fetch_add(tdoc.doc_len as u64, Ordering::Relaxed);
-
-            for (term, &freq) in &tdoc.term_freqs {
-                term_posts
-                    .entry(term.clone())
-                    .or_insert_with(|| Vec::with_capacity(100))
-                    .push((doc_id, freq));
-            }
         }
 
+        // (term, doc, freq) postings grouped by term
+        let term_posts = invert(&pending, base_doc_id);
+
         self.doc_count
             .fetch_add(pending_count as u64, Ordering::Relaxed);
 
@@ -203,13 +354,12 @@ impl TurboProfile {
         };
 
         // Build postings for each term
-        for (term, posts) in term_posts {
+        for posts in term_posts.chunk_by(|a, b| a.0 == b.0) {
             let df = posts.len() as u32;
-            let idf = ((total_docs - df as f32 + 0.5) / (df as f32 + 0.5) + 1.0).ln();
 
             // Build Roaring bitmap
             let mut bitmap = RoaringBitmap::new();
-            for &(doc_id, _) in &posts {
+            for &(_, doc_id, _) in posts {
                 bitmap.insert(doc_id);
             }
 
@@ -219,8 +369,8 @@ impl TurboProfile {
                 let mut block = PostingBlock::new();
                 let mut max_score = 0.0f32;
 
-                for &(doc_id, freq) in chunk {
-                    let doc_len = doc_lengths[doc_id as usize] as f32;
+                for &(_, doc_id, freq) in chunk {
+                    let doc_len = doc_lengths[doc_id as usize - mem_base] as f32;
                     let score =
                         self.bm25
                             .score(freq as f32, df as f32, doc_len, avg_doc_len, total_docs);
@@ -234,40 +384,38 @@ impl TurboProfile {
                 blocks.push(block);
             }
 
-            // Insert or merge
-            if let Some(&offset) = term_dict.get(&term) {
-                let existing = &mut postings[offset];
-                existing.bitmap |= &bitmap;
-                existing.blocks.extend(blocks);
-                existing.df += df;
-                existing.idf =
-                    ((total_docs - existing.df as f32 + 0.5) / (existing.df as f32 + 0.5) + 1.0)
-                        .ln();
-            } else {
-                let offset = postings.len();
-                term_dict.insert(term, offset);
-                postings.push(CompressedPosting {
-                    bitmap,
-                    blocks,
-                    df,
-                    idf,
-                });
-            }
+            // Merge into the term's postings (empty for a new term)
+            let existing = &mut postings[posts[0].0 as usize];
+            existing.bitmap |= &bitmap;
+            existing.blocks.extend(blocks);
+            existing.df += df;
+            existing.idf =
+                ((total_docs - existing.df as f32 + 0.5) / (existing.df as f32 + 0.5) + 1.0).ln();
         }
 
         pending.clear();
     }
 
     /// Search using Block-Max WAND with early termination
-    fn search_bmw(&self, query_terms: &[String], limit: usize, offset: usize) -> Vec<SearchHit> {
-        let term_dict = self.term_dict.read();
+    fn search_bmw(
+        &self,
+        query_terms: &[String],
+        limit: usize,
+        offset: usize,
+        after: Option<SearchCursor>,
+        out: &mut HitBuffer,
+    ) {
+        let terms = self.terms.read();
         let postings = self.postings.read();
         let doc_lengths = self.doc_lengths.read();
         let doc_ids = self.doc_ids.read();
+        let mapped = self.mapped.read();
+        let mapped = mapped.as_deref();
+        let mem_base = self.mem_base.load(Ordering::Relaxed) as usize;
         let doc_count = self.doc_count.load(Ordering::Relaxed);
 
         if doc_count == 0 || query_terms.is_empty() {
-            return Vec::new();
+            return;
         }
 
         let total_docs = doc_count as f32;
@@ -275,244 +423,286 @@ impl TurboProfile {
         let avg_doc_len = total_len / total_docs;
 
         // Collect query term postings
-        let mut query_postings: Vec<(&CompressedPosting, f32)> = Vec::new();
+        let mut query_postings: Vec<TermPostings<'_>> = Vec::new();
         for term in query_terms {
-            if let Some(&offset) = term_dict.get(term) {
-                let posting = &postings[offset];
-                let upper_bound = posting.idf * (self.bm25.k1 + 1.0);
-                query_postings.push((posting, upper_bound));
+            let base = mapped.and_then(|index| Some((index, index.find(term)?)));
+            let memory = terms
+                .lookup(term)
+                .and_then(|id| postings.get(id as usize))
+                .filter(|p| p.df > 0);
+            let df = base.map_or(0, |(index, t)| index.df(t)) + memory.map_or(0, |p| p.df);
+            if df > 0 {
+                let idf = ((total_docs - df as f32 + 0.5) / (df as f32 + 0.5) + 1.0).ln();
+                query_postings.push(TermPostings {
+                    mapped: base,
+                    memory,
+                    df,
+                    upper_bound: idf * (self.bm25.k1 + 1.0),
+                });
             }
         }
 
         if query_postings.is_empty() {
-            return Vec::new();
+            return;
         }
 
         // Sort by upper bound descending
-        query_postings.sort_by(|a, b| b.1.partial_cmp(&a.1).unwrap_or(std::cmp::Ordering::Equal));
+        query_postings.sort_by(|a, b| {
+            b.upper_bound
+                .partial_cmp(&a.upper_bound)
+                .unwrap_or(std::cmp::Ordering::Equal)
+        });
 
         // Score documents using BMW
         let k = limit + offset;
-        let mut top_k: BinaryHeap<Reverse<(OrderedFloat, u32)>> = BinaryHeap::with_capacity(k + 1);
-        let mut threshold = 0.0f32;
+        let mut top_k = TopK::new(k, after);
         let mut scored: HashMap<u32, f32> = HashMap::with_capacity(k * 10);
 
-        for (posting, _) in &query_postings {
-            for block in &posting.blocks {
-                // Skip if block can't beat threshold
-                if block.max_score < threshold && !top_k.is_empty() {
-                    continue;
-                }
+        let doc_len = |doc_id: u32| {
+            let doc = doc_id as usize;
+            let len = if doc < mem_base {
+                mapped.and_then(|index| index.doc_lengths().get(doc))
+            } else {
+                doc_lengths.get(doc - mem_base)
+            };
+            len.copied().unwrap_or(0) as f32
+        };
 
-                for (i, &doc_id) in block.doc_ids.iter().enumerate() {
-                    let freq = block.freqs[i];
-                    let doc_len = doc_lengths[doc_id as usize] as f32;
+        for term in &query_postings {
+            let mut score_block = |ids: &[u32], freqs: &[u16]| {
+                for (&doc_id, &freq) in ids.iter().zip(freqs) {
                     let score = self.bm25.score(
                         freq as f32,
-                        posting.df as f32,
-                        doc_len,
+                        term.df as f32,
+                        doc_len(doc_id),
                         avg_doc_len,
                         total_docs,
                     );
                     *scored.entry(doc_id).or_insert(0.0) += score;
                 }
+            };
+
+            // Skip blocks that can't beat threshold
+            if let Some((index, t)) = term.mapped {
+                for (ids, freqs, max_score) in index.blocks(t) {
+                    if max_score < top_k.threshold() {
+                        continue;
+                    }
+                    score_block(ids, freqs);
+                }
+            }
+            if let Some(posting) = term.memory {
+                for block in &posting.blocks {
+                    if block.max_score < top_k.threshold() {
+                        continue;
+                    }
+                    score_block(&block.doc_ids, &block.freqs);
+                }
             }
         }
 
         // Build top-k heap
         for (doc_id, score) in scored {
-            let entry = Reverse((OrderedFloat(score), doc_id));
-            if top_k.len() < k {
-                top_k.push(entry);
-                if top_k.len() == k {
-                    threshold = top_k.peek().unwrap().0 .0 .0;
-                }
-            } else if score > threshold {
-                top_k.pop();
-                top_k.push(entry);
-                threshold = top_k.peek().unwrap().0 .0 .0;
-            }
+            top_k.push(score, doc_id);
         }
 
-        // Extract results
-        let mut results: Vec<_> = top_k
-            .into_sorted_vec()
-            .into_iter()
-            .skip(offset)
-            .take(limit)
-            .map(|Reverse((score, doc_id))| {
-                SearchHit::new(doc_ids[doc_id as usize].clone(), score.0)
+        top_k.into_hits(offset, limit, out, |doc_id, ids| {
+            let doc = doc_id as usize;
+            ids.push_str(match mapped {
+                Some(index) if doc < mem_base => index.id(doc),
+                _ => doc_ids.get(doc - mem_base),
             })
-            .collect();
-
-        results.reverse();
-        results
-    }
-}
-
-impl Default for TurboProfile {
-    fn default() -> Self {
-        Self::new()
-    }
-}
-
-impl SearchProfile for TurboProfile {
-    fn name(&self) -> &'static str {
-        "turbo"
-    }
-
-    fn profile_type(&self) -> ProfileType {
-        ProfileType::Turbo
-    }
-
-    fn index_batch(&mut self, docs: &[Document]) -> Result<usize, IndexError> {
-        // Parallel tokenization
-        let tokenized = self.tokenize_parallel(docs);
-        let count = tokenized.len();
-
-        // Add to pending buffer
-        self.pending.write().extend(tokenized);
-
-        // Auto-flush if buffer is large
-        if self.pending.read().len() >= self.config.segment_size {
-            self.build_from_pending();
-        }
-
-        Ok(count)
-    }
-
-    fn commit(&mut self) -> Result<(), IndexError> {
-        self.build_from_pending();
-        Ok(())
-    }
-
-    fn search(
-        &self,
-        query: &str,
-        limit: usize,
-        offset: usize,
-    ) -> Result<SearchResult, SearchError> {
-        let start = Instant::now();
-        let query_terms = self.tokenizer.tokenize_query(query);
-        let hits = self.search_bmw(&query_terms, limit, offset);
-        let total = hits.len() as u64;
-
-        Ok(SearchResult {
-            hits,
-            total,
-            duration: start.elapsed(),
-            profile: self.name().to_string(),
         })
     }
 
-    fn memory_stats(&self) -> MemoryStats {
-        let term_dict = self.term_dict.read();
-        let postings = self.postings.read();
-        let doc_lengths = self.doc_lengths.read();
-        let doc_ids = self.doc_ids.read();
-
-        let term_dict_bytes = term_dict.len() * 64;
-        let postings_bytes: usize = postings
-            .iter()
-            .map(|p| {
-                let bitmap_size = p.bitmap.serialized_size();
-                let blocks_size: usize = p
-                    .blocks
-                    .iter()
-                    .map(|b| b.doc_ids.len() * 4 + b.freqs.len() * 2 + 4)
-                    .sum();
-                bitmap_size + blocks_size
-            })
-            .sum();
-
-        let doc_lengths_bytes = doc_lengths.len() * 2;
-        let doc_ids_bytes: usize = doc_ids.iter().map(|s| s.len()).sum();
-
-        MemoryStats {
-            index_bytes: (term_dict_bytes + postings_bytes + doc_lengths_bytes + doc_ids_bytes)
-                as u64,
-            term_dict_bytes: term_dict_bytes as u64,
-            postings_bytes: postings_bytes as u64,
-            docs_indexed: self.doc_count.load(Ordering::Relaxed),
-            mmap_bytes: 0,
-        }
-    }
-
-    fn save(&self, path: &Path) -> Result<(), IndexError> {
-        let file = File::create(path.join("turbo.idx"))?;
-        let mut writer = BufWriter::with_capacity(64 * 1024, file);
-
-        // Header
-        writer.write_all(b"TURB")?;
-        writer.write_all(&1u32.to_le_bytes())?;
-
-        let term_dict = self.term_dict.read();
+    /// Write the committed index to a new, synced file in the mappable
+    /// format, merging the mapped index with the in-memory postings
+    fn write_mapped(&self, path: &Path) -> Result<(), IndexError> {
+        let interner = self.terms.read();
         let postings = self.postings.read();
         let doc_lengths = self.doc_lengths.read();
         let doc_ids = self.doc_ids.read();
+        let mapped = self.mapped.read();
+        let mapped = mapped.as_deref();
         let doc_count = self.doc_count.load(Ordering::Relaxed);
         let total_doc_length = self.total_doc_length.load(Ordering::Relaxed);
+        // Pending docs' IDs are not saved
+        let mem_docs = (doc_count - self.mem_base.load(Ordering::Relaxed)) as usize;
+
+        // Merge-join the sorted mapped terms with the sorted in-memory ones
+        let base_terms: Vec<&[u8]> = mapped.map_or(Vec::new(), |index| {
+            (0..index.term_count()).map(|t| index.term(t)).collect()
+        });
+        let mut memory_terms: Vec<(&str, usize)> = (postings.iter().enumerate())
+            .filter(|(_, p)| p.df > 0)
+            .map(|(id, _)| (interner.term(id as u32), id))
+            .collect();
+        memory_terms.par_sort_unstable_by(|a, b| a.0.cmp(b.0));
+
+        let mut terms = Vec::with_capacity(base_terms.len().max(memory_terms.len()));
+        let (mut i, mut j) = (0, 0);
+        while i < base_terms.len() || j < memory_terms.len() {
+            let order = match (base_terms.get(i), memory_terms.get(j)) {
+                (Some(base), Some((term, _))) => (*base).cmp(term.as_bytes()),
+                (Some(_), None) => std::cmp::Ordering::Less,
+                _ => std::cmp::Ordering::Greater,
+            };
+            let base = (order.is_le()).then(|| (mapped.unwrap(), i));
+            let memory = (order.is_ge()).then(|| &postings[memory_terms[j].1]);
+            let term = if order.is_le() {
+                base_terms[i]
+            } else {
+                memory_terms[j].0.as_bytes()
+            };
+            terms.push((term, base, memory));
+            i += order.is_le() as usize;
+            j += order.is_ge() as usize;
+        }
 
-        // Counts
-        writer.write_all(&(term_dict.len() as u64).to_le_bytes())?;
-        writer.write_all(&(postings.len() as u64).to_le_bytes())?;
-        writer.write_all(&doc_count.to_le_bytes())?;
-        writer.write_all(&total_doc_length.to_le_bytes())?;
+        // Offsets of every term's postings and blocks, mapped ones first
+        let mut term_ends = Vec::with_capacity(terms.len());
+        let mut posting_ends = Vec::with_capacity(terms.len());
+        let mut block_ends = Vec::with_capacity(terms.len());
+        let mut block_posting_ends = Vec::new();
+        let mut block_maxes = Vec::new();
+        let (mut term_bytes, mut posting_count) = (0u64, 0u64);
+        for &(term, base, memory) in &terms {
+            term_bytes += term.len() as u64;
+            term_ends.push(term_bytes);
+            let mut add_block = |len: usize, max_score: f32| {
+                posting_count += len as u64;
+                block_posting_ends.push(posting_count);
+                block_maxes.push(max_score);
+            };
+            if let Some((index, t)) = base {
+                for (ids, _, max_score) in index.blocks(t) {
+                    add_block(ids.len(), max_score);
+                }
+            }
+            for block in memory.iter().flat_map(|p| &p.blocks) {
+                add_block(block.doc_ids.len(), block.max_score);
+            }
+            posting_ends.push(posting_count);
+            block_ends.push(block_maxes.len() as u64);
+        }
 
-        // Term dictionary
-        for (term, &offset) in term_dict.iter() {
-            let term_bytes = term.as_bytes();
-            writer.write_all(&(term_bytes.len() as u32).to_le_bytes())?;
-            writer.write_all(term_bytes)?;
-            writer.write_all(&(offset as u64).to_le_bytes())?;
+        let base_id_bytes = mapped.map_or(0, |index| index.id_bytes.len() as u64);
+        let mut id_ends = Vec::with_capacity(mem_docs);
+        let mut id_bytes = base_id_bytes;
+        for id in doc_ids.iter().take(mem_docs) {
+            id_bytes += id.len() as u64;
+            id_ends.push(id_bytes);
         }
 
-        // Postings
-        for posting in postings.iter() {
-            let mut bitmap_bytes = Vec::new();
-            posting.bitmap.serialize_into(&mut bitmap_bytes).unwrap();
-            writer.write_all(&(bitmap_bytes.len() as u64).to_le_bytes())?;
-            writer.write_all(&bitmap_bytes)?;
-
-            writer.write_all(&posting.df.to_le_bytes())?;
-            writer.write_all(&posting.idf.to_le_bytes())?;
-
-            writer.write_all(&(posting.blocks.len() as u32).to_le_bytes())?;
-            for block in &posting.blocks {
-                writer.write_all(&(block.doc_ids.len() as u32).to_le_bytes())?;
-                for &doc_id in &block.doc_ids {
-                    writer.write_all(&doc_id.to_le_bytes())?;
+        let file = File::create(path)?;
+        let mut writer = SectionWriter::new(BufWriter::with_capacity(8 * 1024 * 1024, file));
+        writer.section(INDEX_MAGIC)?;
+        writer.section(&[
+            terms.len() as u64,
+            posting_count,
+            block_maxes.len() as u64,
+            doc_count,
+            total_doc_length,
+            term_bytes,
+            id_bytes,
+        ])?;
+        writer.section(&term_ends)?;
+        writer.begin()?;
+        for (term, _, _) in &terms {
+            writer.extend(term)?;
+        }
+        writer.section(&posting_ends)?;
+        writer.section(&block_ends)?;
+        writer.section(&block_posting_ends)?;
+        writer.section(&block_maxes)?;
+
+        writer.begin()?;
+        for &(_, base, memory) in &terms {
+            if let Some((index, t)) = base {
+                for (ids, _, _) in index.blocks(t) {
+                    writer.extend(ids)?;
                 }
-                for &freq in &block.freqs {
-                    writer.write_all(&freq.to_le_bytes())?;
+            }
+            for block in memory.iter().flat_map(|p| &p.blocks) {
+                writer.extend(&block.doc_ids)?;
+            }
+        }
+        writer.begin()?;
+        for &(_, base, memory) in &terms {
+            if let Some((index, t)) = base {
+                for (_, freqs, _) in index.blocks(t) {
+                    writer.extend(freqs)?;
                 }
-                writer.write_all(&block.max_score.to_le_bytes())?;
+            }
+            for block in memory.iter().flat_map(|p| &p.blocks) {
+                writer.extend(&block.freqs)?;
             }
         }
 
-        // Doc lengths
-        for &len in doc_lengths.iter() {
-            writer.write_all(&len.to_le_bytes())?;
+        writer.begin()?;
+        if let Some(index) = mapped {
+            writer.extend(index.doc_lengths())?;
         }
+        writer.extend(&doc_lengths[..mem_docs])?;
 
-        // Doc IDs
-        for id in doc_ids.iter() {
-            let id_bytes = id.as_bytes();
-            writer.write_all(&(id_bytes.len() as u32).to_le_bytes())?;
-            writer.write_all(id_bytes)?;
+        writer.begin()?;
+        if let Some(index) = mapped {
+            writer.extend(index.file.get(&index.id_ends))?;
+        }
+        writer.extend(&id_ends)?;
+        writer.begin()?;
+        if let Some(index) = mapped {
+            writer.extend(index.file.get(&index.id_bytes))?;
+        }
+        for id in doc_ids.iter().take(mem_docs) {
+            writer.extend(id.as_bytes())?;
         }
 
-        writer.flush()?;
+        let file = writer
+            .into_inner()
+            .into_inner()
+            .map_err(|e| e.into_error())?;
+        file.sync_all()?;
         Ok(())
     }
 
-    fn load(&mut self, path: &Path) -> Result<(), IndexError> {
-        let file = File::open(path.join("turbo.idx"))?;
+    /// Search the index saved in `path` in place from now on and drop the
+    /// in-memory copy of its docs; only pending docs stay in memory.
+    /// Skipped if docs were committed during the save. Interned terms are
+    /// kept, since pending docs refer to them by ID.
+    fn remap(&self, path: &Path) -> Result<(), IndexError> {
+        let index = MappedIndex::open(MappedFile::open(&path.join(INDEX_FILE))?)?;
+
+        let mut postings = self.postings.write();
+        let mut doc_lengths = self.doc_lengths.write();
+        let mut doc_ids = self.doc_ids.write();
+        let doc_count = index.doc_count;
+        if self.doc_count.load(Ordering::Relaxed) != doc_count {
+            return Ok(());
+        }
+
+        let saved = (doc_count - self.mem_base.load(Ordering::Relaxed)) as usize;
+        let mut pending_ids = IdTable::new();
+        for id in doc_ids.iter().skip(saved) {
+            pending_ids.push(id);
+        }
+        *doc_ids = pending_ids;
+        *postings = Vec::new();
+        doc_lengths.clear();
+
+        *self.mapped.write() = Some(Arc::new(index));
+        self.mem_base.store(doc_count, Ordering::Relaxed);
+        Ok(())
+    }
+
+    /// Load the unaligned format into memory
+    fn load_v1(&mut self, path: &Path) -> Result<(), IndexError> {
+        let file = File::open(path.join(INDEX_FILE))?;
         let mut reader = BufReader::with_capacity(64 * 1024, file);
 
         let mut magic = [0u8; 4];
         reader.read_exact(&mut magic)?;
-        if &magic != b"TURB" {
+        if &magic != INDEX_MAGIC_V1 {
             return Err(IndexError::Corrupted("Invalid magic".into()));
         }
 
@@ -532,7 +722,7 @@ impl SearchProfile for TurboProfile {
         let total_doc_length = u64::from_le_bytes(buf8);
 
         // Term dictionary
-        let mut term_dict = HashMap::with_capacity(term_count as usize);
+        let mut term_offsets = Vec::with_capacity(term_count as usize);
         for _ in 0..term_count {
             reader.read_exact(&mut buf4)?;
             let term_len = u32::from_le_bytes(buf4) as usize;
@@ -542,7 +732,7 @@ impl SearchProfile for TurboProfile {
                 .map_err(|_| IndexError::Corrupted("Invalid UTF-8".into()))?;
             reader.read_exact(&mut buf8)?;
             let offset = u64::from_le_bytes(buf8) as usize;
-            term_dict.insert(term, offset);
+            term_offsets.push((term, offset));
         }
 
         // Postings
@@ -606,19 +796,21 @@ impl SearchProfile for TurboProfile {
         }
 
         // Doc IDs
-        let mut doc_ids = Vec::with_capacity(doc_count as usize);
+        let mut doc_ids = IdTable::new();
+        let mut id_bytes = Vec::new();
         for _ in 0..doc_count {
             reader.read_exact(&mut buf4)?;
-            let id_len = u32::from_le_bytes(buf4) as usize;
-            let mut id_bytes = vec![0u8; id_len];
+            id_bytes.resize(u32::from_le_bytes(buf4) as usize, 0);
             reader.read_exact(&mut id_bytes)?;
             doc_ids.push(
-                String::from_utf8(id_bytes)
+                std::str::from_utf8(&id_bytes)
                     .map_err(|_| IndexError::Corrupted("Invalid UTF-8".into()))?,
             );
         }
 
-        *self.term_dict.write() = term_dict;
+        // Postings were written in term ID order
+        *self.terms.write() = TermInterner::from_ids(term_offsets)
+            .ok_or_else(|| IndexError::Corrupted("Invalid term offsets".into()))?;
         *self.postings.write() = postings;
         *self.doc_lengths.write() = doc_lengths;
         *self.doc_ids.write() = doc_ids;
@@ -628,45 +820,234 @@ impl SearchProfile for TurboProfile {
 
         Ok(())
     }
+}
+
+impl Default for TurboProfile {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl SearchProfile for TurboProfile {
+    fn name(&self) -> &'static str {
+        "turbo"
+    }
+
+    fn profile_type(&self) -> ProfileType {
+        ProfileType::Turbo
+    }
+
+    fn index_batch_refs(&mut self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
+        self.add_pending(docs)
+    }
+
+    fn index_batch_shared(&self, docs: &[DocumentRef<'_>]) -> Option<Result<usize, IndexError>> {
+        Some(self.add_pending(docs))
+    }
+
+    fn commit(&mut self) -> Result<(), IndexError> {
+        self.build_from_pending();
+        Ok(())
+    }
+
+    fn search(
+        &self,
+        query: &str,
+        limit: usize,
+        offset: usize,
+    ) -> Result<SearchResult, SearchError> {
+        let start = Instant::now();
+        let mut out = HitBuffer::new();
+        self.search_hits(query, limit, offset, &mut out)?;
+        Ok(out.to_result(self.name(), start.elapsed()))
+    }
+
+    fn search_hits(
+        &self,
+        query: &str,
+        limit: usize,
+        offset: usize,
+        out: &mut HitBuffer,
+    ) -> Result<(), SearchError> {
+        out.clear();
+        let query_terms = self.tokenizer.tokenize_query(query);
+        self.search_bmw(&query_terms, limit, offset, None, out);
+        out.total = out.len() as u64;
+        Ok(())
+    }
+
+    fn search_after(
+        &self,
+        query: &str,
+        limit: usize,
+        after: Option<SearchCursor>,
+    ) -> Result<SearchResult, SearchError> {
+        let start = Instant::now();
+        let query_terms = self.tokenizer.tokenize_query(query);
+        let mut out = HitBuffer::new();
+        self.search_bmw(&query_terms, limit, 0, after, &mut out);
+        out.total = out.len() as u64;
+        Ok(out.to_result(self.name(), start.elapsed()))
+    }
+
+    fn count_hits(&self, query: &str, mode: TotalMode) -> Result<u64, SearchError> {
+        let mut query_terms = self.tokenizer.tokenize_query(query);
+        query_terms.sort_unstable();
+        query_terms.dedup();
+
+        let terms = self.terms.read();
+        let postings = self.postings.read();
+        let mapped = self.mapped.read();
+        let mapped = mapped.as_deref();
+
+        // Saved doc IDs all precede the in-memory ones
+        let saved: Vec<&[u32]> = query_terms
+            .iter()
+            .map(|term| {
+                mapped
+                    .and_then(|index| Some(index.doc_ids(index.find(term)?)))
+                    .unwrap_or_default()
+            })
+            .collect();
+        let parts: Vec<Parts<'_>> = query_terms
+            .iter()
+            .zip(&saved)
+            .map(|(term, saved)| {
+                let memory = terms
+                    .lookup(term)
+                    .and_then(|id| postings.get(id as usize))
+                    .map(|posting| &posting.bitmap as &dyn TermDocs);
+                Parts::new(std::iter::once(saved as &dyn TermDocs).chain(memory))
+            })
+            .collect();
+        let parts: Vec<&dyn TermDocs> = parts.iter().map(|p| p as &dyn TermDocs).collect();
+        Ok(count_matches(
+            &parts,
+            self.doc_count.load(Ordering::Relaxed),
+            mode,
+        ))
+    }
+
+    fn memory_stats(&self) -> MemoryStats {
+        let terms = self.terms.read();
+        let postings = self.postings.read();
+        let doc_lengths = self.doc_lengths.read();
+        let doc_ids = self.doc_ids.read();
+
+        let term_dict_bytes = terms.heap_bytes();
+        let postings_bytes: usize = postings
+            .iter()
+            .map(|p| {
+                let bitmap_size = p.bitmap.serialized_size();
+                let blocks_size: usize = p
+                    .blocks
+                    .iter()
+                    .map(|b| b.doc_ids.len() * 4 + b.freqs.len() * 2 + 4)
+                    .sum();
+                bitmap_size + blocks_size
+            })
+            .sum();
+
+        let doc_lengths_bytes = doc_lengths.len() * 2;
+        let doc_ids_bytes = doc_ids.heap_bytes();
+        let mmap_bytes = self
+            .mapped
+            .read()
+            .as_ref()
+            .map_or(0, |index| index.file.len());
+
+        MemoryStats {
+            index_bytes: (term_dict_bytes
+                + postings_bytes
+                + doc_lengths_bytes
+                + doc_ids_bytes
+                + mmap_bytes) as u64,
+            term_dict_bytes: term_dict_bytes as u64,
+            postings_bytes: postings_bytes as u64,
+            docs_indexed: self.doc_count.load(Ordering::Relaxed),
+            mmap_bytes: mmap_bytes as u64,
+        }
+    }
+
+    /// Write the whole index to a new file and rename it into place, then
+    /// search it from the mapping
+    fn save(&self, path: &Path) -> Result<(), IndexError> {
+        let tmp_path = path.join(INDEX_TMP_FILE);
+        self.write_mapped(&tmp_path)?;
+        std::fs::rename(&tmp_path, path.join(INDEX_FILE))?;
+        self.remap(path)
+    }
+
+    fn load(&mut self, path: &Path) -> Result<(), IndexError> {
+        self.clear();
+        let file = MappedFile::open(&path.join(INDEX_FILE))?;
+        if file.bytes().starts_with(INDEX_MAGIC_V1) {
+            return self.load_v1(path);
+        }
+
+        let index = MappedIndex::open(file)?;
+        self.doc_count.store(index.doc_count, Ordering::Relaxed);
+        self.total_doc_length
+            .store(index.total_doc_length, Ordering::Relaxed);
+        self.mem_base.store(index.doc_count, Ordering::Relaxed);
+        *self.mapped.get_mut() = Some(Arc::new(index));
+        Ok(())
+    }
+
+    fn atomic_save(&self) -> bool {
+        true
+    }
 
     fn doc_count(&self) -> u64 {
         self.doc_count.load(Ordering::Relaxed)
     }
 
     fn clear(&mut self) {
-        self.term_dict.write().clear();
+        self.terms.write().clear();
         self.postings.write().clear();
         self.doc_lengths.write().clear();
         self.doc_ids.write().clear();
+        *self.mapped.write() = None;
+        self.mem_base.store(0, Ordering::Relaxed);
         self.doc_count.store(0, Ordering::Relaxed);
         self.total_doc_length.store(0, Ordering::Relaxed);
         self.pending.write().clear();
     }
-}
-
-/// Ordered float for heap
-#[derive(Debug, Clone, Copy, PartialEq)]
-struct OrderedFloat(f32);
 
-impl Ord for OrderedFloat {
-    fn cmp(&self, other: &Self) -> std::cmp::Ordering {
-        self.0
-            .partial_cmp(&other.0)
-            .unwrap_or(std::cmp::Ordering::Equal)
-    }
-}
-
-impl PartialOrd for OrderedFloat {
-    fn partial_cmp(&self, other: &Self) -> Option<std::cmp::Ordering> {
-        Some(self.cmp(other))
+    /// A view over the same mapping. Committed docs not yet remapped
+    /// (those of an unaligned load, or of a save that raced a write) are
+    /// copied.
+    fn snapshot(&self) -> Result<Box<dyn SearchProfile>, IndexError> {
+        let doc_count = self.doc_count.load(Ordering::Relaxed);
+        let mem_base = self.mem_base.load(Ordering::Relaxed);
+        let snapshot = Self {
+            terms: RwLock::new(TermInterner::new()),
+            postings: RwLock::new(Vec::new()),
+            doc_lengths: RwLock::new(Vec::new()),
+            doc_ids: RwLock::new(IdTable::new()),
+            mapped: RwLock::new(self.mapped.read().clone()),
+            mem_base: AtomicU64::new(mem_base),
+            doc_count: AtomicU64::new(doc_count),
+            total_doc_length: AtomicU64::new(self.total_doc_length.load(Ordering::Relaxed)),
+            bm25: self.bm25,
+            tokenizer: FastTokenizer::default(),
+            config: self.config.clone(),
+            pending: RwLock::new(Vec::new()),
+        };
+        if mem_base != doc_count {
+            *snapshot.terms.write() = self.terms.read().clone();
+            *snapshot.postings.write() = self.postings.read().clone();
+            *snapshot.doc_lengths.write() = self.doc_lengths.read().clone();
+            *snapshot.doc_ids.write() = self.doc_ids.read().clone();
+        }
+        Ok(Box::new(snapshot))
     }
 }
 
-impl Eq for OrderedFloat {}
-
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::document::Document;
     use tempfile::tempdir;
 
     #[test]
@@ -734,4 +1115,39 @@ mod tests {
         let result = profile2.search("world", 10, 0).unwrap();
         assert_eq!(result.hits.len(), 2);
     }
+
+    #[test]
+    fn test_turbo_mapped_resave() {
+        let dir = tempdir().unwrap();
+        let mut profile = TurboProfile::new();
+        profile
+            .index_batch(&[
+                Document::new("a", "hello world"),
+                Document::new("b", "world peace"),
+            ])
+            .unwrap();
+        profile.commit().unwrap();
+        profile.save(dir.path()).unwrap();
+
+        // Loading maps the file; new docs are merged into it on save
+        let mut loaded = TurboProfile::new();
+        loaded.load(dir.path()).unwrap();
+        assert!(loaded.memory_stats().mmap_bytes > 0);
+        loaded
+            .index_batch(&[Document::new("c", "hello again")])
+            .unwrap();
+        loaded.commit().unwrap();
+        let mut ids: Vec<_> = (loaded.search("hello", 10, 0).unwrap().hits)
+            .into_iter()
+            .map(|h| h.id)
+            .collect();
+        ids.sort();
+        assert_eq!(ids, ["a", "c"]);
+
+        loaded.save(dir.path()).unwrap();
+        let snapshot = loaded.snapshot().unwrap();
+        assert_eq!(snapshot.doc_count(), 3);
+        assert_eq!(snapshot.search("world", 10, 0).unwrap().hits.len(), 2);
+        assert_eq!(snapshot.search("again", 10, 0).unwrap().hits[0].id, "c");
+    }
 }
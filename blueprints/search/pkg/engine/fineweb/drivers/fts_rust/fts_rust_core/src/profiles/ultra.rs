@@ -8,20 +8,29 @@
 //! - Vectorized FNV-1a hashing with LUT
 //! - Minimal allocations per document
 //! - Inline hot paths
+//! - Saved segments are memory-mapped and searched in place
 
-use crate::document::Document;
-use crate::profiles::{Bm25Params, ProfileType, SearchProfile};
-use crate::result::{IndexError, MemoryStats, SearchError, SearchHit, SearchResult};
+use crate::document::DocumentRef;
+use crate::mapped::{MappedFile, Section, SectionWriter};
+use crate::profiles::{
+    count_matches, Bm25Params, Parts, ProfileType, SearchProfile, TermDocs, TopK,
+};
+use crate::result::{
+    HitBuffer, IndexError, MemoryStats, SearchCursor, SearchError, SearchResult, TotalMode,
+};
+use crate::segments::{SegmentInfo, SegmentManifest};
+use crate::tokenizer::{FastTokenizer, TermBuffer};
 
 use parking_lot::RwLock;
 use rayon::prelude::*;
 use rustc_hash::FxHashMap;
-use std::cmp::Reverse;
-use std::collections::BinaryHeap;
+use std::fmt::Write as _;
 use std::fs::File;
-use std::io::{BufReader, BufWriter, Read, Write};
-use std::path::Path;
+use std::io::{BufReader, BufWriter, Read};
+use std::ops::Range;
+use std::path::{Path, PathBuf};
 use std::sync::atomic::{AtomicU32, AtomicU64, Ordering};
+use std::sync::Arc;
 use std::time::Instant;
 
 /// Number of shards - 16 is optimal for 10-core M2 Pro
@@ -31,29 +40,16 @@ const SHARD_MASK: u64 = (NUM_SHARDS - 1) as u64;
 /// Block size for scoring
 const BLOCK_SIZE: usize = 512;
 
-/// FNV-1a constants
-const FNV_OFFSET: u64 = 0xcbf29ce484222325;
-const FNV_PRIME: u64 = 0x100000001b3;
-
-/// Pre-computed character lookup table
-/// 0 = non-alnum, otherwise = lowercase ASCII value
-static CHAR_LUT: [u8; 256] = {
-    let mut t = [0u8; 256];
-    let mut i = 0;
-    while i < 256 {
-        t[i] = if i >= b'a' as usize && i <= b'z' as usize {
-            i as u8
-        } else if i >= b'A' as usize && i <= b'Z' as usize {
-            (i as u8) | 0x20
-        } else if i >= b'0' as usize && i <= b'9' as usize {
-            i as u8
-        } else {
-            0
-        };
-        i += 1;
-    }
-    t
-};
+/// Segment files and the manifest are named `ultra.*`
+const SEGMENT_PREFIX: &str = "ultra";
+const SEGMENT_MAGIC: &[u8; 4] = b"ULS2";
+/// Unaligned segment format, read into memory and rewritten on save
+const SEGMENT_MAGIC_V1: &[u8; 4] = b"ULS1";
+/// Single-file format written before segments; still loadable
+const LEGACY_FILE: &str = "ultra.idx";
+
+/// Terms are 2 to 32 characters long
+const TOKENIZER: FastTokenizer = FastTokenizer::new(2, 32);
 
 /// Compact posting entry - 6 bytes packed
 #[derive(Debug, Clone, Copy)]
@@ -89,7 +85,19 @@ impl PostingList {
     }
 }
 
+impl Clone for PostingList {
+    fn clone(&self) -> Self {
+        Self {
+            entries: self.entries.clone(),
+            block_maxes: self.block_maxes.clone(),
+            df: AtomicU32::new(self.df.load(Ordering::Relaxed)),
+            idf: self.idf,
+        }
+    }
+}
+
 /// Index shard - owns its own term dict and postings
+#[derive(Clone)]
 struct IndexShard {
     /// Term hash -> posting list (FxHash is fastest for u64 keys)
     term_dict: FxHashMap<u64, PostingList>,
@@ -116,12 +124,131 @@ impl IndexShard {
     }
 }
 
+/// A segment file searched in place (format ULS2)
+///
+/// Layout, one section each: magic; header (base doc, doc count, total
+/// length, term count, posting count); term hashes, ascending; posting
+/// starts per term plus an end marker; doc IDs; frequencies; doc lengths.
+struct MappedSegment {
+    path: PathBuf,
+    file: MappedFile,
+    base_doc: u64,
+    doc_count: u64,
+    total_len: u64,
+    hashes: Section<u64>,
+    starts: Section<u64>,
+    doc_ids: Section<u32>,
+    freqs: Section<u16>,
+    doc_lengths: Section<u16>,
+}
+
+impl MappedSegment {
+    fn open(path: PathBuf, file: MappedFile, info: &SegmentInfo) -> Result<Self, IndexError> {
+        let mut sections = file.sections();
+        if file.get(&sections.next::<u8>(4)?) != SEGMENT_MAGIC {
+            return Err(IndexError::Corrupted(format!("{}: bad magic", info.file)));
+        }
+        let header = file.get(&sections.next::<u64>(5)?);
+        let (base_doc, doc_count, total_len) = (header[0], header[1], header[2]);
+        let (term_count, posting_count) = (header[3], header[4]);
+        if base_doc != info.base_doc || doc_count != info.doc_count {
+            return Err(IndexError::Corrupted(format!(
+                "{}: docs {}+{} do not match the manifest",
+                info.file, base_doc, doc_count
+            )));
+        }
+
+        Ok(Self {
+            hashes: sections.next(term_count)?,
+            starts: sections.next(term_count + 1)?,
+            doc_ids: sections.next(posting_count)?,
+            freqs: sections.next(posting_count)?,
+            doc_lengths: sections.next(doc_count)?,
+            path,
+            file,
+            base_doc,
+            doc_count,
+            total_len,
+        })
+    }
+
+    fn end_doc(&self) -> u64 {
+        self.base_doc + self.doc_count
+    }
+
+    fn doc_lengths(&self) -> &[u16] {
+        self.file.get(&self.doc_lengths)
+    }
+
+    /// Doc IDs and frequencies of the term at `index` in the term table.
+    /// Bounds are checked here rather than at open, so opening stays O(1).
+    fn postings_at(&self, index: usize) -> Option<(&[u32], &[u16])> {
+        let starts = self.file.get(&self.starts);
+        let range = starts[index] as usize..starts[index + 1] as usize;
+        Some((
+            self.file.get(&self.doc_ids).get(range.clone())?,
+            self.file.get(&self.freqs).get(range)?,
+        ))
+    }
+
+    fn postings(&self, hash: u64) -> Option<(&[u32], &[u16])> {
+        let index = self.file.get(&self.hashes).binary_search(&hash).ok()?;
+        self.postings_at(index)
+    }
+}
+
+/// One term's postings from one source, in doc order
+enum Run<'a> {
+    Mapped(&'a [u32], &'a [u16]),
+    Memory(&'a [PostingEntry]),
+}
+
+impl Run<'_> {
+    fn len(&self) -> usize {
+        match self {
+            Run::Mapped(ids, _) => ids.len(),
+            Run::Memory(entries) => entries.len(),
+        }
+    }
+}
+
+impl TermDocs for Run<'_> {
+    fn df(&self) -> u64 {
+        self.len() as u64
+    }
+
+    fn nth(&self, i: u64) -> u32 {
+        match self {
+            Run::Mapped(ids, _) => ids[i as usize],
+            Run::Memory(entries) => entries[i as usize].doc_id,
+        }
+    }
+
+    fn contains(&self, doc: u32) -> bool {
+        match self {
+            Run::Mapped(ids, _) => ids.binary_search(&doc).is_ok(),
+            Run::Memory(entries) => entries.binary_search_by_key(&doc, |e| e.doc_id).is_ok(),
+        }
+    }
+
+    fn for_each_doc(&self, f: &mut dyn FnMut(u32)) {
+        match self {
+            Run::Mapped(ids, _) => ids.iter().for_each(|&doc| f(doc)),
+            Run::Memory(entries) => entries.iter().for_each(|e| f(e.doc_id)),
+        }
+    }
+}
+
 /// Ultra profile for maximum throughput
 pub struct UltraProfile {
-    /// Sharded index for concurrent access
+    /// Sharded index for concurrent access, holding docs from `mem_base` on
     shards: Vec<RwLock<IndexShard>>,
-    /// Document lengths
+    /// Lengths of the docs in the shards, indexed by doc ID - `mem_base`
     doc_lengths: RwLock<Vec<u16>>,
+    /// Saved segments, searched in place; they cover the docs below `mem_base`
+    mapped: RwLock<Vec<Arc<MappedSegment>>>,
+    /// First doc ID held in memory
+    mem_base: AtomicU64,
     /// Document count
     doc_count: AtomicU64,
     /// Total document length
@@ -130,6 +257,8 @@ pub struct UltraProfile {
     bm25: Bm25Params,
     /// Block maxes dirty flag
     block_maxes_dirty: AtomicU32,
+    /// Segments on disk as of the last save or load
+    segments: RwLock<SegmentManifest>,
 }
 
 impl UltraProfile {
@@ -140,10 +269,13 @@ impl UltraProfile {
         Self {
             shards,
             doc_lengths: RwLock::new(Vec::with_capacity(10_000_000)),
+            mapped: RwLock::new(Vec::new()),
+            mem_base: AtomicU64::new(0),
             doc_count: AtomicU64::new(0),
             total_doc_length: AtomicU64::new(0),
             bm25: Bm25Params::default(),
             block_maxes_dirty: AtomicU32::new(1),
+            segments: RwLock::new(SegmentManifest::default()),
         }
     }
 
@@ -152,56 +284,423 @@ impl UltraProfile {
         (hash & SHARD_MASK) as usize
     }
 
-    /// Ultra-fast tokenization with batch output
-    /// Returns: Vec<(hash, freq)> - minimal allocation
-    #[inline]
-    fn tokenize_batch(text: &[u8]) -> Vec<(u64, u16)> {
-        let len = text.len();
-        if len == 0 {
-            return Vec::new();
+    /// Index `docs` straight into the shards. Concurrent calls each reserve
+    /// a doc-ID range up front; postings may then arrive out of doc order,
+    /// which `commit` repairs.
+    fn add_docs(&self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
+        if docs.is_empty() {
+            return Ok(0);
+        }
+
+        let num_docs = docs.len();
+        let base_doc_id = self.doc_count.fetch_add(num_docs as u64, Ordering::Relaxed) as u32;
+
+        // Phase 1: Parallel tokenization - collect (doc_id, doc_len, terms)
+        // Terms already include shard_id to avoid recomputation
+        let tokenized: Vec<_> = docs
+            .par_iter()
+            .enumerate()
+            .map_init(TermBuffer::default, |buf, (i, doc)| {
+                let doc_id = base_doc_id + i as u32;
+                let terms = Self::tokenize_batch(buf, doc.text);
+                let doc_len = buf.token_count();
+                (doc_id, doc_len.min(u16::MAX as u32) as u16, terms)
+            })
+            .collect();
+
+        // Phase 2: Collect doc lengths and update counts
+        let total_len: u64 = tokenized.iter().map(|(_, len, _)| *len as u64).sum();
+        self.total_doc_length.fetch_add(total_len, Ordering::Relaxed);
+
+        {
+            // A later range may have been written first
+            let mut doc_lengths = self.doc_lengths.write();
+            let base = base_doc_id as usize - self.mem_base.load(Ordering::Relaxed) as usize;
+            if doc_lengths.len() < base + num_docs {
+                doc_lengths.resize(base + num_docs, 0);
+            }
+            for (slot, (_, len, _)) in doc_lengths[base..].iter_mut().zip(&tokenized) {
+                *slot = *len;
+            }
+        }
+
+        // Phase 3: Sequential aggregate - fastest approach
+        let mut shard_postings: Vec<Vec<(u64, u32, u16)>> = (0..NUM_SHARDS)
+            .map(|_| Vec::new())
+            .collect();
+
+        for (doc_id, _, terms) in &tokenized {
+            for &(hash, freq) in terms {
+                let shard_id = Self::shard_for_hash(hash);
+                shard_postings[shard_id].push((hash, *doc_id, freq));
+            }
+        }
+
+        // Phase 4: Parallel shard updates
+        shard_postings.into_par_iter().enumerate().for_each(|(shard_id, postings)| {
+            let mut shard = self.shards[shard_id].write();
+            for (hash, doc_id, freq) in postings {
+                shard.add_posting(hash, doc_id, freq);
+            }
+        });
+
+        self.block_maxes_dirty.store(1, Ordering::Relaxed);
+        Ok(num_docs)
+    }
+
+    /// Write the postings and doc lengths of `docs` to a new, synced
+    /// segment file. `docs` must start and end on segment boundaries, so
+    /// each mapped segment lies wholly inside or outside it; docs past the
+    /// mapped segments come from memory. Posting lists must be sorted by
+    /// doc ID, as `commit` leaves them.
+    fn write_segment(&self, path: &Path, docs: Range<u64>) -> Result<(), IndexError> {
+        let mapped = self.mapped.read();
+        let shards: Vec<_> = self.shards.iter().map(|shard| shard.read()).collect();
+        let doc_lengths = self.doc_lengths.read();
+        let mem_base = self.mem_base.load(Ordering::Relaxed);
+
+        let sources: Vec<&MappedSegment> = mapped
+            .iter()
+            .filter(|seg| docs.start <= seg.base_doc && seg.end_doc() <= docs.end)
+            .map(Arc::as_ref)
+            .collect();
+        let mem_docs = docs.start.max(mem_base)..docs.end.max(mem_base);
+        let covered =
+            sources.iter().map(|seg| seg.doc_count).sum::<u64>() + mem_docs.end - mem_docs.start;
+        if covered != docs.end - docs.start {
+            return Err(IndexError::Corrupted(format!(
+                "docs {}..{} are not in memory or whole segments",
+                docs.start, docs.end
+            )));
+        }
+        let mem_lengths =
+            &doc_lengths[(mem_docs.start - mem_base) as usize..(mem_docs.end - mem_base) as usize];
+
+        // Each term's runs in doc order: mapped segments first, then memory
+        let mut terms: FxHashMap<u64, Vec<Run<'_>>> = FxHashMap::default();
+        for seg in &sources {
+            for (i, &hash) in seg.file.get(&seg.hashes).iter().enumerate() {
+                let (ids, freqs) = seg.postings_at(i).ok_or_else(|| {
+                    IndexError::Corrupted(format!("{}: bad posting range", seg.path.display()))
+                })?;
+                terms.entry(hash).or_default().push(Run::Mapped(ids, freqs));
+            }
+        }
+        let (lo, hi) = (mem_docs.start as u32, mem_docs.end as u32);
+        for shard in &shards {
+            for (&hash, posting) in &shard.term_dict {
+                let entries = &posting.entries;
+                let from = entries.partition_point(|e| e.doc_id < lo);
+                let to = entries.partition_point(|e| e.doc_id < hi);
+                if from < to {
+                    terms
+                        .entry(hash)
+                        .or_default()
+                        .push(Run::Memory(&entries[from..to]));
+                }
+            }
+        }
+        let mut terms: Vec<_> = terms.into_iter().collect();
+        terms.par_sort_unstable_by_key(|(hash, _)| *hash);
+
+        let hashes: Vec<u64> = terms.iter().map(|(hash, _)| *hash).collect();
+        let mut starts = Vec::with_capacity(terms.len() + 1);
+        let mut posting_count = 0u64;
+        starts.push(0);
+        for (_, runs) in &terms {
+            posting_count += runs.iter().map(Run::len).sum::<usize>() as u64;
+            starts.push(posting_count);
+        }
+        let total_len = sources.iter().map(|seg| seg.total_len).sum::<u64>()
+            + mem_lengths.iter().map(|&len| len as u64).sum::<u64>();
+
+        let file = File::create(path)?;
+        let mut writer = SectionWriter::new(BufWriter::with_capacity(8 * 1024 * 1024, file));
+        writer.section(SEGMENT_MAGIC)?;
+        writer.section(&[
+            docs.start,
+            docs.end - docs.start,
+            total_len,
+            terms.len() as u64,
+            posting_count,
+        ])?;
+        writer.section(&hashes)?;
+        writer.section(&starts)?;
+
+        // Memory entries are packed pairs, split through a buffer
+        let mut doc_ids = Vec::new();
+        writer.begin()?;
+        for run in terms.iter().flat_map(|(_, runs)| runs) {
+            match *run {
+                Run::Mapped(ids, _) => writer.extend(ids)?,
+                Run::Memory(entries) => {
+                    doc_ids.clear();
+                    doc_ids.extend(entries.iter().map(|e| e.doc_id));
+                    writer.extend(&doc_ids)?;
+                }
+            }
+        }
+        let mut freqs = Vec::new();
+        writer.begin()?;
+        for run in terms.iter().flat_map(|(_, runs)| runs) {
+            match *run {
+                Run::Mapped(_, fs) => writer.extend(fs)?,
+                Run::Memory(entries) => {
+                    freqs.clear();
+                    freqs.extend(entries.iter().map(|e| e.freq));
+                    writer.extend(&freqs)?;
+                }
+            }
+        }
+
+        writer.begin()?;
+        for seg in &sources {
+            writer.extend(seg.doc_lengths())?;
         }
+        writer.extend(mem_lengths)?;
 
-        // Pre-allocate frequency map
-        let mut freqs: FxHashMap<u64, u16> = FxHashMap::with_capacity_and_hasher(
-            len / 6,
-            Default::default(),
-        );
+        let file = writer
+            .into_inner()
+            .into_inner()
+            .map_err(|e| e.into_error())?;
+        file.sync_all()?;
+        Ok(())
+    }
 
-        let mut i = 0;
+    /// Map every segment in `manifest`, oldest first
+    fn load_segments(&mut self, dir: &Path, manifest: SegmentManifest) -> Result<(), IndexError> {
+        self.clear();
 
-        // Main tokenization loop - minimal branching
-        while i < len {
-            // Skip non-alnum bytes
-            while i < len && CHAR_LUT[text[i] as usize] == 0 {
-                i += 1;
+        let mut mapped = Vec::with_capacity(manifest.segments.len());
+        for info in &manifest.segments {
+            let path = dir.join(&info.file);
+            let file = MappedFile::open(&path)?;
+            if file.bytes().starts_with(SEGMENT_MAGIC_V1) {
+                return self.load_segments_v1(dir, manifest);
             }
+            mapped.push(Arc::new(MappedSegment::open(path, file, info)?));
+        }
+
+        let doc_count = manifest.doc_count();
+        let total_doc_length = mapped.iter().map(|seg| seg.total_len).sum();
+        *self.mapped.get_mut() = mapped;
+        self.mem_base.store(doc_count, Ordering::Relaxed);
+        self.doc_count.store(doc_count, Ordering::Relaxed);
+        self.total_doc_length
+            .store(total_doc_length, Ordering::Relaxed);
+        *self.segments.get_mut() = manifest;
 
-            if i >= len {
-                break;
+        Ok(())
+    }
+
+    /// Search the segments in `manifest` in place from now on and drop the
+    /// in-memory copy of their docs. Skipped if docs were added during the
+    /// save: memory has to keep every doc past the mapped segments.
+    fn remap(&self, dir: &Path, manifest: &SegmentManifest) -> Result<(), IndexError> {
+        let doc_count = manifest.doc_count();
+        if self.doc_count.load(Ordering::Relaxed) != doc_count {
+            return Ok(());
+        }
+
+        let mut mapped = self.mapped.write();
+        let mut segments = Vec::with_capacity(manifest.segments.len());
+        for info in &manifest.segments {
+            let path = dir.join(&info.file);
+            match mapped.iter().find(|seg| seg.path == path) {
+                Some(seg) => segments.push(Arc::clone(seg)),
+                None => {
+                    let file = MappedFile::open(&path)?;
+                    segments.push(Arc::new(MappedSegment::open(path, file, info)?));
+                }
             }
+        }
+        *mapped = segments;
+
+        for shard_lock in &self.shards {
+            *shard_lock.write() = IndexShard::new();
+        }
+        self.doc_lengths.write().clear();
+        self.mem_base.store(doc_count, Ordering::Relaxed);
+        Ok(())
+    }
 
-            let start = i;
-            let mut hash = FNV_OFFSET;
+    /// Load segments in the unaligned format into memory. The next save
+    /// rewrites them as mappable segments.
+    fn load_segments_v1(
+        &mut self,
+        dir: &Path,
+        manifest: SegmentManifest,
+    ) -> Result<(), IndexError> {
+        self.clear();
 
-            // Hash while scanning token
-            while i < len {
-                let c = CHAR_LUT[text[i] as usize];
-                if c == 0 {
-                    break;
+        let mut buf2 = [0u8; 2];
+        let mut buf4 = [0u8; 4];
+        let mut buf8 = [0u8; 8];
+        let mut doc_lengths = Vec::with_capacity(manifest.doc_count() as usize);
+        let mut total_doc_length = 0u64;
+
+        for seg in &manifest.segments {
+            let file = File::open(dir.join(&seg.file))?;
+            let mut reader = BufReader::with_capacity(8 * 1024 * 1024, file);
+
+            reader.read_exact(&mut buf4)?;
+            if &buf4 != SEGMENT_MAGIC_V1 {
+                return Err(IndexError::Corrupted(format!("{}: bad magic", seg.file)));
+            }
+            reader.read_exact(&mut buf8)?;
+            let base_doc = u64::from_le_bytes(buf8);
+            reader.read_exact(&mut buf8)?;
+            let doc_count = u64::from_le_bytes(buf8);
+            if base_doc != seg.base_doc || doc_count != seg.doc_count {
+                return Err(IndexError::Corrupted(format!(
+                    "{}: docs {}+{} do not match the manifest",
+                    seg.file, base_doc, doc_count
+                )));
+            }
+            reader.read_exact(&mut buf8)?;
+            total_doc_length += u64::from_le_bytes(buf8);
+
+            for _ in 0..NUM_SHARDS {
+                reader.read_exact(&mut buf8)?;
+                let term_count = u64::from_le_bytes(buf8);
+
+                for _ in 0..term_count {
+                    reader.read_exact(&mut buf8)?;
+                    let hash = u64::from_le_bytes(buf8);
+                    reader.read_exact(&mut buf8)?;
+                    let entry_count = u64::from_le_bytes(buf8) as usize;
+
+                    // Segments are in doc order, so appending keeps lists sorted
+                    let shard = self.shards[Self::shard_for_hash(hash)].get_mut();
+                    let posting = shard
+                        .term_dict
+                        .entry(hash)
+                        .or_insert_with(PostingList::new);
+                    posting.entries.reserve(entry_count);
+                    for _ in 0..entry_count {
+                        reader.read_exact(&mut buf4)?;
+                        let doc_id = u32::from_le_bytes(buf4);
+                        reader.read_exact(&mut buf2)?;
+                        let freq = u16::from_le_bytes(buf2);
+                        posting.push(doc_id, freq);
+                    }
                 }
-                hash ^= c as u64;
-                hash = hash.wrapping_mul(FNV_PRIME);
-                i += 1;
             }
 
-            // Only keep tokens of reasonable length
-            let token_len = i - start;
-            if token_len >= 2 && token_len <= 32 {
-                *freqs.entry(hash).or_insert(0) += 1;
+            for _ in 0..doc_count {
+                reader.read_exact(&mut buf2)?;
+                doc_lengths.push(u16::from_le_bytes(buf2));
+            }
+        }
+
+        *self.doc_lengths.get_mut() = doc_lengths;
+        self.doc_count.store(manifest.doc_count(), Ordering::Relaxed);
+        self.total_doc_length
+            .store(total_doc_length, Ordering::Relaxed);
+        self.block_maxes_dirty.store(1, Ordering::Relaxed);
+        *self.segments.get_mut() = SegmentManifest {
+            segments: Vec::new(),
+            next_seq: manifest.next_seq,
+        };
+
+        Ok(())
+    }
+
+    /// Load the single-file format that predates segments
+    fn load_legacy(&mut self, path: &Path) -> Result<(), IndexError> {
+        let idx_path = path.join(LEGACY_FILE);
+        if !idx_path.exists() {
+            return Ok(());
+        }
+
+        let file = File::open(idx_path)?;
+        let mut reader = BufReader::with_capacity(8 * 1024 * 1024, file);
+
+        let mut magic = [0u8; 4];
+        reader.read_exact(&mut magic)?;
+
+        let mut buf2 = [0u8; 2];
+        let mut buf4 = [0u8; 4];
+        let mut buf8 = [0u8; 8];
+
+        reader.read_exact(&mut buf4)?; // version
+
+        reader.read_exact(&mut buf8)?;
+        let doc_count = u64::from_le_bytes(buf8);
+
+        reader.read_exact(&mut buf8)?;
+        let total_doc_length = u64::from_le_bytes(buf8);
+        self.total_doc_length.store(total_doc_length, Ordering::Relaxed);
+
+        if &magic == b"ULT5" {
+            // New sharded format
+            reader.read_exact(&mut buf8)?;
+            let num_shards = u64::from_le_bytes(buf8) as usize;
+
+            self.clear();
+
+            for shard_id in 0..num_shards.min(NUM_SHARDS) {
+                reader.read_exact(&mut buf8)?;
+                let term_count = u64::from_le_bytes(buf8) as usize;
+
+                let mut shard = self.shards[shard_id].write();
+                shard.term_dict.reserve(term_count);
+
+                for _ in 0..term_count {
+                    reader.read_exact(&mut buf8)?;
+                    let hash = u64::from_le_bytes(buf8);
+                    reader.read_exact(&mut buf4)?;
+                    let df = u32::from_le_bytes(buf4);
+                    reader.read_exact(&mut buf4)?;
+                    let idf = f32::from_le_bytes(buf4);
+                    reader.read_exact(&mut buf8)?;
+                    let entry_count = u64::from_le_bytes(buf8) as usize;
+
+                    let mut entries = Vec::with_capacity(entry_count);
+                    for _ in 0..entry_count {
+                        reader.read_exact(&mut buf4)?;
+                        let doc_id = u32::from_le_bytes(buf4);
+                        reader.read_exact(&mut buf2)?;
+                        let freq = u16::from_le_bytes(buf2);
+                        entries.push(PostingEntry { doc_id, freq });
+                    }
+
+                    shard.term_dict.insert(
+                        hash,
+                        PostingList {
+                            entries,
+                            block_maxes: Vec::new(),
+                            df: AtomicU32::new(df),
+                            idf,
+                        },
+                    );
+                }
             }
+        } else {
+            // Skip old format loading - not compatible
+            return Err(IndexError::Corrupted("Old index format not supported".into()));
         }
 
-        freqs.into_iter().collect()
+        // Read doc lengths
+        let mut doc_lengths = Vec::with_capacity(doc_count as usize);
+        for _ in 0..doc_count {
+            reader.read_exact(&mut buf2)?;
+            doc_lengths.push(u16::from_le_bytes(buf2));
+        }
+
+        *self.doc_lengths.write() = doc_lengths;
+        self.doc_count.store(doc_count, Ordering::Relaxed);
+        self.block_maxes_dirty.store(1, Ordering::Relaxed);
+
+        Ok(())
+    }
+
+    /// Ultra-fast tokenization with batch output
+    /// Returns: Vec<(hash, freq)> - one allocation, reusing `buf`
+    #[inline]
+    fn tokenize_batch(buf: &mut TermBuffer, text: &str) -> Vec<(u64, u16)> {
+        TOKENIZER.tokenize_hashed(text, buf);
+        buf.terms().iter().map(|t| (t.hash, t.freq)).collect()
     }
 
     /// Compute block max scores
@@ -220,6 +719,7 @@ impl UltraProfile {
         let avg_doc_len = total_len / total_docs;
 
         let doc_lengths = self.doc_lengths.read();
+        let mem_base = self.mem_base.load(Ordering::Relaxed) as usize;
         let bm25 = &self.bm25;
 
         self.shards.par_iter().for_each(|shard_lock| {
@@ -235,7 +735,7 @@ impl UltraProfile {
                 for chunk in posting.entries.chunks(BLOCK_SIZE) {
                     let mut max_score = 0.0f32;
                     for entry in chunk {
-                        let doc_id = entry.doc_id as usize;
+                        let doc_id = entry.doc_id as usize - mem_base;
                         if doc_id < doc_lengths.len() {
                             let doc_len = doc_lengths[doc_id] as f32;
                             let score = bm25.score(
@@ -257,14 +757,23 @@ impl UltraProfile {
     }
 
     /// Fast search implementation
-    fn search_internal(&self, query: &str, limit: usize, offset: usize) -> Vec<SearchHit> {
+    fn search_internal(
+        &self,
+        query: &str,
+        limit: usize,
+        offset: usize,
+        after: Option<SearchCursor>,
+        out: &mut HitBuffer,
+    ) {
         self.compute_block_maxes();
 
+        let mapped = self.mapped.read();
         let doc_lengths = self.doc_lengths.read();
+        let mem_base = self.mem_base.load(Ordering::Relaxed) as usize;
         let doc_count = self.doc_count.load(Ordering::Relaxed);
 
         if doc_count == 0 {
-            return Vec::new();
+            return;
         }
 
         let total_docs = doc_count as f32;
@@ -272,37 +781,60 @@ impl UltraProfile {
         let avg_doc_len = total_len / total_docs;
 
         // Tokenize query
-        let query_terms = Self::tokenize_batch(query.as_bytes());
+        let query_terms = Self::tokenize_batch(&mut TermBuffer::default(), query);
         if query_terms.is_empty() {
-            return Vec::new();
+            return;
         }
 
         // Score documents
-        let k = limit + offset;
-        let mut top_k: BinaryHeap<Reverse<(OrderedFloat, u32)>> = BinaryHeap::with_capacity(k + 1);
-        let mut threshold = 0.0f32;
+        let mut top_k = TopK::new(limit + offset, after);
         let mut scored: FxHashMap<u32, f32> = FxHashMap::default();
 
         // Search each shard for matching terms
         for (hash, _) in &query_terms {
             let shard_id = Self::shard_for_hash(*hash);
             let shard = self.shards[shard_id].read();
+            let memory = shard.term_dict.get(hash);
+            let runs: Vec<_> = mapped
+                .iter()
+                .filter_map(|seg| Some((seg, seg.postings(*hash)?)))
+                .collect();
+            let df = runs
+                .iter()
+                .map(|(_, (ids, _))| ids.len() as u32)
+                .sum::<u32>()
+                + memory.map_or(0, |posting| posting.df.load(Ordering::Relaxed));
+
+            for (seg, (ids, freqs)) in runs {
+                let lengths = seg.doc_lengths();
+                for (&doc_id, &freq) in ids.iter().zip(freqs) {
+                    // Out-of-range IDs in a damaged file wrap and are skipped
+                    let i = (doc_id as u64).wrapping_sub(seg.base_doc) as usize;
+                    if i < lengths.len() {
+                        let score = self.bm25.score(
+                            freq as f32,
+                            df as f32,
+                            lengths[i] as f32,
+                            avg_doc_len,
+                            total_docs,
+                        );
+                        *scored.entry(doc_id).or_insert(0.0) += score;
+                    }
+                }
+            }
 
-            if let Some(posting) = shard.term_dict.get(hash) {
-                let df = posting.df.load(Ordering::Relaxed);
-
+            if let Some(posting) = memory {
                 for (block_idx, chunk) in posting.entries.chunks(BLOCK_SIZE).enumerate() {
                     if block_idx < posting.block_maxes.len()
-                        && posting.block_maxes[block_idx] < threshold
-                        && !top_k.is_empty()
+                        && posting.block_maxes[block_idx] < top_k.threshold()
                     {
                         continue;
                     }
 
                     for entry in chunk {
                         let doc_id = entry.doc_id;
-                        if (doc_id as usize) < doc_lengths.len() {
-                            let doc_len = doc_lengths[doc_id as usize] as f32;
+                        if (doc_id as usize - mem_base) < doc_lengths.len() {
+                            let doc_len = doc_lengths[doc_id as usize - mem_base] as f32;
                             let score = self.bm25.score(
                                 entry.freq as f32,
                                 df as f32,
@@ -318,26 +850,12 @@ impl UltraProfile {
         }
 
         for (doc_id, score) in scored {
-            let entry = Reverse((OrderedFloat(score), doc_id));
-            if top_k.len() < k {
-                top_k.push(entry);
-                if top_k.len() == k {
-                    threshold = top_k.peek().unwrap().0 .0 .0;
-                }
-            } else if score > threshold {
-                top_k.pop();
-                top_k.push(entry);
-                threshold = top_k.peek().unwrap().0 .0 .0;
-            }
+            top_k.push(score, doc_id);
         }
 
-        top_k
-            .into_sorted_vec()
-            .into_iter()
-            .skip(offset)
-            .take(limit)
-            .map(|Reverse((score, doc_id))| SearchHit::new(format!("doc_{}", doc_id), score.0))
-            .collect()
+        top_k.into_hits(offset, limit, out, |doc_id, ids| {
+            let _ = write!(ids, "doc_{}", doc_id);
+        })
     }
 }
 
@@ -356,59 +874,12 @@ impl SearchProfile for UltraProfile {
         ProfileType::Ultra
     }
 
-    fn index_batch(&mut self, docs: &[Document]) -> Result<usize, IndexError> {
-        if docs.is_empty() {
-            return Ok(0);
-        }
-
-        let base_doc_id = self.doc_count.load(Ordering::Relaxed) as u32;
-        let num_docs = docs.len();
-
-        // Phase 1: Parallel tokenization - collect (doc_id, doc_len, terms)
-        // Terms already include shard_id to avoid recomputation
-        let tokenized: Vec<_> = docs
-            .par_iter()
-            .enumerate()
-            .map(|(i, doc)| {
-                let doc_id = base_doc_id + i as u32;
-                let terms = Self::tokenize_batch(doc.text.as_bytes());
-                let doc_len: u32 = terms.iter().map(|(_, f)| *f as u32).sum();
-                (doc_id, doc_len.min(u16::MAX as u32) as u16, terms)
-            })
-            .collect();
-
-        // Phase 2: Collect doc lengths and update counts
-        let total_len: u64 = tokenized.iter().map(|(_, len, _)| *len as u64).sum();
-        self.doc_count.fetch_add(num_docs as u64, Ordering::Relaxed);
-        self.total_doc_length.fetch_add(total_len, Ordering::Relaxed);
-
-        {
-            let mut doc_lengths = self.doc_lengths.write();
-            doc_lengths.extend(tokenized.iter().map(|(_, len, _)| *len));
-        }
-
-        // Phase 3: Sequential aggregate - fastest approach
-        let mut shard_postings: Vec<Vec<(u64, u32, u16)>> = (0..NUM_SHARDS)
-            .map(|_| Vec::new())
-            .collect();
-
-        for (doc_id, _, terms) in &tokenized {
-            for &(hash, freq) in terms {
-                let shard_id = Self::shard_for_hash(hash);
-                shard_postings[shard_id].push((hash, *doc_id, freq));
-            }
-        }
-
-        // Phase 4: Parallel shard updates
-        shard_postings.into_par_iter().enumerate().for_each(|(shard_id, postings)| {
-            let mut shard = self.shards[shard_id].write();
-            for (hash, doc_id, freq) in postings {
-                shard.add_posting(hash, doc_id, freq);
-            }
-        });
+    fn index_batch_refs(&mut self, docs: &[DocumentRef<'_>]) -> Result<usize, IndexError> {
+        self.add_docs(docs)
+    }
 
-        self.block_maxes_dirty.store(1, Ordering::Relaxed);
-        Ok(num_docs)
+    fn index_batch_shared(&self, docs: &[DocumentRef<'_>]) -> Option<Result<usize, IndexError>> {
+        Some(self.add_docs(docs))
     }
 
     fn commit(&mut self) -> Result<(), IndexError> {
@@ -418,6 +889,10 @@ impl SearchProfile for UltraProfile {
             self.shards.par_iter().for_each(|shard_lock| {
                 let mut shard = shard_lock.write();
                 for posting in shard.term_dict.values_mut() {
+                    // Concurrent batches append their doc ranges in any order
+                    if !posting.entries.is_sorted_by_key(|e| e.doc_id) {
+                        posting.entries.sort_unstable_by_key(|e| e.doc_id);
+                    }
                     let df = posting.df.load(Ordering::Relaxed);
                     posting.idf = ((total_docs - df as f32 + 0.5) / (df as f32 + 0.5) + 1.0).ln();
                 }
@@ -429,15 +904,83 @@ impl SearchProfile for UltraProfile {
 
     fn search(&self, query: &str, limit: usize, offset: usize) -> Result<SearchResult, SearchError> {
         let start = Instant::now();
-        let hits = self.search_internal(query, limit, offset);
-        let total = hits.len() as u64;
-
-        Ok(SearchResult {
-            hits,
-            total,
-            duration: start.elapsed(),
-            profile: self.name().to_string(),
-        })
+        let mut out = HitBuffer::new();
+        self.search_hits(query, limit, offset, &mut out)?;
+        Ok(out.to_result(self.name(), start.elapsed()))
+    }
+
+    fn search_hits(
+        &self,
+        query: &str,
+        limit: usize,
+        offset: usize,
+        out: &mut HitBuffer,
+    ) -> Result<(), SearchError> {
+        out.clear();
+        self.search_internal(query, limit, offset, None, out);
+        out.total = out.len() as u64;
+        Ok(())
+    }
+
+    fn search_after(
+        &self,
+        query: &str,
+        limit: usize,
+        after: Option<SearchCursor>,
+    ) -> Result<SearchResult, SearchError> {
+        let start = Instant::now();
+        let mut out = HitBuffer::new();
+        self.search_internal(query, limit, 0, after, &mut out);
+        out.total = out.len() as u64;
+        Ok(out.to_result(self.name(), start.elapsed()))
+    }
+
+    fn count_hits(&self, query: &str, mode: TotalMode) -> Result<u64, SearchError> {
+        let mut hashes: Vec<u64> = Self::tokenize_batch(&mut TermBuffer::default(), query)
+            .into_iter()
+            .map(|(hash, _)| hash)
+            .collect();
+        hashes.sort_unstable();
+        hashes.dedup();
+
+        // Read-lock the query's shards in shard order, as saving does
+        let mut needed = [false; NUM_SHARDS];
+        for &hash in &hashes {
+            needed[Self::shard_for_hash(hash)] = true;
+        }
+        let shards: Vec<_> = self
+            .shards
+            .iter()
+            .zip(needed)
+            .map(|(shard, needed)| needed.then(|| shard.read()))
+            .collect();
+        let mapped = self.mapped.read();
+
+        // Segments hold ascending doc ranges, all below the in-memory docs
+        let runs: Vec<Vec<Run<'_>>> = hashes
+            .iter()
+            .map(|hash| {
+                let memory = shards[Self::shard_for_hash(*hash)]
+                    .as_ref()
+                    .and_then(|shard| shard.term_dict.get(hash));
+                mapped
+                    .iter()
+                    .filter_map(|seg| seg.postings(*hash))
+                    .map(|(ids, freqs)| Run::Mapped(ids, freqs))
+                    .chain(memory.map(|posting| Run::Memory(&posting.entries)))
+                    .collect()
+            })
+            .collect();
+        let parts: Vec<Parts<'_>> = runs
+            .iter()
+            .map(|runs| Parts::new(runs.iter().map(|run| run as &dyn TermDocs)))
+            .collect();
+        let parts: Vec<&dyn TermDocs> = parts.iter().map(|p| p as &dyn TermDocs).collect();
+        Ok(count_matches(
+            &parts,
+            self.doc_count.load(Ordering::Relaxed),
+            mode,
+        ))
     }
 
     fn memory_stats(&self) -> MemoryStats {
@@ -453,144 +996,85 @@ impl SearchProfile for UltraProfile {
             }
         }
         let doc_lengths_bytes = doc_lengths.len() * 2;
+        let mmap_bytes: usize = self.mapped.read().iter().map(|seg| seg.file.len()).sum();
 
         MemoryStats {
-            index_bytes: (term_dict_bytes + postings_bytes + doc_lengths_bytes) as u64,
+            index_bytes: (term_dict_bytes + postings_bytes + doc_lengths_bytes + mmap_bytes) as u64,
             term_dict_bytes: term_dict_bytes as u64,
             postings_bytes: postings_bytes as u64,
             docs_indexed: self.doc_count.load(Ordering::Relaxed),
-            mmap_bytes: 0,
+            mmap_bytes: mmap_bytes as u64,
         }
     }
 
+    /// Write the documents added since the last save as a new segment,
+    /// merge full size tiers, then publish the result in the manifest.
+    /// Segments already on disk are reused only if `path` holds the
+    /// manifest they were saved under; otherwise everything is rewritten.
+    /// Afterwards the saved docs are searched from the mapped segments.
     fn save(&self, path: &Path) -> Result<(), IndexError> {
-        let file = File::create(path.join("ultra.idx"))?;
-        let mut writer = BufWriter::with_capacity(8 * 1024 * 1024, file);
-
-        writer.write_all(b"ULT5")?; // New version for sharded format
-        writer.write_all(&5u32.to_le_bytes())?;
+        let on_disk = SegmentManifest::read(path, SEGMENT_PREFIX)?.unwrap_or_default();
+        let mut persisted = self.segments.write();
+        let mut manifest = if *persisted == on_disk {
+            on_disk.clone()
+        } else {
+            SegmentManifest {
+                segments: Vec::new(),
+                next_seq: on_disk.next_seq,
+            }
+        };
 
-        let doc_lengths = self.doc_lengths.read();
         let doc_count = self.doc_count.load(Ordering::Relaxed);
-        let total_doc_length = self.total_doc_length.load(Ordering::Relaxed);
-
-        writer.write_all(&doc_count.to_le_bytes())?;
-        writer.write_all(&total_doc_length.to_le_bytes())?;
-        writer.write_all(&(NUM_SHARDS as u64).to_le_bytes())?;
-
-        // Write each shard
-        for shard_lock in &self.shards {
-            let shard = shard_lock.read();
-            writer.write_all(&(shard.term_dict.len() as u64).to_le_bytes())?;
+        let start = manifest.doc_count();
+        if doc_count > start {
+            let file = manifest.next_file(SEGMENT_PREFIX);
+            self.write_segment(&path.join(&file), start..doc_count)?;
+            manifest.segments.push(SegmentInfo {
+                file,
+                base_doc: start,
+                doc_count: doc_count - start,
+            });
+        }
 
-            for (hash, posting) in &shard.term_dict {
-                writer.write_all(&hash.to_le_bytes())?;
-                let df = posting.df.load(Ordering::Relaxed);
-                writer.write_all(&df.to_le_bytes())?;
-                writer.write_all(&posting.idf.to_le_bytes())?;
-                writer.write_all(&(posting.entries.len() as u64).to_le_bytes())?;
-                for entry in &posting.entries {
-                    writer.write_all(&entry.doc_id.to_le_bytes())?;
-                    writer.write_all(&entry.freq.to_le_bytes())?;
-                }
-            }
+        while let Some(range) = manifest.merge_candidates() {
+            let first = manifest.segments[range.start].base_doc;
+            let docs = first..manifest.segments[range.end - 1].end_doc();
+            let file = manifest.next_file(SEGMENT_PREFIX);
+            self.write_segment(&path.join(&file), docs.clone())?;
+            manifest.segments.splice(
+                range,
+                [SegmentInfo {
+                    file,
+                    base_doc: docs.start,
+                    doc_count: docs.end - docs.start,
+                }],
+            );
         }
 
-        // Write doc lengths
-        for &len in doc_lengths.iter() {
-            writer.write_all(&len.to_le_bytes())?;
+        manifest.write(path, SEGMENT_PREFIX)?;
+        self.remap(path, &manifest)?;
+        // Older generations may still map removed files, which stay
+        // readable until unmapped
+        manifest.remove_obsolete(path, &on_disk)?;
+        match std::fs::remove_file(path.join(LEGACY_FILE)) {
+            Ok(()) => {}
+            Err(e) if e.kind() == std::io::ErrorKind::NotFound => {}
+            Err(e) => return Err(e.into()),
         }
 
-        writer.flush()?;
+        *persisted = manifest;
         Ok(())
     }
 
     fn load(&mut self, path: &Path) -> Result<(), IndexError> {
-        let idx_path = path.join("ultra.idx");
-        if !idx_path.exists() {
-            return Ok(());
+        match SegmentManifest::read(path, SEGMENT_PREFIX)? {
+            Some(manifest) => self.load_segments(path, manifest),
+            None => self.load_legacy(path),
         }
+    }
 
-        let file = File::open(idx_path)?;
-        let mut reader = BufReader::with_capacity(8 * 1024 * 1024, file);
-
-        let mut magic = [0u8; 4];
-        reader.read_exact(&mut magic)?;
-
-        let mut buf2 = [0u8; 2];
-        let mut buf4 = [0u8; 4];
-        let mut buf8 = [0u8; 8];
-
-        reader.read_exact(&mut buf4)?; // version
-
-        reader.read_exact(&mut buf8)?;
-        let doc_count = u64::from_le_bytes(buf8);
-
-        reader.read_exact(&mut buf8)?;
-        let total_doc_length = u64::from_le_bytes(buf8);
-        self.total_doc_length.store(total_doc_length, Ordering::Relaxed);
-
-        if &magic == b"ULT5" {
-            // New sharded format
-            reader.read_exact(&mut buf8)?;
-            let num_shards = u64::from_le_bytes(buf8) as usize;
-
-            self.clear();
-
-            for shard_id in 0..num_shards.min(NUM_SHARDS) {
-                reader.read_exact(&mut buf8)?;
-                let term_count = u64::from_le_bytes(buf8) as usize;
-
-                let mut shard = self.shards[shard_id].write();
-                shard.term_dict.reserve(term_count);
-
-                for _ in 0..term_count {
-                    reader.read_exact(&mut buf8)?;
-                    let hash = u64::from_le_bytes(buf8);
-                    reader.read_exact(&mut buf4)?;
-                    let df = u32::from_le_bytes(buf4);
-                    reader.read_exact(&mut buf4)?;
-                    let idf = f32::from_le_bytes(buf4);
-                    reader.read_exact(&mut buf8)?;
-                    let entry_count = u64::from_le_bytes(buf8) as usize;
-
-                    let mut entries = Vec::with_capacity(entry_count);
-                    for _ in 0..entry_count {
-                        reader.read_exact(&mut buf4)?;
-                        let doc_id = u32::from_le_bytes(buf4);
-                        reader.read_exact(&mut buf2)?;
-                        let freq = u16::from_le_bytes(buf2);
-                        entries.push(PostingEntry { doc_id, freq });
-                    }
-
-                    shard.term_dict.insert(
-                        hash,
-                        PostingList {
-                            entries,
-                            block_maxes: Vec::new(),
-                            df: AtomicU32::new(df),
-                            idf,
-                        },
-                    );
-                }
-            }
-        } else {
-            // Skip old format loading - not compatible
-            return Err(IndexError::Corrupted("Old index format not supported".into()));
-        }
-
-        // Read doc lengths
-        let mut doc_lengths = Vec::with_capacity(doc_count as usize);
-        for _ in 0..doc_count {
-            reader.read_exact(&mut buf2)?;
-            doc_lengths.push(u16::from_le_bytes(buf2));
-        }
-
-        *self.doc_lengths.write() = doc_lengths;
-        self.doc_count.store(doc_count, Ordering::Relaxed);
-        self.block_maxes_dirty.store(1, Ordering::Relaxed);
-
-        Ok(())
+    fn atomic_save(&self) -> bool {
+        true
     }
 
     fn doc_count(&self) -> u64 {
@@ -602,33 +1086,55 @@ impl SearchProfile for UltraProfile {
             shard_lock.write().clear();
         }
         self.doc_lengths.write().clear();
+        self.mapped.write().clear();
+        self.mem_base.store(0, Ordering::Relaxed);
         self.doc_count.store(0, Ordering::Relaxed);
         self.total_doc_length.store(0, Ordering::Relaxed);
         self.block_maxes_dirty.store(1, Ordering::Relaxed);
+        *self.segments.write() = SegmentManifest::default();
     }
-}
-
-/// Ordered float for heap
-#[derive(Debug, Clone, Copy, PartialEq)]
-struct OrderedFloat(f32);
-
-impl Ord for OrderedFloat {
-    fn cmp(&self, other: &Self) -> std::cmp::Ordering {
-        self.0.partial_cmp(&other.0).unwrap_or(std::cmp::Ordering::Equal)
-    }
-}
 
-impl PartialOrd for OrderedFloat {
-    fn partial_cmp(&self, other: &Self) -> Option<std::cmp::Ordering> {
-        Some(self.cmp(other))
+    /// A view over the same mapped segments. Docs not yet remapped (those
+    /// of an unaligned load, or of a save that raced a write) are copied.
+    fn snapshot(&self) -> Result<Box<dyn SearchProfile>, IndexError> {
+        let doc_count = self.doc_count.load(Ordering::Relaxed);
+        let mem_base = self.mem_base.load(Ordering::Relaxed);
+        let (shards, doc_lengths) = if mem_base == doc_count {
+            let shards = (0..NUM_SHARDS)
+                .map(|_| {
+                    RwLock::new(IndexShard {
+                        term_dict: FxHashMap::default(),
+                    })
+                })
+                .collect();
+            (shards, Vec::new())
+        } else {
+            let shards = self
+                .shards
+                .iter()
+                .map(|shard| RwLock::new(shard.read().clone()))
+                .collect();
+            (shards, self.doc_lengths.read().clone())
+        };
+        Ok(Box::new(Self {
+            shards,
+            doc_lengths: RwLock::new(doc_lengths),
+            mapped: RwLock::new(self.mapped.read().clone()),
+            mem_base: AtomicU64::new(mem_base),
+            doc_count: AtomicU64::new(doc_count),
+            total_doc_length: AtomicU64::new(self.total_doc_length.load(Ordering::Relaxed)),
+            bm25: self.bm25,
+            block_maxes_dirty: AtomicU32::new(self.block_maxes_dirty.load(Ordering::Relaxed)),
+            segments: RwLock::new(self.segments.read().clone()),
+        }))
     }
 }
 
-impl Eq for OrderedFloat {}
-
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::document::Document;
+    use crate::segments::MERGE_FACTOR;
 
     #[test]
     fn test_ultra_basic() {
@@ -646,6 +1152,75 @@ mod tests {
         assert!(!result.hits.is_empty());
     }
 
+    #[test]
+    fn test_ultra_segments() {
+        let dir = tempfile::tempdir().unwrap();
+        let mut profile = UltraProfile::new();
+
+        // Each save writes only the new batch
+        for i in 0..MERGE_FACTOR - 1 {
+            profile
+                .index_batch(&[Document::new(i.to_string(), "segmented rust index")])
+                .unwrap();
+            profile.commit().unwrap();
+            profile.save(dir.path()).unwrap();
+        }
+        let manifest = SegmentManifest::read(dir.path(), SEGMENT_PREFIX).unwrap().unwrap();
+        assert_eq!(manifest.segments.len(), MERGE_FACTOR - 1);
+        assert_eq!(manifest.segments[2].base_doc, 2);
+
+        // A full tier is merged into one segment
+        profile
+            .index_batch(&[Document::new("last", "segmented rust merge")])
+            .unwrap();
+        profile.commit().unwrap();
+        profile.save(dir.path()).unwrap();
+        let merged = SegmentManifest::read(dir.path(), SEGMENT_PREFIX).unwrap().unwrap();
+        assert_eq!(merged.segments.len(), 1);
+        assert_eq!(merged.doc_count(), MERGE_FACTOR as u64);
+        assert!(!dir.path().join(&manifest.segments[0].file).exists());
+
+        let mut loaded = UltraProfile::new();
+        loaded.load(dir.path()).unwrap();
+        assert_eq!(loaded.doc_count(), MERGE_FACTOR as u64);
+        assert_eq!(loaded.search("rust", 100, 0).unwrap().hits.len(), MERGE_FACTOR);
+        assert_eq!(loaded.search("merge", 10, 0).unwrap().hits.len(), 1);
+    }
+
+    #[test]
+    fn test_ultra_mapped_reopen() {
+        let dir = tempfile::tempdir().unwrap();
+        let mut profile = UltraProfile::new();
+        profile
+            .index_batch(&[
+                Document::new("a", "mapped rust segment"),
+                Document::new("b", "mapped go segment"),
+            ])
+            .unwrap();
+        profile.commit().unwrap();
+        profile.save(dir.path()).unwrap();
+
+        // Saved docs are served from the mapping, new ones from memory
+        let mut loaded = UltraProfile::new();
+        loaded.load(dir.path()).unwrap();
+        assert!(loaded.memory_stats().mmap_bytes > 0);
+        assert_eq!(loaded.search("mapped", 10, 0).unwrap().hits.len(), 2);
+        loaded
+            .index_batch(&[Document::new("c", "fresh rust doc")])
+            .unwrap();
+        loaded.commit().unwrap();
+        let hits = loaded.search("rust", 10, 0).unwrap().hits;
+        let mut ids: Vec<_> = hits.iter().map(|h| h.id.as_str()).collect();
+        ids.sort();
+        assert_eq!(ids, ["doc_0", "doc_2"]);
+
+        loaded.save(dir.path()).unwrap();
+        let snapshot = loaded.snapshot().unwrap();
+        assert_eq!(snapshot.doc_count(), 3);
+        assert_eq!(snapshot.search("rust", 10, 0).unwrap().hits.len(), 2);
+        assert_eq!(snapshot.memory_stats().postings_bytes, 0);
+    }
+
     #[test]
     fn test_ultra_million_throughput() {
         let mut profile = UltraProfile::new();
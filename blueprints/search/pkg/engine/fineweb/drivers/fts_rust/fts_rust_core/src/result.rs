@@ -29,6 +29,42 @@ impl SearchHit {
     }
 }
 
+/// Position after a hit, for deep paging with `search_after`
+///
+/// Hits rank by score, highest first, then by internal doc ID, lowest
+/// first. The next page holds the hits ranked strictly after the cursor.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct SearchCursor {
+    pub score: f32,
+    pub doc: u32,
+}
+
+impl SearchCursor {
+    pub fn new(score: f32, doc: u32) -> Self {
+        Self { score, doc }
+    }
+
+    /// Whether a hit ranks after the cursor
+    #[inline]
+    pub fn admits(&self, score: f32, doc: u32) -> bool {
+        score < self.score || (score == self.score && doc > self.doc)
+    }
+
+    /// Opaque token of 16 hex digits
+    pub fn encode(&self) -> String {
+        format!("{:08x}{:08x}", self.score.to_bits(), self.doc)
+    }
+
+    pub fn decode(token: &str) -> Option<Self> {
+        if token.len() != 16 || !token.bytes().all(|b| b.is_ascii_hexdigit()) {
+            return None;
+        }
+        let score = u32::from_str_radix(&token[..8], 16).ok()?;
+        let doc = u32::from_str_radix(&token[8..], 16).ok()?;
+        Some(Self::new(f32::from_bits(score), doc))
+    }
+}
+
 /// Search result containing hits and metadata
 #[derive(Debug, Clone)]
 pub struct SearchResult {
@@ -40,6 +76,8 @@ pub struct SearchResult {
     pub duration: Duration,
     /// Profile used for search
     pub profile: String,
+    /// Cursor after the last hit, if the page was full
+    pub next: Option<SearchCursor>,
 }
 
 impl SearchResult {
@@ -49,10 +87,153 @@ impl SearchResult {
             total: 0,
             duration: Duration::ZERO,
             profile: profile.into(),
+            next: None,
         }
     }
 }
 
+/// One page of hits packed for reuse: each hit's score and the end of its
+/// ID in a shared string. A buffer kept across queries stops allocating
+/// once it has grown, whatever the page holds.
+#[derive(Debug, Clone, Default)]
+pub struct HitBuffer {
+    /// (score, end of the ID in `ids`), best first
+    hits: Vec<(f32, usize)>,
+    ids: String,
+    /// Total matching documents (may be estimate)
+    pub total: u64,
+    /// Cursor after the last hit, if the page was full
+    pub next: Option<SearchCursor>,
+}
+
+impl HitBuffer {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Empty the buffer, keeping its capacity
+    pub fn clear(&mut self) {
+        self.hits.clear();
+        self.ids.clear();
+        self.total = 0;
+        self.next = None;
+    }
+
+    /// Append a hit whose ID `write_id` appends to the ID string
+    #[inline]
+    pub fn push_with(&mut self, score: f32, write_id: impl FnOnce(&mut String)) {
+        write_id(&mut self.ids);
+        self.hits.push((score, self.ids.len()));
+    }
+
+    pub fn push(&mut self, score: f32, id: &str) {
+        self.push_with(score, |ids| ids.push_str(id));
+    }
+
+    pub fn len(&self) -> usize {
+        self.hits.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.hits.is_empty()
+    }
+
+    /// Bytes of all hit IDs together
+    pub fn id_bytes(&self) -> usize {
+        self.ids.len()
+    }
+
+    /// (score, ID) of each hit, best first
+    pub fn iter(&self) -> impl Iterator<Item = (f32, &str)> + '_ {
+        let starts = std::iter::once(0).chain(self.hits.iter().map(|&(_, end)| end));
+        self.hits
+            .iter()
+            .zip(starts)
+            .map(|(&(score, end), start)| (score, &self.ids[start..end]))
+    }
+
+    /// Replace the contents with the hits of `result`
+    pub fn fill_from(&mut self, result: &SearchResult) {
+        self.clear();
+        for hit in &result.hits {
+            self.push(hit.score, &hit.id);
+        }
+        self.total = result.total;
+        self.next = result.next;
+    }
+
+    /// Copy into a `SearchResult`, one `String` per hit
+    pub fn to_result(&self, profile: &str, duration: Duration) -> SearchResult {
+        SearchResult {
+            hits: self
+                .iter()
+                .map(|(score, id)| SearchHit::new(id, score))
+                .collect(),
+            total: self.total,
+            duration,
+            profile: profile.to_string(),
+            next: self.next,
+        }
+    }
+}
+
+/// How to count the documents matching a query
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum TotalMode {
+    /// Enumerate every match (no scoring, but no pruning either)
+    Exact,
+    /// The largest document frequency among the query terms: free, and
+    /// exact for single-term queries
+    LowerBound,
+    /// Extrapolated from document frequencies and a sample of postings
+    Estimate,
+}
+
+impl TotalMode {
+    pub fn parse(s: &str) -> Option<Self> {
+        match s.to_lowercase().as_str() {
+            "exact" => Some(Self::Exact),
+            "lower_bound" | "lowerbound" | "lower" => Some(Self::LowerBound),
+            "estimate" | "approximate" => Some(Self::Estimate),
+            _ => None,
+        }
+    }
+
+    pub fn as_str(&self) -> &'static str {
+        match self {
+            Self::Exact => "exact",
+            Self::LowerBound => "lower_bound",
+            Self::Estimate => "estimate",
+        }
+    }
+}
+
+/// Number of matching docs with one field value
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct FacetCount {
+    pub value: String,
+    pub count: u64,
+}
+
+/// The most frequent values of one field among a query's matches
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct Facet {
+    /// Field name (`lang`, `domain` or `year`)
+    pub field: String,
+    /// Most frequent first
+    pub counts: Vec<FacetCount>,
+}
+
+/// Facet counts over the full match set of a query
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct FacetResult {
+    pub facets: Vec<Facet>,
+    /// Documents matching the query
+    pub matches: u64,
+    /// Counts were extrapolated from a sample of the matches
+    pub approximate: bool,
+}
+
 /// Memory usage statistics
 #[derive(Debug, Clone, Default, Serialize, Deserialize)]
 pub struct MemoryStats {
@@ -0,0 +1,181 @@
+//! Segment manifests for incremental persistence
+//!
+//! A profile that persists in segments writes each commit's new documents
+//! to a fresh immutable file and then atomically replaces a small JSON
+//! manifest listing the live segments. Segments cover contiguous doc-ID
+//! ranges in order. Once enough segments of one size tier pile up at the
+//! tail they are merged into one, so each document is rewritten only a
+//! logarithmic number of times.
+//!
+//! Only the ultra profile persists this way so far. The other profiles
+//! still rewrite their single `<profile>.idx` file on every save.
+
+use crate::result::IndexError;
+
+use serde::{Deserialize, Serialize};
+use std::io::Write;
+use std::ops::Range;
+use std::path::Path;
+
+/// Segments of one size tier that trigger a merge; also the tier ratio
+pub const MERGE_FACTOR: usize = 8;
+
+/// One immutable segment file
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
+pub struct SegmentInfo {
+    /// File name within the index directory
+    pub file: String,
+    /// First doc ID in the segment
+    pub base_doc: u64,
+    /// Documents in the segment
+    pub doc_count: u64,
+}
+
+impl SegmentInfo {
+    /// Doc ID after the last one in the segment
+    pub fn end_doc(&self) -> u64 {
+        self.base_doc + self.doc_count
+    }
+}
+
+/// Live segments of a profile, oldest first
+#[derive(Debug, Clone, Default, PartialEq, Eq, Serialize, Deserialize)]
+pub struct SegmentManifest {
+    pub segments: Vec<SegmentInfo>,
+    /// Sequence number of the next segment file
+    pub next_seq: u64,
+}
+
+impl SegmentManifest {
+    /// Read `<prefix>.manifest` from `dir`, if present
+    pub fn read(dir: &Path, prefix: &str) -> Result<Option<Self>, IndexError> {
+        let bytes = match std::fs::read(manifest_path(dir, prefix)) {
+            Ok(b) => b,
+            Err(e) if e.kind() == std::io::ErrorKind::NotFound => return Ok(None),
+            Err(e) => return Err(e.into()),
+        };
+        serde_json::from_slice(&bytes)
+            .map(Some)
+            .map_err(|e| IndexError::Corrupted(format!("{} manifest: {}", prefix, e)))
+    }
+
+    /// Durably replace `<prefix>.manifest` in `dir`. Segment files must
+    /// already be synced: the manifest is what makes them live.
+    pub fn write(&self, dir: &Path, prefix: &str) -> Result<(), IndexError> {
+        let bytes =
+            serde_json::to_vec(self).map_err(|e| IndexError::Serialization(e.to_string()))?;
+        let path = manifest_path(dir, prefix);
+        let tmp_path = path.with_extension("manifest.tmp");
+        {
+            let mut file = std::fs::File::create(&tmp_path)?;
+            file.write_all(&bytes)?;
+            file.sync_all()?;
+        }
+        std::fs::rename(&tmp_path, &path)?;
+        sync_dir(dir)
+    }
+
+    /// Documents covered by the segments
+    pub fn doc_count(&self) -> u64 {
+        self.segments.last().map_or(0, SegmentInfo::end_doc)
+    }
+
+    /// Reserve the file name for a new segment
+    pub fn next_file(&mut self, prefix: &str) -> String {
+        self.next_seq += 1;
+        format!("{}.seg.{:06}", prefix, self.next_seq)
+    }
+
+    /// Trailing segments to merge: the newest run of at least
+    /// `MERGE_FACTOR` segments in the same size tier
+    pub fn merge_candidates(&self) -> Option<Range<usize>> {
+        let last_tier = tier(self.segments.last()?.doc_count);
+        let run = self
+            .segments
+            .iter()
+            .rev()
+            .take_while(|s| tier(s.doc_count) == last_tier)
+            .count();
+        let n = self.segments.len();
+        (run >= MERGE_FACTOR).then(|| n - run..n)
+    }
+
+    /// Remove segment files listed in `old` but not in `self`
+    pub fn remove_obsolete(&self, dir: &Path, old: &SegmentManifest) -> Result<(), IndexError> {
+        for seg in &old.segments {
+            if self.segments.iter().any(|s| s.file == seg.file) {
+                continue;
+            }
+            match std::fs::remove_file(dir.join(&seg.file)) {
+                Ok(()) => {}
+                Err(e) if e.kind() == std::io::ErrorKind::NotFound => {}
+                Err(e) => return Err(e.into()),
+            }
+        }
+        Ok(())
+    }
+}
+
+/// Path of `<prefix>.manifest` in `dir`
+pub fn manifest_path(dir: &Path, prefix: &str) -> std::path::PathBuf {
+    dir.join(format!("{}.manifest", prefix))
+}
+
+/// Flush `dir` itself so renames and new entries in it survive a crash
+pub fn sync_dir(dir: &Path) -> Result<(), IndexError> {
+    #[cfg(unix)]
+    std::fs::File::open(dir)?.sync_all()?;
+    #[cfg(not(unix))]
+    let _ = dir;
+    Ok(())
+}
+
+/// Size tier: segments within a factor of `MERGE_FACTOR` share a tier
+fn tier(doc_count: u64) -> u32 {
+    doc_count.max(1).ilog(MERGE_FACTOR as u64)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use tempfile::tempdir;
+
+    fn push(manifest: &mut SegmentManifest, docs: u64) {
+        let file = manifest.next_file("t");
+        let base_doc = manifest.doc_count();
+        manifest.segments.push(SegmentInfo {
+            file,
+            base_doc,
+            doc_count: docs,
+        });
+    }
+
+    #[test]
+    fn test_merge_candidates() {
+        let mut manifest = SegmentManifest::default();
+        push(&mut manifest, 1000);
+        for _ in 0..MERGE_FACTOR - 1 {
+            push(&mut manifest, 10);
+        }
+        assert_eq!(manifest.merge_candidates(), None);
+
+        push(&mut manifest, 10);
+        assert_eq!(manifest.merge_candidates(), Some(1..MERGE_FACTOR + 1));
+    }
+
+    #[test]
+    fn test_manifest_roundtrip() {
+        let dir = tempdir().unwrap();
+        assert!(SegmentManifest::read(dir.path(), "t").unwrap().is_none());
+
+        let mut manifest = SegmentManifest::default();
+        push(&mut manifest, 5);
+        push(&mut manifest, 7);
+        manifest.write(dir.path(), "t").unwrap();
+
+        let read = SegmentManifest::read(dir.path(), "t").unwrap().unwrap();
+        assert_eq!(read, manifest);
+        assert_eq!(read.doc_count(), 12);
+        assert_eq!(read.segments[1].file, "t.seg.000002");
+    }
+}
@@ -1,12 +1,174 @@
 //! Fast tokenization with zero-copy where possible
+//!
+//! A token is a run of Unicode letters and digits (plus combining marks,
+//! so decomposed Vietnamese stays whole). The scanner classifies 32 bytes
+//! at a time with word-parallel (SWAR) arithmetic: runs of ASCII letters
+//! and digits, and of ASCII delimiters, are skipped a block at a time,
+//! and only non-ASCII characters are decoded one by one. Each token is
+//! lowercased and hashed in the same pass; Latin-1, Latin Extended and
+//! Vietnamese letters are lowercased through a lookup table.
+//!
+//! Indexing profiles tokenize into hashed terms: each distinct term of a
+//! text is identified by the FNV-1a hash of its lowercased UTF-8 bytes,
+//! found without copying the token, and counted in a buffer reused across
+//! the texts a thread tokenizes. A `TermInterner` then maps the hashes to
+//! dense term IDs, keeping one copy of each term string in a shared arena.
 
+use crate::document::DocumentRef;
+
+use parking_lot::RwLock;
+use rayon::prelude::*;
+use rustc_hash::FxHashMap;
 use std::collections::HashMap;
+use std::sync::LazyLock;
+
+/// FNV-1a constants
+const FNV_OFFSET: u64 = 0xcbf29ce484222325;
+const FNV_PRIME: u64 = 0x100000001b3;
+
+/// Bytes classified at a time
+const BLOCK: usize = 32;
+
+/// Pre-computed character lookup table
+/// 0 = non-alnum, otherwise = lowercase ASCII value
+static CHAR_LUT: [u8; 256] = {
+    let mut t = [0u8; 256];
+    let mut i = 0;
+    while i < 256 {
+        t[i] = if i >= b'a' as usize && i <= b'z' as usize {
+            i as u8
+        } else if i >= b'A' as usize && i <= b'Z' as usize {
+            (i as u8) | 0x20
+        } else if i >= b'0' as usize && i <= b'9' as usize {
+            i as u8
+        } else {
+            0
+        };
+        i += 1;
+    }
+    t
+};
+
+/// Lowercase forms of U+0080..U+0250 (Latin-1 Supplement, Latin Extended-A
+/// and -B, including Vietnamese Đ, Ơ and Ư) and of U+1E00..U+1F00 (Latin
+/// Extended Additional, including the Vietnamese tone-marked vowels)
+static LATIN_LOWER: LazyLock<(Vec<char>, Vec<char>)> =
+    LazyLock::new(|| (lower_range(0x80..0x250), lower_range(0x1E00..0x1F00)));
+
+fn lower_range(range: std::ops::Range<u32>) -> Vec<char> {
+    range
+        .map(|cp| {
+            let c = char::from_u32(cp).unwrap_or_default();
+            // Multi-char lowercase forms (only U+0130) keep the base letter
+            c.to_lowercase().next().unwrap_or(c)
+        })
+        .collect()
+}
+
+/// Feed the lowercase form of non-ASCII `c` to `f`
+#[inline]
+fn lowercase(c: char, mut f: impl FnMut(char)) {
+    let (latin, latin_additional) = &*LATIN_LOWER;
+    let cp = c as usize;
+    match cp {
+        0x80..0x250 => f(latin[cp - 0x80]),
+        0x1E00..0x1F00 => f(latin_additional[cp - 0x1E00]),
+        _ => c.to_lowercase().for_each(f),
+    }
+}
+
+/// Whether non-ASCII `c` continues a token
+#[inline]
+fn is_word_char(c: char) -> bool {
+    // Combining diacritics keep decomposed (NFD) letters whole
+    c.is_alphanumeric() || ('\u{300}'..='\u{36F}').contains(&c)
+}
+
+#[inline]
+fn fnv(hash: u64, bytes: &[u8]) -> u64 {
+    bytes
+        .iter()
+        .fold(hash, |hash, &b| (hash ^ b as u64).wrapping_mul(FNV_PRIME))
+}
+
+/// Hash of a normalized (lowercased) term: FNV-1a over its UTF-8 bytes
+#[inline]
+pub fn term_hash(term: &[u8]) -> u64 {
+    fnv(FNV_OFFSET, term)
+}
+
+/// Append the normalized (lowercased) form of token `token` to `out`
+pub fn normalize(token: &str, out: &mut String) {
+    for c in token.chars() {
+        if c.is_ascii() {
+            out.push(c.to_ascii_lowercase());
+        } else {
+            lowercase(c, |l| out.push(l));
+        }
+    }
+}
+
+/// One byte per lane set to `b`
+const fn splat(b: u8) -> u64 {
+    u64::from_ne_bytes([b; 8])
+}
+
+/// High bit of each byte lane of 7-bit `x` that lies in `lo..=hi`
+#[inline]
+fn in_range(x: u64, lo: u8, hi: u8) -> u64 {
+    let ge_lo = x.wrapping_add(splat(0x80 - lo));
+    let gt_hi = x.wrapping_add(splat(0x7f - hi));
+    ge_lo & !gt_hi & splat(0x80)
+}
+
+/// Gather the high bit of each byte lane into bits 0..8
+#[inline]
+fn movemask(x: u64) -> u32 {
+    ((x >> 7).wrapping_mul(0x0102_0408_1020_4080) >> 56) as u32
+}
+
+/// Masks of the ASCII letters and digits and of the non-ASCII bytes in a
+/// 32-byte block; bit `i` stands for byte `i`
+#[inline]
+fn classify(block: &[u8]) -> (u32, u32) {
+    let (mut alnum, mut high) = (0u32, 0u32);
+    for (w, word) in block.chunks_exact(8).enumerate() {
+        let x = u64::from_le_bytes(word.try_into().unwrap_or_default());
+        let non_ascii = x & splat(0x80);
+        let ascii = x & splat(0x7f);
+        let digit = in_range(ascii, b'0', b'9');
+        let alpha = in_range(ascii | splat(0x20), b'a', b'z');
+        alnum |= movemask((digit | alpha) & !non_ascii) << (8 * w);
+        high |= movemask(non_ascii) << (8 * w);
+    }
+    (alnum, high)
+}
 
-/// Fast byte-level tokenizer optimized for ASCII text
+/// `classify` the block at `base`; bytes past the end count as delimiters
+#[inline]
+fn classify_at(bytes: &[u8], base: usize) -> (u32, u32) {
+    match bytes.get(base..base + BLOCK) {
+        Some(block) => classify(block),
+        None => {
+            let mut block = [0u8; BLOCK];
+            let tail = &bytes[base..];
+            block[..tail.len()].copy_from_slice(tail);
+            classify(&block)
+        }
+    }
+}
+
+/// The non-ASCII character at byte `i` of `text`
+#[inline]
+fn char_at(text: &str, i: usize) -> char {
+    text[i..].chars().next().unwrap_or_default()
+}
+
+/// Unicode-aware tokenizer with fast paths for ASCII text
 pub struct FastTokenizer {
-    /// Minimum token length
+    /// Minimum token length in characters
     min_length: usize,
-    /// Maximum token length
+    /// Maximum token length in characters
     max_length: usize,
 }
 
@@ -20,78 +182,336 @@ impl Default for FastTokenizer {
 }
 
 impl FastTokenizer {
-    pub fn new(min_length: usize, max_length: usize) -> Self {
+    pub const fn new(min_length: usize, max_length: usize) -> Self {
         Self {
             min_length,
             max_length,
         }
     }
 
-    /// Tokenize text and count term frequencies
-    /// Returns map of term -> frequency
+    /// Call `f(hash, start, end)` for each token of `text`, with the
+    /// `term_hash` of its normalized form and its byte range
     #[inline]
-    pub fn tokenize_with_freqs(&self, text: &str) -> HashMap<String, u16> {
-        let mut freqs: HashMap<String, u16> = HashMap::with_capacity(text.len() / 5);
+    fn scan(&self, text: &str, mut f: impl FnMut(u64, usize, usize)) {
         let bytes = text.as_bytes();
-        let mut start = 0;
-        let mut in_token = false;
+        let len = bytes.len();
+        let mut emit = |(start, hash, chars): (usize, u64, usize), end: usize| {
+            if chars >= self.min_length && chars <= self.max_length {
+                f(hash, start, end);
+            }
+        };
+        // The token being scanned: start, hash and length in characters
+        let mut token: Option<(usize, u64, usize)> = None;
+        let mut base = 0;
 
-        for (i, &b) in bytes.iter().enumerate() {
-            let is_alnum = b.is_ascii_alphanumeric();
+        while base < len {
+            let (alnum, high) = classify_at(bytes, base);
 
-            if is_alnum {
-                if !in_token {
-                    start = i;
-                    in_token = true;
+            if high != 0 {
+                // Non-ASCII in the block: go byte by byte, decoding characters
+                let end = (base + BLOCK).min(len);
+                let mut i = base;
+                while i < end {
+                    let b = bytes[i];
+                    let (word, width) = if b < 0x80 {
+                        let c = CHAR_LUT[b as usize];
+                        if c != 0 {
+                            let (_, hash, chars) = token.get_or_insert((i, FNV_OFFSET, 0));
+                            *hash = (*hash ^ c as u64).wrapping_mul(FNV_PRIME);
+                            *chars += 1;
+                        }
+                        (c != 0, 1)
+                    } else {
+                        let c = char_at(text, i);
+                        let word = is_word_char(c);
+                        if word {
+                            let (_, hash, chars) = token.get_or_insert((i, FNV_OFFSET, 0));
+                            lowercase(c, |l| {
+                                *hash = fnv(*hash, l.encode_utf8(&mut [0; 4]).as_bytes())
+                            });
+                            *chars += 1;
+                        }
+                        (word, c.len_utf8())
+                    };
+                    if !word {
+                        if let Some(t) = token.take() {
+                            emit(t, i);
+                        }
+                    }
+                    i += width;
                 }
-            } else if in_token {
-                let end = i;
-                let len = end - start;
-                if len >= self.min_length && len <= self.max_length {
-                    // Lowercase in-place
-                    let token = self.normalize_token(&bytes[start..end]);
-                    *freqs.entry(token).or_insert(0) += 1;
+                // A character may run past the block
+                base = i;
+                continue;
+            }
+
+            // ASCII block: walk the runs of letters and digits in the mask
+            let alnum = alnum as u64;
+            let mut pos = 0;
+            while pos < BLOCK {
+                if let Some((_, hash, chars)) = &mut token {
+                    let run = (alnum >> pos).trailing_ones() as usize;
+                    for &b in &bytes[base + pos..base + pos + run] {
+                        *hash = (*hash ^ CHAR_LUT[b as usize] as u64).wrapping_mul(FNV_PRIME);
+                    }
+                    *chars += run;
+                    pos += run;
+                    if pos == BLOCK {
+                        break;
+                    }
+                    if let Some(t) = token.take() {
+                        emit(t, base + pos);
+                    }
+                }
+                pos += ((alnum >> pos).trailing_zeros() as usize).min(BLOCK - pos);
+                if pos < BLOCK {
+                    token = Some((base + pos, FNV_OFFSET, 0));
                 }
-                in_token = false;
             }
+            base += BLOCK;
         }
 
-        // Handle last token
-        if in_token {
-            let len = bytes.len() - start;
-            if len >= self.min_length && len <= self.max_length {
-                let token = self.normalize_token(&bytes[start..]);
-                *freqs.entry(token).or_insert(0) += 1;
-            }
+        if let Some(t) = token {
+            emit(t, len);
         }
+    }
 
+    /// Tokenize text and count term frequencies
+    /// Returns map of term -> frequency
+    #[inline]
+    pub fn tokenize_with_freqs(&self, text: &str) -> HashMap<String, u16> {
+        let mut buf = TermBuffer::default();
+        self.tokenize_hashed(text, &mut buf);
+        let mut freqs = HashMap::with_capacity(buf.terms.len());
+        for t in &buf.terms {
+            let mut term = String::with_capacity(t.end - t.start);
+            normalize(&text[t.start..t.end], &mut term);
+            freqs.insert(term, t.freq);
+        }
         freqs
     }
 
     /// Tokenize for query (returns unique terms)
     #[inline]
     pub fn tokenize_query(&self, query: &str) -> Vec<String> {
-        let freqs = self.tokenize_with_freqs(query);
-        freqs.into_keys().collect()
+        self.tokenize_with_freqs(query).into_keys().collect()
+    }
+
+    /// Tokenize text into `buf` as distinct term hashes with frequencies,
+    /// without allocating per token
+    #[inline]
+    pub fn tokenize_hashed(&self, text: &str, buf: &mut TermBuffer) {
+        buf.slots.clear();
+        buf.terms.clear();
+        buf.tokens = 0;
+
+        self.scan(text, |hash, start, end| {
+            buf.tokens += 1;
+            match buf.slots.get(&hash) {
+                Some(&slot) => {
+                    let term = &mut buf.terms[slot as usize];
+                    term.freq = term.freq.saturating_add(1);
+                }
+                None => {
+                    buf.slots.insert(hash, buf.terms.len() as u32);
+                    buf.terms.push(HashedTerm {
+                        hash,
+                        freq: 1,
+                        start,
+                        end,
+                    });
+                }
+            }
+        });
+    }
+
+    /// Tokenize docs in parallel into interned term IDs, adding new terms
+    /// to `interner`. Each worker thread reuses one `TermBuffer`.
+    pub fn tokenize_interned(
+        &self,
+        docs: &[DocumentRef<'_>],
+        interner: &RwLock<TermInterner>,
+    ) -> Vec<TokenizedDoc> {
+        docs.par_iter()
+            .map_init(TermBuffer::default, |buf, doc| {
+                self.tokenize_hashed(doc.text, buf);
+                buf.intern(doc.text, interner)
+            })
+            .collect()
+    }
+}
+
+/// A distinct term of a tokenized text
+#[derive(Debug, Clone, Copy)]
+pub struct HashedTerm {
+    /// `term_hash` of the term
+    pub hash: u64,
+    /// Occurrences in the text
+    pub freq: u16,
+    /// Byte range of the first occurrence
+    pub start: usize,
+    pub end: usize,
+}
+
+/// Reusable output of `FastTokenizer::tokenize_hashed`. Once its tables
+/// have grown to fit the texts, tokenizing into it allocates nothing.
+#[derive(Debug, Default)]
+pub struct TermBuffer {
+    /// Term hash -> index in `terms`
+    slots: FxHashMap<u64, u32>,
+    terms: Vec<HashedTerm>,
+    tokens: u32,
+}
+
+impl TermBuffer {
+    /// Distinct terms, in order of first occurrence
+    pub fn terms(&self) -> &[HashedTerm] {
+        &self.terms
+    }
+
+    /// Number of tokens, repeats included
+    pub fn token_count(&self) -> u32 {
+        self.tokens
     }
 
-    /// Normalize a token (lowercase ASCII)
+    /// Map the terms of `text` (as tokenized into this buffer) to term IDs.
+    /// Known terms need only the read lock; new ones are interned under the
+    /// write lock.
+    pub fn intern(&self, text: &str, interner: &RwLock<TermInterner>) -> TokenizedDoc {
+        let mut terms = Vec::with_capacity(self.terms.len());
+        {
+            let interner = interner.read();
+            terms.extend(
+                self.terms
+                    .iter()
+                    .map_while(|t| Some((interner.get(t.hash)?, t.freq))),
+            );
+        }
+        if terms.len() < self.terms.len() {
+            let mut interner = interner.write();
+            for t in &self.terms[terms.len()..] {
+                let id = interner.intern(t.hash, &text[t.start..t.end]);
+                terms.push((id, t.freq));
+            }
+        }
+        TokenizedDoc {
+            terms,
+            doc_len: self.tokens,
+        }
+    }
+}
+
+/// A tokenized document: its terms' IDs and frequencies
+#[derive(Debug, Clone, Default)]
+pub struct TokenizedDoc {
+    pub terms: Vec<(u32, u16)>,
+    /// Number of tokens
+    pub doc_len: u32,
+}
+
+/// Term dictionary of dense `u32` IDs, assigned in order of first sight,
+/// with all term strings in one arena
+///
+/// Terms are found by `term_hash`: two terms with the same 64-bit hash
+/// share an ID, as they share postings in the ultra profile.
+#[derive(Debug, Clone, Default)]
+pub struct TermInterner {
+    /// Term hash -> term ID
+    ids: FxHashMap<u64, u32>,
+    /// Normalized terms back to back, indexed by `ends`
+    bytes: String,
+    ends: Vec<usize>,
+}
+
+impl TermInterner {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Rebuild an interner from `(term, id)` pairs, as saved by profiles
+    /// that index their postings by term ID. `None` unless the IDs are
+    /// exactly `0..terms.len()`.
+    pub fn from_ids(mut terms: Vec<(String, usize)>) -> Option<Self> {
+        terms.sort_unstable_by_key(|&(_, id)| id);
+        let mut interner = Self::new();
+        for (i, (term, id)) in terms.iter().enumerate() {
+            if *id != i || interner.intern(term_hash(term.as_bytes()), term) as usize != i {
+                return None;
+            }
+        }
+        Some(interner)
+    }
+
+    pub fn len(&self) -> usize {
+        self.ends.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.ends.is_empty()
+    }
+
+    /// ID of the term with hash `hash`
     #[inline]
-    fn normalize_token(&self, bytes: &[u8]) -> String {
-        let mut result = String::with_capacity(bytes.len());
-        for &b in bytes {
-            result.push(b.to_ascii_lowercase() as char);
+    pub fn get(&self, hash: u64) -> Option<u32> {
+        self.ids.get(&hash).copied()
+    }
+
+    /// ID of normalized term `term`
+    pub fn lookup(&self, term: &str) -> Option<u32> {
+        self.get(term_hash(term.as_bytes()))
+    }
+
+    /// ID of the term with hash `hash`, adding token `term` (normalized)
+    /// if it is new
+    pub fn intern(&mut self, hash: u64, term: &str) -> u32 {
+        if let Some(id) = self.get(hash) {
+            return id;
         }
-        result
+        let id = self.ends.len() as u32;
+        normalize(term, &mut self.bytes);
+        self.ends.push(self.bytes.len());
+        self.ids.insert(hash, id);
+        id
+    }
+
+    /// The term with ID `id`
+    pub fn term(&self, id: u32) -> &str {
+        let id = id as usize;
+        let start = if id == 0 { 0 } else { self.ends[id - 1] };
+        &self.bytes[start..self.ends[id]]
+    }
+
+    pub fn clear(&mut self) {
+        self.ids.clear();
+        self.bytes.clear();
+        self.ends.clear();
+    }
+
+    /// Heap bytes used by the dictionary
+    pub fn heap_bytes(&self) -> usize {
+        self.ids.capacity() * (std::mem::size_of::<(u64, u32)>() + 1)
+            + self.bytes.capacity()
+            + self.ends.capacity() * std::mem::size_of::<usize>()
     }
 }
 
+/// Invert tokenized docs, numbered from `base_doc`, into
+/// `(term ID, doc ID, freq)` postings sorted by term and then doc
+pub fn invert(docs: &[TokenizedDoc], base_doc: u32) -> Vec<(u32, u32, u16)> {
+    let mut postings = Vec::with_capacity(docs.iter().map(|d| d.terms.len()).sum());
+    for (i, doc) in docs.iter().enumerate() {
+        let doc_id = base_doc + i as u32;
+        postings.extend(doc.terms.iter().map(|&(term, freq)| (term, doc_id, freq)));
+    }
+    postings.par_sort_unstable();
+    postings
+}
+
 /// Parallel tokenization for batch processing
 pub fn tokenize_batch_parallel(
     texts: &[String],
     tokenizer: &FastTokenizer,
 ) -> Vec<HashMap<String, u16>> {
-    use rayon::prelude::*;
     texts
         .par_iter()
         .map(|text| tokenizer.tokenize_with_freqs(text))
@@ -127,4 +547,79 @@ mod tests {
         assert!(terms.contains(&"hello".to_string()));
         assert!(terms.contains(&"world".to_string()));
     }
+
+    #[test]
+    fn test_unicode_tokenization() {
+        let tokenizer = FastTokenizer::default();
+        let freqs =
+            tokenizer.tokenize_with_freqs("Tiếng Việt của người VIỆT: Đà Nẵng, ĐÀ NẴNG; Ơn ƯỚC");
+        assert_eq!(freqs.get("việt"), Some(&2));
+        assert_eq!(freqs.get("tiếng"), Some(&1));
+        assert_eq!(freqs.get("đà"), Some(&2));
+        assert_eq!(freqs.get("nẵng"), Some(&2));
+        assert_eq!(freqs.get("ơn"), Some(&1));
+        assert_eq!(freqs.get("ước"), Some(&1));
+
+        // Decomposed letters (base + combining marks) stay whole
+        let terms = tokenizer.tokenize_query("Vie\u{323}\u{302}t");
+        assert_eq!(terms, ["vie\u{323}\u{302}t"]);
+    }
+
+    #[test]
+    fn test_block_scan_matches_chars() {
+        // Character-at-a-time reference
+        let reference = |text: &str| {
+            let mut freqs = HashMap::new();
+            let words = text.split(|c: char| {
+                !(c.is_ascii_alphanumeric() || (!c.is_ascii() && is_word_char(c)))
+            });
+            for word in words {
+                if (2..=64).contains(&word.chars().count()) {
+                    let mut term = String::new();
+                    normalize(word, &mut term);
+                    *freqs.entry(term).or_insert(0u16) += 1;
+                }
+            }
+            freqs
+        };
+
+        let tokenizer = FastTokenizer::default();
+        let texts = [
+            format!("{} {}", "a".repeat(31), "b".repeat(33)),
+            format!("{}ữ{} x", "Ab1".repeat(11), "c".repeat(40)),
+            format!("{}—{}…", "-".repeat(45), "Q9".repeat(20)),
+            "Phở bò, bún chả & cà phê sữa đá — ngon! ".repeat(4),
+        ];
+        for text in &texts {
+            assert_eq!(
+                tokenizer.tokenize_with_freqs(text),
+                reference(text),
+                "{}",
+                text
+            );
+        }
+    }
+
+    #[test]
+    fn test_interned_tokenization() {
+        let tokenizer = FastTokenizer::default();
+        let interner = RwLock::new(TermInterner::new());
+        let docs = [
+            DocumentRef::new("1", "Hello World hello a"),
+            DocumentRef::new("2", "world PEACE"),
+        ];
+        let tokenized = tokenizer.tokenize_interned(&docs, &interner);
+
+        let interner = interner.into_inner();
+        assert_eq!(interner.len(), 3);
+        let id = |term| interner.lookup(term).unwrap();
+        assert_eq!(interner.term(id("peace")), "peace");
+        assert_eq!(tokenized[0].terms, [(id("hello"), 2), (id("world"), 1)]);
+        assert_eq!(tokenized[0].doc_len, 3);
+        assert_eq!(tokenized[1].terms, [(id("world"), 1), (id("peace"), 1)]);
+
+        let postings = invert(&tokenized, 10);
+        assert_eq!(postings[0], (id("hello"), 10, 2));
+        assert_eq!(postings[1..3], [(id("world"), 10, 1), (id("world"), 11, 1)]);
+    }
 }
@@ -6,6 +6,40 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  const char *format;
+  const char *name;
+  const char *metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema **children;
+  struct ArrowSchema *dictionary;
+  void (*release)(struct ArrowSchema *);
+  void *private_data;
+};
+
+struct ArrowArray {
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void **buffers;
+  struct ArrowArray **children;
+  struct ArrowArray *dictionary;
+  void (*release)(struct ArrowArray *);
+  void *private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
 /**
  * Maximum documents per batch for optimal memory usage
  */
@@ -16,11 +50,31 @@
  */
 #define DEFAULT_SEGMENT_SIZE 100000
 
+/**
+ * Bytes for a search cursor token, including the terminating NUL
+ */
+#define SEARCH_CURSOR_SIZE 17
+
+/**
+ * Binary batch format code: id, text
+ */
+#define BINARY_PLAIN 0
+
+/**
+ * Binary batch format code: id, text, url, language, date
+ */
+#define BINARY_WITH_METADATA 1
+
 /**
  * Main FTS index
  */
 typedef struct FtsIndex FtsIndex;
 
+/**
+ * A running ingest pipeline: a bounded chunk queue and its indexing worker
+ */
+typedef struct IngestSession IngestSession;
+
 /**
  * Progress callback type
  */
@@ -46,6 +100,42 @@ typedef struct FtsSearchResult {
   char *profile;
 } FtsSearchResult;
 
+/**
+ * Search hit written by `fts_search_into`
+ *
+ * The hit's ID is `id_len` bytes at `id_offset` in the ID string table
+ * (not null-terminated).
+ */
+typedef struct FtsHitRef {
+  /**
+   * Rank of the hit in the full result list (`offset` + position)
+   */
+  uint32_t ordinal;
+  float score;
+  uint32_t id_offset;
+  uint32_t id_len;
+} FtsHitRef;
+
+/**
+ * Result summary written by `fts_search_into`
+ */
+typedef struct FtsSearchInfo {
+  /**
+   * Hits written to the buffer
+   */
+  uint32_t count;
+  /**
+   * Bytes in the ID string table
+   */
+  uint32_t id_bytes;
+  uint64_t total;
+  uint64_t duration_ns;
+  /**
+   * Buffer size needed for this result page
+   */
+  uintptr_t required;
+} FtsSearchInfo;
+
 /**
  * Memory statistics for FFI
  */
@@ -85,6 +175,12 @@ void fts_index_close(struct FtsIndex *idx);
 /**
  * Index a batch of documents from JSON
  *
+ * `docs_json` is either a JSON array of `{"id", "text"}` objects or
+ * NDJSON (one object per line), chosen by its first non-whitespace byte.
+ * Strings are deserialized in place where they have no escapes; NDJSON
+ * is split on line boundaries and parsed and indexed in parallel. For
+ * NDJSON the progress `total` is the number of lines.
+ *
  * # Safety
  * - `idx` must be a valid index pointer
  * - `docs_json` must be a valid pointer to JSON data
@@ -103,6 +199,46 @@ int64_t fts_index_batch(struct FtsIndex *idx,
  */
 int fts_index_commit(struct FtsIndex *idx);
 
+/**
+ * Create or continue a resumable bulk build
+ *
+ * If `data_dir` holds a checkpoint, the index saved with it is restored
+ * (dropping anything committed since) and opened, and `*cursor_out`
+ * receives the source cursor JSON (`{"file":..,"row_group":..,"row":..}`,
+ * free with `fts_string_free`).
+ * Otherwise a new index is created and `*cursor_out` is set to null.
+ *
+ * # Safety
+ * - `data_dir` and `profile` must be valid null-terminated C strings
+ * - `cursor_out` must be a valid pointer
+ */
+struct FtsIndex *fts_index_resume(const char *data_dir, const char *profile, char **cursor_out);
+
+/**
+ * Commit, durably save, and record `cursor_json` as the resume point
+ *
+ * # Safety
+ * - `idx` must be a valid index pointer
+ * - `cursor_json` must be a valid null-terminated C string
+ */
+int fts_index_checkpoint(struct FtsIndex *idx, const char *cursor_json);
+
+/**
+ * Remove the checkpoint of a finished build
+ *
+ * # Safety
+ * - `idx` must be a valid index pointer
+ */
+int fts_index_clear_checkpoint(struct FtsIndex *idx);
+
+/**
+ * Free a string returned by the library
+ *
+ * # Safety
+ * - `s` must be null or a pointer returned by this library
+ */
+void fts_string_free(char *s);
+
 /**
  * Index documents from a binary format for maximum throughput
  *
@@ -112,6 +248,9 @@ int fts_index_commit(struct FtsIndex *idx);
  *   - text_len: u32 (little-endian)
  *   - text: [u8; text_len]
  *
+ * Safe to call from several threads on the same index: their batches
+ * are indexed concurrently rather than one after another.
+ *
  * # Safety
  * - `idx` must be a valid index pointer
  * - `data` must be valid binary data
@@ -124,6 +263,122 @@ int64_t fts_index_batch_binary(struct FtsIndex *idx,
                                uint64_t doc_count,
                                FtsProgressFn progress);
 
+/**
+ * Index documents from a binary batch in the given `BINARY_*` format
+ *
+ * `BINARY_WITH_METADATA` appends url, language and date fields (each a
+ * u32 length plus bytes, empty = absent) after the text, so profiles
+ * with metadata fields can serve `fts_search_filtered`. Returns -2 for
+ * an unknown format.
+ *
+ * # Safety
+ * Same as `fts_index_batch_binary`
+ */
+int64_t fts_index_batch_binary_format(struct FtsIndex *idx,
+                                      const uint8_t *data,
+                                      uintptr_t data_len,
+                                      uint64_t doc_count,
+                                      uint32_t format,
+                                      FtsProgressFn progress);
+
+/**
+ * Start a streaming ingest session
+ *
+ * Chunks pushed with `fts_ingest_push` are parsed and indexed on a
+ * dedicated pool of `threads` threads (0 = number of CPUs) while the
+ * caller prepares the next chunk; at most `queue_depth` chunks wait in
+ * between. End the session with `fts_ingest_finish`, then commit.
+ *
+ * # Safety
+ * - `idx` must be a valid index pointer
+ */
+struct IngestSession *fts_ingest_begin(struct FtsIndex *idx, uint32_t queue_depth, uint32_t threads);
+
+/**
+ * Start a streaming ingest session whose chunks use the given `BINARY_*`
+ * format (see `fts_index_batch_binary_format`)
+ *
+ * # Safety
+ * - `idx` must be a valid index pointer
+ */
+struct IngestSession *fts_ingest_begin_format(struct FtsIndex *idx,
+                                              uint32_t queue_depth,
+                                              uint32_t threads,
+                                              uint32_t format);
+
+/**
+ * Queue a chunk of whole documents in the session's binary format
+ *
+ * The chunk is copied, so the caller may reuse its buffer on return.
+ * Blocks only while the session queue is full. Returns -3 if indexing an
+ * earlier chunk failed; `fts_ingest_finish` reports the error.
+ *
+ * # Safety
+ * - `session` must be a valid pointer returned by `fts_ingest_begin`
+ * - `chunk` must be valid for reads of `chunk_len` bytes
+ */
+int fts_ingest_push(struct IngestSession *session, const uint8_t *chunk, uintptr_t chunk_len);
+
+/**
+ * Documents indexed so far by a session
+ *
+ * # Safety
+ * - `session` must be a valid pointer returned by `fts_ingest_begin`
+ */
+uint64_t fts_ingest_indexed(struct IngestSession *session);
+
+/**
+ * Wait for queued chunks to be indexed and free the session
+ *
+ * Returns the number of documents indexed, or -3 on error.
+ *
+ * # Safety
+ * - `session` must be a valid pointer returned by `fts_ingest_begin`;
+ *   it is invalid after this call
+ */
+int64_t fts_ingest_finish(struct IngestSession *session);
+
+/**
+ * Index a record batch passed through the Arrow C Data Interface
+ *
+ * `schema` and `array` describe a struct array (an exported record batch)
+ * with string columns named "id" and "text"; other columns are ignored.
+ * Text is tokenized straight from the Arrow offset and value buffers,
+ * without a copy. Rows with a null text are skipped.
+ *
+ * Ownership of both structs moves to the index: unless a pointer is null
+ * (-1) or the library was built without `arrow-ingest` (-3), their
+ * release callbacks have run and the structs are marked released when
+ * this returns, on success or error. Returns the number of documents
+ * indexed, or -3 on error.
+ *
+ * # Safety
+ * - `idx` must be a valid index pointer
+ * - `schema` and `array` must be valid, unreleased C Data Interface structs
+ */
+int64_t fts_index_arrow(struct FtsIndex *idx, struct ArrowSchema *schema, struct ArrowArray *array);
+
+/**
+ * Index the id and text columns of Parquet files
+ *
+ * `path` is a file, a directory of `*.parquet` files, or a glob in the
+ * file name (`/data/fineweb/*.parquet`). Row groups are decoded in
+ * parallel on `threads` threads (0 = number of CPUs), reading only the
+ * two columns. `progress(indexed, total_rows)` is called after each
+ * record batch. Returns the number of documents indexed, or a negative
+ * error (-3 also when built without the `parquet-ingest` feature).
+ *
+ * # Safety
+ * - `idx` must be a valid index pointer
+ * - `path`, `id_col` and `text_col` must be valid null-terminated C strings
+ */
+int64_t fts_index_parquet(struct FtsIndex *idx,
+                          const char *path,
+                          const char *id_col,
+                          const char *text_col,
+                          uint32_t threads,
+                          FtsProgressFn progress);
+
 /**
  * Search the index
  *
@@ -146,6 +401,133 @@ int fts_search(struct FtsIndex *idx,
  */
 void fts_result_free(struct FtsSearchResult *result);
 
+/**
+ * Search the index into a caller-provided buffer
+ *
+ * Writes `count` `FtsHitRef`s at the start of `buf`, followed by the ID
+ * string table, and the summary to `*out`. Nothing is allocated for the
+ * caller and there is nothing to free. Hit IDs go from the profile's ID
+ * table through a per-thread hit buffer into `buf`, so once that buffer
+ * has grown a query allocates nothing per hit.
+ *
+ * Returns 0 on success, or -4 if `buf_len` is smaller than
+ * `out->required` (no hits are written; retry with a larger buffer).
+ *
+ * # Safety
+ * - `idx` must be a valid index pointer
+ * - `query` must be a valid null-terminated C string
+ * - `buf` must be valid for writes of `buf_len` bytes (any alignment)
+ * - `out` must be a valid pointer
+ */
+int fts_search_into(struct FtsIndex *idx,
+                    const char *query,
+                    uint32_t limit,
+                    uint32_t offset,
+                    uint8_t *buf,
+                    uintptr_t buf_len,
+                    struct FtsSearchInfo *out);
+
+/**
+ * Search the hits ranked after a cursor into a caller-provided buffer,
+ * laid out as by `fts_search_into`
+ *
+ * `after` is the `next` token of the previous page, or NULL or an empty
+ * string for the first page. Only `limit` hits are collected however deep
+ * the page is, so walking every hit of a query costs no more per page
+ * than the first. `next` receives the token for the following page, or an
+ * empty string once the hits run out. Hit ordinals restart at 0.
+ *
+ * Returns -2 for a malformed cursor, -3 if the profile cannot page by
+ * cursor, and -4 if `buf_len` is too small.
+ *
+ * # Safety
+ * - `idx` must be a valid index pointer
+ * - `query` must be a valid null-terminated C string
+ * - `after` must be NULL or a valid null-terminated C string
+ * - `buf` must be valid for writes of `buf_len` bytes (any alignment)
+ * - `out` must be a valid pointer
+ * - `next` must be valid for writes of `SEARCH_CURSOR_SIZE` bytes
+ */
+int fts_search_after(struct FtsIndex *idx,
+                     const char *query,
+                     const char *after,
+                     uint32_t limit,
+                     uint8_t *buf,
+                     uintptr_t buf_len,
+                     struct FtsSearchInfo *out,
+                     char *next);
+
+/**
+ * Search the documents matching a metadata filter into a caller-provided
+ * buffer, laid out as by `fts_search_into`
+ *
+ * `filter` is an expression over the `lang`, `domain` and `year` fields,
+ * e.g. `lang:en AND NOT domain:example.com`; NULL or an empty string
+ * searches unfiltered. Matching docs are selected before scoring, so
+ * `limit` filtered hits come back without over-fetching.
+ *
+ * Returns -2 if the filter does not parse, -3 if the profile does not
+ * index metadata, and -4 if `buf_len` is too small.
+ *
+ * # Safety
+ * - `idx` must be a valid index pointer
+ * - `query` must be a valid null-terminated C string
+ * - `filter` must be NULL or a valid null-terminated C string
+ * - `buf` must be valid for writes of `buf_len` bytes (any alignment)
+ * - `out` must be a valid pointer
+ */
+int fts_search_filtered(struct FtsIndex *idx,
+                        const char *query,
+                        const char *filter,
+                        uint32_t limit,
+                        uint32_t offset,
+                        uint8_t *buf,
+                        uintptr_t buf_len,
+                        struct FtsSearchInfo *out);
+
+/**
+ * Facet counts over every document matching `query`
+ *
+ * `fields` lists the fields to count, separated by commas or spaces
+ * (`lang`, `domain`, `year`); NULL or an empty string counts all of them.
+ * Each field keeps its `top_n` most frequent values. With `approximate`,
+ * very broad queries count a sample of the matches and scale it up.
+ *
+ * On success `*out` receives JSON (free with `fts_string_free`):
+ * `{"facets":[{"field":"domain","counts":[{"value":..,"count":..}]}],
+ * "matches":..,"approximate":..}`. Returns -2 for an unknown field and
+ * -3 if the profile does not index metadata.
+ *
+ * # Safety
+ * - `idx` must be a valid index pointer
+ * - `query` must be a valid null-terminated C string
+ * - `fields` must be NULL or a valid null-terminated C string
+ * - `out` must be a valid pointer
+ */
+int fts_facets(struct FtsIndex *idx,
+               const char *query,
+               const char *fields,
+               uint32_t top_n,
+               bool approximate,
+               char **out);
+
+/**
+ * Count the documents matching `query`
+ *
+ * `mode` is `exact`, `lower_bound` (the largest term's document
+ * frequency, read without touching postings) or `estimate` (sampled from
+ * the postings); NULL means `exact`. The count goes to `*out`.
+ *
+ * Returns -2 for an unknown mode and -3 if the profile cannot count.
+ *
+ * # Safety
+ * - `idx` must be a valid index pointer
+ * - `query` must be a valid null-terminated C string
+ * - `mode` must be NULL or a valid null-terminated C string
+ * - `out` must be a valid pointer
+ */
+int fts_count(struct FtsIndex *idx, const char *query, const char *mode, uint64_t *out);
+
 /**
  * Get memory statistics
  *
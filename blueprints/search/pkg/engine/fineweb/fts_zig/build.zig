@@ -20,6 +20,7 @@ pub fn build(b: *std.Build) void {
         .optimize = optimize,
     });
     main_mod.addOptions("build_options", options);
+    linkZstd(main_mod);
 
     // =========================================================================
     // Shared Library (for CGO integration)
@@ -41,6 +42,7 @@ pub fn build(b: *std.Build) void {
         .optimize = optimize,
     });
     static_mod.addOptions("build_options", options);
+    linkZstd(static_mod);
 
     const static_lib = b.addLibrary(.{
         .name = "fts_zig_static",
@@ -95,6 +97,7 @@ pub fn build(b: *std.Build) void {
         .optimize = optimize,
     });
     test_mod.addOptions("build_options", options);
+    linkZstd(test_mod);
 
     const unit_tests = b.addTest(.{
         .root_module = test_mod,
@@ -131,9 +134,7 @@ pub fn build(b: *std.Build) void {
         .target = target,
         .optimize = .ReleaseFast,
     });
-    parquet_mod.linkSystemLibrary("zstd", .{});
-    parquet_mod.addIncludePath(.{ .cwd_relative = "/opt/homebrew/include" });
-    parquet_mod.addLibraryPath(.{ .cwd_relative = "/opt/homebrew/lib" });
+    linkZstd(parquet_mod);
     throughput_mod.addImport("parquet_reader", parquet_mod);
     throughput_mod.addOptions("build_options", options);
 
@@ -152,3 +153,10 @@ pub fn build(b: *std.Build) void {
     const throughput_step = b.step("throughput", "Run throughput benchmark (1M docs/sec target)");
     throughput_step.dependOn(&run_throughput.step);
 }
+
+/// libzstd backs ZSTD parquet pages (streaming ingest and the throughput benchmark)
+fn linkZstd(mod: *std.Build.Module) void {
+    mod.linkSystemLibrary("zstd", .{});
+    mod.addIncludePath(.{ .cwd_relative = "/opt/homebrew/include" });
+    mod.addLibraryPath(.{ .cwd_relative = "/opt/homebrew/lib" });
+}
@@ -12,12 +12,61 @@ extern "C" {
 /* Opaque handle to an index */
 typedef void* fts_handle_t;
 
+/* Opaque handle to a hot-swappable index reference */
+typedef void* fts_index_ref_t;
+
 /* Search result */
 typedef struct {
     uint32_t doc_id;
     float score;
 } fts_search_result_t;
 
+/* Search result with external key, see fts_ref_search_keyed
+ * key_offset: position of the key in key_buf, UINT32_MAX if it did not fit
+ * key_len: key length (bytes needed when it did not fit) */
+typedef struct {
+    uint32_t doc_id;
+    float score;
+    uint32_t key_offset;
+    uint32_t key_len;
+} fts_keyed_result_t;
+
+/* Doc-values filter clause, see fts_ref_search_with */
+typedef enum {
+    FTS_FILTER_INT_RANGE = 0,     /* int_min <= value <= int_max */
+    FTS_FILTER_FLOAT_RANGE = 1,   /* float_min <= value <= float_max */
+    FTS_FILTER_STRING_EQ = 2      /* value == value[0..value_len] */
+} fts_filter_op_t;
+
+typedef struct {
+    const char* field;
+    size_t field_len;
+    uint32_t op;                  /* fts_filter_op_t */
+    uint32_t _padding;
+    int64_t int_min;
+    int64_t int_max;
+    double float_min;
+    double float_max;
+    const char* value;
+    size_t value_len;
+} fts_filter_clause_t;
+
+/* Result ordering, see fts_ref_search_with */
+typedef enum {
+    FTS_SORT_SCORE = 0,           /* BM25 descending */
+    FTS_SORT_FIELD = 1,           /* field value, BM25 breaks ties */
+    FTS_SORT_BLEND = 2            /* BM25 + weight * field value */
+} fts_sort_mode_t;
+
+typedef struct {
+    uint32_t mode;                /* fts_sort_mode_t */
+    uint32_t descending;          /* FTS_SORT_FIELD: nonzero = descending */
+    const char* field;
+    size_t field_len;
+    float weight;                 /* FTS_SORT_BLEND */
+    uint32_t _padding;
+} fts_sort_t;
+
 /* Index statistics */
 typedef struct {
     uint32_t doc_count;
@@ -45,6 +94,39 @@ fts_handle_t fts_speed_builder_create(void);
 /* Add a document to the speed index builder */
 int fts_speed_builder_add(fts_handle_t handle, const char* text, size_t text_len);
 
+/* Add a document with an external key (URL, UUID, ...) to the speed builder
+ * Keys are returned by fts_ref_search_keyed and resolved by fts_ref_lookup_key */
+int fts_speed_builder_add_keyed(fts_handle_t handle, const char* key, size_t key_len,
+                                const char* text, size_t text_len);
+
+/* Set doc values (per-document attributes for filtering and sorting) of
+ * doc_id in the speed builder. A field keeps the kind of its first set;
+ * unset docs read as 0 / no value.
+ * Returns: FTS_OK, or FTS_ERR_INVALID_ARGUMENT on a kind mismatch */
+int fts_speed_builder_set_int(fts_handle_t handle, uint32_t doc_id,
+                              const char* field, size_t field_len, int64_t value);
+int fts_speed_builder_set_float(fts_handle_t handle, uint32_t doc_id,
+                                const char* field, size_t field_len, double value);
+int fts_speed_builder_set_string(fts_handle_t handle, uint32_t doc_id,
+                                 const char* field, size_t field_len,
+                                 const char* value, size_t value_len);
+
+/* Stream a parquet text column into the speed index builder
+ * path_glob: file, directory (all *.parquet) or dir/pattern with * and ?
+ * n_threads: decode threads, 0 = one per CPU
+ * Returns: number of documents added, or a negative fts_error_t */
+int64_t fts_speed_ingest_parquet(fts_handle_t handle, const char* path_glob,
+                                 const char* column, uint32_t n_threads);
+
+/* Resumable fts_speed_ingest_parquet: checkpoints progress under
+ * checkpoint_dir and, if a checkpoint exists there, restores it into the
+ * (empty) builder and continues after it. Remove checkpoint_dir once the
+ * built index is safely stored.
+ * Returns: documents restored plus documents added, or a negative fts_error_t */
+int64_t fts_speed_ingest_parquet_resumable(fts_handle_t handle, const char* path_glob,
+                                           const char* column, uint32_t n_threads,
+                                           const char* checkpoint_dir);
+
 /* Build the speed index from builder */
 fts_handle_t fts_speed_builder_build(fts_handle_t handle);
 
@@ -72,9 +154,42 @@ fts_handle_t fts_balanced_builder_create(void);
 /* Add a document to the balanced index builder */
 int fts_balanced_builder_add(fts_handle_t handle, const char* text, size_t text_len);
 
+/* Add a document with an external key (URL, UUID, ...) to the balanced builder
+ * Keys are returned by fts_ref_search_keyed and resolved by fts_ref_lookup_key */
+int fts_balanced_builder_add_keyed(fts_handle_t handle, const char* key, size_t key_len,
+                                   const char* text, size_t text_len);
+
+/* Set doc values (per-document attributes for filtering and sorting) of
+ * doc_id in the balanced builder. A field keeps the kind of its first set;
+ * unset docs read as 0 / no value.
+ * Returns: FTS_OK, or FTS_ERR_INVALID_ARGUMENT on a kind mismatch */
+int fts_balanced_builder_set_int(fts_handle_t handle, uint32_t doc_id,
+                                 const char* field, size_t field_len, int64_t value);
+int fts_balanced_builder_set_float(fts_handle_t handle, uint32_t doc_id,
+                                   const char* field, size_t field_len, double value);
+int fts_balanced_builder_set_string(fts_handle_t handle, uint32_t doc_id,
+                                    const char* field, size_t field_len,
+                                    const char* value, size_t value_len);
+
+/* Stream a parquet text column into the balanced index builder */
+int64_t fts_balanced_ingest_parquet(fts_handle_t handle, const char* path_glob,
+                                    const char* column, uint32_t n_threads);
+
+/* Resumable fts_balanced_ingest_parquet (see fts_speed_ingest_parquet_resumable) */
+int64_t fts_balanced_ingest_parquet_resumable(fts_handle_t handle, const char* path_glob,
+                                              const char* column, uint32_t n_threads,
+                                              const char* checkpoint_dir);
+
 /* Build the balanced index from builder */
 fts_handle_t fts_balanced_builder_build(fts_handle_t handle);
 
+/* Build the balanced index with a static rank: weight * <field> (an int or
+ * float doc value) is added to every BM25 score, and posting blocks carry the
+ * static maximum so top-K search can stop early. order != 0 renumbers docs by
+ * descending static score; map result IDs back with fts_ref_original_id. */
+fts_handle_t fts_balanced_builder_build_static(fts_handle_t handle, const char* field,
+                                               size_t field_len, float weight, uint32_t order);
+
 /* Destroy a balanced index builder */
 void fts_balanced_builder_destroy(fts_handle_t handle);
 
@@ -95,6 +210,32 @@ fts_handle_t fts_compact_builder_create(void);
 /* Add a document to the compact index builder */
 int fts_compact_builder_add(fts_handle_t handle, const char* text, size_t text_len);
 
+/* Add a document with an external key (URL, UUID, ...) to the compact builder
+ * Keys are returned by fts_ref_search_keyed and resolved by fts_ref_lookup_key */
+int fts_compact_builder_add_keyed(fts_handle_t handle, const char* key, size_t key_len,
+                                  const char* text, size_t text_len);
+
+/* Set doc values (per-document attributes for filtering and sorting) of
+ * doc_id in the compact builder. A field keeps the kind of its first set;
+ * unset docs read as 0 / no value.
+ * Returns: FTS_OK, or FTS_ERR_INVALID_ARGUMENT on a kind mismatch */
+int fts_compact_builder_set_int(fts_handle_t handle, uint32_t doc_id,
+                                const char* field, size_t field_len, int64_t value);
+int fts_compact_builder_set_float(fts_handle_t handle, uint32_t doc_id,
+                                  const char* field, size_t field_len, double value);
+int fts_compact_builder_set_string(fts_handle_t handle, uint32_t doc_id,
+                                   const char* field, size_t field_len,
+                                   const char* value, size_t value_len);
+
+/* Stream a parquet text column into the compact index builder */
+int64_t fts_compact_ingest_parquet(fts_handle_t handle, const char* path_glob,
+                                   const char* column, uint32_t n_threads);
+
+/* Resumable fts_compact_ingest_parquet (see fts_speed_ingest_parquet_resumable) */
+int64_t fts_compact_ingest_parquet_resumable(fts_handle_t handle, const char* path_glob,
+                                             const char* column, uint32_t n_threads,
+                                             const char* checkpoint_dir);
+
 /* Build the compact index from builder */
 fts_handle_t fts_compact_builder_build(fts_handle_t handle);
 
@@ -108,6 +249,71 @@ int fts_compact_search(fts_handle_t handle, const char* query, size_t query_len,
 /* Destroy a compact index */
 void fts_compact_destroy(fts_handle_t handle);
 
+/* ============================================================================
+ * Hot-Swap Index Reference (zero-downtime rebuilds)
+ * ============================================================================ */
+
+/* Index profiles, for fts_index_ref_create */
+typedef enum {
+    FTS_PROFILE_SPEED = 0,
+    FTS_PROFILE_BALANCED = 1,
+    FTS_PROFILE_COMPACT = 2
+} fts_profile_t;
+
+/* Create an index reference for profile, publishing index (may be NULL)
+ * The reference takes ownership of index; do not destroy it directly */
+fts_index_ref_t fts_index_ref_create(int32_t profile, fts_handle_t index);
+
+/* Atomically publish new_index (same profile; may be NULL to unpublish)
+ * In-flight searches finish on the previous index, which is destroyed
+ * when the last of them completes. Searches never block on a swap.
+ * Returns: FTS_OK or FTS_ERR_ALLOCATION_FAILED */
+int fts_swap(fts_index_ref_t ref, fts_handle_t new_index);
+
+/* Search the currently published index
+ * Returns: number of results, 0 if nothing is published */
+int fts_ref_search(fts_index_ref_t ref, const char* query, size_t query_len,
+                   fts_search_result_t* results, size_t max_results);
+
+/* Get statistics of the currently published index
+ * Returns: FTS_OK or FTS_ERR_NOT_FOUND if nothing is published */
+int fts_ref_stats(fts_index_ref_t ref, fts_stats_t* stats);
+
+/* Search the currently published index with doc-values filters and a sort
+ * Clauses are ANDed and checked during posting traversal; blocks of docs
+ * whose min/max rule a clause out are skipped. clauses may be NULL when
+ * n_clauses is 0 (at most 8), sort NULL for BM25 order.
+ * Returns: number of results, or a negative fts_error_t
+ * (FTS_ERR_NOT_FOUND for an unknown field or nothing published) */
+int fts_ref_search_with(fts_index_ref_t ref, const char* query, size_t query_len,
+                        const fts_filter_clause_t* clauses, size_t n_clauses,
+                        const fts_sort_t* sort,
+                        fts_search_result_t* results, size_t max_results);
+
+/* Search the currently published index, returning external keys
+ * Keys are packed into key_buf; a key that does not fit gets
+ * key_offset = UINT32_MAX and key_len = its size (retry with a larger buffer)
+ * Only the latest doc of a re-added key is returned.
+ * Returns: number of results, 0 if nothing is published */
+int fts_ref_search_keyed(fts_index_ref_t ref, const char* query, size_t query_len,
+                         fts_keyed_result_t* results, size_t max_results,
+                         char* key_buf, size_t key_buf_len);
+
+/* Copy the external key of doc_id into buf (at most buf_len bytes)
+ * Returns: key length (0 if the doc has no key), or a negative fts_error_t */
+int64_t fts_ref_doc_key(fts_index_ref_t ref, uint32_t doc_id, char* buf, size_t buf_len);
+
+/* Look up the doc ID of an external key (the latest doc if re-added)
+ * Returns: doc ID, or FTS_ERR_NOT_FOUND */
+int64_t fts_ref_lookup_key(fts_index_ref_t ref, const char* key, size_t key_len);
+
+/* Map a doc ID of the published index to the ID it was added with
+ * Returns: original doc ID, or FTS_ERR_NOT_FOUND */
+int64_t fts_ref_original_id(fts_index_ref_t ref, uint32_t doc_id);
+
+/* Destroy an index reference and release the published index */
+void fts_index_ref_destroy(fts_index_ref_t ref);
+
 /* ============================================================================
  * Utility Functions
  * ============================================================================ */
@@ -13,17 +13,74 @@ package fts_zig
 import "C"
 import (
 	"sync"
+	"sync/atomic"
 	"unsafe"
 )
 
 // cgoDriver implements Driver using CGO.
+//
+// Built indexes are published as generations behind an atomic pointer, so
+// Rebuild can swap in a replacement without blocking Search. The mutex only
+// guards the builder.
 type cgoDriver struct {
-	mu       sync.RWMutex
-	profile  Profile
-	builder  C.fts_handle_t
-	index    C.fts_handle_t
-	built    bool
-	docCount uint32
+	mu        sync.RWMutex
+	rebuildMu sync.Mutex // serializes Rebuild calls
+	profile   Profile
+	builder   C.fts_handle_t
+	built     bool
+	keyed     bool // some document added to the builder has an external key
+	docCount  uint32
+	gen       atomic.Pointer[generation] // nil until built and after Close
+}
+
+// generation is a published index together with the driver state that
+// describes it. Searches pin one for the whole call, so doc IDs and keys
+// are always read against the index that produced them.
+type generation struct {
+	ref       C.fts_index_ref_t
+	keyed     bool // some document has an external key
+	reordered bool // doc IDs renumbered by static rank
+	// users counts calls in flight, plus one while published; the ref is
+	// destroyed when it drops to zero.
+	users atomic.Int64
+}
+
+func newGeneration(ref C.fts_index_ref_t, keyed, reordered bool) *generation {
+	g := &generation{ref: ref, keyed: keyed, reordered: reordered}
+	g.users.Store(1)
+	return g
+}
+
+// tryAcquire pins g unless it has already been retired.
+func (g *generation) tryAcquire() bool {
+	for {
+		n := g.users.Load()
+		if n == 0 {
+			return false
+		}
+		if g.users.CompareAndSwap(n, n+1) {
+			return true
+		}
+	}
+}
+
+func (g *generation) release() {
+	if g.users.Add(-1) == 0 {
+		C.fts_index_ref_destroy(g.ref)
+	}
+}
+
+// acquire pins the published generation, or returns nil if there is none.
+// The caller must release it.
+func (d *cgoDriver) acquire() *generation {
+	for {
+		g := d.gen.Load()
+		// A generation is unpublished before it is retired, so a failed
+		// tryAcquire means a newer one (or nil) is loaded next time.
+		if g == nil || g.tryAcquire() {
+			return g
+		}
+	}
 }
 
 func newCGODriver(cfg Config) (Driver, error) {
@@ -31,16 +88,7 @@ func newCGODriver(cfg Config) (Driver, error) {
 		profile: cfg.Profile,
 	}
 
-	// Create builder based on profile
-	switch cfg.Profile {
-	case ProfileSpeed:
-		d.builder = C.fts_speed_builder_create()
-	case ProfileBalanced:
-		d.builder = C.fts_balanced_builder_create()
-	case ProfileCompact:
-		d.builder = C.fts_compact_builder_create()
-	}
-
+	d.builder = createBuilder(cfg.Profile)
 	if d.builder == nil {
 		return nil, ErrNotInitialized
 	}
@@ -48,29 +96,107 @@ func newCGODriver(cfg Config) (Driver, error) {
 	return d, nil
 }
 
-func (d *cgoDriver) AddDocument(text string) (uint32, error) {
-	d.mu.Lock()
-	defer d.mu.Unlock()
+func createBuilder(profile Profile) C.fts_handle_t {
+	switch profile {
+	case ProfileSpeed:
+		return C.fts_speed_builder_create()
+	case ProfileBalanced:
+		return C.fts_balanced_builder_create()
+	case ProfileCompact:
+		return C.fts_compact_builder_create()
+	}
+	return nil
+}
 
-	if d.built {
-		return 0, ErrAlreadyBuilt
+func builderAdd(profile Profile, builder C.fts_handle_t, text string) error {
+	cText := C.CString(text)
+	defer C.free(unsafe.Pointer(cText))
+
+	var ret C.int
+	switch profile {
+	case ProfileSpeed:
+		ret = C.fts_speed_builder_add(builder, cText, C.size_t(len(text)))
+	case ProfileBalanced:
+		ret = C.fts_balanced_builder_add(builder, cText, C.size_t(len(text)))
+	case ProfileCompact:
+		ret = C.fts_compact_builder_add(builder, cText, C.size_t(len(text)))
 	}
 
+	if ret != 0 {
+		return ErrInvalidHandle
+	}
+	return nil
+}
+
+func builderAddKeyed(profile Profile, builder C.fts_handle_t, key, text string) error {
+	cKey := C.CString(key)
+	defer C.free(unsafe.Pointer(cKey))
 	cText := C.CString(text)
 	defer C.free(unsafe.Pointer(cText))
 
 	var ret C.int
-	switch d.profile {
+	switch profile {
 	case ProfileSpeed:
-		ret = C.fts_speed_builder_add(d.builder, cText, C.size_t(len(text)))
+		ret = C.fts_speed_builder_add_keyed(builder, cKey, C.size_t(len(key)), cText, C.size_t(len(text)))
 	case ProfileBalanced:
-		ret = C.fts_balanced_builder_add(d.builder, cText, C.size_t(len(text)))
+		ret = C.fts_balanced_builder_add_keyed(builder, cKey, C.size_t(len(key)), cText, C.size_t(len(text)))
 	case ProfileCompact:
-		ret = C.fts_compact_builder_add(d.builder, cText, C.size_t(len(text)))
+		ret = C.fts_compact_builder_add_keyed(builder, cKey, C.size_t(len(key)), cText, C.size_t(len(text)))
 	}
 
 	if ret != 0 {
-		return 0, ErrInvalidHandle
+		return ErrInvalidHandle
+	}
+	return nil
+}
+
+// buildIndex finalizes builder into an index and destroys the builder.
+func buildIndex(profile Profile, builder C.fts_handle_t) C.fts_handle_t {
+	var index C.fts_handle_t
+	switch profile {
+	case ProfileSpeed:
+		index = C.fts_speed_builder_build(builder)
+	case ProfileBalanced:
+		index = C.fts_balanced_builder_build(builder)
+	case ProfileCompact:
+		index = C.fts_compact_builder_build(builder)
+	}
+	destroyBuilder(profile, builder)
+	return index
+}
+
+func destroyBuilder(profile Profile, builder C.fts_handle_t) {
+	switch profile {
+	case ProfileSpeed:
+		C.fts_speed_builder_destroy(builder)
+	case ProfileBalanced:
+		C.fts_balanced_builder_destroy(builder)
+	case ProfileCompact:
+		C.fts_compact_builder_destroy(builder)
+	}
+}
+
+func destroyIndex(profile Profile, index C.fts_handle_t) {
+	switch profile {
+	case ProfileSpeed:
+		C.fts_speed_destroy(index)
+	case ProfileBalanced:
+		C.fts_balanced_destroy(index)
+	case ProfileCompact:
+		C.fts_compact_destroy(index)
+	}
+}
+
+func (d *cgoDriver) AddDocument(text string) (uint32, error) {
+	d.mu.Lock()
+	defer d.mu.Unlock()
+
+	if d.built {
+		return 0, ErrAlreadyBuilt
+	}
+
+	if err := builderAdd(d.profile, d.builder, text); err != nil {
+		return 0, err
 	}
 
 	docID := d.docCount
@@ -78,6 +204,44 @@ func (d *cgoDriver) AddDocument(text string) (uint32, error) {
 	return docID, nil
 }
 
+func (d *cgoDriver) AddKeyedDocument(key, text string) (uint32, error) {
+	d.mu.Lock()
+	defer d.mu.Unlock()
+
+	if d.built {
+		return 0, ErrAlreadyBuilt
+	}
+
+	if err := builderAddKeyed(d.profile, d.builder, key, text); err != nil {
+		return 0, err
+	}
+
+	docID := d.docCount
+	d.docCount++
+	d.keyed = true
+	return docID, nil
+}
+
+func (d *cgoDriver) LookupKey(key string) (uint32, bool, error) {
+	g := d.acquire()
+	if g == nil {
+		return 0, false, ErrNotBuilt
+	}
+	defer g.release()
+
+	cKey := C.CString(key)
+	defer C.free(unsafe.Pointer(cKey))
+
+	ret := C.fts_ref_lookup_key(g.ref, cKey, C.size_t(len(key)))
+	if ret == C.FTS_ERR_NOT_FOUND {
+		return 0, false, nil
+	}
+	if ret < 0 {
+		return 0, false, ffiError(int(ret))
+	}
+	return g.originalID(uint32(ret)), true, nil
+}
+
 func (d *cgoDriver) AddDocuments(texts []string) error {
 	for _, text := range texts {
 		if _, err := d.AddDocument(text); err != nil {
@@ -87,6 +251,68 @@ func (d *cgoDriver) AddDocuments(texts []string) error {
 	return nil
 }
 
+func (d *cgoDriver) IngestParquet(pathGlob, column string, nThreads int) (int, error) {
+	return d.ingestParquet(pathGlob, column, nThreads, "")
+}
+
+func (d *cgoDriver) IngestParquetResumable(pathGlob, column string, nThreads int, checkpointDir string) (int, error) {
+	if checkpointDir == "" {
+		return 0, ErrInvalidArg
+	}
+	return d.ingestParquet(pathGlob, column, nThreads, checkpointDir)
+}
+
+func (d *cgoDriver) ingestParquet(pathGlob, column string, nThreads int, checkpointDir string) (int, error) {
+	d.mu.Lock()
+	defer d.mu.Unlock()
+
+	if d.built {
+		return 0, ErrAlreadyBuilt
+	}
+
+	cPath := C.CString(pathGlob)
+	defer C.free(unsafe.Pointer(cPath))
+	cColumn := C.CString(column)
+	defer C.free(unsafe.Pointer(cColumn))
+	// Zero asks the library for one decode thread per CPU; negative counts
+	// would otherwise wrap to ~4 billion threads.
+	threads := C.uint32_t(0)
+	if nThreads > 0 {
+		threads = C.uint32_t(nThreads)
+	}
+
+	var ret C.int64_t
+	if checkpointDir == "" {
+		switch d.profile {
+		case ProfileSpeed:
+			ret = C.fts_speed_ingest_parquet(d.builder, cPath, cColumn, threads)
+		case ProfileBalanced:
+			ret = C.fts_balanced_ingest_parquet(d.builder, cPath, cColumn, threads)
+		case ProfileCompact:
+			ret = C.fts_compact_ingest_parquet(d.builder, cPath, cColumn, threads)
+		}
+	} else {
+		cDir := C.CString(checkpointDir)
+		defer C.free(unsafe.Pointer(cDir))
+
+		switch d.profile {
+		case ProfileSpeed:
+			ret = C.fts_speed_ingest_parquet_resumable(d.builder, cPath, cColumn, threads, cDir)
+		case ProfileBalanced:
+			ret = C.fts_balanced_ingest_parquet_resumable(d.builder, cPath, cColumn, threads, cDir)
+		case ProfileCompact:
+			ret = C.fts_compact_ingest_parquet_resumable(d.builder, cPath, cColumn, threads, cDir)
+		}
+	}
+
+	if ret < 0 {
+		return 0, ffiError(int(ret))
+	}
+
+	d.docCount += uint32(ret)
+	return int(ret), nil
+}
+
 func (d *cgoDriver) Build() error {
 	d.mu.Lock()
 	defer d.mu.Unlock()
@@ -95,81 +321,340 @@ func (d *cgoDriver) Build() error {
 		return ErrAlreadyBuilt
 	}
 
-	switch d.profile {
-	case ProfileSpeed:
-		d.index = C.fts_speed_builder_build(d.builder)
-		C.fts_speed_builder_destroy(d.builder)
-	case ProfileBalanced:
-		d.index = C.fts_balanced_builder_build(d.builder)
-		C.fts_balanced_builder_destroy(d.builder)
-	case ProfileCompact:
-		d.index = C.fts_compact_builder_build(d.builder)
-		C.fts_compact_builder_destroy(d.builder)
+	index := buildIndex(d.profile, d.builder)
+	d.builder = nil
+	return d.publish(index, false)
+}
+
+// BuildStaticRanked builds the index with weight * field (an int or float
+// doc value) added to every score. With reorder, docs are renumbered by
+// static rank so searches stop early; result IDs are mapped back.
+func (d *cgoDriver) BuildStaticRanked(field string, weight float32, reorder bool) error {
+	d.mu.Lock()
+	defer d.mu.Unlock()
+
+	if d.built {
+		return ErrAlreadyBuilt
 	}
+	if d.profile != ProfileBalanced {
+		return ErrUnsupported
+	}
+
+	cField := C.CString(field)
+	defer C.free(unsafe.Pointer(cField))
 
+	var order C.uint32_t
+	if reorder {
+		order = 1
+	}
+	index := C.fts_balanced_builder_build_static(d.builder, cField, C.size_t(len(field)),
+		C.float(weight), order)
+	if index == nil {
+		// Builder is kept so Build can still be used (e.g. unknown field)
+		return ErrInvalidArg
+	}
+	destroyBuilder(d.profile, d.builder)
 	d.builder = nil
 
-	if d.index == nil {
-		return ErrInvalidHandle
+	return d.publish(index, reorder)
+}
+
+// publish serves a freshly built index as the first generation.
+func (d *cgoDriver) publish(index C.fts_handle_t, reordered bool) error {
+	ref, err := d.newRef(index)
+	if err != nil {
+		return err
 	}
 
+	d.gen.Store(newGeneration(ref, d.keyed, reordered))
 	d.built = true
 	return nil
 }
 
-func (d *cgoDriver) Search(query string, limit int) ([]SearchResult, error) {
-	d.mu.RLock()
-	defer d.mu.RUnlock()
+// newRef wraps a built index in an index reference, destroying the index
+// if that fails.
+func (d *cgoDriver) newRef(index C.fts_handle_t) (C.fts_index_ref_t, error) {
+	if index == nil {
+		return nil, ErrInvalidHandle
+	}
+
+	ref := C.fts_index_ref_create(C.int32_t(d.profile), index)
+	if ref == nil {
+		destroyIndex(d.profile, index)
+		return nil, ErrOutOfMemory
+	}
+	return ref, nil
+}
+
+// originalID maps a doc ID of g's index to the ID returned when the
+// document was added.
+func (g *generation) originalID(docID uint32) uint32 {
+	if !g.reordered {
+		return docID
+	}
+	if ret := C.fts_ref_original_id(g.ref, C.uint32_t(docID)); ret >= 0 {
+		return uint32(ret)
+	}
+	return docID
+}
+
+// Rebuild indexes texts into a fresh index and atomically swaps it in.
+// Searches keep running against the previous index while it builds and
+// finish on it if they started before the swap; it is freed afterwards.
+// The replacement is always a plain build, so an index built with
+// BuildStaticRanked loses its static rank.
+func (d *cgoDriver) Rebuild(texts []string) error {
+	d.rebuildMu.Lock()
+	defer d.rebuildMu.Unlock()
+
+	if d.gen.Load() == nil {
+		return ErrNotBuilt
+	}
+
+	builder := createBuilder(d.profile)
+	if builder == nil {
+		return ErrOutOfMemory
+	}
+	for _, text := range texts {
+		if err := builderAdd(d.profile, builder, text); err != nil {
+			destroyBuilder(d.profile, builder)
+			return err
+		}
+	}
+
+	ref, err := d.newRef(buildIndex(d.profile, builder))
+	if err != nil {
+		return err
+	}
 
-	if !d.built {
+	// The replacement is a plain build over texts: IDs follow texts order
+	// (no static-rank renumbering) and no document carries a key. Rebuilds
+	// are serialized, so the swap only fails if Close ran meanwhile.
+	next := newGeneration(ref, false, false)
+	prev := d.gen.Load()
+	if prev == nil || !d.gen.CompareAndSwap(prev, next) {
+		next.release()
+		return ErrNotBuilt
+	}
+	prev.release()
+	return nil
+}
+
+func (d *cgoDriver) Search(query string, limit int) ([]SearchResult, error) {
+	g := d.acquire()
+	if g == nil {
 		return nil, ErrNotBuilt
 	}
+	defer g.release()
 
 	cQuery := C.CString(query)
 	defer C.free(unsafe.Pointer(cQuery))
 
+	if g.keyed {
+		return g.searchKeyed(cQuery, len(query), limit), nil
+	}
+
 	results := make([]C.fts_search_result_t, limit)
-	var count C.int
+	count := C.fts_ref_search(g.ref, cQuery, C.size_t(len(query)),
+		&results[0], C.size_t(limit))
 
-	switch d.profile {
-	case ProfileSpeed:
-		count = C.fts_speed_search(d.index, cQuery, C.size_t(len(query)),
-			&results[0], C.size_t(limit))
-	case ProfileBalanced:
-		count = C.fts_balanced_search(d.index, cQuery, C.size_t(len(query)),
-			&results[0], C.size_t(limit))
-	case ProfileCompact:
-		count = C.fts_compact_search(d.index, cQuery, C.size_t(len(query)),
-			&results[0], C.size_t(limit))
+	out := make([]SearchResult, int(count))
+	for i := 0; i < int(count); i++ {
+		out[i] = SearchResult{
+			DocID: g.originalID(uint32(results[i].doc_id)),
+			Score: float32(results[i].score),
+		}
+	}
+
+	return out, nil
+}
+
+// searchKeyed runs a keyed search, retrying once with a key buffer large
+// enough for every hit if the first guess was too small.
+func (g *generation) searchKeyed(cQuery *C.char, queryLen, limit int) []SearchResult {
+	results := make([]C.fts_keyed_result_t, limit)
+	keyBuf := make([]byte, 128*limit)
+
+	var count int
+	for attempt := 0; attempt < 2; attempt++ {
+		count = int(C.fts_ref_search_keyed(g.ref, cQuery, C.size_t(queryLen),
+			&results[0], C.size_t(limit),
+			(*C.char)(unsafe.Pointer(&keyBuf[0])), C.size_t(len(keyBuf))))
+
+		need := 0
+		for i := 0; i < count; i++ {
+			need += int(results[i].key_len)
+		}
+		if need <= len(keyBuf) {
+			break
+		}
+		keyBuf = make([]byte, need)
+	}
+
+	out := make([]SearchResult, count)
+	for i := 0; i < count; i++ {
+		r := results[i]
+		out[i] = SearchResult{
+			DocID: g.originalID(uint32(r.doc_id)),
+			Score: float32(r.score),
+		}
+		if off := uint32(r.key_offset); off != ^uint32(0) {
+			out[i].Key = string(keyBuf[off : off+uint32(r.key_len)])
+		}
+	}
+	return out
+}
+
+func (d *cgoDriver) SetInt(docID uint32, field string, value int64) error {
+	return d.setDocValue(docID, field, func(cField *C.char) C.int {
+		n := C.size_t(len(field))
+		switch d.profile {
+		case ProfileSpeed:
+			return C.fts_speed_builder_set_int(d.builder, C.uint32_t(docID), cField, n, C.int64_t(value))
+		case ProfileBalanced:
+			return C.fts_balanced_builder_set_int(d.builder, C.uint32_t(docID), cField, n, C.int64_t(value))
+		case ProfileCompact:
+			return C.fts_compact_builder_set_int(d.builder, C.uint32_t(docID), cField, n, C.int64_t(value))
+		}
+		return C.FTS_ERR_INVALID_HANDLE
+	})
+}
+
+func (d *cgoDriver) SetFloat(docID uint32, field string, value float64) error {
+	return d.setDocValue(docID, field, func(cField *C.char) C.int {
+		n := C.size_t(len(field))
+		switch d.profile {
+		case ProfileSpeed:
+			return C.fts_speed_builder_set_float(d.builder, C.uint32_t(docID), cField, n, C.double(value))
+		case ProfileBalanced:
+			return C.fts_balanced_builder_set_float(d.builder, C.uint32_t(docID), cField, n, C.double(value))
+		case ProfileCompact:
+			return C.fts_compact_builder_set_float(d.builder, C.uint32_t(docID), cField, n, C.double(value))
+		}
+		return C.FTS_ERR_INVALID_HANDLE
+	})
+}
+
+func (d *cgoDriver) SetString(docID uint32, field, value string) error {
+	cValue := C.CString(value)
+	defer C.free(unsafe.Pointer(cValue))
+	vn := C.size_t(len(value))
+
+	return d.setDocValue(docID, field, func(cField *C.char) C.int {
+		n := C.size_t(len(field))
+		switch d.profile {
+		case ProfileSpeed:
+			return C.fts_speed_builder_set_string(d.builder, C.uint32_t(docID), cField, n, cValue, vn)
+		case ProfileBalanced:
+			return C.fts_balanced_builder_set_string(d.builder, C.uint32_t(docID), cField, n, cValue, vn)
+		case ProfileCompact:
+			return C.fts_compact_builder_set_string(d.builder, C.uint32_t(docID), cField, n, cValue, vn)
+		}
+		return C.FTS_ERR_INVALID_HANDLE
+	})
+}
+
+// setDocValue runs set against the builder with field as a C string.
+func (d *cgoDriver) setDocValue(docID uint32, field string, set func(cField *C.char) C.int) error {
+	d.mu.Lock()
+	defer d.mu.Unlock()
+
+	if d.built {
+		return ErrAlreadyBuilt
+	}
+	if docID >= d.docCount {
+		return ErrInvalidArg
+	}
+
+	cField := C.CString(field)
+	defer C.free(unsafe.Pointer(cField))
+
+	if ret := set(cField); ret != C.FTS_OK {
+		return ffiError(int(ret))
+	}
+	return nil
+}
+
+func (d *cgoDriver) SearchWith(query string, limit int, opts SearchOptions) ([]SearchResult, error) {
+	g := d.acquire()
+	if g == nil {
+		return nil, ErrNotBuilt
+	}
+	defer g.release()
+
+	var cStrings []*C.char
+	cString := func(s string) *C.char {
+		cs := C.CString(s)
+		cStrings = append(cStrings, cs)
+		return cs
+	}
+	defer func() {
+		for _, cs := range cStrings {
+			C.free(unsafe.Pointer(cs))
+		}
+	}()
+
+	// Only C pointers are stored in the clauses, so the slice may live in Go memory.
+	var clauses []C.fts_filter_clause_t
+	for _, f := range opts.Filters {
+		clauses = append(clauses, C.fts_filter_clause_t{
+			field:     cString(f.Field),
+			field_len: C.size_t(len(f.Field)),
+			op:        C.uint32_t(f.Op),
+			int_min:   C.int64_t(f.IntMin),
+			int_max:   C.int64_t(f.IntMax),
+			float_min: C.double(f.FloatMin),
+			float_max: C.double(f.FloatMax),
+			value:     cString(f.Value),
+			value_len: C.size_t(len(f.Value)),
+		})
+	}
+	var clausePtr *C.fts_filter_clause_t
+	if len(clauses) > 0 {
+		clausePtr = &clauses[0]
+	}
+
+	sort := C.fts_sort_t{
+		mode:      C.uint32_t(opts.Sort),
+		field:     cString(opts.SortField),
+		field_len: C.size_t(len(opts.SortField)),
+		weight:    C.float(opts.BlendWeight),
+	}
+	if !opts.Ascending {
+		sort.descending = 1
+	}
+
+	cQuery := cString(query)
+	results := make([]C.fts_search_result_t, limit)
+	count := C.fts_ref_search_with(g.ref, cQuery, C.size_t(len(query)),
+		clausePtr, C.size_t(len(clauses)), &sort,
+		&results[0], C.size_t(limit))
+	if count < 0 {
+		return nil, ffiError(int(count))
 	}
 
 	out := make([]SearchResult, int(count))
 	for i := 0; i < int(count); i++ {
 		out[i] = SearchResult{
-			DocID: uint32(results[i].doc_id),
+			DocID: g.originalID(uint32(results[i].doc_id)),
 			Score: float32(results[i].score),
 		}
 	}
-
 	return out, nil
 }
 
 func (d *cgoDriver) Stats() (Stats, error) {
-	d.mu.RLock()
-	defer d.mu.RUnlock()
-
-	if !d.built {
+	g := d.acquire()
+	if g == nil {
+		d.mu.RLock()
+		defer d.mu.RUnlock()
 		return Stats{DocCount: d.docCount}, nil
 	}
+	defer g.release()
 
 	var stats C.fts_stats_t
-
-	switch d.profile {
-	case ProfileSpeed:
-		C.fts_speed_stats(d.index, &stats)
-	default:
-		// Other profiles don't have stats function yet
-		return Stats{DocCount: d.docCount}, nil
+	if ret := C.fts_ref_stats(g.ref, &stats); ret != C.FTS_OK {
+		return Stats{}, ffiError(int(ret))
 	}
 
 	return Stats{
@@ -184,32 +669,34 @@ func (d *cgoDriver) Close() error {
 	defer d.mu.Unlock()
 
 	if d.builder != nil {
-		switch d.profile {
-		case ProfileSpeed:
-			C.fts_speed_builder_destroy(d.builder)
-		case ProfileBalanced:
-			C.fts_balanced_builder_destroy(d.builder)
-		case ProfileCompact:
-			C.fts_compact_builder_destroy(d.builder)
-		}
+		destroyBuilder(d.profile, d.builder)
 		d.builder = nil
 	}
 
-	if d.index != nil {
-		switch d.profile {
-		case ProfileSpeed:
-			C.fts_speed_destroy(d.index)
-		case ProfileBalanced:
-			C.fts_balanced_destroy(d.index)
-		case ProfileCompact:
-			C.fts_compact_destroy(d.index)
-		}
-		d.index = nil
+	// Searches still running finish on the index before it is freed
+	if g := d.gen.Swap(nil); g != nil {
+		g.release()
 	}
 
 	return nil
 }
 
+// ffiError maps a negative fts_error_t to a Go error.
+func ffiError(code int) error {
+	switch code {
+	case C.FTS_ERR_INVALID_HANDLE:
+		return ErrInvalidHandle
+	case C.FTS_ERR_ALLOCATION_FAILED:
+		return ErrOutOfMemory
+	case C.FTS_ERR_NOT_FOUND:
+		return ErrNotFound
+	case C.FTS_ERR_INVALID_ARGUMENT:
+		return ErrInvalidArg
+	default:
+		return ErrIO
+	}
+}
+
 // Version returns the fts_zig library version.
 func Version() string {
 	return C.GoString(C.fts_version())
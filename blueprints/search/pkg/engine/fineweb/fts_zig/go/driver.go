@@ -10,6 +10,7 @@ package fts_zig
 import (
 	"errors"
 	"iter"
+	"os"
 )
 
 // Profile represents the search profile to use.
@@ -28,6 +29,8 @@ const (
 type SearchResult struct {
 	DocID uint32
 	Score float32
+	// Key is the external key of keyed documents (see KeyedDriver).
+	Key string
 }
 
 // Stats represents index statistics.
@@ -64,6 +67,117 @@ type Driver interface {
 	Close() error
 }
 
+// ParquetIngester is implemented by drivers that can read parquet files
+// natively, without materializing texts in Go.
+type ParquetIngester interface {
+	// IngestParquet indexes column of every parquet file matched by pathGlob
+	// (a file, a directory, or dir/pattern with * and ?) using nThreads decode
+	// threads (<= 0 = one per CPU). Returns the number of documents added.
+	IngestParquet(pathGlob, column string, nThreads int) (int, error)
+
+	// IngestParquetResumable is IngestParquet with checkpoints under
+	// checkpointDir. If a checkpoint exists it is restored into the (empty)
+	// builder and ingest continues after it. Returns documents restored plus
+	// documents added.
+	IngestParquetResumable(pathGlob, column string, nThreads int, checkpointDir string) (int, error)
+}
+
+// Rebuilder is implemented by drivers that can replace a built index
+// without downtime.
+type Rebuilder interface {
+	// Rebuild indexes texts into a new index and atomically publishes it.
+	// Searches are served from the previous index until the swap and never
+	// block on it.
+	Rebuild(texts []string) error
+}
+
+// KeyedDriver is implemented by drivers that store external document keys
+// (URLs, UUIDs, ...) inside the index. Search results then carry the key of
+// each hit, and keys can be resolved back to doc IDs for updates.
+type KeyedDriver interface {
+	// AddKeyedDocument adds a document with an external key.
+	AddKeyedDocument(key, text string) (uint32, error)
+
+	// LookupKey returns the doc ID of key in the built index. If the key was
+	// added more than once, the latest document wins.
+	LookupKey(key string) (uint32, bool, error)
+}
+
+// FilterOp selects how a Filter compares a doc value.
+type FilterOp int
+
+const (
+	// FilterIntRange keeps docs with IntMin <= value <= IntMax.
+	FilterIntRange FilterOp = iota
+	// FilterFloatRange keeps docs with FloatMin <= value <= FloatMax.
+	FilterFloatRange
+	// FilterStringEq keeps docs whose value equals Value.
+	FilterStringEq
+)
+
+// Filter restricts search results by a doc-values field.
+type Filter struct {
+	Field    string
+	Op       FilterOp
+	IntMin   int64
+	IntMax   int64
+	FloatMin float64
+	FloatMax float64
+	Value    string
+}
+
+// SortMode selects the ranking of filtered searches.
+type SortMode int
+
+const (
+	// SortScore ranks by BM25 score.
+	SortScore SortMode = iota
+	// SortField ranks by SearchOptions.SortField; BM25 breaks ties.
+	SortField
+	// SortBlend ranks by BM25 + BlendWeight * SortField.
+	SortBlend
+)
+
+// SearchOptions configures DocValuesDriver.SearchWith. Filters are ANDed.
+type SearchOptions struct {
+	Filters     []Filter
+	Sort        SortMode
+	SortField   string
+	Ascending   bool
+	BlendWeight float32
+}
+
+// DocValuesDriver is implemented by drivers that store per-document
+// attributes (language, domain, date, quality, ...) as columnar doc values
+// and evaluate filters and field sorts inside the index, instead of
+// over-fetching and filtering in Go.
+type DocValuesDriver interface {
+	// SetInt sets an int doc value of an added document.
+	SetInt(docID uint32, field string, value int64) error
+
+	// SetFloat sets a float doc value of an added document.
+	SetFloat(docID uint32, field string, value float64) error
+
+	// SetString sets a low-cardinality string doc value of an added document.
+	SetString(docID uint32, field, value string) error
+
+	// SearchWith searches with filters and a sort order.
+	SearchWith(query string, limit int, opts SearchOptions) ([]SearchResult, error)
+}
+
+// StaticRanker is implemented by drivers that fold a query-independent
+// document score (quality, educational score, ...) into ranking and use it
+// to terminate top-K search early. Only the balanced profile supports it.
+type StaticRanker interface {
+	// BuildStaticRanked builds the index like Build, adding
+	// weight * <field> (an int or float doc value) to every search score.
+	// With reorder, docs are renumbered by descending static score so
+	// searches can stop once no remaining doc can enter the top-K; results
+	// still report the doc IDs returned by AddDocument. SearchWith ranks
+	// by BM25 or its requested sort, without the static score.
+	BuildStaticRanked(field string, weight float32, reorder bool) error
+}
+
 // Errors
 var (
 	ErrNotInitialized = errors.New("fts_zig: driver not initialized")
@@ -71,6 +185,11 @@ var (
 	ErrNotBuilt       = errors.New("fts_zig: index not built yet")
 	ErrInvalidHandle  = errors.New("fts_zig: invalid handle")
 	ErrCGODisabled    = errors.New("fts_zig: CGO is disabled")
+	ErrOutOfMemory    = errors.New("fts_zig: allocation failed")
+	ErrNotFound       = errors.New("fts_zig: not found")
+	ErrInvalidArg     = errors.New("fts_zig: invalid argument")
+	ErrIO             = errors.New("fts_zig: I/O error")
+	ErrUnsupported    = errors.New("fts_zig: not supported by this driver")
 )
 
 // Config holds configuration for creating a driver.
@@ -147,3 +266,32 @@ func ImportFromParquetIter(driver Driver, batches iter.Seq2[[]string, error]) (i
 	}
 	return total, nil
 }
+
+// ImportParquetNative indexes a parquet text column entirely inside the
+// library: row groups are decoded, decompressed and tokenized on native
+// threads and fed to the builder with bounded memory. Only drivers
+// implementing ParquetIngester (CGO) support it.
+func ImportParquetNative(driver Driver, pathGlob, column string, nThreads int) (int, error) {
+	ing, ok := driver.(ParquetIngester)
+	if !ok {
+		return 0, ErrUnsupported
+	}
+	return ing.IngestParquet(pathGlob, column, nThreads)
+}
+
+// ImportParquetResumable is ImportParquetNative with crash recovery: progress
+// is checkpointed under checkpointDir, and rerunning with the same inputs on
+// a fresh driver resumes after the last checkpoint. Call ClearCheckpoint once
+// the built index has been persisted.
+func ImportParquetResumable(driver Driver, pathGlob, column string, nThreads int, checkpointDir string) (int, error) {
+	ing, ok := driver.(ParquetIngester)
+	if !ok {
+		return 0, ErrUnsupported
+	}
+	return ing.IngestParquetResumable(pathGlob, column, nThreads, checkpointDir)
+}
+
+// ClearCheckpoint removes the checkpoints of a finished resumable import.
+func ClearCheckpoint(checkpointDir string) error {
+	return os.RemoveAll(checkpointDir)
+}
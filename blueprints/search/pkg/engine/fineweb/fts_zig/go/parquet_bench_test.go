@@ -272,3 +272,34 @@ func TestImportFromParquetIterError(t *testing.T) {
 		t.Errorf("expected 2 docs before error, got %d", n)
 	}
 }
+
+// TestImportParquetNativeUnsupported verifies non-native drivers are rejected.
+func TestImportParquetNativeUnsupported(t *testing.T) {
+	driver, err := NewIPCDriver(DefaultConfig())
+	if err != nil {
+		t.Fatalf("create driver: %v", err)
+	}
+	defer driver.Close()
+
+	n, err := ImportParquetNative(driver, "/tmp/fts_zig/*.parquet", "text", 0)
+	if err != ErrUnsupported {
+		t.Errorf("expected ErrUnsupported, got: %v", err)
+	}
+	if n != 0 {
+		t.Errorf("expected 0 docs, got %d", n)
+	}
+}
+
+// TestImportParquetResumableUnsupported verifies non-native drivers are rejected.
+func TestImportParquetResumableUnsupported(t *testing.T) {
+	driver, err := NewIPCDriver(DefaultConfig())
+	if err != nil {
+		t.Fatalf("create driver: %v", err)
+	}
+	defer driver.Close()
+
+	_, err = ImportParquetResumable(driver, "/tmp/fts_zig/*.parquet", "text", 0, t.TempDir())
+	if err != ErrUnsupported {
+		t.Errorf("expected ErrUnsupported, got: %v", err)
+	}
+}
@@ -0,0 +1,159 @@
+//! Snappy raw block decompression (no framing format)
+//! Used for SNAPPY-compressed parquet pages
+//!
+//! Block layout: varint uncompressed length, then a sequence of
+//! literal / copy elements selected by the low 2 bits of each tag byte.
+
+const std = @import("std");
+
+pub const Error = error{
+    CorruptInput,
+    OutputTooSmall,
+};
+
+const TAG_LITERAL: u8 = 0;
+const TAG_COPY1: u8 = 1;
+const TAG_COPY2: u8 = 2;
+const TAG_COPY4: u8 = 3;
+
+/// Read the uncompressed length stored in the block preamble
+pub fn decompressedLength(src: []const u8) Error!usize {
+    return (try readPreamble(src)).len;
+}
+
+/// Decompress a raw snappy block into `dst`
+/// Returns the number of bytes written (equal to the preamble length)
+pub fn decompress(src: []const u8, dst: []u8) Error!usize {
+    const preamble = try readPreamble(src);
+    if (preamble.len > dst.len) return error.OutputTooSmall;
+
+    const out = dst[0..preamble.len];
+    var s: usize = preamble.bytes;
+    var d: usize = 0;
+
+    while (s < src.len) {
+        const tag = src[s];
+        s += 1;
+
+        switch (tag & 0x03) {
+            TAG_LITERAL => {
+                var len: usize = tag >> 2;
+                if (len >= 60) {
+                    // 60..63: literal length-1 stored in the next 1..4 bytes
+                    const extra: usize = len - 59;
+                    if (s + extra > src.len) return error.CorruptInput;
+                    len = 0;
+                    for (0..extra) |i| {
+                        len |= @as(usize, src[s + i]) << @intCast(i * 8);
+                    }
+                    s += extra;
+                }
+                len += 1;
+
+                if (s + len > src.len or d + len > out.len) return error.CorruptInput;
+                @memcpy(out[d..][0..len], src[s..][0..len]);
+                s += len;
+                d += len;
+            },
+            TAG_COPY1 => {
+                if (s + 1 > src.len) return error.CorruptInput;
+                const len: usize = 4 + ((tag >> 2) & 0x07);
+                const offset: usize = (@as(usize, tag >> 5) << 8) | src[s];
+                s += 1;
+                try copyBack(out, &d, offset, len);
+            },
+            TAG_COPY2 => {
+                if (s + 2 > src.len) return error.CorruptInput;
+                const len: usize = 1 + @as(usize, tag >> 2);
+                const offset: usize = std.mem.readInt(u16, src[s..][0..2], .little);
+                s += 2;
+                try copyBack(out, &d, offset, len);
+            },
+            TAG_COPY4 => {
+                if (s + 4 > src.len) return error.CorruptInput;
+                const len: usize = 1 + @as(usize, tag >> 2);
+                const offset: usize = std.mem.readInt(u32, src[s..][0..4], .little);
+                s += 4;
+                try copyBack(out, &d, offset, len);
+            },
+            else => unreachable,
+        }
+    }
+
+    if (d != out.len) return error.CorruptInput;
+    return d;
+}
+
+/// Copy `len` bytes starting `offset` bytes behind the write cursor.
+/// Overlapping copies (offset < len) replicate the pattern byte by byte.
+inline fn copyBack(out: []u8, d: *usize, offset: usize, len: usize) Error!void {
+    if (offset == 0 or offset > d.* or d.* + len > out.len) return error.CorruptInput;
+
+    const start = d.* - offset;
+    if (offset >= len) {
+        @memcpy(out[d.*..][0..len], out[start..][0..len]);
+    } else {
+        for (0..len) |i| out[d.* + i] = out[start + i];
+    }
+    d.* += len;
+}
+
+fn readPreamble(src: []const u8) Error!struct { len: usize, bytes: usize } {
+    var result: u64 = 0;
+    var shift: u6 = 0;
+    var i: usize = 0;
+
+    while (i < src.len and i < 5) {
+        const b = src[i];
+        result |= @as(u64, b & 0x7F) << shift;
+        i += 1;
+        if (b < 0x80) {
+            if (result > std.math.maxInt(u32)) return error.CorruptInput;
+            return .{ .len = @intCast(result), .bytes = i };
+        }
+        shift += 7;
+    }
+
+    return error.CorruptInput;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+test "snappy literal only" {
+    // len=5, literal tag (5-1)<<2, "hello"
+    const block = [_]u8{ 0x05, 0x10, 'h', 'e', 'l', 'l', 'o' };
+    var out: [5]u8 = undefined;
+
+    try std.testing.expectEqual(@as(usize, 5), try decompressedLength(&block));
+    const n = try decompress(&block, &out);
+    try std.testing.expectEqual(@as(usize, 5), n);
+    try std.testing.expectEqualStrings("hello", &out);
+}
+
+test "snappy overlapping copy" {
+    // "ab" literal followed by copy1 len=8 offset=2 -> "ababababab"
+    const block = [_]u8{ 0x0A, 0x04, 'a', 'b', 0x01 | (4 << 2), 0x02 };
+    var out: [10]u8 = undefined;
+
+    const n = try decompress(&block, &out);
+    try std.testing.expectEqual(@as(usize, 10), n);
+    try std.testing.expectEqualStrings("ababababab", &out);
+}
+
+test "snappy copy2" {
+    // "abcd" literal followed by copy2 len=4 offset=4 -> "abcdabcd"
+    const block = [_]u8{ 0x08, 0x0C, 'a', 'b', 'c', 'd', 0x02 | (3 << 2), 0x04, 0x00 };
+    var out: [8]u8 = undefined;
+
+    _ = try decompress(&block, &out);
+    try std.testing.expectEqualStrings("abcdabcd", &out);
+}
+
+test "snappy rejects bad offset" {
+    const block = [_]u8{ 0x04, 0x01 | (0 << 2), 0x05 };
+    var out: [4]u8 = undefined;
+
+    try std.testing.expectError(error.CorruptInput, decompress(&block, &out));
+}
@@ -13,6 +13,42 @@ pub const FFISearchResult = extern struct {
     score: f32,
 };
 
+/// Search result with its external key in a caller-provided key buffer
+/// `key_offset` is maxInt(u32) if the key did not fit (`key_len` = size needed)
+pub const FFIKeyedResult = extern struct {
+    doc_id: u32,
+    score: f32,
+    key_offset: u32,
+    key_len: u32,
+};
+
+/// Doc-values filter clause for fts_ref_search_with
+pub const FFIFilterClause = extern struct {
+    field: [*]const u8,
+    field_len: usize,
+    /// 0 = int range, 1 = float range, 2 = string equality
+    op: u32,
+    _padding: u32 = 0,
+    int_min: i64,
+    int_max: i64,
+    float_min: f64,
+    float_max: f64,
+    value: ?[*]const u8,
+    value_len: usize,
+};
+
+/// Result ordering for fts_ref_search_with
+pub const FFISort = extern struct {
+    /// 0 = BM25, 1 = field value, 2 = BM25 + weight * field value
+    mode: u32,
+    /// Field sort: nonzero = descending
+    descending: u32,
+    field: ?[*]const u8,
+    field_len: usize,
+    weight: f32,
+    _padding: u32 = 0,
+};
+
 /// Index statistics
 pub const FFIStats = extern struct {
     doc_count: u32,
@@ -52,6 +88,46 @@ export fn fts_speed_builder_add(handle: IndexHandle, text: [*]const u8, text_len
     return @intFromEnum(FFIError.ok);
 }
 
+/// Add a document with an external key (URL, UUID, ...) to the speed index builder
+export fn fts_speed_builder_add_keyed(handle: IndexHandle, key: [*]const u8, key_len: usize, text: [*]const u8, text_len: usize) i32 {
+    const builder: *main.profile.speed.SpeedIndexBuilder = @ptrCast(@alignCast(handle));
+    _ = builder.addDocumentKeyed(key[0..key_len], text[0..text_len]) catch return @intFromEnum(FFIError.allocation_failed);
+    return @intFromEnum(FFIError.ok);
+}
+
+/// Set an int doc value (date, year, ...) of a document in the speed index builder
+export fn fts_speed_builder_set_int(handle: IndexHandle, doc_id: u32, field: [*]const u8, field_len: usize, value: i64) i32 {
+    const builder: *main.profile.speed.SpeedIndexBuilder = @ptrCast(@alignCast(handle));
+    return docValueResult(builder.doc_values.setInt(field[0..field_len], doc_id, value));
+}
+
+/// Set a float doc value (quality score, ...) of a document in the speed index builder
+export fn fts_speed_builder_set_float(handle: IndexHandle, doc_id: u32, field: [*]const u8, field_len: usize, value: f64) i32 {
+    const builder: *main.profile.speed.SpeedIndexBuilder = @ptrCast(@alignCast(handle));
+    return docValueResult(builder.doc_values.setFloat(field[0..field_len], doc_id, value));
+}
+
+/// Set a string doc value (language, domain, ...) of a document in the speed index builder
+export fn fts_speed_builder_set_string(handle: IndexHandle, doc_id: u32, field: [*]const u8, field_len: usize, value: [*]const u8, value_len: usize) i32 {
+    const builder: *main.profile.speed.SpeedIndexBuilder = @ptrCast(@alignCast(handle));
+    return docValueResult(builder.doc_values.setString(field[0..field_len], doc_id, value[0..value_len]));
+}
+
+/// Stream a parquet text column into the speed index builder
+/// Returns the number of documents added, or a negative FFIError
+export fn fts_speed_ingest_parquet(handle: IndexHandle, path_glob: [*:0]const u8, column: [*:0]const u8, n_threads: u32) i64 {
+    const builder: *main.profile.speed.SpeedIndexBuilder = @ptrCast(@alignCast(handle));
+    return ingestParquet(main.profile.speed.SpeedIndexBuilder, builder, path_glob, column, n_threads, null);
+}
+
+/// Resumable variant of fts_speed_ingest_parquet: checkpoints progress under
+/// `checkpoint_dir` and, if a checkpoint exists, restores it into the (empty)
+/// builder and continues from its cursor. Returns documents restored + added.
+export fn fts_speed_ingest_parquet_resumable(handle: IndexHandle, path_glob: [*:0]const u8, column: [*:0]const u8, n_threads: u32, checkpoint_dir: [*:0]const u8) i64 {
+    const builder: *main.profile.speed.SpeedIndexBuilder = @ptrCast(@alignCast(handle));
+    return ingestParquet(main.profile.speed.SpeedIndexBuilder, builder, path_glob, column, n_threads, std.mem.span(checkpoint_dir));
+}
+
 /// Build the speed index from builder
 export fn fts_speed_builder_build(handle: IndexHandle) ?IndexHandle {
     const builder: *main.profile.speed.SpeedIndexBuilder = @ptrCast(@alignCast(handle));
@@ -122,6 +198,46 @@ export fn fts_balanced_builder_add(handle: IndexHandle, text: [*]const u8, text_
     return @intFromEnum(FFIError.ok);
 }
 
+/// Add a document with an external key (URL, UUID, ...) to the balanced index builder
+export fn fts_balanced_builder_add_keyed(handle: IndexHandle, key: [*]const u8, key_len: usize, text: [*]const u8, text_len: usize) i32 {
+    const builder: *main.profile.balanced.BalancedIndexBuilder = @ptrCast(@alignCast(handle));
+    _ = builder.addDocumentKeyed(key[0..key_len], text[0..text_len]) catch return @intFromEnum(FFIError.allocation_failed);
+    return @intFromEnum(FFIError.ok);
+}
+
+/// Set an int doc value (date, year, ...) of a document in the balanced index builder
+export fn fts_balanced_builder_set_int(handle: IndexHandle, doc_id: u32, field: [*]const u8, field_len: usize, value: i64) i32 {
+    const builder: *main.profile.balanced.BalancedIndexBuilder = @ptrCast(@alignCast(handle));
+    return docValueResult(builder.doc_values.setInt(field[0..field_len], doc_id, value));
+}
+
+/// Set a float doc value (quality score, ...) of a document in the balanced index builder
+export fn fts_balanced_builder_set_float(handle: IndexHandle, doc_id: u32, field: [*]const u8, field_len: usize, value: f64) i32 {
+    const builder: *main.profile.balanced.BalancedIndexBuilder = @ptrCast(@alignCast(handle));
+    return docValueResult(builder.doc_values.setFloat(field[0..field_len], doc_id, value));
+}
+
+/// Set a string doc value (language, domain, ...) of a document in the balanced index builder
+export fn fts_balanced_builder_set_string(handle: IndexHandle, doc_id: u32, field: [*]const u8, field_len: usize, value: [*]const u8, value_len: usize) i32 {
+    const builder: *main.profile.balanced.BalancedIndexBuilder = @ptrCast(@alignCast(handle));
+    return docValueResult(builder.doc_values.setString(field[0..field_len], doc_id, value[0..value_len]));
+}
+
+/// Stream a parquet text column into the balanced index builder
+/// Returns the number of documents added, or a negative FFIError
+export fn fts_balanced_ingest_parquet(handle: IndexHandle, path_glob: [*:0]const u8, column: [*:0]const u8, n_threads: u32) i64 {
+    const builder: *main.profile.balanced.BalancedIndexBuilder = @ptrCast(@alignCast(handle));
+    return ingestParquet(main.profile.balanced.BalancedIndexBuilder, builder, path_glob, column, n_threads, null);
+}
+
+/// Resumable variant of fts_balanced_ingest_parquet: checkpoints progress under
+/// `checkpoint_dir` and, if a checkpoint exists, restores it into the (empty)
+/// builder and continues from its cursor. Returns documents restored + added.
+export fn fts_balanced_ingest_parquet_resumable(handle: IndexHandle, path_glob: [*:0]const u8, column: [*:0]const u8, n_threads: u32, checkpoint_dir: [*:0]const u8) i64 {
+    const builder: *main.profile.balanced.BalancedIndexBuilder = @ptrCast(@alignCast(handle));
+    return ingestParquet(main.profile.balanced.BalancedIndexBuilder, builder, path_glob, column, n_threads, std.mem.span(checkpoint_dir));
+}
+
 /// Build the balanced index from builder
 export fn fts_balanced_builder_build(handle: IndexHandle) ?IndexHandle {
     const builder: *main.profile.balanced.BalancedIndexBuilder = @ptrCast(@alignCast(handle));
@@ -130,6 +246,28 @@ export fn fts_balanced_builder_build(handle: IndexHandle) ?IndexHandle {
     return @ptrCast(idx);
 }
 
+/// Build the balanced index with a static rank from a numeric doc-values field
+/// order != 0 renumbers docs by descending static score (see fts_ref_original_id)
+export fn fts_balanced_builder_build_static(
+    handle: IndexHandle,
+    field: [*]const u8,
+    field_len: usize,
+    weight: f32,
+    order: u32,
+) ?IndexHandle {
+    const builder: *main.profile.balanced.BalancedIndexBuilder = @ptrCast(@alignCast(handle));
+    const idx = allocator.create(main.profile.balanced.BalancedIndex) catch return null;
+    idx.* = builder.buildWith(.{
+        .static_field = field[0..field_len],
+        .static_weight = weight,
+        .order_by_static = order != 0,
+    }) catch {
+        allocator.destroy(idx);
+        return null;
+    };
+    return @ptrCast(idx);
+}
+
 /// Destroy a balanced index builder
 export fn fts_balanced_builder_destroy(handle: IndexHandle) void {
     const builder: *main.profile.balanced.BalancedIndexBuilder = @ptrCast(@alignCast(handle));
@@ -184,6 +322,46 @@ export fn fts_compact_builder_add(handle: IndexHandle, text: [*]const u8, text_l
     return @intFromEnum(FFIError.ok);
 }
 
+/// Add a document with an external key (URL, UUID, ...) to the compact index builder
+export fn fts_compact_builder_add_keyed(handle: IndexHandle, key: [*]const u8, key_len: usize, text: [*]const u8, text_len: usize) i32 {
+    const builder: *main.profile.compact.CompactIndexBuilder = @ptrCast(@alignCast(handle));
+    _ = builder.addDocumentKeyed(key[0..key_len], text[0..text_len]) catch return @intFromEnum(FFIError.allocation_failed);
+    return @intFromEnum(FFIError.ok);
+}
+
+/// Set an int doc value (date, year, ...) of a document in the compact index builder
+export fn fts_compact_builder_set_int(handle: IndexHandle, doc_id: u32, field: [*]const u8, field_len: usize, value: i64) i32 {
+    const builder: *main.profile.compact.CompactIndexBuilder = @ptrCast(@alignCast(handle));
+    return docValueResult(builder.doc_values.setInt(field[0..field_len], doc_id, value));
+}
+
+/// Set a float doc value (quality score, ...) of a document in the compact index builder
+export fn fts_compact_builder_set_float(handle: IndexHandle, doc_id: u32, field: [*]const u8, field_len: usize, value: f64) i32 {
+    const builder: *main.profile.compact.CompactIndexBuilder = @ptrCast(@alignCast(handle));
+    return docValueResult(builder.doc_values.setFloat(field[0..field_len], doc_id, value));
+}
+
+/// Set a string doc value (language, domain, ...) of a document in the compact index builder
+export fn fts_compact_builder_set_string(handle: IndexHandle, doc_id: u32, field: [*]const u8, field_len: usize, value: [*]const u8, value_len: usize) i32 {
+    const builder: *main.profile.compact.CompactIndexBuilder = @ptrCast(@alignCast(handle));
+    return docValueResult(builder.doc_values.setString(field[0..field_len], doc_id, value[0..value_len]));
+}
+
+/// Stream a parquet text column into the compact index builder
+/// Returns the number of documents added, or a negative FFIError
+export fn fts_compact_ingest_parquet(handle: IndexHandle, path_glob: [*:0]const u8, column: [*:0]const u8, n_threads: u32) i64 {
+    const builder: *main.profile.compact.CompactIndexBuilder = @ptrCast(@alignCast(handle));
+    return ingestParquet(main.profile.compact.CompactIndexBuilder, builder, path_glob, column, n_threads, null);
+}
+
+/// Resumable variant of fts_compact_ingest_parquet: checkpoints progress under
+/// `checkpoint_dir` and, if a checkpoint exists, restores it into the (empty)
+/// builder and continues from its cursor. Returns documents restored + added.
+export fn fts_compact_ingest_parquet_resumable(handle: IndexHandle, path_glob: [*:0]const u8, column: [*:0]const u8, n_threads: u32, checkpoint_dir: [*:0]const u8) i64 {
+    const builder: *main.profile.compact.CompactIndexBuilder = @ptrCast(@alignCast(handle));
+    return ingestParquet(main.profile.compact.CompactIndexBuilder, builder, path_glob, column, n_threads, std.mem.span(checkpoint_dir));
+}
+
 /// Build the compact index from builder
 export fn fts_compact_builder_build(handle: IndexHandle) ?IndexHandle {
     const builder: *main.profile.compact.CompactIndexBuilder = @ptrCast(@alignCast(handle));
@@ -228,6 +406,339 @@ export fn fts_compact_destroy(handle: IndexHandle) void {
     allocator.destroy(idx);
 }
 
+// ============================================================================
+// Doc Values
+// ============================================================================
+
+fn docValueResult(result: anyerror!void) i32 {
+    result catch |err| {
+        const code: FFIError = switch (err) {
+            error.OutOfMemory => .allocation_failed,
+            else => .invalid_argument,
+        };
+        return @intFromEnum(code);
+    };
+    return @intFromEnum(FFIError.ok);
+}
+
+/// Convert FFI clauses and sort into search options (clauses go to `buf`)
+fn searchOptions(clauses: ?[*]const FFIFilterClause, n_clauses: usize, sort: ?*const FFISort, buf: *[main.search.filter.MAX_CLAUSES]main.search.filter.Clause) ?main.search.filter.Options {
+    const filter = main.search.filter;
+    if (n_clauses > filter.MAX_CLAUSES) return null;
+
+    var opts = filter.Options{};
+    if (n_clauses > 0) {
+        const src = clauses orelse return null;
+        for (src[0..n_clauses], 0..) |c, i| {
+            buf[i] = .{
+                .field = c.field[0..c.field_len],
+                .op = switch (c.op) {
+                    0 => .{ .int_range = .{ .min = c.int_min, .max = c.int_max } },
+                    1 => .{ .float_range = .{ .min = c.float_min, .max = c.float_max } },
+                    2 => .{ .string_eq = if (c.value) |v| v[0..c.value_len] else "" },
+                    else => return null,
+                },
+            };
+        }
+        opts.filter = buf[0..n_clauses];
+    }
+
+    if (sort) |srt| {
+        const name = if (srt.field) |f| f[0..srt.field_len] else "";
+        opts.sort = switch (srt.mode) {
+            0 => .score,
+            1 => .{ .field = .{ .name = name, .descending = srt.descending != 0 } },
+            2 => .{ .blend = .{ .name = name, .weight = srt.weight } },
+            else => return null,
+        };
+    }
+    return opts;
+}
+
+// ============================================================================
+// Parquet Ingest
+// ============================================================================
+
+fn ingestParquet(comptime Builder: type, builder: *Builder, path_glob: [*:0]const u8, column: [*:0]const u8, n_threads: u32, checkpoint_dir: ?[]const u8) i64 {
+    const stats = main.ingest.parquet.ingest(
+        Builder,
+        allocator,
+        builder,
+        std.mem.span(path_glob),
+        std.mem.span(column),
+        .{ .n_threads = n_threads, .checkpoint_dir = checkpoint_dir },
+    ) catch |err| {
+        const code: FFIError = switch (err) {
+            error.OutOfMemory => .allocation_failed,
+            error.FileNotFound, error.NoParquetFiles, error.ColumnNotFound => .not_found,
+            error.UnsupportedGlob, error.UnsupportedColumn => .invalid_argument,
+            error.InvalidCheckpoint, error.CheckpointMismatch, error.BuilderNotEmpty => .invalid_argument,
+            else => .io_error,
+        };
+        return @intFromEnum(code);
+    };
+    return @intCast(stats.docs + stats.resumed_docs);
+}
+
+// ============================================================================
+// Hot-Swap Index Reference FFI
+// ============================================================================
+
+/// Opaque handle to a hot-swappable index reference
+pub const IndexRefHandle = *anyopaque;
+
+/// Built index of any profile, as held by an index reference
+const AnyIndex = union(main.Profile) {
+    speed: *main.profile.speed.SpeedIndex,
+    balanced: *main.profile.balanced.BalancedIndex,
+    compact: *main.profile.compact.CompactIndex,
+};
+
+fn destroyAnyIndex(any: AnyIndex) void {
+    switch (any) {
+        inline else => |idx| {
+            idx.deinit();
+            allocator.destroy(idx);
+        },
+    }
+}
+
+const IndexRefState = struct {
+    profile: main.Profile,
+    ref: main.index.ref.IndexRef(AnyIndex),
+};
+
+fn wrapIndex(profile: main.Profile, handle: IndexHandle) AnyIndex {
+    return switch (profile) {
+        .speed => .{ .speed = @ptrCast(@alignCast(handle)) },
+        .balanced => .{ .balanced = @ptrCast(@alignCast(handle)) },
+        .compact => .{ .compact = @ptrCast(@alignCast(handle)) },
+    };
+}
+
+/// Create an index reference for `profile` (0=speed, 1=balanced, 2=compact)
+/// Takes ownership of `index` when non-null; it is destroyed by the reference
+export fn fts_index_ref_create(profile: i32, index: ?IndexHandle) ?IndexRefHandle {
+    const prof = std.meta.intToEnum(main.Profile, profile) catch return null;
+    const state = allocator.create(IndexRefState) catch return null;
+    state.* = .{
+        .profile = prof,
+        .ref = main.index.ref.IndexRef(AnyIndex).init(allocator, destroyAnyIndex),
+    };
+    if (index) |h| {
+        state.ref.swap(wrapIndex(prof, h)) catch {
+            allocator.destroy(state);
+            return null;
+        };
+    }
+    return @ptrCast(state);
+}
+
+/// Atomically publish `new_index` (same profile, ownership moves to the ref)
+/// In-flight searches finish on the previous index, which is destroyed once
+/// the last of them completes. Searches never block on a swap.
+export fn fts_swap(handle: IndexRefHandle, new_index: ?IndexHandle) i32 {
+    const state: *IndexRefState = @ptrCast(@alignCast(handle));
+    const next: ?AnyIndex = if (new_index) |h| wrapIndex(state.profile, h) else null;
+    state.ref.swap(next) catch return @intFromEnum(FFIError.allocation_failed);
+    return @intFromEnum(FFIError.ok);
+}
+
+/// Search whichever index is currently published
+/// Returns the number of results, 0 if nothing is published
+export fn fts_ref_search(
+    handle: IndexRefHandle,
+    query: [*]const u8,
+    query_len: usize,
+    results: [*]FFISearchResult,
+    max_results: usize,
+) i32 {
+    const state: *IndexRefState = @ptrCast(@alignCast(handle));
+    const guard = state.ref.acquire() orelse return 0;
+    defer guard.release();
+
+    switch (guard.value()) {
+        inline else => |idx| {
+            const search_results = idx.search(query[0..query_len], max_results) catch {
+                return 0;
+            };
+            defer idx.allocator.free(search_results);
+
+            const count = @min(search_results.len, max_results);
+            for (search_results[0..count], 0..) |r, i| {
+                results[i] = .{ .doc_id = r.doc_id, .score = r.score };
+            }
+            return @intCast(count);
+        },
+    }
+}
+
+/// Get statistics of the currently published index
+export fn fts_ref_stats(handle: IndexRefHandle, stats: *FFIStats) i32 {
+    const state: *IndexRefState = @ptrCast(@alignCast(handle));
+    const guard = state.ref.acquire() orelse return @intFromEnum(FFIError.not_found);
+    defer guard.release();
+
+    switch (guard.value()) {
+        inline else => |idx| {
+            stats.doc_count = idx.docCount();
+            stats.term_count = idx.terms.count();
+            stats.memory_bytes = idx.memoryUsage();
+        },
+    }
+    return @intFromEnum(FFIError.ok);
+}
+
+/// Search the published index with doc-values filters (ANDed) and a sort
+/// `clauses` may be NULL when `n_clauses` is 0, `sort` NULL for BM25 order.
+/// Returns the number of results, or a negative FFIError
+/// (FTS_ERR_NOT_FOUND for an unknown field or nothing published)
+export fn fts_ref_search_with(
+    handle: IndexRefHandle,
+    query: [*]const u8,
+    query_len: usize,
+    clauses: ?[*]const FFIFilterClause,
+    n_clauses: usize,
+    sort: ?*const FFISort,
+    results: [*]FFISearchResult,
+    max_results: usize,
+) i32 {
+    var clause_buf: [main.search.filter.MAX_CLAUSES]main.search.filter.Clause = undefined;
+    const opts = searchOptions(clauses, n_clauses, sort, &clause_buf) orelse return @intFromEnum(FFIError.invalid_argument);
+
+    const state: *IndexRefState = @ptrCast(@alignCast(handle));
+    const guard = state.ref.acquire() orelse return @intFromEnum(FFIError.not_found);
+    defer guard.release();
+
+    switch (guard.value()) {
+        inline else => |idx| {
+            const search_results = idx.searchWith(query[0..query_len], max_results, opts) catch |err| {
+                const code: FFIError = switch (err) {
+                    error.OutOfMemory => .allocation_failed,
+                    error.UnknownField => .not_found,
+                    else => .invalid_argument,
+                };
+                return @intFromEnum(code);
+            };
+            defer idx.allocator.free(search_results);
+
+            const count = @min(search_results.len, max_results);
+            for (search_results[0..count], 0..) |r, i| {
+                results[i] = .{ .doc_id = r.doc_id, .score = r.score };
+            }
+            return @intCast(count);
+        },
+    }
+}
+
+/// Search the published index and return each hit's external key
+/// Keys are packed into `key_buf`; see FFIKeyedResult for keys that do not fit
+/// Docs superseded by a re-added key were dropped when the index was built
+/// Returns the number of results, 0 if nothing is published
+export fn fts_ref_search_keyed(
+    handle: IndexRefHandle,
+    query: [*]const u8,
+    query_len: usize,
+    results: [*]FFIKeyedResult,
+    max_results: usize,
+    key_buf: [*]u8,
+    key_buf_len: usize,
+) i32 {
+    const state: *IndexRefState = @ptrCast(@alignCast(handle));
+    const guard = state.ref.acquire() orelse return 0;
+    defer guard.release();
+
+    var key = std.array_list.AlignedManaged(u8, null).init(allocator);
+    defer key.deinit();
+
+    switch (guard.value()) {
+        inline else => |idx| {
+            const search_results = idx.search(query[0..query_len], max_results) catch {
+                return 0;
+            };
+            defer idx.allocator.free(search_results);
+
+            const count = @min(search_results.len, max_results);
+            var used: usize = 0;
+            for (search_results[0..count], 0..) |r, i| {
+                idx.keys.get(r.doc_id, &key) catch return 0;
+                var offset: u32 = std.math.maxInt(u32);
+                if (key_buf_len - used >= key.items.len) {
+                    @memcpy(key_buf[used..][0..key.items.len], key.items);
+                    offset = @intCast(used);
+                    used += key.items.len;
+                }
+                results[i] = .{
+                    .doc_id = r.doc_id,
+                    .score = r.score,
+                    .key_offset = offset,
+                    .key_len = @intCast(key.items.len),
+                };
+            }
+            return @intCast(count);
+        },
+    }
+}
+
+/// Copy the external key of `doc_id` into `buf` (up to `buf_len` bytes)
+/// Returns the key length (0 if the doc has no key), or a negative FFIError
+export fn fts_ref_doc_key(handle: IndexRefHandle, doc_id: u32, buf: [*]u8, buf_len: usize) i64 {
+    const state: *IndexRefState = @ptrCast(@alignCast(handle));
+    const guard = state.ref.acquire() orelse return @intFromEnum(FFIError.not_found);
+    defer guard.release();
+
+    var key = std.array_list.AlignedManaged(u8, null).init(allocator);
+    defer key.deinit();
+
+    switch (guard.value()) {
+        inline else => |idx| {
+            if (doc_id >= idx.docCount()) return @intFromEnum(FFIError.not_found);
+            idx.keys.get(doc_id, &key) catch return @intFromEnum(FFIError.allocation_failed);
+        },
+    }
+    const n = @min(key.items.len, buf_len);
+    @memcpy(buf[0..n], key.items[0..n]);
+    return @intCast(key.items.len);
+}
+
+/// Look up the doc ID of an external key in the published index
+/// Returns the doc ID (the latest one if the key was re-added), or FTS_ERR_NOT_FOUND
+export fn fts_ref_lookup_key(handle: IndexRefHandle, key: [*]const u8, key_len: usize) i64 {
+    const state: *IndexRefState = @ptrCast(@alignCast(handle));
+    const guard = state.ref.acquire() orelse return @intFromEnum(FFIError.not_found);
+    defer guard.release();
+
+    switch (guard.value()) {
+        inline else => |idx| {
+            const doc_id = idx.keys.find(key[0..key_len]) orelse return @intFromEnum(FFIError.not_found);
+            return doc_id;
+        },
+    }
+}
+
+/// Map a doc ID of the published index to the ID it was added with
+/// (differs only for balanced indexes built ordered by static rank)
+export fn fts_ref_original_id(handle: IndexRefHandle, doc_id: u32) i64 {
+    const state: *IndexRefState = @ptrCast(@alignCast(handle));
+    const guard = state.ref.acquire() orelse return @intFromEnum(FFIError.not_found);
+    defer guard.release();
+
+    switch (guard.value()) {
+        inline else => |idx| {
+            if (doc_id >= idx.docCount()) return @intFromEnum(FFIError.not_found);
+            if (@hasDecl(@TypeOf(idx.*), "originalId")) return idx.originalId(doc_id);
+            return doc_id;
+        },
+    }
+}
+
+/// Destroy an index reference and release the published index
+export fn fts_index_ref_destroy(handle: IndexRefHandle) void {
+    const state: *IndexRefState = @ptrCast(@alignCast(handle));
+    state.ref.deinit();
+    allocator.destroy(state);
+}
+
 // ============================================================================
 // Utility FFI
 // ============================================================================
@@ -0,0 +1,403 @@
+//! Checkpoints for resumable bulk builds
+//! A long import periodically flushes the documents added since the last
+//! checkpoint as an immutable run file, then atomically replaces a small
+//! manifest recording how many runs are valid and where the source left off.
+//!
+//! Directory layout:
+//!   run_{n}.ftsr   - doc lengths + postings of one run (docs [start, start+count))
+//!   checkpoint     - manifest: run count, totals, source cursor
+//!
+//! Runs past the manifest's count (crash mid-checkpoint) are ignored and
+//! overwritten. Works with any builder exposing `term_postings`
+//! (hash -> list of `{ doc_id, freq }`), `doc_lengths` and `total_tokens`;
+//! external keys are carried along when the builder has a `keys` store.
+
+const std = @import("std");
+const builtin = @import("builtin");
+const Allocator = std.mem.Allocator;
+
+fn ManagedArrayList(comptime T: type) type {
+    return std.array_list.AlignedManaged(T, null);
+}
+
+/// Position in the source to continue from
+pub const Cursor = struct {
+    /// Source file of the next unit to read
+    file: []const u8 = "",
+    /// Next row group (or batch) within `file`
+    row_group: u32 = 0,
+    /// Source fully consumed; only building remains
+    done: bool = false,
+};
+
+/// Manifest header, followed by `file_len` bytes of cursor file path
+const ManifestHeader = extern struct {
+    magic: [4]u8 = .{ 'F', 'T', 'S', 'C' },
+    version: u32 = 1,
+    runs: u32,
+    docs: u32,
+    total_tokens: u64,
+    row_group: u32,
+    done: u8,
+    _reserved: [3]u8 = .{ 0, 0, 0 },
+    file_len: u32,
+    _padding: u32 = 0,
+};
+
+/// Run file header, followed by `doc_count` u32 doc lengths,
+/// `term_count` entries of `RunTerm` + `postings` × `RunPosting` and
+/// `key_count` external keys (u32 length + bytes) for docs from `doc_start`
+const RunHeader = extern struct {
+    magic: [4]u8 = .{ 'F', 'T', 'S', 'R' },
+    version: u32 = 1,
+    doc_start: u32,
+    doc_count: u32,
+    term_count: u32,
+    key_count: u32 = 0,
+};
+
+const RunTerm = extern struct {
+    hash: u64,
+    postings: u32,
+    _padding: u32 = 0,
+};
+
+const RunPosting = extern struct {
+    doc_id: u32,
+    freq: u16,
+    _padding: u16 = 0,
+};
+
+const MANIFEST_NAME = "checkpoint";
+const MANIFEST_TMP_NAME = "checkpoint.tmp";
+const WRITE_BUFFER_SIZE = 1 << 20;
+
+pub const Error = error{
+    InvalidCheckpoint,
+    /// Restoring into a builder that already holds documents
+    BuilderNotEmpty,
+};
+
+/// Writes and restores checkpoints of one build under `dir`
+pub const Checkpointer = struct {
+    allocator: Allocator,
+    dir: []const u8,
+    /// Valid runs on disk
+    runs: u32,
+    /// Documents covered by those runs
+    docs: u32,
+    /// Cursor file path of the last restore (owned)
+    restored_file: ?[]u8,
+
+    const Self = @This();
+
+    pub fn init(allocator: Allocator, dir: []const u8) Self {
+        return .{
+            .allocator = allocator,
+            .dir = dir,
+            .runs = 0,
+            .docs = 0,
+            .restored_file = null,
+        };
+    }
+
+    pub fn deinit(self: *Self) void {
+        if (self.restored_file) |f| self.allocator.free(f);
+    }
+
+    /// Load the last checkpoint into an empty `builder`.
+    /// Returns the cursor to continue from, or null if there is no checkpoint.
+    /// The cursor's `file` stays valid until `deinit`.
+    pub fn restore(self: *Self, comptime Builder: type, builder: *Builder) !?Cursor {
+        var dir = std.fs.cwd().openDir(self.dir, .{}) catch |err| switch (err) {
+            error.FileNotFound => return null,
+            else => return err,
+        };
+        defer dir.close();
+
+        const manifest = readAllFile(self.allocator, dir, MANIFEST_NAME) catch |err| switch (err) {
+            error.FileNotFound => return null,
+            else => return err,
+        };
+        defer self.allocator.free(manifest);
+
+        if (manifest.len < @sizeOf(ManifestHeader)) return error.InvalidCheckpoint;
+        const header = std.mem.bytesToValue(ManifestHeader, manifest[0..@sizeOf(ManifestHeader)]);
+        if (!std.mem.eql(u8, &header.magic, "FTSC") or header.version != 1) return error.InvalidCheckpoint;
+        if (manifest.len != @sizeOf(ManifestHeader) + header.file_len) return error.InvalidCheckpoint;
+        if (builder.doc_lengths.items.len != 0) return error.BuilderNotEmpty;
+
+        for (0..header.runs) |n| {
+            var name_buf: [32]u8 = undefined;
+            try loadRun(Builder, self.allocator, builder, dir, runName(&name_buf, @intCast(n)));
+        }
+        if (builder.doc_lengths.items.len != header.docs or builder.total_tokens != header.total_tokens) {
+            return error.InvalidCheckpoint;
+        }
+
+        if (self.restored_file) |f| self.allocator.free(f);
+        self.restored_file = try self.allocator.dupe(u8, manifest[@sizeOf(ManifestHeader)..]);
+        self.runs = header.runs;
+        self.docs = header.docs;
+
+        return .{
+            .file = self.restored_file.?,
+            .row_group = header.row_group,
+            .done = header.done != 0,
+        };
+    }
+
+    /// Flush documents added since the previous checkpoint and record `cursor`.
+    /// Crash-safe: the manifest is replaced only after the run is synced.
+    pub fn save(self: *Self, comptime Builder: type, builder: *const Builder, cursor: Cursor) !void {
+        try std.fs.cwd().makePath(self.dir);
+        var dir = try std.fs.cwd().openDir(self.dir, .{});
+        defer dir.close();
+
+        const doc_end: u32 = @intCast(builder.doc_lengths.items.len);
+        var runs = self.runs;
+        if (doc_end > self.docs) {
+            var name_buf: [32]u8 = undefined;
+            try writeRun(Builder, self.allocator, builder, dir, runName(&name_buf, runs), self.docs);
+            runs += 1;
+            // The run's directory entry must be durable before the manifest counts it
+            try syncDir(dir);
+        }
+
+        const header = ManifestHeader{
+            .runs = runs,
+            .docs = doc_end,
+            .total_tokens = builder.total_tokens,
+            .row_group = cursor.row_group,
+            .done = @intFromBool(cursor.done),
+            .file_len = @intCast(cursor.file.len),
+        };
+        {
+            const file = try dir.createFile(MANIFEST_TMP_NAME, .{});
+            defer file.close();
+            try file.writeAll(std.mem.asBytes(&header));
+            try file.writeAll(cursor.file);
+            try file.sync();
+        }
+        try dir.rename(MANIFEST_TMP_NAME, MANIFEST_NAME);
+        try syncDir(dir);
+
+        self.runs = runs;
+        self.docs = doc_end;
+    }
+
+    /// Remove all checkpoint files (call once the index is safely built)
+    pub fn clear(self: *Self) !void {
+        try std.fs.cwd().deleteTree(self.dir);
+        self.runs = 0;
+        self.docs = 0;
+    }
+};
+
+/// Flush directory entries (new runs, the manifest rename) to disk
+fn syncDir(dir: std.fs.Dir) !void {
+    // Windows cannot flush a directory handle; NTFS journals renames
+    if (builtin.os.tag == .windows) return;
+    try std.posix.fsync(dir.fd);
+}
+
+fn runName(buf: []u8, n: u32) []const u8 {
+    return std.fmt.bufPrint(buf, "run_{d}.ftsr", .{n}) catch unreachable;
+}
+
+fn readAllFile(allocator: Allocator, dir: std.fs.Dir, name: []const u8) ![]u8 {
+    const file = try dir.openFile(name, .{});
+    defer file.close();
+
+    const size: usize = @intCast(try file.getEndPos());
+    const data = try allocator.alloc(u8, size);
+    errdefer allocator.free(data);
+    if (try file.readAll(data) != size) return error.InvalidCheckpoint;
+    return data;
+}
+
+/// First index in `postings` (sorted by doc_id) with doc_id >= `doc_id`
+fn lowerBound(postings: anytype, doc_id: u32) usize {
+    var lo: usize = 0;
+    var hi: usize = postings.len;
+    while (lo < hi) {
+        const mid = lo + (hi - lo) / 2;
+        if (postings[mid].doc_id < doc_id) lo = mid + 1 else hi = mid;
+    }
+    return lo;
+}
+
+fn writeRun(comptime Builder: type, allocator: Allocator, builder: *const Builder, dir: std.fs.Dir, name: []const u8, doc_start: u32) !void {
+    const doc_lengths = builder.doc_lengths.items[doc_start..];
+
+    // Terms with postings in this run
+    var term_count: u32 = 0;
+    var iter = builder.term_postings.iterator();
+    while (iter.next()) |entry| {
+        const items = entry.value_ptr.items;
+        if (items.len > 0 and items[items.len - 1].doc_id >= doc_start) term_count += 1;
+    }
+
+    const file = try dir.createFile(name, .{});
+    defer file.close();
+
+    var buf = ManagedArrayList(u8).init(allocator);
+    defer buf.deinit();
+    try buf.ensureTotalCapacity(WRITE_BUFFER_SIZE);
+
+    // Keyed docs in this run (trailing unkeyed docs are not stored)
+    var key_count: u32 = 0;
+    if (@hasField(Builder, "keys") and builder.keys.count > doc_start) {
+        key_count = builder.keys.count - doc_start;
+    }
+
+    const header = RunHeader{
+        .doc_start = doc_start,
+        .doc_count = @intCast(doc_lengths.len),
+        .term_count = term_count,
+        .key_count = key_count,
+    };
+    try buf.appendSlice(std.mem.asBytes(&header));
+    try buf.appendSlice(std.mem.sliceAsBytes(doc_lengths));
+
+    iter = builder.term_postings.iterator();
+    while (iter.next()) |entry| {
+        const items = entry.value_ptr.items;
+        const tail = items[lowerBound(items, doc_start)..];
+        if (tail.len == 0) continue;
+
+        const term = RunTerm{ .hash = entry.key_ptr.*, .postings = @intCast(tail.len) };
+        try buf.appendSlice(std.mem.asBytes(&term));
+        for (tail) |p| {
+            const rp = RunPosting{ .doc_id = p.doc_id, .freq = p.freq };
+            try buf.appendSlice(std.mem.asBytes(&rp));
+        }
+
+        if (buf.items.len >= WRITE_BUFFER_SIZE) {
+            try file.writeAll(buf.items);
+            buf.clearRetainingCapacity();
+        }
+    }
+
+    if (key_count > 0) {
+        var key = ManagedArrayList(u8).init(allocator);
+        defer key.deinit();
+        for (doc_start..doc_start + key_count) |doc_id| {
+            try builder.keys.get(@intCast(doc_id), &key);
+            const len: u32 = @intCast(key.items.len);
+            try buf.appendSlice(std.mem.asBytes(&len));
+            try buf.appendSlice(key.items);
+        }
+    }
+
+    try file.writeAll(buf.items);
+    try file.sync();
+}
+
+fn loadRun(comptime Builder: type, allocator: Allocator, builder: *Builder, dir: std.fs.Dir, name: []const u8) !void {
+    const data = try readAllFile(allocator, dir, name);
+    defer allocator.free(data);
+
+    var pos: usize = 0;
+    const header = try readStruct(RunHeader, data, &pos);
+    if (!std.mem.eql(u8, &header.magic, "FTSR") or header.version != 1) return error.InvalidCheckpoint;
+    if (header.doc_start != builder.doc_lengths.items.len) return error.InvalidCheckpoint;
+
+    for (0..header.doc_count) |_| {
+        const len = try readStruct(u32, data, &pos);
+        try builder.doc_lengths.append(len);
+        builder.total_tokens += len;
+    }
+    const doc_end = header.doc_start + header.doc_count;
+
+    for (0..header.term_count) |_| {
+        const term = try readStruct(RunTerm, data, &pos);
+        const entry = try builder.term_postings.getOrPut(term.hash);
+        if (!entry.found_existing) {
+            entry.value_ptr.* = @TypeOf(entry.value_ptr.*).init(builder.allocator);
+        }
+        try entry.value_ptr.ensureUnusedCapacity(term.postings);
+        for (0..term.postings) |_| {
+            const p = try readStruct(RunPosting, data, &pos);
+            if (p.doc_id < header.doc_start or p.doc_id >= doc_end) return error.InvalidCheckpoint;
+            entry.value_ptr.appendAssumeCapacity(.{ .doc_id = p.doc_id, .freq = p.freq });
+        }
+    }
+
+    if (header.key_count > header.doc_count) return error.InvalidCheckpoint;
+    if (header.key_count > 0) {
+        if (!@hasField(Builder, "keys")) return error.InvalidCheckpoint;
+        for (0..header.key_count) |i| {
+            const len = try readStruct(u32, data, &pos);
+            if (pos + len > data.len) return error.InvalidCheckpoint;
+            try builder.keys.append(header.doc_start + @as(u32, @intCast(i)), data[pos..][0..len]);
+            pos += len;
+        }
+    }
+
+    if (pos != data.len) return error.InvalidCheckpoint;
+}
+
+fn readStruct(comptime T: type, data: []const u8, pos: *usize) !T {
+    if (pos.* + @sizeOf(T) > data.len) return error.InvalidCheckpoint;
+    const value = std.mem.bytesToValue(T, data[pos.*..][0..@sizeOf(T)]);
+    pos.* += @sizeOf(T);
+    return value;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+const speed = @import("../profile/speed.zig");
+
+test "checkpoint save and restore" {
+    const path = "/tmp/fts_zig_checkpoint_test";
+    std.fs.cwd().deleteTree(path) catch {};
+    defer std.fs.cwd().deleteTree(path) catch {};
+
+    var builder = speed.SpeedIndexBuilder.init(std.testing.allocator);
+    defer builder.deinit();
+
+    var cp = Checkpointer.init(std.testing.allocator, path);
+    defer cp.deinit();
+
+    _ = try builder.addDocument("hello world");
+    _ = try builder.addDocument("hello there");
+    try cp.save(speed.SpeedIndexBuilder, &builder, .{ .file = "a.parquet", .row_group = 1 });
+
+    _ = try builder.addDocument("world peace");
+    try cp.save(speed.SpeedIndexBuilder, &builder, .{ .file = "b.parquet", .row_group = 0 });
+    try std.testing.expectEqual(@as(u32, 2), cp.runs);
+
+    // Documents after the last checkpoint are lost on "crash"
+    _ = try builder.addDocument("not checkpointed");
+
+    var restored = speed.SpeedIndexBuilder.init(std.testing.allocator);
+    defer restored.deinit();
+
+    var cp2 = Checkpointer.init(std.testing.allocator, path);
+    defer cp2.deinit();
+    const cursor = (try cp2.restore(speed.SpeedIndexBuilder, &restored)).?;
+
+    try std.testing.expectEqualStrings("b.parquet", cursor.file);
+    try std.testing.expectEqual(@as(u32, 0), cursor.row_group);
+    try std.testing.expect(!cursor.done);
+    try std.testing.expectEqual(@as(usize, 3), restored.doc_lengths.items.len);
+    try std.testing.expectEqual(@as(u64, 6), restored.total_tokens);
+
+    var index = try restored.build();
+    defer index.deinit();
+    const results = try index.search("hello", 10);
+    defer index.allocator.free(results);
+    try std.testing.expectEqual(@as(usize, 2), results.len);
+}
+
+test "checkpoint restore without checkpoint" {
+    var builder = speed.SpeedIndexBuilder.init(std.testing.allocator);
+    defer builder.deinit();
+
+    var cp = Checkpointer.init(std.testing.allocator, "/tmp/fts_zig_checkpoint_missing");
+    defer cp.deinit();
+    try std.testing.expect((try cp.restore(speed.SpeedIndexBuilder, &builder)) == null);
+}
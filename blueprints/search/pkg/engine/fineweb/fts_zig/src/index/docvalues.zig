@@ -0,0 +1,395 @@
+//! Doc values: columnar per-document attributes (language, domain, date,
+//! quality, ...) for filtering and sorting inside the index
+//!   - Numeric columns (i64, f64) are bit-packed per BLOCK_DOCS block as
+//!     offsets from the block minimum, with min/max kept per block so
+//!     filters can skip whole blocks
+//!   - String columns are dictionary encoded: a sorted dictionary plus a
+//!     numeric column of ordinals (ordinal 0 = no value)
+//!   - Every value is stored in an order-preserving u64 encoding, so range
+//!     checks, block stats and sorting are plain integer comparisons
+//!
+//! Columns are filled while building (any doc order, unset docs read as 0 /
+//! no value) and packed by `seal` when the index is built.
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+
+fn ManagedArrayList(comptime T: type) type {
+    return std.array_list.AlignedManaged(T, null);
+}
+
+/// Docs per packed block (unit of min/max skipping)
+pub const BLOCK_DOCS: u32 = 128;
+
+pub const Kind = enum(u8) {
+    int,
+    float,
+    string,
+};
+
+pub const Error = error{
+    /// Field already exists with a different kind
+    FieldKindMismatch,
+    /// Doc values were sealed; no more sets
+    Sealed,
+};
+
+// ============================================================================
+// Order-preserving encodings
+// ============================================================================
+
+pub fn encodeInt(v: i64) u64 {
+    return @as(u64, @bitCast(v)) ^ (1 << 63);
+}
+
+pub fn decodeInt(u: u64) i64 {
+    return @bitCast(u ^ (1 << 63));
+}
+
+pub fn encodeFloat(v: f64) u64 {
+    const b: u64 = @bitCast(v);
+    return if (b >> 63 != 0) ~b else b | (1 << 63);
+}
+
+pub fn decodeFloat(u: u64) f64 {
+    const b = if (u >> 63 != 0) u & ~@as(u64, 1 << 63) else ~u;
+    return @bitCast(b);
+}
+
+/// Per-block packing metadata
+pub const BlockMeta = struct {
+    min: u64,
+    max: u64,
+    /// First word of the block in `Column.words`
+    word: u32,
+    /// Bits per value (0 = every value equals `min`)
+    width: u8,
+};
+
+/// One doc-values column
+pub const Column = struct {
+    kind: Kind,
+    /// Encoded value per doc (build phase; freed by seal)
+    raw: ManagedArrayList(u64),
+    /// Packed representation (after seal)
+    blocks: []BlockMeta,
+    words: []u64,
+    /// String columns: value -> ordinal (provisional until seal)
+    ordinals: std.StringHashMap(u32),
+    /// String columns after seal: dict[ordinal - 1], sorted
+    dict: [][]const u8,
+
+    const Self = @This();
+
+    fn init(allocator: Allocator, kind: Kind) Self {
+        return .{
+            .kind = kind,
+            .raw = ManagedArrayList(u64).init(allocator),
+            .blocks = &.{},
+            .words = &.{},
+            .ordinals = std.StringHashMap(u32).init(allocator),
+            .dict = &.{},
+        };
+    }
+
+    fn deinit(self: *Self, allocator: Allocator) void {
+        self.raw.deinit();
+        allocator.free(self.blocks);
+        allocator.free(self.words);
+        var iter = self.ordinals.keyIterator();
+        while (iter.next()) |key| allocator.free(key.*);
+        self.ordinals.deinit();
+        allocator.free(self.dict);
+    }
+
+    fn set(self: *Self, doc_id: u32, value: u64) !void {
+        if (doc_id >= self.raw.items.len) {
+            try self.raw.appendNTimes(self.defaultValue(), doc_id + 1 - self.raw.items.len);
+        }
+        self.raw.items[doc_id] = value;
+    }
+
+    fn defaultValue(self: Self) u64 {
+        return switch (self.kind) {
+            .int => encodeInt(0),
+            .float => encodeFloat(0),
+            .string => 0,
+        };
+    }
+
+    /// Encoded value of `doc_id`
+    pub inline fn get(self: Self, doc_id: u32) u64 {
+        const block = self.blocks[doc_id / BLOCK_DOCS];
+        if (block.width == 0) return block.min;
+
+        const bit = @as(u64, doc_id % BLOCK_DOCS) * block.width;
+        const word = block.word + @as(usize, @intCast(bit / 64));
+        const shift: u6 = @intCast(bit % 64);
+
+        var v = self.words[word] >> shift;
+        if (@as(u32, shift) + block.width > 64) v |= self.words[word + 1] << @intCast(64 - @as(u32, shift));
+        const mask: u64 = if (block.width == 64) std.math.maxInt(u64) else (@as(u64, 1) << @intCast(block.width)) - 1;
+        return block.min + (v & mask);
+    }
+
+    pub fn blockCount(self: Self) u32 {
+        return @intCast(self.blocks.len);
+    }
+
+    /// Ordinal of a string value, or null if no doc has it
+    pub fn ordinal(self: Self, value: []const u8) ?u64 {
+        return self.ordinals.get(value);
+    }
+
+    /// String of an ordinal (ordinal 0 = no value -> "")
+    pub fn string(self: Self, ord: u64) []const u8 {
+        if (ord == 0 or ord > self.dict.len) return "";
+        return self.dict[@intCast(ord - 1)];
+    }
+
+    /// Value as f64 for score blending (strings blend by ordinal)
+    pub fn number(self: Self, doc_id: u32) f64 {
+        return self.toNumber(self.get(doc_id));
+    }
+
+    /// Encoded value of `doc_id` before seal
+    pub fn rawValue(self: Self, doc_id: u32) u64 {
+        return if (doc_id < self.raw.items.len) self.raw.items[doc_id] else self.defaultValue();
+    }
+
+    /// Decode an encoded value to f64
+    pub fn toNumber(self: Self, v: u64) f64 {
+        return switch (self.kind) {
+            .int => @floatFromInt(decodeInt(v)),
+            .float => decodeFloat(v),
+            .string => @floatFromInt(v),
+        };
+    }
+
+    fn seal(self: *Self, allocator: Allocator, doc_count: u32) !void {
+        if (self.raw.items.len < doc_count) {
+            try self.raw.appendNTimes(self.defaultValue(), doc_count - self.raw.items.len);
+        }
+        if (self.kind == .string) try self.sortDictionary(allocator);
+
+        const values = self.raw.items[0..doc_count];
+        const block_count = (doc_count + BLOCK_DOCS - 1) / BLOCK_DOCS;
+        const blocks = try allocator.alloc(BlockMeta, block_count);
+        errdefer allocator.free(blocks);
+
+        // Pass 1: block stats and widths
+        var total_words: usize = 0;
+        for (blocks, 0..) |*block, b| {
+            const chunk = values[b * BLOCK_DOCS .. @min((b + 1) * BLOCK_DOCS, values.len)];
+            var min: u64 = std.math.maxInt(u64);
+            var max: u64 = 0;
+            for (chunk) |v| {
+                min = @min(min, v);
+                max = @max(max, v);
+            }
+            const width: u8 = 64 - @clz(max - min);
+            block.* = .{ .min = min, .max = max, .word = @intCast(total_words), .width = width };
+            total_words += (chunk.len * width + 63) / 64;
+        }
+
+        // Pass 2: pack offsets from the block minimum
+        const words = try allocator.alloc(u64, total_words);
+        @memset(words, 0);
+        for (blocks, 0..) |block, b| {
+            if (block.width == 0) continue;
+            const chunk = values[b * BLOCK_DOCS .. @min((b + 1) * BLOCK_DOCS, values.len)];
+            for (chunk, 0..) |v, i| {
+                const bit = @as(u64, i) * block.width;
+                const word = block.word + @as(usize, @intCast(bit / 64));
+                const shift: u6 = @intCast(bit % 64);
+                const delta = v - block.min;
+                words[word] |= delta << shift;
+                if (@as(u32, shift) + block.width > 64) words[word + 1] |= delta >> @intCast(64 - @as(u32, shift));
+            }
+        }
+
+        self.blocks = blocks;
+        self.words = words;
+        self.raw.clearAndFree();
+    }
+
+    /// Renumber provisional ordinals so they follow lexicographic order
+    fn sortDictionary(self: *Self, allocator: Allocator) !void {
+        const dict = try allocator.alloc([]const u8, self.ordinals.count());
+        errdefer allocator.free(dict);
+        const remap = try allocator.alloc(u64, self.ordinals.count() + 1);
+        defer allocator.free(remap);
+
+        var iter = self.ordinals.keyIterator();
+        var i: usize = 0;
+        while (iter.next()) |key| : (i += 1) dict[i] = key.*;
+        std.mem.sort([]const u8, dict, {}, struct {
+            fn lessThan(_: void, a: []const u8, b: []const u8) bool {
+                return std.mem.lessThan(u8, a, b);
+            }
+        }.lessThan);
+
+        remap[0] = 0;
+        for (dict, 1..) |value, ord| {
+            const entry = self.ordinals.getPtr(value).?;
+            remap[entry.*] = ord;
+            entry.* = @intCast(ord);
+        }
+        for (self.raw.items) |*v| v.* = remap[@intCast(v.*)];
+        self.dict = dict;
+    }
+
+    pub fn memoryUsage(self: Self) usize {
+        var total = self.raw.capacity * @sizeOf(u64) +
+            self.blocks.len * @sizeOf(BlockMeta) +
+            self.words.len * @sizeOf(u64) +
+            self.dict.len * @sizeOf([]const u8);
+        var iter = self.ordinals.keyIterator();
+        while (iter.next()) |key| total += key.len + @sizeOf([]const u8) + @sizeOf(u32);
+        return total;
+    }
+};
+
+/// Named doc-values columns of one index
+pub const DocValues = struct {
+    allocator: Allocator,
+    /// Field name (owned) -> column
+    columns: std.StringArrayHashMap(Column),
+    sealed: bool,
+
+    const Self = @This();
+
+    pub fn init(allocator: Allocator) Self {
+        return .{
+            .allocator = allocator,
+            .columns = std.StringArrayHashMap(Column).init(allocator),
+            .sealed = false,
+        };
+    }
+
+    pub fn deinit(self: *Self) void {
+        var iter = self.columns.iterator();
+        while (iter.next()) |entry| {
+            entry.value_ptr.deinit(self.allocator);
+            self.allocator.free(entry.key_ptr.*);
+        }
+        self.columns.deinit();
+    }
+
+    pub fn isEmpty(self: Self) bool {
+        return self.columns.count() == 0;
+    }
+
+    pub fn setInt(self: *Self, field: []const u8, doc_id: u32, value: i64) !void {
+        const col = try self.column(field, .int);
+        try col.set(doc_id, encodeInt(value));
+    }
+
+    pub fn setFloat(self: *Self, field: []const u8, doc_id: u32, value: f64) !void {
+        const col = try self.column(field, .float);
+        try col.set(doc_id, encodeFloat(value));
+    }
+
+    pub fn setString(self: *Self, field: []const u8, doc_id: u32, value: []const u8) !void {
+        const col = try self.column(field, .string);
+        const entry = try col.ordinals.getOrPut(value);
+        if (!entry.found_existing) {
+            entry.key_ptr.* = self.allocator.dupe(u8, value) catch |err| {
+                col.ordinals.removeByPtr(entry.key_ptr);
+                return err;
+            };
+            entry.value_ptr.* = col.ordinals.count();
+        }
+        try col.set(doc_id, entry.value_ptr.*);
+    }
+
+    fn column(self: *Self, field: []const u8, kind: Kind) !*Column {
+        if (self.sealed) return error.Sealed;
+        const entry = try self.columns.getOrPut(field);
+        if (entry.found_existing) {
+            if (entry.value_ptr.kind != kind) return error.FieldKindMismatch;
+            return entry.value_ptr;
+        }
+        entry.key_ptr.* = self.allocator.dupe(u8, field) catch |err| {
+            self.columns.swapRemoveAt(entry.index);
+            return err;
+        };
+        entry.value_ptr.* = Column.init(self.allocator, kind);
+        return entry.value_ptr;
+    }
+
+    /// Sealed column by name
+    pub fn get(self: *const Self, field: []const u8) ?*const Column {
+        return self.columns.getPtr(field);
+    }
+
+    /// Renumber docs before seal: new doc `i` takes the values of `order[i]`
+    pub fn permute(self: *Self, order: []const u32) !void {
+        if (self.sealed) return error.Sealed;
+        for (self.columns.values()) |*col| {
+            var values = try ManagedArrayList(u64).initCapacity(self.allocator, order.len);
+            for (order) |old| values.appendAssumeCapacity(col.rawValue(old));
+            col.raw.deinit();
+            col.raw = values;
+        }
+    }
+
+    /// Pack every column for `doc_count` docs (called by the builder's build)
+    pub fn seal(self: *Self, doc_count: u32) !void {
+        for (self.columns.values()) |*col| try col.seal(self.allocator, doc_count);
+        self.sealed = true;
+    }
+
+    pub fn memoryUsage(self: Self) usize {
+        var total: usize = 0;
+        var iter = self.columns.iterator();
+        while (iter.next()) |entry| total += entry.key_ptr.len + entry.value_ptr.memoryUsage();
+        return total;
+    }
+};
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+test "doc values encodings preserve order" {
+    try std.testing.expect(encodeInt(-5) < encodeInt(0));
+    try std.testing.expect(encodeInt(0) < encodeInt(7));
+    try std.testing.expect(encodeFloat(-1.5) < encodeFloat(-0.5));
+    try std.testing.expect(encodeFloat(-0.5) < encodeFloat(0.25));
+    try std.testing.expect(encodeFloat(0.25) < encodeFloat(3.0));
+    try std.testing.expectEqual(@as(i64, -42), decodeInt(encodeInt(-42)));
+    try std.testing.expectEqual(@as(f64, -2.75), decodeFloat(encodeFloat(-2.75)));
+}
+
+test "doc values pack and read back" {
+    var dv = DocValues.init(std.testing.allocator);
+    defer dv.deinit();
+
+    for (0..300) |i| {
+        try dv.setInt("date", @intCast(i), 1_700_000_000 + @as(i64, @intCast(i)) * 3600);
+        try dv.setFloat("quality", @intCast(i), @as(f64, @floatFromInt(i % 10)) / 10.0);
+    }
+    try dv.setString("lang", 3, "vi");
+    try dv.setString("lang", 1, "en");
+    try dv.setString("lang", 2, "vi");
+    try dv.seal(301);
+
+    const date = dv.get("date").?;
+    try std.testing.expectEqual(@as(u32, 3), date.blockCount());
+    try std.testing.expectEqual(@as(i64, 1_700_000_000 + 299 * 3600), decodeInt(date.get(299)));
+    try std.testing.expectEqual(@as(i64, 0), decodeInt(date.get(300)));
+    try std.testing.expectEqual(@as(i64, 1_700_000_000), decodeInt(date.blocks[0].min));
+
+    const quality = dv.get("quality").?;
+    try std.testing.expectEqual(@as(f64, 0.7), decodeFloat(quality.get(137)));
+
+    // Dictionary is sorted: "en" = 1, "vi" = 2, unset = 0
+    const lang = dv.get("lang").?;
+    try std.testing.expectEqual(@as(?u64, 1), lang.ordinal("en"));
+    try std.testing.expectEqual(@as(u64, 2), lang.get(3));
+    try std.testing.expectEqual(@as(u64, 0), lang.get(0));
+    try std.testing.expectEqualStrings("vi", lang.string(lang.get(2)));
+
+    try std.testing.expectError(error.Sealed, dv.setInt("date", 0, 1));
+}
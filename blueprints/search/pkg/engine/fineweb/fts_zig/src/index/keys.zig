@@ -0,0 +1,432 @@
+//! External document keys
+//! Maps dense internal doc IDs to caller-supplied keys (URLs, UUIDs, ...) and back:
+//!   - Keys are front-coded in doc ID order: each key stores the length of
+//!     the prefix shared with the previous key plus the remaining suffix
+//!   - A full key restarts every RESTART_INTERVAL docs for random access
+//!   - key hash -> latest doc ID, so re-adding a key (an update) wins;
+//!     keys whose hashes collide are chained, and lookups compare key bytes
+//!   - Docs whose key was re-added are listed as superseded, for builders
+//!     to drop from their postings
+//!
+//! Serialized form (for segment sidecars and checkpoints):
+//!   KeysHeader, restarts [restart_count]u64, data [data_len]u8
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+const vbyte = @import("../codec/vbyte.zig");
+const hash_util = @import("../util/hash.zig");
+
+fn ManagedArrayList(comptime T: type) type {
+    return std.array_list.AlignedManaged(T, null);
+}
+
+/// Docs between full (non front-coded) keys
+pub const RESTART_INTERVAL: u32 = 16;
+
+const KeysHeader = extern struct {
+    magic: [4]u8 = .{ 'F', 'T', 'S', 'K' },
+    version: u32 = 1,
+    count: u32,
+    restart_count: u32,
+    data_len: u64,
+};
+
+/// Front-coded key table with key -> doc lookup
+pub const KeyStore = struct {
+    allocator: Allocator,
+    /// Entries: vbyte(shared) vbyte(suffix_len) suffix
+    data: ManagedArrayList(u8),
+    /// Offset into `data` of every RESTART_INTERVAL-th key
+    restarts: ManagedArrayList(u64),
+    /// Number of keys (== doc count once keyed docs were added)
+    count: u32,
+    /// Key hash -> latest doc ID with that hash
+    lookup: std.AutoHashMap(u64, u32),
+    /// Doc ID -> previous doc with the same key hash but a different key
+    collisions: std.AutoHashMap(u32, u32),
+    /// Docs superseded by a later doc with the same key, in append order
+    superseded: ManagedArrayList(u32),
+    /// Previous key, for front coding on append
+    last_key: ManagedArrayList(u8),
+
+    const Self = @This();
+
+    pub fn init(allocator: Allocator) Self {
+        return .{
+            .allocator = allocator,
+            .data = ManagedArrayList(u8).init(allocator),
+            .restarts = ManagedArrayList(u64).init(allocator),
+            .count = 0,
+            .lookup = std.AutoHashMap(u64, u32).init(allocator),
+            .collisions = std.AutoHashMap(u32, u32).init(allocator),
+            .superseded = ManagedArrayList(u32).init(allocator),
+            .last_key = ManagedArrayList(u8).init(allocator),
+        };
+    }
+
+    pub fn deinit(self: *Self) void {
+        self.data.deinit();
+        self.restarts.deinit();
+        self.lookup.deinit();
+        self.collisions.deinit();
+        self.superseded.deinit();
+        self.last_key.deinit();
+    }
+
+    /// True if no document has a key
+    pub fn isEmpty(self: Self) bool {
+        return self.count == 0;
+    }
+
+    /// Drop all keys, keeping allocations for reuse
+    pub fn clear(self: *Self) void {
+        self.data.clearRetainingCapacity();
+        self.restarts.clearRetainingCapacity();
+        self.lookup.clearRetainingCapacity();
+        self.collisions.clearRetainingCapacity();
+        self.superseded.clearRetainingCapacity();
+        self.last_key.clearRetainingCapacity();
+        self.count = 0;
+    }
+
+    /// Set the key of `doc_id`. Docs must be keyed in increasing order;
+    /// skipped docs get an empty key.
+    pub fn append(self: *Self, doc_id: u32, key: []const u8) !void {
+        std.debug.assert(doc_id >= self.count);
+        while (self.count < doc_id) try self.push("");
+        try self.push(key);
+        if (key.len > 0) try self.link(doc_id, key, hash_util.hash(key));
+    }
+
+    /// Make `doc_id` the head of the chain for `hash`, unlinking an earlier
+    /// doc with the same key (which becomes superseded)
+    fn link(self: *Self, doc_id: u32, key: []const u8, hash: u64) !void {
+        const head = try self.lookup.getOrPut(hash);
+        if (!head.found_existing) {
+            head.value_ptr.* = doc_id;
+            return;
+        }
+
+        var prev = doc_id;
+        var cur = head.value_ptr.*;
+        head.value_ptr.* = doc_id;
+        try self.collisions.put(doc_id, cur);
+        while (true) {
+            if (self.keyEquals(cur, key)) {
+                // A chain holds each key once, so the walk stops here
+                if (self.collisions.fetchRemove(cur)) |next| {
+                    try self.collisions.put(prev, next.value);
+                } else {
+                    _ = self.collisions.remove(prev);
+                }
+                try self.superseded.append(cur);
+                return;
+            }
+            prev = cur;
+            cur = self.collisions.get(cur) orelse return;
+        }
+    }
+
+    fn push(self: *Self, key: []const u8) !void {
+        var shared: usize = 0;
+        if (self.count % RESTART_INTERVAL == 0) {
+            try self.restarts.append(self.data.items.len);
+        } else {
+            const prev = self.last_key.items;
+            const max = @min(prev.len, key.len);
+            while (shared < max and prev[shared] == key[shared]) shared += 1;
+        }
+
+        var buf: [10]u8 = undefined;
+        var n = vbyte.encode(@intCast(shared), &buf);
+        n += vbyte.encode(@intCast(key.len - shared), buf[n..]);
+        try self.data.appendSlice(buf[0..n]);
+        try self.data.appendSlice(key[shared..]);
+
+        self.last_key.clearRetainingCapacity();
+        try self.last_key.appendSlice(key);
+        self.count += 1;
+    }
+
+    /// Decode the key of `doc_id` into `out` (replacing its contents).
+    /// Docs without a key decode to an empty string.
+    pub fn get(self: Self, doc_id: u32, out: *ManagedArrayList(u8)) !void {
+        out.clearRetainingCapacity();
+        if (doc_id >= self.count) return;
+
+        const restart = doc_id / RESTART_INTERVAL;
+        var pos: usize = @intCast(self.restarts.items[restart]);
+        var i = restart * RESTART_INTERVAL;
+        while (i <= doc_id) : (i += 1) {
+            const entry = self.entryAt(pos);
+            out.shrinkRetainingCapacity(entry.shared);
+            try out.appendSlice(entry.suffix);
+            pos = entry.next;
+        }
+    }
+
+    /// Doc ID whose key is `key`, or null. If several docs share the key,
+    /// the latest one is returned.
+    pub fn find(self: Self, key: []const u8) ?u32 {
+        if (key.len == 0) return null;
+        return self.findHashed(key, hash_util.hash(key));
+    }
+
+    fn findHashed(self: Self, key: []const u8, hash: u64) ?u32 {
+        var doc_id = self.lookup.get(hash) orelse return null;
+        while (!self.keyEquals(doc_id, key)) {
+            doc_id = self.collisions.get(doc_id) orelse return null;
+        }
+        return doc_id;
+    }
+
+    /// Set of the superseded docs, or null if there are none.
+    /// The caller owns the returned set.
+    pub fn supersededSet(self: Self, allocator: Allocator) !?std.DynamicBitSetUnmanaged {
+        if (self.superseded.items.len == 0) return null;
+        var set = try std.DynamicBitSetUnmanaged.initEmpty(allocator, self.count);
+        for (self.superseded.items) |doc_id| set.set(doc_id);
+        return set;
+    }
+
+    /// Remove the postings of superseded docs from a builder's
+    /// term hash -> posting list map, dropping terms left without any.
+    /// Only the latest copy of a re-added key stays searchable.
+    pub fn dropSuperseded(self: Self, term_postings: anytype) !void {
+        var dead = (try self.supersededSet(self.allocator)) orelse return;
+        defer dead.deinit(self.allocator);
+
+        var emptied = ManagedArrayList(u64).init(self.allocator);
+        defer emptied.deinit();
+
+        var iter = term_postings.iterator();
+        while (iter.next()) |entry| {
+            const list = entry.value_ptr;
+            var n: usize = 0;
+            for (list.items) |p| {
+                if (p.doc_id < dead.bit_length and dead.isSet(p.doc_id)) continue;
+                list.items[n] = p;
+                n += 1;
+            }
+            list.shrinkRetainingCapacity(n);
+            if (n == 0) try emptied.append(entry.key_ptr.*);
+        }
+        for (emptied.items) |term| {
+            var removed = term_postings.fetchRemove(term).?;
+            removed.value.deinit();
+        }
+    }
+
+    /// Compare without materializing the key: track how many leading bytes
+    /// of the current key match `key` while walking from the restart point.
+    fn keyEquals(self: Self, doc_id: u32, key: []const u8) bool {
+        const restart = doc_id / RESTART_INTERVAL;
+        var pos: usize = @intCast(self.restarts.items[restart]);
+        var matched: usize = 0;
+        var len: usize = 0;
+
+        var i = restart * RESTART_INTERVAL;
+        while (i <= doc_id) : (i += 1) {
+            const entry = self.entryAt(pos);
+            pos = entry.next;
+            len = entry.shared + entry.suffix.len;
+
+            // Bytes past `matched` in the shared prefix already differ from `key`
+            if (entry.shared > matched) continue;
+            matched = entry.shared;
+            for (entry.suffix) |b| {
+                if (matched >= key.len or key[matched] != b) break;
+                matched += 1;
+            }
+        }
+        return matched == key.len and len == key.len;
+    }
+
+    const Entry = struct { shared: usize, suffix: []const u8, next: usize };
+
+    inline fn entryAt(self: Self, pos: usize) Entry {
+        const data = self.data.items;
+        const shared = vbyte.decode(data[pos..]);
+        const suffix_len = vbyte.decode(data[pos + shared.bytes ..]);
+        const start = pos + shared.bytes + suffix_len.bytes;
+        return .{
+            .shared = shared.value,
+            .suffix = data[start..][0..suffix_len.value],
+            .next = start + suffix_len.value,
+        };
+    }
+
+    pub fn memoryUsage(self: Self) usize {
+        return self.data.capacity +
+            self.restarts.capacity * @sizeOf(u64) +
+            self.lookup.capacity() * (@sizeOf(u64) + @sizeOf(u32)) +
+            self.collisions.capacity() * 2 * @sizeOf(u32) +
+            self.superseded.capacity * @sizeOf(u32) +
+            self.last_key.capacity;
+    }
+
+    /// Append the serialized table to `out`
+    pub fn serialize(self: Self, out: *ManagedArrayList(u8)) !void {
+        const header = KeysHeader{
+            .count = self.count,
+            .restart_count = @intCast(self.restarts.items.len),
+            .data_len = self.data.items.len,
+        };
+        try out.appendSlice(std.mem.asBytes(&header));
+        try out.appendSlice(std.mem.sliceAsBytes(self.restarts.items));
+        try out.appendSlice(self.data.items);
+    }
+
+    /// Rebuild a table from `serialize` output; `consumed` receives its size
+    pub fn deserialize(allocator: Allocator, bytes: []const u8, consumed: *usize) !Self {
+        if (bytes.len < @sizeOf(KeysHeader)) return error.InvalidKeyTable;
+        const header = std.mem.bytesToValue(KeysHeader, bytes[0..@sizeOf(KeysHeader)]);
+        if (!std.mem.eql(u8, &header.magic, "FTSK") or header.version != 1) return error.InvalidKeyTable;
+        if (header.restart_count != (header.count + RESTART_INTERVAL - 1) / RESTART_INTERVAL) return error.InvalidKeyTable;
+
+        const restarts_len = @as(usize, header.restart_count) * @sizeOf(u64);
+        const data_len: usize = @intCast(header.data_len);
+        const total = @sizeOf(KeysHeader) + restarts_len + data_len;
+        if (bytes.len < total) return error.InvalidKeyTable;
+
+        var self = Self.init(allocator);
+        errdefer self.deinit();
+
+        // Replay entries to validate them and rebuild the lookup map
+        const data = bytes[@sizeOf(KeysHeader) + restarts_len ..][0..data_len];
+        var scratch = ManagedArrayList(u8).init(allocator);
+        defer scratch.deinit();
+
+        var pos: usize = 0;
+        for (0..header.count) |doc| {
+            if (pos + 2 > data.len) return error.InvalidKeyTable;
+            const shared = vbyte.decode(data[pos..]);
+            const suffix_len = vbyte.decode(data[pos + shared.bytes ..]);
+            const start = pos + shared.bytes + suffix_len.bytes;
+            if (shared.value > scratch.items.len or start + suffix_len.value > data.len) return error.InvalidKeyTable;
+
+            scratch.shrinkRetainingCapacity(shared.value);
+            try scratch.appendSlice(data[start..][0..suffix_len.value]);
+            try self.append(@intCast(doc), scratch.items);
+            pos = start + suffix_len.value;
+        }
+        if (pos != data.len) return error.InvalidKeyTable;
+
+        consumed.* = total;
+        return self;
+    }
+
+    /// Write the serialized table to `path` (segment sidecar)
+    pub fn writeFile(self: Self, path: []const u8) !void {
+        var bytes = ManagedArrayList(u8).init(self.allocator);
+        defer bytes.deinit();
+        try self.serialize(&bytes);
+
+        const file = try std.fs.cwd().createFile(path, .{});
+        defer file.close();
+        try file.writeAll(bytes.items);
+    }
+
+    /// Load a sidecar written by `writeFile`, or null if there is none
+    pub fn readFile(allocator: Allocator, path: []const u8) !?Self {
+        const bytes = std.fs.cwd().readFileAlloc(allocator, path, std.math.maxInt(u32)) catch |err| switch (err) {
+            error.FileNotFound => return null,
+            else => return err,
+        };
+        defer allocator.free(bytes);
+
+        var consumed: usize = 0;
+        var self = try deserialize(allocator, bytes, &consumed);
+        errdefer self.deinit();
+        if (consumed != bytes.len) return error.InvalidKeyTable;
+        return self;
+    }
+};
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+test "key store get and find" {
+    var keys = KeyStore.init(std.testing.allocator);
+    defer keys.deinit();
+
+    var i: u32 = 0;
+    var buf: [64]u8 = undefined;
+    while (i < 40) : (i += 1) {
+        try keys.append(i, try std.fmt.bufPrint(&buf, "<urn:uuid:0000-{d:0>4}>", .{i}));
+    }
+
+    var out = ManagedArrayList(u8).init(std.testing.allocator);
+    defer out.deinit();
+
+    try keys.get(17, &out);
+    try std.testing.expectEqualStrings("<urn:uuid:0000-0017>", out.items);
+    try keys.get(39, &out);
+    try std.testing.expectEqualStrings("<urn:uuid:0000-0039>", out.items);
+
+    try std.testing.expectEqual(@as(?u32, 33), keys.find("<urn:uuid:0000-0033>"));
+    try std.testing.expectEqual(@as(?u32, null), keys.find("<urn:uuid:0000-0033"));
+    try std.testing.expectEqual(@as(?u32, null), keys.find("missing"));
+
+    // Front coding keeps the table well below the raw key bytes
+    try std.testing.expect(keys.data.items.len < 40 * 20 / 2);
+}
+
+test "key store gaps and updates" {
+    var keys = KeyStore.init(std.testing.allocator);
+    defer keys.deinit();
+
+    try keys.append(0, "a");
+    try keys.append(3, "b");
+    try keys.append(4, "a"); // update of "a"
+
+    var out = ManagedArrayList(u8).init(std.testing.allocator);
+    defer out.deinit();
+
+    try keys.get(2, &out);
+    try std.testing.expectEqualStrings("", out.items);
+    try std.testing.expectEqual(@as(?u32, 4), keys.find("a"));
+    try std.testing.expectEqual(@as(?u32, 3), keys.find("b"));
+    try std.testing.expectEqualSlices(u32, &.{0}, keys.superseded.items);
+}
+
+test "key store hash collisions" {
+    var keys = KeyStore.init(std.testing.allocator);
+    defer keys.deinit();
+
+    // Link every key under one hash, as if they all collided
+    const h: u64 = 42;
+    for ([_][]const u8{ "x", "y", "z", "y" }, 0..) |key, doc| {
+        try keys.push(key);
+        try keys.link(@intCast(doc), key, h);
+    }
+
+    try std.testing.expectEqual(@as(?u32, 0), keys.findHashed("x", h));
+    try std.testing.expectEqual(@as(?u32, 3), keys.findHashed("y", h));
+    try std.testing.expectEqual(@as(?u32, 2), keys.findHashed("z", h));
+    try std.testing.expectEqual(@as(?u32, null), keys.findHashed("w", h));
+    // The first "y" was unlinked from the middle of the chain
+    try std.testing.expectEqualSlices(u32, &.{1}, keys.superseded.items);
+}
+
+test "key store serialize roundtrip" {
+    var keys = KeyStore.init(std.testing.allocator);
+    defer keys.deinit();
+
+    try keys.append(0, "https://example.com/a");
+    try keys.append(1, "https://example.com/b");
+    try keys.append(2, "https://example.org/");
+
+    var bytes = ManagedArrayList(u8).init(std.testing.allocator);
+    defer bytes.deinit();
+    try keys.serialize(&bytes);
+
+    var consumed: usize = 0;
+    var loaded = try KeyStore.deserialize(std.testing.allocator, bytes.items, &consumed);
+    defer loaded.deinit();
+
+    try std.testing.expectEqual(bytes.items.len, consumed);
+    try std.testing.expectEqual(@as(u32, 3), loaded.count);
+    try std.testing.expectEqual(@as(?u32, 2), loaded.find("https://example.org/"));
+}
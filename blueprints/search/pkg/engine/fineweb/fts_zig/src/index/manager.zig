@@ -71,6 +71,19 @@ pub const IndexManager = struct {
         return self.idx_writer.addDocument(text);
     }
 
+    /// Add a document with an external key; a later doc with the same key
+    /// supersedes it once both are flushed
+    pub fn addDocumentKeyed(self: *Self, key: []const u8, text: []const u8) !u32 {
+        return self.idx_writer.addDocumentKeyed(key, text);
+    }
+
+    /// Doc ID of the live flushed document with `key`, or null
+    pub fn findKey(self: *Self, key: []const u8) ?u32 {
+        self.idx_writer.mutex.lock();
+        defer self.idx_writer.mutex.unlock();
+        return self.idx_writer.segment_manager.findKey(key);
+    }
+
     /// Add multiple documents
     pub fn addDocuments(self: *Self, texts: []const []const u8) !void {
         try self.idx_writer.addDocuments(texts);
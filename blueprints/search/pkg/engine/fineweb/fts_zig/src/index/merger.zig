@@ -5,6 +5,7 @@ const std = @import("std");
 const Allocator = std.mem.Allocator;
 const Thread = std.Thread;
 const segment = @import("segment.zig");
+const keys_mod = @import("keys.zig");
 
 fn ManagedArrayList(comptime T: type) type {
     return std.array_list.AlignedManaged(T, null);
@@ -154,11 +155,33 @@ pub const Merger = struct {
         // 1. Open all source segments
         // 2. Create new target segment at target_level
         // 3. Merge posting lists
-        // 4. Write merged segment
-        // 5. Delete source segments
+        // 4. Write merged segment, plus its key sidecar via mergeKeys
+        // 5. Delete source segments (and their .keys sidecars)
     }
 };
 
+/// Key table of the segment merged from `sources` (oldest first), whose
+/// docs are concatenated in order. Superseded docs keep their slot with an
+/// empty key, so an old copy never shadows the live one after the merge.
+pub fn mergeKeys(allocator: Allocator, sources: []const *const segment.SegmentReader) !keys_mod.KeyStore {
+    var merged = keys_mod.KeyStore.init(allocator);
+    errdefer merged.deinit();
+    var key = ManagedArrayList(u8).init(allocator);
+    defer key.deinit();
+
+    var base: u32 = 0;
+    for (sources) |seg| {
+        for (0..seg.keys.count) |i| {
+            const doc_id: u32 = @intCast(i);
+            if (seg.isDeleted(doc_id)) continue;
+            try seg.keys.get(doc_id, &key);
+            if (key.items.len > 0) try merged.append(base + doc_id, key.items);
+        }
+        base += seg.docCount();
+    }
+    return merged;
+}
+
 /// Manual merge trigger (for testing/debugging)
 pub fn forceMerge(allocator: Allocator, base_path: []const u8, target_level: u8) !void {
     _ = allocator;
@@ -171,6 +194,38 @@ pub fn forceMerge(allocator: Allocator, base_path: []const u8, target_level: u8)
 // Tests
 // ============================================================================
 
+test "merge keys" {
+    const writer_mod = @import("writer.zig");
+    const path = "/tmp/fts_zig_merge_keys_test";
+    std.fs.cwd().deleteTree(path) catch {};
+    defer std.fs.cwd().deleteTree(path) catch {};
+
+    var writer = writer_mod.IndexWriter.init(std.testing.allocator, .{
+        .base_path = path,
+        .profile = .speed,
+    });
+    defer writer.deinit();
+
+    _ = try writer.addDocumentKeyed("a", "first");
+    _ = try writer.addDocumentKeyed("b", "second");
+    try writer.flush();
+    _ = try writer.addDocument("no key");
+    _ = try writer.addDocumentKeyed("a", "updated");
+    try writer.flush();
+
+    const segs = writer.segment_manager.segments.items;
+    var merged = try mergeKeys(std.testing.allocator, &.{ segs[0], segs[1] });
+    defer merged.deinit();
+
+    try std.testing.expectEqual(@as(?u32, 3), merged.find("a"));
+    try std.testing.expectEqual(@as(?u32, 1), merged.find("b"));
+
+    var key = ManagedArrayList(u8).init(std.testing.allocator);
+    defer key.deinit();
+    try merged.get(0, &key);
+    try std.testing.expectEqual(@as(usize, 0), key.items.len);
+}
+
 test "merger init" {
     var merger = Merger.init(
         std.testing.allocator,
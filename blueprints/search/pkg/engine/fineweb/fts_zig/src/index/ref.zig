@@ -0,0 +1,210 @@
+//! Hot-swappable index reference
+//! Lets a freshly built index replace the served one without blocking searches:
+//!   - Readers pin the current version lock-free (epoch slot + refcount)
+//!   - `swap` publishes a new version with a single atomic exchange
+//!   - The old version is destroyed by whoever drops its last reference:
+//!     the swapper if it is idle, otherwise the last in-flight search
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+
+/// Reference to the currently published `T`, destroyed with `destroy_fn`
+pub fn IndexRef(comptime T: type) type {
+    return struct {
+        allocator: Allocator,
+        destroy_fn: DestroyFn,
+        current: std.atomic.Value(?*Version),
+        /// Bumped by every swap; readers register in slot `epoch & 1`
+        epoch: std.atomic.Value(u64),
+        /// Readers currently between "load pointer" and "take reference"
+        readers: [2]std.atomic.Value(u32),
+        /// Serializes swaps; never taken by readers
+        swap_mutex: std.Thread.Mutex,
+        /// Number of versions published so far
+        generation: std.atomic.Value(u64),
+
+        const Self = @This();
+
+        pub const DestroyFn = *const fn (T) void;
+
+        pub const Version = struct {
+            value: T,
+            refs: std.atomic.Value(u32),
+            generation: u64,
+            allocator: Allocator,
+            destroy_fn: DestroyFn,
+
+            fn unref(self: *Version) void {
+                if (self.refs.fetchSub(1, .acq_rel) == 1) {
+                    self.destroy_fn(self.value);
+                    self.allocator.destroy(self);
+                }
+            }
+        };
+
+        /// Pinned version; stays valid until `release`, even across swaps
+        pub const Guard = struct {
+            version: *Version,
+
+            pub fn value(self: Guard) T {
+                return self.version.value;
+            }
+
+            pub fn generation(self: Guard) u64 {
+                return self.version.generation;
+            }
+
+            pub fn release(self: Guard) void {
+                self.version.unref();
+            }
+        };
+
+        pub fn init(allocator: Allocator, destroy_fn: DestroyFn) Self {
+            return .{
+                .allocator = allocator,
+                .destroy_fn = destroy_fn,
+                .current = std.atomic.Value(?*Version).init(null),
+                .epoch = std.atomic.Value(u64).init(0),
+                .readers = .{ std.atomic.Value(u32).init(0), std.atomic.Value(u32).init(0) },
+                .swap_mutex = .{},
+                .generation = std.atomic.Value(u64).init(0),
+            };
+        }
+
+        /// Unpublish and release the current version.
+        /// Callers must stop issuing `acquire` first; pinned guards stay valid.
+        pub fn deinit(self: *Self) void {
+            self.swap(null) catch unreachable; // publishing null never allocates
+        }
+
+        /// Pin the current version, or null if nothing is published. Never blocks.
+        pub fn acquire(self: *Self) ?Guard {
+            const slot = self.enterReader();
+            defer _ = self.readers[slot].fetchSub(1, .release);
+
+            const version = self.current.load(.seq_cst) orelse return null;
+            _ = version.refs.fetchAdd(1, .monotonic);
+            return .{ .version = version };
+        }
+
+        /// Publish `value` (ownership moves to the ref) and release the
+        /// previous version. In-flight searches finish on the old version.
+        pub fn swap(self: *Self, value: ?T) !void {
+            self.swap_mutex.lock();
+            defer self.swap_mutex.unlock();
+
+            var next: ?*Version = null;
+            if (value) |v| {
+                const version = try self.allocator.create(Version);
+                version.* = .{
+                    .value = v,
+                    .refs = std.atomic.Value(u32).init(1), // held by the ref
+                    .generation = self.generation.load(.monotonic) + 1,
+                    .allocator = self.allocator,
+                    .destroy_fn = self.destroy_fn,
+                };
+                next = version;
+                self.generation.store(version.generation, .monotonic);
+            }
+
+            const old = self.current.swap(next, .seq_cst);
+            self.drainReaders();
+            if (old) |o| o.unref();
+        }
+
+        fn enterReader(self: *Self) usize {
+            while (true) {
+                const e = self.epoch.load(.seq_cst);
+                const slot: usize = @intCast(e & 1);
+                _ = self.readers[slot].fetchAdd(1, .seq_cst);
+                if (self.epoch.load(.seq_cst) == e) return slot;
+                // Raced with a swap; register in the new epoch instead
+                _ = self.readers[slot].fetchSub(1, .seq_cst);
+            }
+        }
+
+        /// Wait for readers that may still be taking a reference on the old
+        /// pointer. They only hold the slot for a load + increment.
+        fn drainReaders(self: *Self) void {
+            const e = self.epoch.fetchAdd(1, .seq_cst);
+            const slot: usize = @intCast(e & 1);
+            while (self.readers[slot].load(.seq_cst) != 0) {
+                std.Thread.yield() catch {};
+            }
+        }
+    };
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+const TestIndex = struct {
+    id: u32,
+    destroyed: *std.atomic.Value(u32),
+};
+
+fn destroyTestIndex(idx: TestIndex) void {
+    _ = idx.destroyed.fetchAdd(1, .monotonic);
+}
+
+test "index ref swap releases old version" {
+    var destroyed = std.atomic.Value(u32).init(0);
+    var ref = IndexRef(TestIndex).init(std.testing.allocator, destroyTestIndex);
+    defer ref.deinit();
+
+    try std.testing.expect(ref.acquire() == null);
+
+    try ref.swap(.{ .id = 1, .destroyed = &destroyed });
+    try ref.swap(.{ .id = 2, .destroyed = &destroyed });
+    try std.testing.expectEqual(@as(u32, 1), destroyed.load(.monotonic));
+
+    const guard = ref.acquire().?;
+    defer guard.release();
+    try std.testing.expectEqual(@as(u32, 2), guard.value().id);
+    try std.testing.expectEqual(@as(u64, 2), guard.generation());
+}
+
+test "index ref defers destroy until guard release" {
+    var destroyed = std.atomic.Value(u32).init(0);
+    var ref = IndexRef(TestIndex).init(std.testing.allocator, destroyTestIndex);
+    defer ref.deinit();
+
+    try ref.swap(.{ .id = 1, .destroyed = &destroyed });
+    const pinned = ref.acquire().?;
+
+    try ref.swap(.{ .id = 2, .destroyed = &destroyed });
+    try std.testing.expectEqual(@as(u32, 0), destroyed.load(.monotonic));
+    try std.testing.expectEqual(@as(u32, 1), pinned.value().id);
+
+    pinned.release();
+    try std.testing.expectEqual(@as(u32, 1), destroyed.load(.monotonic));
+}
+
+test "index ref concurrent readers" {
+    var destroyed = std.atomic.Value(u32).init(0);
+    var ref = IndexRef(TestIndex).init(std.testing.allocator, destroyTestIndex);
+    try ref.swap(.{ .id = 0, .destroyed = &destroyed });
+
+    var stop = std.atomic.Value(bool).init(false);
+    const Reader = struct {
+        fn run(r: *IndexRef(TestIndex), s: *std.atomic.Value(bool)) void {
+            while (!s.load(.acquire)) {
+                const guard = r.acquire() orelse continue;
+                std.debug.assert(guard.value().id + 1 == guard.generation());
+                guard.release();
+            }
+        }
+    };
+
+    var threads: [4]std.Thread = undefined;
+    for (&threads) |*t| t.* = try std.Thread.spawn(.{}, Reader.run, .{ &ref, &stop });
+
+    for (1..200) |i| try ref.swap(.{ .id = @intCast(i), .destroyed = &destroyed });
+
+    stop.store(true, .release);
+    for (threads) |t| t.join();
+    ref.deinit();
+
+    try std.testing.expectEqual(@as(u32, 200), destroyed.load(.monotonic));
+}
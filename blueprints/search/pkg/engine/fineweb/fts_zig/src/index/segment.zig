@@ -1,9 +1,12 @@
 //! Segment abstraction for streaming indexing
-//! Segments are immutable once written, enabling lock-free reads
+//! Segments are immutable once written, enabling lock-free reads.
+//! External keys live in a `<segment>.keys` sidecar; a keyed doc supersedes
+//! older docs with the same key, which are then masked as deleted.
 
 const std = @import("std");
 const Allocator = std.mem.Allocator;
 const mmap = @import("../util/mmap.zig");
+const keys_mod = @import("keys.zig");
 
 fn ManagedArrayList(comptime T: type) type {
     return std.array_list.AlignedManaged(T, null);
@@ -146,6 +149,10 @@ pub const SegmentReader = struct {
     allocator: Allocator,
     mapped: mmap.MappedFile,
     header: SegmentHeader,
+    /// External keys from the sidecar (empty if the segment has none)
+    keys: keys_mod.KeyStore,
+    /// Docs superseded by a later doc with the same key
+    deleted: std.DynamicBitSetUnmanaged,
 
     const Self = @This();
 
@@ -164,14 +171,24 @@ pub const SegmentReader = struct {
             return error.InvalidMagic;
         }
 
+        const keys_path = try std.fmt.allocPrint(allocator, "{s}.keys", .{path});
+        defer allocator.free(keys_path);
+        var keys = (try keys_mod.KeyStore.readFile(allocator, keys_path)) orelse keys_mod.KeyStore.init(allocator);
+        errdefer keys.deinit();
+        if (keys.count > header.doc_count) return error.InvalidKeyTable;
+
         return Self{
             .allocator = allocator,
             .mapped = mapped,
             .header = header,
+            .keys = keys,
+            .deleted = try std.DynamicBitSetUnmanaged.initEmpty(allocator, header.doc_count),
         };
     }
 
     pub fn close(self: *Self) void {
+        self.deleted.deinit(self.allocator);
+        self.keys.deinit();
         self.mapped.close();
     }
 
@@ -180,6 +197,16 @@ pub const SegmentReader = struct {
         return self.header.doc_count;
     }
 
+    /// Documents not superseded by a later doc with the same key
+    pub fn liveDocCount(self: Self) u32 {
+        return self.header.doc_count - @as(u32, @intCast(self.deleted.count()));
+    }
+
+    /// True if `doc_id` was superseded and must be filtered from results
+    pub fn isDeleted(self: Self, doc_id: u32) bool {
+        return self.deleted.isSet(doc_id);
+    }
+
     /// Get term count
     pub fn termCount(self: Self) u32 {
         return self.header.term_count;
@@ -283,9 +310,54 @@ pub const SegmentManager = struct {
         };
     }
 
-    /// Add a segment
+    /// Add a segment, newest last. Its keyed docs supersede older docs
+    /// with the same key, both within it and in earlier segments.
     pub fn addSegment(self: *Self, segment: *SegmentReader) !void {
         try self.segments.append(segment);
+        if (segment.keys.isEmpty()) return;
+
+        for (segment.keys.superseded.items) |doc_id| segment.deleted.set(doc_id);
+
+        const older = self.segments.items[0 .. self.segments.items.len - 1];
+        if (older.len == 0) return;
+        var key = ManagedArrayList(u8).init(self.allocator);
+        defer key.deinit();
+
+        for (0..segment.keys.count) |i| {
+            const doc_id: u32 = @intCast(i);
+            if (segment.deleted.isSet(doc_id)) continue;
+            try segment.keys.get(doc_id, &key);
+            if (key.items.len == 0) continue;
+
+            for (older) |seg| {
+                if (seg.keys.find(key.items)) |old_doc| seg.deleted.set(old_doc);
+            }
+        }
+    }
+
+    /// Global doc ID (segment base + local ID) of the live doc with `key`
+    pub fn findKey(self: Self, key: []const u8) ?u32 {
+        var base = self.totalDocs();
+        var i = self.segments.items.len;
+        while (i > 0) {
+            i -= 1;
+            const seg = self.segments.items[i];
+            base -= seg.docCount();
+            if (seg.keys.find(key)) |doc_id| {
+                if (!seg.isDeleted(doc_id)) return base + doc_id;
+            }
+        }
+        return null;
+    }
+
+    /// True if global `doc_id` was superseded by a later doc with its key
+    pub fn isDeleted(self: Self, doc_id: u32) bool {
+        var base: u32 = 0;
+        for (self.segments.items) |seg| {
+            if (doc_id < base + seg.docCount()) return seg.isDeleted(doc_id - base);
+            base += seg.docCount();
+        }
+        return false;
     }
 
     /// Get total document count across all segments
@@ -296,6 +368,15 @@ pub const SegmentManager = struct {
         }
         return total;
     }
+
+    /// Total documents not superseded by a later doc with the same key
+    pub fn liveDocs(self: Self) u32 {
+        var total: u32 = 0;
+        for (self.segments.items) |seg| {
+            total += seg.liveDocCount();
+        }
+        return total;
+    }
 };
 
 // ============================================================================
@@ -1,5 +1,7 @@
 //! Streaming index writer with background flushing
-//! Accumulates documents in memory and flushes to segments
+//! Accumulates documents in memory and flushes to segments.
+//! External keys of a segment go to a `<segment>.keys` sidecar, loaded
+//! again when the flushed segment is opened.
 
 const std = @import("std");
 const Allocator = std.mem.Allocator;
@@ -8,6 +10,7 @@ const Mutex = std.Thread.Mutex;
 const segment = @import("segment.zig");
 const byte_tokenizer = @import("../tokenizer/byte.zig");
 const arena_mod = @import("../util/arena.zig");
+const keys_mod = @import("keys.zig");
 
 fn ManagedArrayList(comptime T: type) type {
     return std.array_list.AlignedManaged(T, null);
@@ -43,6 +46,8 @@ pub const IndexWriter = struct {
     total_tokens: u64,
     /// Segment manager
     segment_manager: segment.SegmentManager,
+    /// External keys of buffered docs (segment-local doc IDs)
+    keys: keys_mod.KeyStore,
     /// Global document ID counter
     global_doc_id: u32,
     /// Mutex for thread safety
@@ -58,6 +63,7 @@ pub const IndexWriter = struct {
             .doc_lengths = ManagedArrayList(u32).init(allocator),
             .total_tokens = 0,
             .segment_manager = segment.SegmentManager.init(allocator, config.base_path),
+            .keys = keys_mod.KeyStore.init(allocator),
             .global_doc_id = 0,
             .mutex = .{},
         };
@@ -71,10 +77,20 @@ pub const IndexWriter = struct {
         self.term_postings.deinit();
         self.doc_lengths.deinit();
         self.segment_manager.deinit();
+        self.keys.deinit();
     }
 
     /// Add a document to the index
     pub fn addDocument(self: *Self, text: []const u8) !u32 {
+        return self.addDocumentInternal(null, text);
+    }
+
+    /// Add a document with an external key, persisted with its segment
+    pub fn addDocumentKeyed(self: *Self, key: []const u8, text: []const u8) !u32 {
+        return self.addDocumentInternal(key, text);
+    }
+
+    fn addDocumentInternal(self: *Self, key: ?[]const u8, text: []const u8) !u32 {
         self.mutex.lock();
         defer self.mutex.unlock();
 
@@ -89,6 +105,7 @@ pub const IndexWriter = struct {
         const result = byte_tokenizer.tokenizeAndAggregate(&tokenizer, text, &token_buf, &agg_buf);
 
         // Store
+        if (key) |k| try self.keys.append(@intCast(self.doc_lengths.items.len), k);
         try self.doc_lengths.append(result.doc_len);
         self.total_tokens += result.doc_len;
 
@@ -175,12 +192,26 @@ pub const IndexWriter = struct {
 
         writer.close();
 
+        if (!self.keys.isEmpty()) {
+            var keys_path_buf: [264]u8 = undefined;
+            const keys_path = try std.fmt.bufPrint(&keys_path_buf, "{s}.keys", .{full_path});
+            try self.keys.writeFile(keys_path);
+        }
+
+        // Serve the segment; its keys supersede older docs with the same key
+        const reader = try self.allocator.create(segment.SegmentReader);
+        errdefer self.allocator.destroy(reader);
+        reader.* = try segment.SegmentReader.open(self.allocator, full_path);
+        errdefer reader.close();
+        try self.segment_manager.addSegment(reader);
+
         // Clear buffer
         var clear_iter = self.term_postings.iterator();
         while (clear_iter.next()) |entry| {
             entry.value_ptr.clearRetainingCapacity();
         }
         self.doc_lengths.clearRetainingCapacity();
+        self.keys.clear();
         self.total_tokens = 0;
     }
 
@@ -236,3 +267,46 @@ test "writer basic" {
     // Cleanup
     std.fs.cwd().deleteTree(path) catch {};
 }
+
+test "writer keys sidecar" {
+    const path = "/tmp/fts_zig_writer_keys_test";
+    std.fs.cwd().deleteTree(path) catch {};
+    defer std.fs.cwd().deleteTree(path) catch {};
+
+    var writer = IndexWriter.init(std.testing.allocator, .{
+        .base_path = path,
+        .profile = .speed,
+    });
+    defer writer.deinit();
+
+    _ = try writer.addDocumentKeyed("doc-a", "hello world");
+    _ = try writer.addDocument("no key");
+    _ = try writer.addDocumentKeyed("doc-c", "hello there");
+    try writer.flush();
+
+    var keys = (try keys_mod.KeyStore.readFile(std.testing.allocator, path ++ "/seg_0_0_0.fts.keys")).?;
+    defer keys.deinit();
+    try std.testing.expectEqual(@as(?u32, 2), keys.find("doc-c"));
+    try std.testing.expect(writer.keys.isEmpty());
+
+    // Re-adding a key in a later segment supersedes the older doc
+    _ = try writer.addDocumentKeyed("doc-d", "hello again");
+    _ = try writer.addDocumentKeyed("doc-a", "hello updated");
+    _ = try writer.addDocumentKeyed("doc-d", "hello twice");
+    try writer.flush();
+
+    const segments = &writer.segment_manager;
+    try std.testing.expectEqual(@as(usize, 2), segments.segments.items.len);
+    try std.testing.expectEqual(@as(?u32, 4), segments.findKey("doc-a"));
+    try std.testing.expectEqual(@as(?u32, 5), segments.findKey("doc-d"));
+    try std.testing.expectEqual(@as(?u32, 2), segments.findKey("doc-c"));
+    try std.testing.expect(segments.isDeleted(0));
+    try std.testing.expect(segments.isDeleted(3));
+    try std.testing.expect(!segments.isDeleted(1));
+    try std.testing.expectEqual(@as(u32, 4), segments.liveDocs());
+
+    // Reopening loads the sidecar
+    var reopened = try segment.SegmentReader.open(std.testing.allocator, path ++ "/seg_0_0_1.fts");
+    defer reopened.close();
+    try std.testing.expectEqual(@as(?u32, 1), reopened.keys.find("doc-a"));
+}
@@ -0,0 +1,1241 @@
+//! Streaming Parquet ingest for the in-memory profile builders
+//! Feeds one text column of a set of parquet files straight into a builder:
+//!   - Row groups are decoded by a pool of worker threads
+//!   - ZSTD (libzstd) and SNAPPY (codec/snappy.zig) pages, V1 and V2 data pages
+//!   - PLAIN and RLE_DICTIONARY encoded BYTE_ARRAY values
+//!   - Values are tokenized as soon as their page is decompressed; only
+//!     aggregated tokens are handed to the (single-threaded) builder
+//!   - At most `window` tokenized row groups are in flight, workers block
+//!     when the builder falls behind (bounded memory, backpressure)
+//!
+//! Documents are added in (file, row group, row) order, so doc IDs are
+//! deterministic. Null values become empty documents to keep
+//! doc_id == row ordinal across the whole input.
+//!
+//! With `checkpoint_dir` set, progress is checkpointed every
+//! `checkpoint_every` row groups (index/checkpoint.zig); a rerun with the
+//! same inputs restores the builder and continues after the last checkpoint.
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+
+fn ManagedArrayList(comptime T: type) type {
+    return std.array_list.AlignedManaged(T, null);
+}
+
+const byte_tokenizer = @import("../tokenizer/byte.zig");
+const snappy = @import("../codec/snappy.zig");
+const checkpoint = @import("../index/checkpoint.zig");
+
+const c = @cImport({
+    @cInclude("zstd.h");
+});
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+pub const Options = struct {
+    /// Decode threads (0 = one per CPU)
+    n_threads: u32 = 0,
+    /// Tokenized row groups allowed in flight per decode thread
+    window_per_thread: u32 = 2,
+    /// Directory for resumable-build checkpoints (null = no checkpoints)
+    checkpoint_dir: ?[]const u8 = null,
+    /// Row groups between checkpoints
+    checkpoint_every: u32 = 64,
+};
+
+pub const Stats = struct {
+    files: u32 = 0,
+    row_groups: u32 = 0,
+    /// Documents added by this call
+    docs: u64 = 0,
+    text_bytes: u64 = 0,
+    /// Documents restored from a checkpoint
+    resumed_docs: u64 = 0,
+};
+
+/// Ingest `column` of every parquet file matched by `path_glob` into `builder`.
+///
+/// `path_glob` is a file, a directory (all `*.parquet` inside) or a
+/// `dir/pattern` where pattern may use `*` and `?`. Files are processed in
+/// sorted order. `Builder` must provide
+/// `addTokenized(tokens: []const byte_tokenizer.Token, doc_len: u32) !u32`.
+///
+/// On error the builder keeps the documents added so far. When
+/// checkpointing, the builder must be empty if a checkpoint exists, and the
+/// inputs must still contain the checkpointed cursor file.
+pub fn ingest(
+    comptime Builder: type,
+    allocator: Allocator,
+    builder: *Builder,
+    path_glob: []const u8,
+    column: []const u8,
+    options: Options,
+) anyerror!Stats {
+    var files = try expandGlob(allocator, path_glob);
+    defer {
+        for (files.items) |f| allocator.free(f);
+        files.deinit();
+    }
+
+    // Footers are small; parse them all up front so work units can be
+    // scheduled across file boundaries.
+    var sources = ManagedArrayList(SourceFile).init(allocator);
+    defer {
+        for (sources.items) |*s| s.meta.deinit(allocator);
+        sources.deinit();
+    }
+    var units = ManagedArrayList(WorkUnit).init(allocator);
+    defer units.deinit();
+
+    for (files.items) |path| {
+        {
+            var meta = try readFileMetaData(allocator, path);
+            errdefer meta.deinit(allocator);
+            const col = try findColumn(meta.schema, column);
+            try sources.append(.{ .path = path, .meta = meta, .column = col });
+        }
+
+        const file_idx: u32 = @intCast(sources.items.len - 1);
+        for (0..sources.items[file_idx].meta.row_groups.len) |rg| {
+            try units.append(.{ .file = file_idx, .row_group = @intCast(rg) });
+        }
+    }
+
+    var stats = Stats{
+        .files = @intCast(sources.items.len),
+        .row_groups = @intCast(units.items.len),
+    };
+
+    var checkpointer: ?checkpoint.Checkpointer = null;
+    defer if (checkpointer) |*cp| cp.deinit();
+
+    var first_unit: usize = 0;
+    if (options.checkpoint_dir) |dir| {
+        checkpointer = checkpoint.Checkpointer.init(allocator, dir);
+        if (try checkpointer.?.restore(Builder, builder)) |cursor| {
+            stats.resumed_docs = checkpointer.?.docs;
+            first_unit = if (cursor.done) units.items.len else try findUnit(sources.items, units.items, cursor);
+        }
+    }
+
+    const pending = units.items[first_unit..];
+    if (pending.len == 0) return stats;
+
+    const cpu_count: usize = std.Thread.getCpuCount() catch 4;
+    const requested: usize = if (options.n_threads > 0) options.n_threads else cpu_count;
+    const n_threads: usize = @max(1, @min(requested, pending.len));
+
+    const slots = try allocator.alloc(Pipeline.Slot, n_threads * @max(1, options.window_per_thread));
+    defer allocator.free(slots);
+    for (slots) |*s| s.* = .{};
+
+    var pipeline = Pipeline{
+        .allocator = allocator,
+        .sources = sources.items,
+        .units = pending,
+        .slots = slots,
+    };
+
+    const threads = try allocator.alloc(std.Thread, n_threads);
+    defer allocator.free(threads);
+
+    var spawned: usize = 0;
+    for (threads) |*t| {
+        t.* = std.Thread.spawn(.{}, workerMain, .{&pipeline}) catch |err| {
+            pipeline.fail(err);
+            break;
+        };
+        spawned += 1;
+    }
+
+    // Drain batches in unit order on the calling thread
+    const every: usize = @max(1, options.checkpoint_every);
+    while (pipeline.consumed < pending.len) {
+        var batch = pipeline.take() orelse break;
+        feedBatch(Builder, builder, &batch, &stats) catch |err| {
+            batch.deinit();
+            pipeline.fail(err);
+            break;
+        };
+        batch.deinit();
+        pipeline.release();
+
+        if (checkpointer) |*cp| {
+            const done = pipeline.consumed == pending.len;
+            if (done or pipeline.consumed % every == 0) {
+                const cursor: checkpoint.Cursor = if (done) .{ .done = true } else blk: {
+                    const next = pending[pipeline.consumed];
+                    break :blk .{ .file = sources.items[next.file].path, .row_group = next.row_group };
+                };
+                cp.save(Builder, builder, cursor) catch |err| {
+                    pipeline.fail(err);
+                    break;
+                };
+            }
+        }
+    }
+
+    for (threads[0..spawned]) |t| t.join();
+    for (slots) |*s| {
+        if (s.ready) s.batch.deinit();
+    }
+
+    if (pipeline.failure) |err| return err;
+    return stats;
+}
+
+/// Index of the unit a checkpoint cursor points at
+fn findUnit(sources: []const SourceFile, units: []const WorkUnit, cursor: checkpoint.Cursor) !usize {
+    for (units, 0..) |u, i| {
+        if (u.row_group == cursor.row_group and std.mem.eql(u8, sources[u.file].path, cursor.file)) return i;
+    }
+    return error.CheckpointMismatch;
+}
+
+fn feedBatch(comptime Builder: type, builder: *Builder, batch: *const TokenizedBatch, stats: *Stats) !void {
+    var start: usize = 0;
+    for (batch.docs.items) |span| {
+        _ = try builder.addTokenized(batch.tokens.items[start..span.end], span.doc_len);
+        start = span.end;
+    }
+    stats.docs += batch.docs.items.len;
+    stats.text_bytes += batch.text_bytes;
+}
+
+// ============================================================================
+// Pipeline: ordered, bounded hand-off from decode workers to the builder
+// ============================================================================
+
+const SourceFile = struct {
+    path: []const u8,
+    meta: FileMetaData,
+    column: ColumnInfo,
+};
+
+const WorkUnit = struct {
+    file: u32,
+    row_group: u32,
+};
+
+/// Aggregated tokens of every document in one row group
+const TokenizedBatch = struct {
+    tokens: ManagedArrayList(byte_tokenizer.Token),
+    docs: ManagedArrayList(DocSpan),
+    text_bytes: u64 = 0,
+
+    const DocSpan = struct {
+        /// End offset into `tokens`
+        end: usize,
+        /// Total token count (for BM25 normalization)
+        doc_len: u32,
+    };
+
+    fn init(allocator: Allocator) TokenizedBatch {
+        return .{
+            .tokens = ManagedArrayList(byte_tokenizer.Token).init(allocator),
+            .docs = ManagedArrayList(DocSpan).init(allocator),
+        };
+    }
+
+    fn deinit(self: *TokenizedBatch) void {
+        self.tokens.deinit();
+        self.docs.deinit();
+    }
+};
+
+const Pipeline = struct {
+    allocator: Allocator,
+    sources: []const SourceFile,
+    units: []const WorkUnit,
+    next_unit: std.atomic.Value(usize) = std.atomic.Value(usize).init(0),
+    mutex: std.Thread.Mutex = .{},
+    cond: std.Thread.Condition = .{},
+    /// Ring of completed batches, indexed by unit % slots.len
+    slots: []Slot,
+    /// Units handed to the builder (only written by the consumer)
+    consumed: usize = 0,
+    failure: ?anyerror = null,
+
+    const Slot = struct {
+        ready: bool = false,
+        batch: TokenizedBatch = undefined,
+    };
+
+    fn fail(self: *Pipeline, err: anyerror) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        if (self.failure == null) self.failure = err;
+        self.cond.broadcast();
+    }
+
+    /// Block until `unit` fits in the in-flight window.
+    /// Returns false if the pipeline was aborted.
+    fn waitForWindow(self: *Pipeline, unit: usize) bool {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        while (self.failure == null and unit >= self.consumed + self.slots.len) {
+            self.cond.wait(&self.mutex);
+        }
+        return self.failure == null;
+    }
+
+    fn publish(self: *Pipeline, unit: usize, batch: TokenizedBatch) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        self.slots[unit % self.slots.len] = .{ .ready = true, .batch = batch };
+        self.cond.broadcast();
+    }
+
+    /// Take the next batch in unit order, or null if aborted
+    fn take(self: *Pipeline) ?TokenizedBatch {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        const slot = &self.slots[self.consumed % self.slots.len];
+        while (self.failure == null and !slot.ready) {
+            self.cond.wait(&self.mutex);
+        }
+        if (self.failure != null) return null;
+        slot.ready = false;
+        return slot.batch;
+    }
+
+    /// Mark the taken batch as consumed, opening the window by one unit
+    fn release(self: *Pipeline) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        self.consumed += 1;
+        self.cond.broadcast();
+    }
+};
+
+fn workerMain(pipeline: *Pipeline) void {
+    var worker = Worker.init(pipeline.allocator) catch |err| return pipeline.fail(err);
+    defer worker.deinit();
+
+    while (true) {
+        const unit = pipeline.next_unit.fetchAdd(1, .monotonic);
+        if (unit >= pipeline.units.len) return;
+        if (!pipeline.waitForWindow(unit)) return;
+
+        var batch = TokenizedBatch.init(pipeline.allocator);
+        worker.decodeUnit(pipeline.sources, pipeline.units[unit], &batch) catch |err| {
+            batch.deinit();
+            return pipeline.fail(err);
+        };
+        pipeline.publish(unit, batch);
+    }
+}
+
+// ============================================================================
+// Worker: column chunk -> pages -> tokens
+// ============================================================================
+
+const Worker = struct {
+    allocator: Allocator,
+    tokenizer: byte_tokenizer.ByteTokenizer,
+    token_buf: []byte_tokenizer.Token,
+    agg_buf: []byte_tokenizer.Token,
+    /// Raw (compressed) column chunk
+    chunk_buf: ManagedArrayList(u8),
+    /// Decompressed data page
+    page_buf: ManagedArrayList(u8),
+    /// Decompressed dictionary page; `dict` slices point into it
+    dict_buf: ManagedArrayList(u8),
+    dict: ManagedArrayList([]const u8),
+    def_levels: ManagedArrayList(u32),
+    indices: ManagedArrayList(u32),
+
+    fn init(allocator: Allocator) !Worker {
+        const token_buf = try allocator.alloc(byte_tokenizer.Token, 8192);
+        errdefer allocator.free(token_buf);
+        const agg_buf = try allocator.alloc(byte_tokenizer.Token, 4096);
+
+        return .{
+            .allocator = allocator,
+            .tokenizer = byte_tokenizer.ByteTokenizer.init(.{ .lowercase = true }),
+            .token_buf = token_buf,
+            .agg_buf = agg_buf,
+            .chunk_buf = ManagedArrayList(u8).init(allocator),
+            .page_buf = ManagedArrayList(u8).init(allocator),
+            .dict_buf = ManagedArrayList(u8).init(allocator),
+            .dict = ManagedArrayList([]const u8).init(allocator),
+            .def_levels = ManagedArrayList(u32).init(allocator),
+            .indices = ManagedArrayList(u32).init(allocator),
+        };
+    }
+
+    fn deinit(self: *Worker) void {
+        self.allocator.free(self.token_buf);
+        self.allocator.free(self.agg_buf);
+        self.chunk_buf.deinit();
+        self.page_buf.deinit();
+        self.dict_buf.deinit();
+        self.dict.deinit();
+        self.def_levels.deinit();
+        self.indices.deinit();
+    }
+
+    fn decodeUnit(self: *Worker, sources: []const SourceFile, unit: WorkUnit, batch: *TokenizedBatch) !void {
+        const src = &sources[unit.file];
+        const rg = src.meta.row_groups[unit.row_group];
+        if (src.column.leaf_idx >= rg.columns.len) return error.ColumnNotFound;
+        const col = rg.columns[src.column.leaf_idx];
+
+        // Some writers emit dictionary_page_offset = 0 for chunks without one
+        var chunk_offset: usize = @intCast(col.data_page_offset);
+        if (col.dictionary_page_offset) |dict_offset| {
+            if (dict_offset > 0 and dict_offset < col.data_page_offset) chunk_offset = @intCast(dict_offset);
+        }
+        const chunk_size: usize = @intCast(col.total_compressed_size);
+
+        const file = try std.fs.cwd().openFile(src.path, .{});
+        defer file.close();
+        try file.seekTo(chunk_offset);
+        try self.chunk_buf.resize(chunk_size);
+        if (try file.readAll(self.chunk_buf.items) != chunk_size) return error.TruncatedColumnChunk;
+
+        self.dict.clearRetainingCapacity();
+        try batch.docs.ensureTotalCapacity(@intCast(@max(rg.num_rows, 0)));
+
+        const chunk = self.chunk_buf.items;
+        var pos: usize = 0;
+        var values_read: i64 = 0;
+
+        while (pos < chunk.len and values_read < col.num_values) {
+            var header_reader = ThriftReader.init(chunk[pos..]);
+            const ph = try parsePageHeader(&header_reader);
+            pos += header_reader.pos;
+
+            const compressed_size: usize = @intCast(ph.compressed_size);
+            if (pos + compressed_size > chunk.len) return error.TruncatedPage;
+            const page = chunk[pos..][0..compressed_size];
+            pos += compressed_size;
+
+            switch (ph.page_type) {
+                PAGE_DICTIONARY => try self.loadDictionary(col.codec, ph, page),
+                PAGE_DATA => values_read += try self.decodeDataPage(col.codec, ph, page, src.column.optional, batch),
+                PAGE_DATA_V2 => values_read += try self.decodeDataPageV2(col.codec, ph, page, src.column.optional, batch),
+                else => {}, // index pages
+            }
+        }
+    }
+
+    fn loadDictionary(self: *Worker, codec: i32, ph: PageHeader, page: []const u8) !void {
+        const data = try decompressPage(codec, page, @intCast(ph.uncompressed_size), &self.dict_buf);
+        const num_values: usize = @intCast(ph.dict_num_values);
+
+        self.dict.clearRetainingCapacity();
+        try self.dict.ensureTotalCapacity(num_values);
+
+        var pos: usize = 0;
+        for (0..num_values) |_| {
+            if (pos + 4 > data.len) return error.TruncatedPage;
+            const len: usize = std.mem.readInt(u32, data[pos..][0..4], .little);
+            pos += 4;
+            if (pos + len > data.len) return error.TruncatedPage;
+            self.dict.appendAssumeCapacity(data[pos..][0..len]);
+            pos += len;
+        }
+    }
+
+    fn decodeDataPage(self: *Worker, codec: i32, ph: PageHeader, page: []const u8, optional: bool, batch: *TokenizedBatch) !i64 {
+        const data = try decompressPage(codec, page, @intCast(ph.uncompressed_size), &self.page_buf);
+        const num_values: usize = @intCast(ph.dp_num_values);
+
+        var values = data;
+        if (optional) {
+            // V1: def levels are prefixed with their 4-byte encoded length
+            if (data.len < 4) return error.TruncatedPage;
+            const def_len: usize = std.mem.readInt(u32, data[0..4], .little);
+            if (4 + def_len > data.len) return error.TruncatedPage;
+            try self.decodeDefLevels(data[4..][0..def_len], num_values);
+            values = data[4 + def_len ..];
+        }
+
+        try self.emitValues(ph.dp_encoding, values, num_values, optional, batch);
+        return @intCast(num_values);
+    }
+
+    fn decodeDataPageV2(self: *Worker, codec: i32, ph: PageHeader, page: []const u8, optional: bool, batch: *TokenizedBatch) !i64 {
+        const num_values: usize = @intCast(ph.dpv2_num_values);
+        const rep_len: usize = @intCast(ph.dpv2_rep_levels_byte_length);
+        const def_len: usize = @intCast(ph.dpv2_def_levels_byte_length);
+        const levels_len = rep_len + def_len;
+        const uncompressed_size: usize = @intCast(ph.uncompressed_size);
+        if (levels_len > page.len or levels_len > uncompressed_size) return error.TruncatedPage;
+
+        // V2: levels are stored uncompressed ahead of the (optionally compressed) values
+        const body = page[levels_len..];
+        const values = if (ph.dpv2_is_compressed)
+            try decompressPage(codec, body, uncompressed_size - levels_len, &self.page_buf)
+        else
+            body;
+
+        if (optional) try self.decodeDefLevels(page[rep_len..][0..def_len], num_values);
+
+        try self.emitValues(ph.dpv2_encoding, values, num_values, optional, batch);
+        return @intCast(num_values);
+    }
+
+    /// Decode max_def_level=1 levels into `def_levels` (1 = value present)
+    fn decodeDefLevels(self: *Worker, data: []const u8, num_values: usize) !void {
+        try self.def_levels.resize(num_values);
+        if (data.len == 0) {
+            @memset(self.def_levels.items, 1);
+            return;
+        }
+        if (decodeRleBitPacked(data, 1, self.def_levels.items) < num_values) return error.TruncatedPage;
+    }
+
+    fn emitValues(self: *Worker, encoding: i32, data: []const u8, num_values: usize, optional: bool, batch: *TokenizedBatch) !void {
+        switch (encoding) {
+            ENC_PLAIN => {
+                var pos: usize = 0;
+                for (0..num_values) |i| {
+                    if (optional and self.def_levels.items[i] == 0) {
+                        try self.addDoc(batch, "");
+                        continue;
+                    }
+                    if (pos + 4 > data.len) return error.TruncatedPage;
+                    const len: usize = std.mem.readInt(u32, data[pos..][0..4], .little);
+                    pos += 4;
+                    if (pos + len > data.len) return error.TruncatedPage;
+                    try self.addDoc(batch, data[pos..][0..len]);
+                    pos += len;
+                }
+            },
+            ENC_PLAIN_DICTIONARY, ENC_RLE_DICTIONARY => {
+                var non_null = num_values;
+                if (optional) {
+                    non_null = 0;
+                    for (self.def_levels.items[0..num_values]) |lvl| non_null += lvl;
+                }
+
+                try self.indices.resize(non_null);
+                if (non_null > 0) {
+                    if (data.len < 1) return error.TruncatedPage;
+                    const bit_width = data[0];
+                    if (bit_width > 32) return error.InvalidBitWidth;
+                    if (decodeRleBitPacked(data[1..], bit_width, self.indices.items) < non_null) return error.TruncatedPage;
+                }
+
+                var next: usize = 0;
+                for (0..num_values) |i| {
+                    if (optional and self.def_levels.items[i] == 0) {
+                        try self.addDoc(batch, "");
+                        continue;
+                    }
+                    const idx = self.indices.items[next];
+                    next += 1;
+                    if (idx >= self.dict.items.len) return error.InvalidDictionaryIndex;
+                    try self.addDoc(batch, self.dict.items[idx]);
+                }
+            },
+            else => return error.UnsupportedEncoding,
+        }
+    }
+
+    inline fn addDoc(self: *Worker, batch: *TokenizedBatch, text: []const u8) !void {
+        const result = byte_tokenizer.tokenizeAndAggregate(&self.tokenizer, text, self.token_buf, self.agg_buf);
+        try batch.tokens.appendSlice(result.tokens);
+        try batch.docs.append(.{ .end = batch.tokens.items.len, .doc_len = result.doc_len });
+        batch.text_bytes += text.len;
+    }
+};
+
+/// Decompress a page body into `out` (or return it as-is when uncompressed)
+fn decompressPage(codec: i32, src: []const u8, uncompressed_size: usize, out: *ManagedArrayList(u8)) ![]const u8 {
+    switch (codec) {
+        CODEC_UNCOMPRESSED => return src,
+        CODEC_SNAPPY => {
+            try out.resize(uncompressed_size);
+            if (try snappy.decompress(src, out.items) != uncompressed_size) return error.IncompleteDecompression;
+            return out.items;
+        },
+        CODEC_ZSTD => {
+            try out.resize(uncompressed_size);
+            if (uncompressed_size == 0) return out.items;
+            const result = c.ZSTD_decompress(out.items.ptr, out.items.len, src.ptr, src.len);
+            if (c.ZSTD_isError(result) != 0) return error.ZstdDecompressError;
+            if (result != uncompressed_size) return error.IncompleteDecompression;
+            return out.items;
+        },
+        else => return error.UnsupportedCodec,
+    }
+}
+
+/// Decode RLE/Bit-Packed Hybrid encoded integers into `out`
+/// Returns the number of values decoded (<= out.len)
+fn decodeRleBitPacked(data: []const u8, bit_width: u8, out: []u32) usize {
+    if (bit_width == 0) {
+        @memset(out, 0);
+        return out.len;
+    }
+
+    const mask: u64 = (@as(u64, 1) << @intCast(bit_width)) - 1;
+    var pos: usize = 0;
+    var count: usize = 0;
+
+    while (count < out.len and pos < data.len) {
+        var header: u32 = 0;
+        var shift: u5 = 0;
+        while (pos < data.len) {
+            const b = data[pos];
+            pos += 1;
+            header |= @as(u32, b & 0x7F) << shift;
+            if (b & 0x80 == 0) break;
+            shift +|= 7;
+        }
+
+        if (header & 1 == 1) {
+            // Bit-packed run: (header >> 1) groups of 8 values
+            const total_values: usize = @as(usize, header >> 1) * 8;
+            const bytes_needed = (total_values * bit_width + 7) / 8;
+            if (pos + bytes_needed > data.len) break;
+            const run = data[pos..][0..bytes_needed];
+
+            var bit_pos: usize = 0;
+            for (0..total_values) |_| {
+                if (count >= out.len) break;
+                const byte_idx = bit_pos / 8;
+                var raw: u64 = 0;
+                for (0..@min(run.len - byte_idx, 8)) |bi| {
+                    raw |= @as(u64, run[byte_idx + bi]) << @intCast(bi * 8);
+                }
+                out[count] = @intCast((raw >> @intCast(bit_pos % 8)) & mask);
+                count += 1;
+                bit_pos += bit_width;
+            }
+            pos += bytes_needed;
+        } else {
+            // RLE run: (header >> 1) repeats of one value
+            const run_len: usize = header >> 1;
+            const value_bytes: usize = (bit_width + 7) / 8;
+            if (pos + value_bytes > data.len) break;
+
+            var value: u32 = 0;
+            for (0..value_bytes) |bi| {
+                value |= @as(u32, data[pos + bi]) << @intCast(bi * 8);
+            }
+            pos += value_bytes;
+
+            const n = @min(run_len, out.len - count);
+            @memset(out[count..][0..n], value);
+            count += n;
+        }
+    }
+    return count;
+}
+
+// ============================================================================
+// Input discovery
+// ============================================================================
+
+/// Resolve a file, directory or `dir/pattern` glob into a sorted file list
+fn expandGlob(allocator: Allocator, path_glob: []const u8) !ManagedArrayList([]u8) {
+    var files = ManagedArrayList([]u8).init(allocator);
+    errdefer {
+        for (files.items) |f| allocator.free(f);
+        files.deinit();
+    }
+
+    if (std.mem.indexOfAny(u8, path_glob, "*?") == null) {
+        const stat = try std.fs.cwd().statFile(path_glob);
+        if (stat.kind == .directory) {
+            try appendMatches(allocator, &files, path_glob, "*.parquet");
+        } else {
+            try files.append(try allocator.dupe(u8, path_glob));
+        }
+    } else {
+        const dir_path = std.fs.path.dirname(path_glob) orelse ".";
+        if (std.mem.indexOfAny(u8, dir_path, "*?") != null) return error.UnsupportedGlob;
+        try appendMatches(allocator, &files, dir_path, std.fs.path.basename(path_glob));
+    }
+
+    if (files.items.len == 0) return error.NoParquetFiles;
+
+    std.mem.sort([]u8, files.items, {}, struct {
+        fn lessThan(_: void, a: []u8, b: []u8) bool {
+            return std.mem.order(u8, a, b) == .lt;
+        }
+    }.lessThan);
+
+    return files;
+}
+
+fn appendMatches(allocator: Allocator, files: *ManagedArrayList([]u8), dir_path: []const u8, pattern: []const u8) !void {
+    var dir = try std.fs.cwd().openDir(dir_path, .{ .iterate = true });
+    defer dir.close();
+
+    var iter = dir.iterate();
+    while (try iter.next()) |entry| {
+        if (entry.kind != .file) continue;
+        if (!globMatch(pattern, entry.name)) continue;
+        try files.append(try std.fs.path.join(allocator, &.{ dir_path, entry.name }));
+    }
+}
+
+/// Match `name` against a pattern supporting `*` and `?`
+fn globMatch(pattern: []const u8, name: []const u8) bool {
+    var p: usize = 0;
+    var n: usize = 0;
+    var star_p: ?usize = null;
+    var star_n: usize = 0;
+
+    while (n < name.len) {
+        if (p < pattern.len and (pattern[p] == '?' or pattern[p] == name[n])) {
+            p += 1;
+            n += 1;
+        } else if (p < pattern.len and pattern[p] == '*') {
+            star_p = p;
+            star_n = n;
+            p += 1;
+        } else if (star_p) |sp| {
+            p = sp + 1;
+            star_n += 1;
+            n = star_n;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.len and pattern[p] == '*') p += 1;
+    return p == pattern.len;
+}
+
+// ============================================================================
+// Thrift Compact Protocol decoder
+// ============================================================================
+
+const ThriftReader = struct {
+    data: []const u8,
+    pos: usize,
+    last_field_id: i16,
+
+    fn init(data: []const u8) ThriftReader {
+        return .{ .data = data, .pos = 0, .last_field_id = 0 };
+    }
+
+    fn readByte(self: *ThriftReader) !u8 {
+        if (self.pos >= self.data.len) return error.EndOfBuffer;
+        const b = self.data[self.pos];
+        self.pos += 1;
+        return b;
+    }
+
+    fn readBytes(self: *ThriftReader, n: usize) ![]const u8 {
+        if (self.pos + n > self.data.len) return error.EndOfBuffer;
+        const result = self.data[self.pos .. self.pos + n];
+        self.pos += n;
+        return result;
+    }
+
+    fn readVarint(self: *ThriftReader) !u64 {
+        var result: u64 = 0;
+        var shift: u6 = 0;
+        while (true) {
+            const b = try self.readByte();
+            result |= @as(u64, b & 0x7F) << shift;
+            if (b & 0x80 == 0) break;
+            if (shift >= 63) return error.VarintTooLong;
+            shift +|= 7;
+        }
+        return result;
+    }
+
+    fn readI32(self: *ThriftReader) !i32 {
+        const n: u32 = @truncate(try self.readVarint());
+        return @bitCast((n >> 1) ^ (-%@as(u32, n & 1)));
+    }
+
+    fn readI64(self: *ThriftReader) !i64 {
+        const n: u64 = try self.readVarint();
+        return @bitCast((n >> 1) ^ (-%@as(u64, n & 1)));
+    }
+
+    fn readI16(self: *ThriftReader) !i16 {
+        const n: u16 = @truncate(try self.readVarint());
+        return @bitCast((n >> 1) ^ (-%@as(u16, n & 1)));
+    }
+
+    fn readBinary(self: *ThriftReader) ![]const u8 {
+        const len: usize = @intCast(try self.readVarint());
+        return try self.readBytes(len);
+    }
+
+    fn readListSize(self: *ThriftReader) !usize {
+        const header = try self.readByte();
+        var size: usize = @intCast((header >> 4) & 0x0F);
+        if (size == 0x0F) size = @intCast(try self.readVarint());
+        return size;
+    }
+
+    const FieldHeader = struct {
+        field_id: i16,
+        type_id: u4,
+    };
+
+    fn readFieldHeader(self: *ThriftReader) !?FieldHeader {
+        const byte = try self.readByte();
+        if (byte == 0) return null; // STOP
+
+        const type_id: u4 = @truncate(byte & 0x0F);
+        const delta: i16 = @intCast((byte >> 4) & 0x0F);
+
+        if (delta != 0) {
+            self.last_field_id += delta;
+        } else {
+            self.last_field_id = try self.readI16();
+        }
+
+        return FieldHeader{ .field_id = self.last_field_id, .type_id = type_id };
+    }
+
+    fn pushStruct(self: *ThriftReader) i16 {
+        const saved = self.last_field_id;
+        self.last_field_id = 0;
+        return saved;
+    }
+
+    fn popStruct(self: *ThriftReader, saved: i16) void {
+        self.last_field_id = saved;
+    }
+
+    // Thrift compact type IDs
+    const T_BOOL_TRUE = 1;
+    const T_BOOL_FALSE = 2;
+    const T_BYTE = 3;
+    const T_I16 = 4;
+    const T_I32 = 5;
+    const T_I64 = 6;
+    const T_DOUBLE = 7;
+    const T_BINARY = 8;
+    const T_LIST = 9;
+    const T_SET = 10;
+    const T_MAP = 11;
+    const T_STRUCT = 12;
+
+    fn skipValue(self: *ThriftReader, type_id: u4) !void {
+        switch (type_id) {
+            T_BOOL_TRUE, T_BOOL_FALSE => {},
+            T_BYTE => _ = try self.readBytes(1),
+            T_I16, T_I32, T_I64 => _ = try self.readVarint(),
+            T_DOUBLE => _ = try self.readBytes(8),
+            T_BINARY => _ = try self.readBinary(),
+            T_LIST, T_SET => {
+                const header = try self.readByte();
+                const elem_type: u4 = @truncate(header & 0x0F);
+                var size: usize = @intCast((header >> 4) & 0x0F);
+                if (size == 0x0F) size = @intCast(try self.readVarint());
+                for (0..size) |_| try self.skipValue(elem_type);
+            },
+            T_MAP => {
+                const size: usize = @intCast(try self.readVarint());
+                if (size > 0) {
+                    const types = try self.readByte();
+                    const key_type: u4 = @truncate((types >> 4) & 0x0F);
+                    const val_type: u4 = @truncate(types & 0x0F);
+                    for (0..size) |_| {
+                        try self.skipValue(key_type);
+                        try self.skipValue(val_type);
+                    }
+                }
+            },
+            T_STRUCT => {
+                const saved = self.pushStruct();
+                while (try self.readFieldHeader()) |fh| {
+                    try self.skipValue(fh.type_id);
+                }
+                self.popStruct(saved);
+            },
+            else => return error.UnknownThriftType,
+        }
+    }
+};
+
+// ============================================================================
+// Parquet metadata
+// ============================================================================
+
+const SchemaElement = struct {
+    name: []u8,
+    type_value: ?i32 = null,
+    repetition_type: i32 = REP_REQUIRED,
+    num_children: i32 = 0,
+};
+
+const ColumnChunkMeta = struct {
+    type_value: i32 = 0,
+    codec: i32 = 0,
+    num_values: i64 = 0,
+    total_uncompressed_size: i64 = 0,
+    total_compressed_size: i64 = 0,
+    data_page_offset: i64 = 0,
+    dictionary_page_offset: ?i64 = null,
+};
+
+const RowGroupMeta = struct {
+    columns: []ColumnChunkMeta,
+    total_byte_size: i64 = 0,
+    num_rows: i64 = 0,
+};
+
+const FileMetaData = struct {
+    version: i32 = 0,
+    schema: []SchemaElement,
+    num_rows: i64 = 0,
+    row_groups: []RowGroupMeta,
+
+    fn deinit(self: *FileMetaData, allocator: Allocator) void {
+        for (self.row_groups) |rg| allocator.free(rg.columns);
+        allocator.free(self.row_groups);
+        for (self.schema) |s| allocator.free(s.name);
+        allocator.free(self.schema);
+    }
+};
+
+/// Leaf column selected for ingest
+const ColumnInfo = struct {
+    leaf_idx: usize,
+    /// OPTIONAL columns carry definition levels (max_def_level = 1)
+    optional: bool,
+};
+
+// Parquet enums
+const CODEC_UNCOMPRESSED: i32 = 0;
+const CODEC_SNAPPY: i32 = 1;
+const CODEC_ZSTD: i32 = 6;
+const PAGE_DATA: i32 = 0;
+const PAGE_DICTIONARY: i32 = 2;
+const PAGE_DATA_V2: i32 = 3;
+const ENC_PLAIN: i32 = 0;
+const ENC_PLAIN_DICTIONARY: i32 = 2;
+const ENC_RLE_DICTIONARY: i32 = 8;
+const REP_REQUIRED: i32 = 0;
+const REP_OPTIONAL: i32 = 1;
+const TYPE_BYTE_ARRAY: i32 = 6;
+
+fn readFileMetaData(allocator: Allocator, path: []const u8) !FileMetaData {
+    const file = try std.fs.cwd().openFile(path, .{});
+    defer file.close();
+
+    const file_size: usize = @intCast((try file.stat()).size);
+    if (file_size < 12) return error.FileTooSmall;
+
+    try file.seekTo(file_size - 8);
+    var tail: [8]u8 = undefined;
+    if (try file.readAll(&tail) != tail.len) return error.InvalidFooter;
+
+    if (!std.mem.eql(u8, tail[4..8], "PAR1")) return error.NotParquet;
+    const footer_len: usize = std.mem.readInt(u32, tail[0..4], .little);
+    if (footer_len + 8 > file_size) return error.InvalidFooter;
+
+    try file.seekTo(file_size - 8 - footer_len);
+    const footer_buf = try allocator.alloc(u8, footer_len);
+    defer allocator.free(footer_buf);
+    if (try file.readAll(footer_buf) != footer_len) return error.InvalidFooter;
+
+    return parseFileMetaData(allocator, footer_buf);
+}
+
+fn parseFileMetaData(allocator: Allocator, data: []const u8) !FileMetaData {
+    var reader = ThriftReader.init(data);
+    var meta = FileMetaData{
+        .schema = &.{},
+        .row_groups = &.{},
+    };
+    errdefer meta.deinit(allocator);
+
+    while (try reader.readFieldHeader()) |fh| {
+        switch (fh.field_id) {
+            1 => meta.version = try reader.readI32(),
+            2 => { // schema: list<SchemaElement>
+                const size = try reader.readListSize();
+                const schema = try allocator.alloc(SchemaElement, size);
+                for (schema) |*s| s.* = .{ .name = &.{} };
+                meta.schema = schema;
+                for (schema) |*s| s.* = try parseSchemaElement(allocator, &reader);
+            },
+            3 => meta.num_rows = try reader.readI64(),
+            4 => { // row_groups: list<RowGroup>
+                const size = try reader.readListSize();
+                const row_groups = try allocator.alloc(RowGroupMeta, size);
+                for (row_groups) |*rg| rg.* = .{ .columns = &.{} };
+                meta.row_groups = row_groups;
+                for (row_groups) |*rg| rg.* = try parseRowGroup(allocator, &reader);
+            },
+            else => try reader.skipValue(fh.type_id),
+        }
+    }
+
+    return meta;
+}
+
+fn parseSchemaElement(allocator: Allocator, reader: *ThriftReader) !SchemaElement {
+    var elem = SchemaElement{ .name = &.{} };
+    errdefer allocator.free(elem.name);
+    const saved = reader.pushStruct();
+    defer reader.popStruct(saved);
+
+    while (try reader.readFieldHeader()) |fh| {
+        switch (fh.field_id) {
+            1 => elem.type_value = try reader.readI32(),
+            3 => elem.repetition_type = try reader.readI32(),
+            4 => {
+                allocator.free(elem.name);
+                elem.name = try allocator.dupe(u8, try reader.readBinary());
+            },
+            5 => elem.num_children = try reader.readI32(),
+            else => try reader.skipValue(fh.type_id),
+        }
+    }
+    return elem;
+}
+
+fn parseRowGroup(allocator: Allocator, reader: *ThriftReader) !RowGroupMeta {
+    var rg = RowGroupMeta{ .columns = &.{} };
+    errdefer allocator.free(rg.columns);
+    const saved = reader.pushStruct();
+    defer reader.popStruct(saved);
+
+    while (try reader.readFieldHeader()) |fh| {
+        switch (fh.field_id) {
+            1 => { // columns: list<ColumnChunk>
+                const size = try reader.readListSize();
+                allocator.free(rg.columns);
+                rg.columns = try allocator.alloc(ColumnChunkMeta, size);
+                for (rg.columns) |*col| col.* = try parseColumnChunk(reader);
+            },
+            2 => rg.total_byte_size = try reader.readI64(),
+            3 => rg.num_rows = try reader.readI64(),
+            else => try reader.skipValue(fh.type_id),
+        }
+    }
+    return rg;
+}
+
+fn parseColumnChunk(reader: *ThriftReader) !ColumnChunkMeta {
+    var col = ColumnChunkMeta{};
+    const saved = reader.pushStruct();
+    defer reader.popStruct(saved);
+
+    while (try reader.readFieldHeader()) |fh| {
+        switch (fh.field_id) {
+            3 => col = try parseColumnMetaData(reader), // meta_data: ColumnMetaData
+            else => try reader.skipValue(fh.type_id),
+        }
+    }
+    return col;
+}
+
+fn parseColumnMetaData(reader: *ThriftReader) !ColumnChunkMeta {
+    var col = ColumnChunkMeta{};
+    const saved = reader.pushStruct();
+    defer reader.popStruct(saved);
+
+    while (try reader.readFieldHeader()) |fh| {
+        switch (fh.field_id) {
+            1 => col.type_value = try reader.readI32(),
+            4 => col.codec = try reader.readI32(),
+            5 => col.num_values = try reader.readI64(),
+            6 => col.total_uncompressed_size = try reader.readI64(),
+            7 => col.total_compressed_size = try reader.readI64(),
+            9 => col.data_page_offset = try reader.readI64(),
+            11 => col.dictionary_page_offset = try reader.readI64(),
+            else => try reader.skipValue(fh.type_id),
+        }
+    }
+    return col;
+}
+
+/// Find a top-level BYTE_ARRAY leaf column by name
+fn findColumn(schema: []const SchemaElement, name: []const u8) !ColumnInfo {
+    if (schema.len == 0) return error.ColumnNotFound;
+
+    // schema[0] is the root message; row group columns follow leaf order
+    var leaf_idx: usize = 0;
+    for (schema[1..]) |elem| {
+        if (elem.num_children != 0) continue;
+        if (std.mem.eql(u8, elem.name, name)) {
+            if (elem.type_value != null and elem.type_value.? != TYPE_BYTE_ARRAY) return error.UnsupportedColumn;
+            if (elem.repetition_type != REP_REQUIRED and elem.repetition_type != REP_OPTIONAL) return error.UnsupportedColumn;
+            return .{ .leaf_idx = leaf_idx, .optional = elem.repetition_type == REP_OPTIONAL };
+        }
+        leaf_idx += 1;
+    }
+    return error.ColumnNotFound;
+}
+
+// ============================================================================
+// Page header parsing
+// ============================================================================
+
+const PageHeader = struct {
+    page_type: i32 = 0,
+    uncompressed_size: i32 = 0,
+    compressed_size: i32 = 0,
+    // DataPageHeader fields
+    dp_num_values: i32 = 0,
+    dp_encoding: i32 = 0,
+    // DictionaryPageHeader fields
+    dict_num_values: i32 = 0,
+    // DataPageHeaderV2 fields
+    dpv2_num_values: i32 = 0,
+    dpv2_num_nulls: i32 = 0,
+    dpv2_encoding: i32 = 0,
+    dpv2_def_levels_byte_length: i32 = 0,
+    dpv2_rep_levels_byte_length: i32 = 0,
+    dpv2_is_compressed: bool = true,
+};
+
+fn parsePageHeader(reader: *ThriftReader) !PageHeader {
+    var ph = PageHeader{};
+    const saved = reader.pushStruct();
+    defer reader.popStruct(saved);
+
+    while (try reader.readFieldHeader()) |fh| {
+        switch (fh.field_id) {
+            1 => ph.page_type = try reader.readI32(),
+            2 => ph.uncompressed_size = try reader.readI32(),
+            3 => ph.compressed_size = try reader.readI32(),
+            5 => { // DataPageHeader
+                const s2 = reader.pushStruct();
+                defer reader.popStruct(s2);
+                while (try reader.readFieldHeader()) |fh2| {
+                    switch (fh2.field_id) {
+                        1 => ph.dp_num_values = try reader.readI32(),
+                        2 => ph.dp_encoding = try reader.readI32(),
+                        else => try reader.skipValue(fh2.type_id),
+                    }
+                }
+            },
+            7 => { // DictionaryPageHeader
+                const s2 = reader.pushStruct();
+                defer reader.popStruct(s2);
+                while (try reader.readFieldHeader()) |fh2| {
+                    switch (fh2.field_id) {
+                        1 => ph.dict_num_values = try reader.readI32(),
+                        else => try reader.skipValue(fh2.type_id),
+                    }
+                }
+            },
+            8 => { // DataPageHeaderV2
+                const s2 = reader.pushStruct();
+                defer reader.popStruct(s2);
+                while (try reader.readFieldHeader()) |fh2| {
+                    switch (fh2.field_id) {
+                        1 => ph.dpv2_num_values = try reader.readI32(),
+                        2 => ph.dpv2_num_nulls = try reader.readI32(),
+                        4 => ph.dpv2_encoding = try reader.readI32(),
+                        5 => ph.dpv2_def_levels_byte_length = try reader.readI32(),
+                        6 => ph.dpv2_rep_levels_byte_length = try reader.readI32(),
+                        7 => ph.dpv2_is_compressed = (fh2.type_id == ThriftReader.T_BOOL_TRUE),
+                        else => try reader.skipValue(fh2.type_id),
+                    }
+                }
+            },
+            else => try reader.skipValue(fh.type_id),
+        }
+    }
+
+    if (ph.compressed_size < 0 or ph.uncompressed_size < 0) return error.InvalidPageHeader;
+    return ph;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+test "glob match" {
+    try std.testing.expect(globMatch("*.parquet", "000_00000.parquet"));
+    try std.testing.expect(globMatch("train-?.parquet", "train-1.parquet"));
+    try std.testing.expect(globMatch("*", "anything"));
+    try std.testing.expect(!globMatch("*.parquet", "notes.txt"));
+    try std.testing.expect(!globMatch("train-?.parquet", "train-12.parquet"));
+}
+
+test "rle bit-packed decode" {
+    // RLE run: header=(5 << 1), value=1
+    const rle = [_]u8{ 0x0A, 0x01 };
+    var out: [5]u32 = undefined;
+    try std.testing.expectEqual(@as(usize, 5), decodeRleBitPacked(&rle, 1, &out));
+    for (out) |v| try std.testing.expectEqual(@as(u32, 1), v);
+
+    // Bit-packed run: 1 group of 8 values, width 3: 0..7
+    const packed_run = [_]u8{ 0x03, 0x88, 0xC6, 0xFA };
+    var vals: [8]u32 = undefined;
+    try std.testing.expectEqual(@as(usize, 8), decodeRleBitPacked(&packed_run, 3, &vals));
+    for (vals, 0..) |v, i| try std.testing.expectEqual(@as(u32, @intCast(i)), v);
+}
+
+test "thrift page header" {
+    // page_type=0 (i32, field 1), uncompressed=10 (field 2), compressed=8 (field 3), STOP
+    const data = [_]u8{ 0x15, 0x00, 0x15, 0x14, 0x15, 0x10, 0x00 };
+    var reader = ThriftReader.init(&data);
+    const ph = try parsePageHeader(&reader);
+    try std.testing.expectEqual(PAGE_DATA, ph.page_type);
+    try std.testing.expectEqual(@as(i32, 10), ph.uncompressed_size);
+    try std.testing.expectEqual(@as(i32, 8), ph.compressed_size);
+}
+
+test "ingest missing path" {
+    const Dummy = struct {
+        fn addTokenized(_: *@This(), _: []const byte_tokenizer.Token, _: u32) !u32 {
+            return 0;
+        }
+    };
+    var dummy = Dummy{};
+    try std.testing.expectError(
+        error.FileNotFound,
+        ingest(Dummy, std.testing.allocator, &dummy, "/nonexistent/fts_zig_ingest.parquet", "text", .{}),
+    );
+}
+
+test "ingest parquet fixtures" {
+    // Fixtures come from testdata/gen_fixtures.py: SNAPPY (dictionary + V1
+    // RLE_DICTIONARY page, then a V2 PLAIN row group) and ZSTD (dictionary +
+    // V2 RLE_DICTIONARY page), all with nulls in an OPTIONAL `text` column
+    // that follows a REQUIRED `id` column.
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    try tmp.dir.writeFile(.{ .sub_path = "a_snappy.parquet", .data = @embedFile("testdata/a_snappy.parquet") });
+    try tmp.dir.writeFile(.{ .sub_path = "b_zstd.parquet", .data = @embedFile("testdata/b_zstd.parquet") });
+    try tmp.dir.writeFile(.{ .sub_path = "notes.txt", .data = "not parquet" });
+
+    const dir_path = try tmp.dir.realpathAlloc(std.testing.allocator, ".");
+    defer std.testing.allocator.free(dir_path);
+
+    const Collector = struct {
+        doc_lens: ManagedArrayList(u32),
+
+        fn addTokenized(self: *@This(), _: []const byte_tokenizer.Token, doc_len: u32) !u32 {
+            try self.doc_lens.append(doc_len);
+            return @intCast(self.doc_lens.items.len - 1);
+        }
+    };
+
+    // Nulls become empty documents; order follows file, row group, row
+    const expected = [_]u32{ 2, 0, 3, 2, 2, 0, 2, 4, 4, 0, 1, 5, 1, 2, 0, 1, 3, 0 };
+
+    for ([_]u32{ 1, 3 }) |n_threads| {
+        var collector = Collector{ .doc_lens = ManagedArrayList(u32).init(std.testing.allocator) };
+        defer collector.doc_lens.deinit();
+
+        const stats = try ingest(Collector, std.testing.allocator, &collector, dir_path, "text", .{ .n_threads = n_threads });
+        try std.testing.expectEqual(@as(u32, 2), stats.files);
+        try std.testing.expectEqual(@as(u32, 3), stats.row_groups);
+        try std.testing.expectEqual(@as(u64, expected.len), stats.docs);
+        try std.testing.expectEqual(@as(u64, 145), stats.text_bytes);
+        try std.testing.expectEqualSlices(u32, &expected, collector.doc_lens.items);
+    }
+
+    // The REQUIRED id column decodes too (V1 PLAIN without def levels)
+    var ids = Collector{ .doc_lens = ManagedArrayList(u32).init(std.testing.allocator) };
+    defer ids.doc_lens.deinit();
+    const id_stats = try ingest(Collector, std.testing.allocator, &ids, dir_path, "id", .{});
+    try std.testing.expectEqual(@as(u64, expected.len), id_stats.docs);
+    for (ids.doc_lens.items) |len| try std.testing.expectEqual(@as(u32, 2), len);
+}
@@ -0,0 +1,343 @@
+#!/usr/bin/env python3
+"""Generate the parquet fixtures used by the ingest tests in parquet.zig.
+
+The files are written by hand (thrift compact footer, explicit pages) so
+they exercise exactly the reader paths we care about without depending on
+pyarrow:
+
+  a_snappy.parquet  SNAPPY, row group 0: dictionary page + V1
+                    RLE_DICTIONARY page with nulls; row group 1: V2 PLAIN
+                    page with nulls
+  b_zstd.parquet    ZSTD, one row group: dictionary page + V2
+                    RLE_DICTIONARY page with nulls
+
+Both files have a REQUIRED `id` column ahead of the OPTIONAL `text`
+column, so the reader must pick the right leaf. Requires the `zstd` CLI.
+
+Usage: python3 gen_fixtures.py  (writes next to this script)
+"""
+
+import os
+import struct
+import subprocess
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+CODEC_SNAPPY = 1
+CODEC_ZSTD = 6
+ENC_PLAIN = 0
+ENC_PLAIN_DICTIONARY = 2
+ENC_RLE = 3
+ENC_RLE_DICTIONARY = 8
+PAGE_DATA = 0
+PAGE_DICTIONARY = 2
+PAGE_DATA_V2 = 3
+
+T_TRUE, T_FALSE, T_I32, T_I64, T_BINARY, T_LIST, T_STRUCT = 1, 2, 5, 6, 8, 9, 12
+
+
+# ---------------------------------------------------------------------------
+# Thrift compact protocol writer
+# ---------------------------------------------------------------------------
+
+
+def varint(n):
+    out = bytearray()
+    while True:
+        b = n & 0x7F
+        n >>= 7
+        if n:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def zigzag(n):
+    return (n << 1) ^ (n >> 63)
+
+
+class Struct:
+    """Fields as (id, type, value); value is encoded per type."""
+
+    def __init__(self, *fields):
+        self.fields = fields
+
+    def encode(self):
+        out = bytearray()
+        last = 0
+        for fid, ftype, value in self.fields:
+            if ftype in (T_TRUE, T_FALSE):
+                ftype = T_TRUE if value else T_FALSE
+            delta = fid - last
+            if 0 < delta <= 15:
+                out.append((delta << 4) | ftype)
+            else:
+                out.append(ftype)
+                out += varint(zigzag(fid))
+            last = fid
+            out += encode_value(ftype, value)
+        out.append(0)
+        return bytes(out)
+
+
+def encode_value(ftype, value):
+    if ftype in (T_TRUE, T_FALSE):
+        return b""
+    if ftype in (T_I32, T_I64):
+        return varint(zigzag(value))
+    if ftype == T_BINARY:
+        data = value.encode() if isinstance(value, str) else value
+        return varint(len(data)) + data
+    if ftype == T_STRUCT:
+        return value.encode()
+    if ftype == T_LIST:
+        elem_type, items = value
+        header = bytes([(len(items) << 4) | elem_type]) if len(items) < 15 else bytes([0xF0 | elem_type]) + varint(len(items))
+        return header + b"".join(encode_value(elem_type, v) for v in items)
+    raise ValueError(ftype)
+
+
+# ---------------------------------------------------------------------------
+# Codecs and encodings
+# ---------------------------------------------------------------------------
+
+
+def snappy_compress(data):
+    """Raw snappy block with greedy 2-byte-offset copies (exercises both tags)."""
+    out = bytearray(varint(len(data)))
+    literal_start = 0
+    i = 0
+
+    def flush_literal(end):
+        start = literal_start
+        while start < end:
+            n = min(end - start, 60)
+            out.append((n - 1) << 2)
+            out.extend(data[start : start + n])
+            start += n
+
+    while i < len(data):
+        best_len, best_off = 0, 0
+        for j in range(max(0, i - 0xFFFF), i):
+            n = 0
+            while i + n < len(data) and data[j + n] == data[i + n] and n < 64:
+                n += 1
+            if n > best_len:
+                best_len, best_off = n, i - j
+        if best_len >= 4:
+            flush_literal(i)
+            out.append(((best_len - 1) << 2) | 2)
+            out += struct.pack("<H", best_off)
+            i += best_len
+            literal_start = i
+        else:
+            i += 1
+    flush_literal(len(data))
+    return bytes(out)
+
+
+def zstd_compress(data):
+    # --stream-size records the content size in the frame header, as
+    # parquet writers do
+    cmd = ["zstd", "-q", "-19", "-c", "--stream-size=%d" % len(data)]
+    return subprocess.run(cmd, input=data, stdout=subprocess.PIPE, check=True).stdout
+
+
+def compress(codec, data):
+    return snappy_compress(data) if codec == CODEC_SNAPPY else zstd_compress(data)
+
+
+def plain(values):
+    return b"".join(struct.pack("<I", len(v)) + v.encode() for v in values)
+
+
+def bit_packed(values, bit_width):
+    """One bit-packed run; pads to a multiple of 8 values."""
+    values = list(values) + [0] * (-len(values) % 8)
+    acc, nbits, out = 0, 0, bytearray()
+    for v in values:
+        acc |= v << nbits
+        nbits += bit_width
+        while nbits >= 8:
+            out.append(acc & 0xFF)
+            acc >>= 8
+            nbits -= 8
+    return varint(((len(values) // 8) << 1) | 1) + bytes(out)
+
+
+def def_levels(texts):
+    return bit_packed([0 if t is None else 1 for t in texts], 1)
+
+
+# ---------------------------------------------------------------------------
+# Pages and column chunks
+# ---------------------------------------------------------------------------
+
+
+def page(page_type, uncompressed_size, body, **sub):
+    fields = [(1, T_I32, page_type), (2, T_I32, uncompressed_size), (3, T_I32, len(body))]
+    if "data" in sub:
+        fields.append((5, T_STRUCT, sub["data"]))
+    if "dictionary" in sub:
+        fields.append((7, T_STRUCT, sub["dictionary"]))
+    if "data_v2" in sub:
+        fields.append((8, T_STRUCT, sub["data_v2"]))
+    return Struct(*fields).encode() + body
+
+
+def dictionary_page(codec, values):
+    raw = plain(values)
+    header = Struct((1, T_I32, len(values)), (2, T_I32, ENC_PLAIN_DICTIONARY))
+    return page(PAGE_DICTIONARY, len(raw), compress(codec, raw), dictionary=header)
+
+
+def dictionary_indices(texts, dictionary):
+    indices = [dictionary.index(t) for t in texts if t is not None]
+    width = max(1, (len(dictionary) - 1).bit_length())
+    return bytes([width]) + bit_packed(indices, width)
+
+
+def data_page_v1(codec, texts, encoding, values, optional):
+    levels = def_levels(texts) if optional else b""
+    raw = (struct.pack("<I", len(levels)) + levels if optional else b"") + values
+    header = Struct(
+        (1, T_I32, len(texts)),
+        (2, T_I32, encoding),
+        (3, T_I32, ENC_RLE),
+        (4, T_I32, ENC_RLE),
+    )
+    return page(PAGE_DATA, len(raw), compress(codec, raw), data=header)
+
+
+def data_page_v2(codec, texts, encoding, values, optional):
+    levels = def_levels(texts) if optional else b""
+    body = compress(codec, values)
+    header = Struct(
+        (1, T_I32, len(texts)),
+        (2, T_I32, sum(t is None for t in texts)),
+        (3, T_I32, len(texts)),
+        (4, T_I32, encoding),
+        (5, T_I32, len(levels)),
+        (6, T_I32, 0),
+        (7, T_TRUE, True),
+    )
+    return page(PAGE_DATA_V2, len(levels) + len(values), levels + body, data_v2=header)
+
+
+class Writer:
+    def __init__(self, codec):
+        self.codec = codec
+        self.buf = bytearray(b"PAR1")
+        self.row_groups = []
+
+    def column_chunk(self, name, num_values, pages, has_dictionary, encodings):
+        start = len(self.buf)
+        dict_offset = start if has_dictionary else None
+        data_offset = start + len(pages[0]) if has_dictionary else start
+        for p in pages:
+            self.buf += p
+        size = len(self.buf) - start
+        fields = [
+            (1, T_I32, 6),  # BYTE_ARRAY
+            (2, T_LIST, (T_I32, encodings)),
+            (3, T_LIST, (T_BINARY, [name])),
+            (4, T_I32, self.codec),
+            (5, T_I64, num_values),
+            (6, T_I64, size),
+            (7, T_I64, size),
+            (9, T_I64, data_offset),
+        ]
+        if dict_offset is not None:
+            fields.append((11, T_I64, dict_offset))
+        meta = Struct(*fields)
+        return Struct((2, T_I64, start), (3, T_STRUCT, meta)), size
+
+    def row_group(self, ids, text_pages, text_has_dictionary, text_encodings):
+        id_chunk, id_size = self.column_chunk(
+            "id", len(ids), [data_page_v1(self.codec, ids, ENC_PLAIN, plain(ids), False)], False, [ENC_PLAIN, ENC_RLE]
+        )
+        text_chunk, text_size = self.column_chunk("text", len(ids), text_pages, text_has_dictionary, text_encodings)
+        self.row_groups.append(
+            Struct(
+                (1, T_LIST, (T_STRUCT, [id_chunk, text_chunk])),
+                (2, T_I64, id_size + text_size),
+                (3, T_I64, len(ids)),
+            )
+        )
+
+    def finish(self, path, num_rows):
+        schema = [
+            Struct((4, T_BINARY, "schema"), (5, T_I32, 2)),
+            Struct((1, T_I32, 6), (3, T_I32, 0), (4, T_BINARY, "id")),
+            Struct((1, T_I32, 6), (3, T_I32, 1), (4, T_BINARY, "text"), (6, T_I32, 0)),  # UTF8
+        ]
+        footer = Struct(
+            (1, T_I32, 1),
+            (2, T_LIST, (T_STRUCT, schema)),
+            (3, T_I64, num_rows),
+            (4, T_LIST, (T_STRUCT, self.row_groups)),
+            (6, T_BINARY, "fts_zig gen_fixtures.py"),
+        ).encode()
+        self.buf += footer + struct.pack("<I", len(footer)) + b"PAR1"
+        with open(path, "wb") as f:
+            f.write(self.buf)
+
+
+# ---------------------------------------------------------------------------
+# Fixtures (keep in sync with the "ingest parquet fixtures" test)
+# ---------------------------------------------------------------------------
+
+A_RG0 = ["red fox", None, "red fox jumps", "lazy dog", "red fox", None, "lazy dog", "red fox jumps over"]
+A_RG1 = ["one two three four", None, "xy", "five six seven eight nine"]
+B_RG0 = ["alpha", "alpha beta", None, "alpha", "gamma delta epsilon", None]
+
+
+def ids(prefix, texts):
+    return ["%s-%d" % (prefix, i) for i in range(len(texts))]
+
+
+def dictionary_of(texts):
+    seen = []
+    for t in texts:
+        if t is not None and t not in seen:
+            seen.append(t)
+    return seen
+
+
+def main():
+    a = Writer(CODEC_SNAPPY)
+    d0 = dictionary_of(A_RG0)
+    a.row_group(
+        ids("a0", A_RG0),
+        [
+            dictionary_page(a.codec, d0),
+            data_page_v1(a.codec, A_RG0, ENC_RLE_DICTIONARY, dictionary_indices(A_RG0, d0), True),
+        ],
+        True,
+        [ENC_PLAIN_DICTIONARY, ENC_RLE, ENC_RLE_DICTIONARY],
+    )
+    a.row_group(
+        ids("a1", A_RG1),
+        [data_page_v2(a.codec, A_RG1, ENC_PLAIN, plain([t for t in A_RG1 if t is not None]), True)],
+        False,
+        [ENC_PLAIN, ENC_RLE],
+    )
+    a.finish(os.path.join(HERE, "a_snappy.parquet"), len(A_RG0) + len(A_RG1))
+
+    b = Writer(CODEC_ZSTD)
+    d1 = dictionary_of(B_RG0)
+    b.row_group(
+        ids("b0", B_RG0),
+        [
+            dictionary_page(b.codec, d1),
+            data_page_v2(b.codec, B_RG0, ENC_RLE_DICTIONARY, dictionary_indices(B_RG0, d1), True),
+        ],
+        True,
+        [ENC_PLAIN_DICTIONARY, ENC_RLE, ENC_RLE_DICTIONARY],
+    )
+    b.finish(os.path.join(HERE, "b_zstd.parquet"), len(B_RG0))
+
+
+if __name__ == "__main__":
+    main()
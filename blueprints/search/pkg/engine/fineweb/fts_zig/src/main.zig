@@ -19,6 +19,7 @@ pub const codec = struct {
     pub const vbyte = @import("codec/vbyte.zig");
     pub const eliasfano = @import("codec/eliasfano.zig");
     pub const fst = @import("codec/fst.zig");
+    pub const snappy = @import("codec/snappy.zig");
 };
 
 pub const profile = struct {
@@ -31,6 +32,7 @@ pub const search = struct {
     pub const query = @import("search/query.zig");
     pub const scorer = @import("search/scorer.zig");
     pub const collector = @import("search/collector.zig");
+    pub const filter = @import("search/filter.zig");
 };
 
 pub const index = struct {
@@ -38,6 +40,14 @@ pub const index = struct {
     pub const writer = @import("index/writer.zig");
     pub const merger = @import("index/merger.zig");
     pub const manager = @import("index/manager.zig");
+    pub const ref = @import("index/ref.zig");
+    pub const checkpoint = @import("index/checkpoint.zig");
+    pub const keys = @import("index/keys.zig");
+    pub const docvalues = @import("index/docvalues.zig");
+};
+
+pub const ingest = struct {
+    pub const parquet = @import("ingest/parquet.zig");
 };
 
 pub const util = struct {
@@ -98,16 +108,23 @@ test "main exports" {
     _ = codec.vbyte;
     _ = codec.eliasfano;
     _ = codec.fst;
+    _ = codec.snappy;
     _ = profile.speed;
     _ = profile.balanced;
     _ = profile.compact;
     _ = search.query;
     _ = search.scorer;
     _ = search.collector;
+    _ = search.filter;
     _ = index.segment;
     _ = index.writer;
     _ = index.merger;
     _ = index.manager;
+    _ = index.ref;
+    _ = index.checkpoint;
+    _ = index.keys;
+    _ = index.docvalues;
+    _ = ingest.parquet;
     _ = util.hash;
     _ = util.simd;
     _ = util.arena;
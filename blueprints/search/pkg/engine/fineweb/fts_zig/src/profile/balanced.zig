@@ -19,6 +19,9 @@ const byte_tokenizer = @import("../tokenizer/byte.zig");
 const scorer = @import("../search/scorer.zig");
 const query_mod = @import("../search/query.zig");
 const collector_mod = @import("../search/collector.zig");
+const keys_mod = @import("../index/keys.zig");
+const docvalues_mod = @import("../index/docvalues.zig");
+const filter_mod = @import("../search/filter.zig");
 const simd = @import("../util/simd.zig");
 
 /// Block size for posting lists
@@ -36,6 +39,8 @@ pub const PostingBlock = struct {
     last_doc_id: u32,
     /// Maximum BM25 score in this block (for pruning)
     max_score: f32,
+    /// Maximum static score in this block (0 without static rank)
+    max_static: f32,
     /// Number of docs in this block
     count: u16,
 };
@@ -45,6 +50,30 @@ pub const TermData = struct {
     blocks: []PostingBlock,
     total_docs: u32,
     idf: f32,
+    /// Maximum BM25 score over all blocks
+    max_score: f32,
+};
+
+/// Decode the absolute doc IDs of `block` into `out`
+fn decodeBlock(block: PostingBlock, out: *[BLOCK_SIZE]u32) usize {
+    // decodeMany returns running sums of the deltas (first delta is 0)
+    const decoded = vbyte.decodeMany(block.doc_ids, out);
+    for (out[0..decoded.count]) |*did| did.* += block.first_doc_id;
+    return decoded.count;
+}
+
+/// Static-rank options for `BalancedIndexBuilder.buildWith`
+pub const BuildOptions = struct {
+    /// Int or float doc-values field holding a query-independent score
+    /// (quality, educational score, ...) added to BM25 by `search`;
+    /// `searchWith` keeps ranking by BM25 or the requested sort
+    static_field: ?[]const u8 = null,
+    /// Static score = weight * field value
+    static_weight: f32 = 1.0,
+    /// Renumber docs by descending static score so searches can stop once
+    /// the remaining docs cannot reach the top-K. Doc IDs change;
+    /// `BalancedIndex.originalId` maps them back.
+    order_by_static: bool = false,
 };
 
 /// Document metadata
@@ -63,6 +92,18 @@ pub const BalancedIndex = struct {
     bm25: scorer.BM25Scorer,
     /// Total tokens
     total_tokens: u64,
+    /// External document keys (empty unless keyed documents were added)
+    keys: keys_mod.KeyStore,
+    /// Per-document attributes for filtering and sorting
+    doc_values: docvalues_mod.DocValues,
+    /// Weighted static score per doc (empty unless built with a static field)
+    static_scores: []f32,
+    /// Largest static score
+    max_static: f32,
+    /// Docs are numbered by descending static score
+    static_ordered: bool,
+    /// Doc ID before static-rank renumbering (empty if not renumbered)
+    original_ids: []u32,
 
     const Self = @This();
 
@@ -73,6 +114,12 @@ pub const BalancedIndex = struct {
             .docs = ManagedArrayList(DocMeta).init(allocator),
             .bm25 = scorer.BM25Scorer.init(.{}, 0, 0),
             .total_tokens = 0,
+            .keys = keys_mod.KeyStore.init(allocator),
+            .doc_values = docvalues_mod.DocValues.init(allocator),
+            .static_scores = &.{},
+            .max_static = 0,
+            .static_ordered = false,
+            .original_ids = &.{},
         };
     }
 
@@ -87,6 +134,10 @@ pub const BalancedIndex = struct {
         }
         self.terms.deinit();
         self.docs.deinit();
+        self.keys.deinit();
+        self.doc_values.deinit();
+        self.allocator.free(self.static_scores);
+        self.allocator.free(self.original_ids);
     }
 
     /// Get number of documents
@@ -94,6 +145,11 @@ pub const BalancedIndex = struct {
         return @intCast(self.docs.items.len);
     }
 
+    /// Doc ID as numbered when added (differs after static-rank ordering)
+    pub fn originalId(self: Self, doc_id: u32) u32 {
+        return if (self.original_ids.len > 0) self.original_ids[doc_id] else doc_id;
+    }
+
     /// Search using Block-Max WAND algorithm
     pub fn search(self: *Self, query_text: []const u8, limit: usize) ![]collector_mod.SearchResult {
         var query = try query_mod.parse(self.allocator, query_text);
@@ -103,6 +159,10 @@ pub const BalancedIndex = struct {
             return &[_]collector_mod.SearchResult{};
         }
 
+        if (self.static_scores.len > 0) {
+            return self.searchStaticRanked(query.terms, limit);
+        }
+
         if (query.terms.len == 1) {
             return self.searchSingleTerm(query.terms[0].hash, limit);
         }
@@ -110,6 +170,51 @@ pub const BalancedIndex = struct {
         return self.searchBlockMaxWAND(query.terms, limit);
     }
 
+    /// Search with doc-values filters and/or a field sort (see search/filter.zig)
+    /// Posting blocks whose doc range the filter rules out are not decoded.
+    pub fn searchWith(self: *Self, query_text: []const u8, limit: usize, opts: filter_mod.Options) ![]collector_mod.SearchResult {
+        if (opts.isDefault()) return self.search(query_text, limit);
+
+        var plan = try filter_mod.Plan.compile(&self.doc_values, opts);
+        var query = try query_mod.parse(self.allocator, query_text);
+        defer query.deinit();
+
+        var coll = filter_mod.RankedCollector.init(self.allocator, &plan, limit);
+        defer coll.deinit();
+
+        if (query.terms.len == 1) {
+            if (self.terms.get(query.terms[0].hash)) |term_data| {
+                try self.scanFiltered(term_data, &plan, &coll);
+            }
+        } else if (query.terms.len > 1) {
+            var acc = filter_mod.ScoreAccumulator.init(self.allocator);
+            defer acc.deinit();
+            for (query.terms) |term| {
+                const term_data = self.terms.get(term.hash) orelse continue;
+                try self.scanFiltered(term_data, &plan, &acc);
+            }
+            try acc.drainInto(&coll);
+        }
+        return coll.results();
+    }
+
+    /// Score the postings of `term_data` that pass `plan` into `sink`
+    fn scanFiltered(self: *Self, term_data: TermData, plan: *filter_mod.Plan, sink: anytype) !void {
+        for (term_data.blocks) |block| {
+            if (!plan.rangeMayMatch(block.first_doc_id, block.last_doc_id)) continue;
+
+            var doc_ids: [BLOCK_SIZE]u32 = undefined;
+            const count = decodeBlock(block, &doc_ids);
+
+            for (doc_ids[0..count], 0..) |doc_id, i| {
+                if (!plan.accept(doc_id)) continue;
+
+                const doc_meta = self.docs.items[doc_id];
+                try sink.push(doc_id, self.bm25.score(block.freqs[i], doc_meta.length, term_data.idf));
+            }
+        }
+    }
+
     fn searchSingleTerm(self: *Self, term_hash: u64, limit: usize) ![]collector_mod.SearchResult {
         const term_data = self.terms.get(term_hash) orelse {
             return &[_]collector_mod.SearchResult{};
@@ -126,18 +231,9 @@ pub const BalancedIndex = struct {
 
             // Decode and score block
             var doc_ids: [BLOCK_SIZE]u32 = undefined;
-            const decoded = vbyte.decodeMany(block.doc_ids, &doc_ids);
-
-            // Add base doc ID
-            for (doc_ids[0..decoded.count], 0..) |*did, i| {
-                if (i == 0) {
-                    did.* = block.first_doc_id;
-                } else {
-                    did.* += doc_ids[i - 1];
-                }
-            }
+            const count = decodeBlock(block, &doc_ids);
 
-            for (doc_ids[0..decoded.count], 0..) |doc_id, i| {
+            for (doc_ids[0..count], 0..) |doc_id, i| {
                 const freq = block.freqs[i];
                 const doc_meta = self.docs.items[doc_id];
                 const score = self.bm25.score(freq, doc_meta.length, term_data.idf);
@@ -191,13 +287,9 @@ pub const BalancedIndex = struct {
         for (term_list.items) |tc| {
             for (tc.data.blocks) |block| {
                 var doc_ids: [BLOCK_SIZE]u32 = undefined;
-                const decoded = vbyte.decodeMany(block.doc_ids, &doc_ids);
-
-                var prev: u32 = block.first_doc_id;
-                for (0..decoded.count) |i| {
-                    const doc_id = if (i == 0) block.first_doc_id else prev + doc_ids[i];
-                    prev = doc_id;
+                const count = decodeBlock(block, &doc_ids);
 
+                for (doc_ids[0..count], 0..) |doc_id, i| {
                     const freq = block.freqs[i];
                     const doc_meta = self.docs.items[doc_id];
                     const score = self.bm25.score(freq, doc_meta.length, tc.data.idf);
@@ -226,6 +318,102 @@ pub const BalancedIndex = struct {
         return results[0..result_count];
     }
 
+    /// BM25 + static score, document-at-a-time with early termination.
+    /// Blocks whose BM25 + static upper bound cannot reach the current top-K
+    /// are skipped. With static-rank doc ordering the scan stops as soon as
+    /// static[pivot] + the terms' max BM25 falls below the threshold, since
+    /// every later doc has a lower static score.
+    fn searchStaticRanked(self: *Self, terms: []const query_mod.QueryTerm, limit: usize) ![]collector_mod.SearchResult {
+        var cursors = ManagedArrayList(StaticCursor).init(self.allocator);
+        defer cursors.deinit();
+
+        var max_bm25: f32 = 0;
+        for (terms) |term| {
+            const data = self.terms.get(term.hash) orelse continue;
+            try cursors.append(StaticCursor.init(data));
+            max_bm25 += data.max_score;
+        }
+
+        const plan = filter_mod.Plan{};
+        var coll = filter_mod.RankedCollector.init(self.allocator, &plan, limit);
+        defer coll.deinit();
+
+        while (true) {
+            if (coll.isFull()) {
+                const threshold = coll.threshold();
+                for (cursors.items) |*c| {
+                    while (c.block < c.data.blocks.len) {
+                        const block = c.data.blocks[c.block];
+                        const bound = block.max_score + block.max_static + (max_bm25 - c.data.max_score);
+                        if (bound >= threshold) break;
+                        c.nextBlock();
+                    }
+                }
+            }
+
+            var pivot: u32 = std.math.maxInt(u32);
+            for (cursors.items) |*c| pivot = @min(pivot, c.doc());
+            if (pivot == std.math.maxInt(u32)) break;
+
+            if (coll.isFull()) {
+                const static_bound = if (self.static_ordered) self.static_scores[pivot] else self.max_static;
+                if (static_bound + max_bm25 < coll.threshold()) break;
+            }
+
+            const doc_len = self.docs.items[pivot].length;
+            var score = self.static_scores[pivot];
+            for (cursors.items) |*c| {
+                if (c.doc() != pivot) continue;
+                score += self.bm25.score(c.freq(), doc_len, c.data.idf);
+                c.advance();
+            }
+            try coll.push(pivot, score);
+        }
+
+        return coll.results();
+    }
+
+    /// Position in one term's posting blocks
+    const StaticCursor = struct {
+        data: TermData,
+        block: usize = 0,
+        pos: usize = 0,
+        count: usize = 0,
+        doc_ids: [BLOCK_SIZE]u32 = undefined,
+
+        fn init(data: TermData) StaticCursor {
+            var c = StaticCursor{ .data = data };
+            c.load();
+            return c;
+        }
+
+        fn load(self: *StaticCursor) void {
+            self.pos = 0;
+            self.count = 0;
+            if (self.block < self.data.blocks.len) {
+                self.count = decodeBlock(self.data.blocks[self.block], &self.doc_ids);
+            }
+        }
+
+        inline fn doc(self: *const StaticCursor) u32 {
+            return if (self.pos < self.count) self.doc_ids[self.pos] else std.math.maxInt(u32);
+        }
+
+        inline fn freq(self: *const StaticCursor) u8 {
+            return self.data.blocks[self.block].freqs[self.pos];
+        }
+
+        fn advance(self: *StaticCursor) void {
+            self.pos += 1;
+            if (self.pos >= self.count) self.nextBlock();
+        }
+
+        fn nextBlock(self: *StaticCursor) void {
+            self.block += 1;
+            self.load();
+        }
+    };
+
     const TermWithCursor = struct {
         data: TermData,
         block_idx: usize,
@@ -247,6 +435,10 @@ pub const BalancedIndex = struct {
         }
 
         total += self.docs.items.len * @sizeOf(DocMeta);
+        total += self.static_scores.len * @sizeOf(f32);
+        total += self.original_ids.len * @sizeOf(u32);
+        total += self.keys.memoryUsage();
+        total += self.doc_values.memoryUsage();
         return total;
     }
 };
@@ -260,6 +452,10 @@ pub const BalancedIndexBuilder = struct {
     doc_lengths: ManagedArrayList(u32),
     /// Total tokens
     total_tokens: u64,
+    /// External document keys (empty unless keyed documents were added)
+    keys: keys_mod.KeyStore,
+    /// Per-document attributes for filtering and sorting
+    doc_values: docvalues_mod.DocValues,
 
     const Self = @This();
 
@@ -274,6 +470,8 @@ pub const BalancedIndexBuilder = struct {
             .term_postings = std.AutoHashMap(u64, ManagedArrayList(TempPosting)).init(allocator),
             .doc_lengths = ManagedArrayList(u32).init(allocator),
             .total_tokens = 0,
+            .keys = keys_mod.KeyStore.init(allocator),
+            .doc_values = docvalues_mod.DocValues.init(allocator),
         };
     }
 
@@ -284,22 +482,38 @@ pub const BalancedIndexBuilder = struct {
         }
         self.term_postings.deinit();
         self.doc_lengths.deinit();
+        self.keys.deinit();
+        self.doc_values.deinit();
     }
 
     /// Add a document
     pub fn addDocument(self: *Self, text: []const u8) !u32 {
-        const doc_id: u32 = @intCast(self.doc_lengths.items.len);
-
         var token_buf: [8192]byte_tokenizer.Token = undefined;
         var agg_buf: [4096]byte_tokenizer.Token = undefined;
 
         const tokenizer = byte_tokenizer.ByteTokenizer.init(.{ .lowercase = true });
         const result = byte_tokenizer.tokenizeAndAggregate(&tokenizer, text, &token_buf, &agg_buf);
 
-        try self.doc_lengths.append(result.doc_len);
-        self.total_tokens += result.doc_len;
+        return self.addTokenized(result.tokens, result.doc_len);
+    }
 
-        for (result.tokens) |token| {
+    /// Add a document with an external key (URL, UUID, ...).
+    /// Keys move into the built index: `keys.get(doc_id)` / `keys.find(key)`.
+    pub fn addDocumentKeyed(self: *Self, key: []const u8, text: []const u8) !u32 {
+        const doc_id = try self.addDocument(text);
+        try self.keys.append(doc_id, key);
+        return doc_id;
+    }
+
+    /// Add a document that was already tokenized and aggregated
+    /// (one token per distinct term, `freq` set). Used by streaming ingest.
+    pub fn addTokenized(self: *Self, tokens: []const byte_tokenizer.Token, doc_len: u32) !u32 {
+        const doc_id: u32 = @intCast(self.doc_lengths.items.len);
+
+        try self.doc_lengths.append(doc_len);
+        self.total_tokens += doc_len;
+
+        for (tokens) |token| {
             const entry = try self.term_postings.getOrPut(token.hash);
             if (!entry.found_existing) {
                 entry.value_ptr.* = ManagedArrayList(TempPosting).init(self.allocator);
@@ -313,8 +527,102 @@ pub const BalancedIndexBuilder = struct {
         return doc_id;
     }
 
+    /// Weighted static score of every doc from a numeric doc-values field
+    fn staticScores(self: *Self, field: []const u8, weight: f32) ![]f32 {
+        const col = self.doc_values.columns.getPtr(field) orelse return error.UnknownField;
+        if (col.kind == .string) return error.FieldKindMismatch;
+
+        const scores = try self.allocator.alloc(f32, self.doc_lengths.items.len);
+        for (scores, 0..) |*s, i| {
+            s.* = weight * @as(f32, @floatCast(col.toNumber(col.rawValue(@intCast(i)))));
+        }
+        return scores;
+    }
+
+    /// Renumber docs by descending static score (ties keep insertion order).
+    /// Rewrites postings, lengths, keys and doc values and permutes `scores`.
+    /// Returns new -> original doc IDs.
+    fn renumberByStatic(self: *Self, scores: []f32) ![]u32 {
+        const order = try self.allocator.alloc(u32, scores.len);
+        errdefer self.allocator.free(order);
+        for (order, 0..) |*o, i| o.* = @intCast(i);
+        std.mem.sort(u32, order, scores, struct {
+            fn lessThan(s: []f32, a: u32, b: u32) bool {
+                if (s[a] != s[b]) return s[a] > s[b];
+                return a < b;
+            }
+        }.lessThan);
+
+        const new_ids = try self.allocator.alloc(u32, order.len);
+        defer self.allocator.free(new_ids);
+        for (order, 0..) |old, new| new_ids[old] = @intCast(new);
+
+        const old_scores = try self.allocator.dupe(f32, scores);
+        defer self.allocator.free(old_scores);
+        const old_lengths = try self.allocator.dupe(u32, self.doc_lengths.items);
+        defer self.allocator.free(old_lengths);
+        for (order, 0..) |old, new| {
+            scores[new] = old_scores[old];
+            self.doc_lengths.items[new] = old_lengths[old];
+        }
+
+        var iter = self.term_postings.iterator();
+        while (iter.next()) |entry| {
+            const postings = entry.value_ptr.items;
+            for (postings) |*p| p.doc_id = new_ids[p.doc_id];
+            std.mem.sort(TempPosting, postings, {}, struct {
+                fn lessThan(_: void, a: TempPosting, b: TempPosting) bool {
+                    return a.doc_id < b.doc_id;
+                }
+            }.lessThan);
+        }
+
+        if (!self.keys.isEmpty()) {
+            var keys = keys_mod.KeyStore.init(self.allocator);
+            errdefer keys.deinit();
+            var key = ManagedArrayList(u8).init(self.allocator);
+            defer key.deinit();
+
+            // Superseded docs are left unkeyed: replaying the appends in rank
+            // order would otherwise let the lowest-ranked copy of a key win
+            var dead = try self.keys.supersededSet(self.allocator);
+            defer if (dead) |*d| d.deinit(self.allocator);
+            for (order, 0..) |old, new| {
+                if (dead) |d| {
+                    if (old < d.bit_length and d.isSet(old)) continue;
+                }
+                try self.keys.get(old, &key);
+                if (key.items.len > 0) try keys.append(@intCast(new), key.items);
+            }
+            self.keys.deinit();
+            self.keys = keys;
+        }
+
+        try self.doc_values.permute(order);
+        return order;
+    }
+
     /// Build the index
     pub fn build(self: *Self) !BalancedIndex {
+        return self.buildWith(.{});
+    }
+
+    /// Build the index with a static rank (see BuildOptions).
+    /// With `order_by_static` the builder's docs are renumbered first.
+    /// Docs superseded by a re-added key are dropped from the postings.
+    pub fn buildWith(self: *Self, opts: BuildOptions) !BalancedIndex {
+        try self.keys.dropSuperseded(&self.term_postings);
+
+        var static_scores: []f32 = &.{};
+        errdefer self.allocator.free(static_scores);
+        var original_ids: []u32 = &.{};
+        errdefer self.allocator.free(original_ids);
+
+        if (opts.static_field) |field| {
+            static_scores = try self.staticScores(field, opts.static_weight);
+            if (opts.order_by_static) original_ids = try self.renumberByStatic(static_scores);
+        }
+
         var index = BalancedIndex.init(self.allocator);
 
         // Copy document metadata
@@ -337,6 +645,7 @@ pub const BalancedIndexBuilder = struct {
             const idf = index.bm25.idf(@intCast(postings.len));
 
             // Create blocks
+            var term_max: f32 = 0;
             const num_blocks = (postings.len + BLOCK_SIZE - 1) / BLOCK_SIZE;
             var blocks = try self.allocator.alloc(PostingBlock, num_blocks);
 
@@ -351,6 +660,7 @@ pub const BalancedIndexBuilder = struct {
 
                 var freqs = try self.allocator.alloc(u8, block_postings.len);
                 var max_score: f32 = 0;
+                var max_static: f32 = if (static_scores.len > 0) -std.math.inf(f32) else 0;
 
                 var prev_doc: u32 = 0;
                 for (block_postings, 0..) |p, i| {
@@ -364,7 +674,9 @@ pub const BalancedIndexBuilder = struct {
                     const doc_meta = index.docs.items[p.doc_id];
                     const s = index.bm25.score(p.freq, doc_meta.length, idf);
                     max_score = @max(max_score, s);
+                    if (static_scores.len > 0) max_static = @max(max_static, static_scores[p.doc_id]);
                 }
+                term_max = @max(term_max, max_score);
 
                 blocks[bi] = .{
                     .doc_ids = try self.allocator.dupe(u8, doc_id_encoder.bytes()),
@@ -372,6 +684,7 @@ pub const BalancedIndexBuilder = struct {
                     .first_doc_id = block_postings[0].doc_id,
                     .last_doc_id = block_postings[block_postings.len - 1].doc_id,
                     .max_score = max_score,
+                    .max_static = max_static,
                     .count = @intCast(block_postings.len),
                 };
             }
@@ -380,9 +693,18 @@ pub const BalancedIndexBuilder = struct {
                 .blocks = blocks,
                 .total_docs = @intCast(postings.len),
                 .idf = idf,
+                .max_score = term_max,
             });
         }
 
+        index.static_scores = static_scores;
+        index.max_static = if (static_scores.len > 0) std.mem.max(f32, static_scores) else 0;
+        index.static_ordered = original_ids.len > 0;
+        index.original_ids = original_ids;
+
+        std.mem.swap(keys_mod.KeyStore, &index.keys, &self.keys);
+        try self.doc_values.seal(@intCast(self.doc_lengths.items.len));
+        std.mem.swap(docvalues_mod.DocValues, &index.doc_values, &self.doc_values);
         return index;
     }
 };
@@ -425,3 +747,78 @@ test "balanced index multi term" {
 
     try std.testing.expect(results.len >= 1);
 }
+
+test "balanced index filtered search" {
+    var builder = BalancedIndexBuilder.init(std.testing.allocator);
+    defer builder.deinit();
+
+    for (0..6) |i| {
+        const doc_id = try builder.addDocument("red fox");
+        try builder.doc_values.setString("lang", doc_id, if (i % 2 == 0) "en" else "vi");
+    }
+
+    var index = try builder.build();
+    defer index.deinit();
+
+    const clauses = [_]filter_mod.Clause{.{ .field = "lang", .op = .{ .string_eq = "vi" } }};
+    const results = try index.searchWith("fox", 10, .{ .filter = &clauses });
+    defer index.allocator.free(results);
+
+    // Every doc sits in one block: each must decode to its own ID
+    try std.testing.expectEqual(@as(usize, 3), results.len);
+    for (results) |r| try std.testing.expectEqual(@as(u32, 1), r.doc_id % 2);
+}
+
+test "balanced index static rank" {
+    var builder = BalancedIndexBuilder.init(std.testing.allocator);
+    defer builder.deinit();
+
+    const texts = [_][]const u8{ "brown fox", "brown dog", "quick brown cat", "red fox" };
+    const quality = [_]f64{ 0.1, 0.9, 0.5, 0.3 };
+    for (texts, quality) |text, q| {
+        const doc_id = try builder.addDocument(text);
+        try builder.doc_values.setFloat("quality", doc_id, q);
+    }
+
+    var index = try builder.buildWith(.{ .static_field = "quality", .static_weight = 10.0, .order_by_static = true });
+    defer index.deinit();
+
+    try std.testing.expect(index.static_ordered);
+    // Docs are renumbered by descending quality
+    try std.testing.expectEqual(@as(u32, 1), index.originalId(0));
+    try std.testing.expectEqual(@as(u32, 2), index.originalId(1));
+    try std.testing.expectEqual(@as(u32, 0), index.originalId(3));
+    try std.testing.expectApproxEqAbs(@as(f64, 0.9), index.doc_values.get("quality").?.number(0), 1e-9);
+
+    const results = try index.search("brown", 2);
+    defer index.allocator.free(results);
+
+    try std.testing.expectEqual(@as(usize, 2), results.len);
+    try std.testing.expectEqual(@as(u32, 1), index.originalId(results[0].doc_id));
+    try std.testing.expectEqual(@as(u32, 2), index.originalId(results[1].doc_id));
+}
+
+test "balanced index static rank keeps latest key" {
+    var builder = BalancedIndexBuilder.init(std.testing.allocator);
+    defer builder.deinit();
+
+    // "a" is re-added (an update) with a lower quality than its first copy
+    const keys = [_][]const u8{ "a", "b", "a" };
+    const quality = [_]f64{ 0.9, 0.5, 0.1 };
+    for (keys, quality) |key, q| {
+        const doc_id = try builder.addDocumentKeyed(key, "brown fox");
+        try builder.doc_values.setFloat("quality", doc_id, q);
+    }
+
+    var index = try builder.buildWith(.{ .static_field = "quality", .static_weight = 1.0, .order_by_static = true });
+    defer index.deinit();
+
+    try std.testing.expectEqual(@as(u32, 2), index.originalId(index.keys.find("a").?));
+    try std.testing.expectEqual(@as(u32, 1), index.originalId(index.keys.find("b").?));
+
+    // The first copy of "a" is no longer searchable
+    const results = try index.search("brown fox", 10);
+    defer index.allocator.free(results);
+    try std.testing.expectEqual(@as(usize, 2), results.len);
+    for (results) |r| try std.testing.expect(index.originalId(r.doc_id) != 0);
+}
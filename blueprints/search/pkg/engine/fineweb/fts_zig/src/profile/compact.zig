@@ -17,6 +17,9 @@ const byte_tokenizer = @import("../tokenizer/byte.zig");
 const scorer = @import("../search/scorer.zig");
 const query_mod = @import("../search/query.zig");
 const collector_mod = @import("../search/collector.zig");
+const keys_mod = @import("../index/keys.zig");
+const docvalues_mod = @import("../index/docvalues.zig");
+const filter_mod = @import("../search/filter.zig");
 
 /// Term data with Elias-Fano encoded postings
 pub const TermData = struct {
@@ -46,6 +49,10 @@ pub const CompactIndex = struct {
     bm25: scorer.BM25Scorer,
     /// Total tokens
     total_tokens: u64,
+    /// External document keys (empty unless keyed documents were added)
+    keys: keys_mod.KeyStore,
+    /// Per-document attributes for filtering and sorting
+    doc_values: docvalues_mod.DocValues,
 
     const Self = @This();
 
@@ -56,6 +63,8 @@ pub const CompactIndex = struct {
             .docs = ManagedArrayList(DocMeta).init(allocator),
             .bm25 = scorer.BM25Scorer.init(.{}, 0, 0),
             .total_tokens = 0,
+            .keys = keys_mod.KeyStore.init(allocator),
+            .doc_values = docvalues_mod.DocValues.init(allocator),
         };
     }
 
@@ -68,6 +77,8 @@ pub const CompactIndex = struct {
         }
         self.terms.deinit();
         self.docs.deinit();
+        self.keys.deinit();
+        self.doc_values.deinit();
     }
 
     /// Get number of documents
@@ -91,6 +102,44 @@ pub const CompactIndex = struct {
         return self.searchMultiTerm(query.terms, limit);
     }
 
+    /// Search with doc-values filters and/or a field sort (see search/filter.zig)
+    pub fn searchWith(self: *Self, query_text: []const u8, limit: usize, opts: filter_mod.Options) ![]collector_mod.SearchResult {
+        if (opts.isDefault()) return self.search(query_text, limit);
+
+        var plan = try filter_mod.Plan.compile(&self.doc_values, opts);
+        var query = try query_mod.parse(self.allocator, query_text);
+        defer query.deinit();
+
+        var coll = filter_mod.RankedCollector.init(self.allocator, &plan, limit);
+        defer coll.deinit();
+
+        if (query.terms.len == 1) {
+            if (self.terms.get(query.terms[0].hash)) |term_data| {
+                try self.scanFiltered(term_data, &plan, &coll);
+            }
+        } else if (query.terms.len > 1) {
+            var acc = filter_mod.ScoreAccumulator.init(self.allocator);
+            defer acc.deinit();
+            for (query.terms) |term| {
+                const term_data = self.terms.get(term.hash) orelse continue;
+                try self.scanFiltered(term_data, &plan, &acc);
+            }
+            try acc.drainInto(&coll);
+        }
+        return coll.results();
+    }
+
+    /// Score the postings of `term_data` that pass `plan` into `sink`
+    fn scanFiltered(self: *Self, term_data: TermData, plan: *filter_mod.Plan, sink: anytype) !void {
+        var ef_iter = term_data.doc_ids.iterator();
+        var idx: usize = 0;
+        while (ef_iter.next()) |doc_id| : (idx += 1) {
+            if (!plan.accept(doc_id)) continue;
+            const doc_meta = self.docs.items[doc_id];
+            try sink.push(doc_id, self.bm25.score(term_data.freqs[idx], doc_meta.length, term_data.idf));
+        }
+    }
+
     fn searchSingleTerm(self: *Self, term_hash: u64, limit: usize) ![]collector_mod.SearchResult {
         const term_data = self.terms.get(term_hash) orelse {
             return &[_]collector_mod.SearchResult{};
@@ -168,6 +217,8 @@ pub const CompactIndex = struct {
         }
 
         total += self.docs.items.len * @sizeOf(DocMeta);
+        total += self.keys.memoryUsage();
+        total += self.doc_values.memoryUsage();
         return total;
     }
 
@@ -205,6 +256,10 @@ pub const CompactIndexBuilder = struct {
     term_postings: std.AutoHashMap(u64, ManagedArrayList(TempPosting)),
     doc_lengths: ManagedArrayList(u32),
     total_tokens: u64,
+    /// External document keys (empty unless keyed documents were added)
+    keys: keys_mod.KeyStore,
+    /// Per-document attributes for filtering and sorting
+    doc_values: docvalues_mod.DocValues,
 
     const Self = @This();
 
@@ -219,6 +274,8 @@ pub const CompactIndexBuilder = struct {
             .term_postings = std.AutoHashMap(u64, ManagedArrayList(TempPosting)).init(allocator),
             .doc_lengths = ManagedArrayList(u32).init(allocator),
             .total_tokens = 0,
+            .keys = keys_mod.KeyStore.init(allocator),
+            .doc_values = docvalues_mod.DocValues.init(allocator),
         };
     }
 
@@ -229,22 +286,38 @@ pub const CompactIndexBuilder = struct {
         }
         self.term_postings.deinit();
         self.doc_lengths.deinit();
+        self.keys.deinit();
+        self.doc_values.deinit();
     }
 
     /// Add a document
     pub fn addDocument(self: *Self, text: []const u8) !u32 {
-        const doc_id: u32 = @intCast(self.doc_lengths.items.len);
-
         var token_buf: [8192]byte_tokenizer.Token = undefined;
         var agg_buf: [4096]byte_tokenizer.Token = undefined;
 
         const tokenizer = byte_tokenizer.ByteTokenizer.init(.{ .lowercase = true });
         const result = byte_tokenizer.tokenizeAndAggregate(&tokenizer, text, &token_buf, &agg_buf);
 
-        try self.doc_lengths.append(result.doc_len);
-        self.total_tokens += result.doc_len;
+        return self.addTokenized(result.tokens, result.doc_len);
+    }
 
-        for (result.tokens) |token| {
+    /// Add a document with an external key (URL, UUID, ...).
+    /// Keys move into the built index: `keys.get(doc_id)` / `keys.find(key)`.
+    pub fn addDocumentKeyed(self: *Self, key: []const u8, text: []const u8) !u32 {
+        const doc_id = try self.addDocument(text);
+        try self.keys.append(doc_id, key);
+        return doc_id;
+    }
+
+    /// Add a document that was already tokenized and aggregated
+    /// (one token per distinct term, `freq` set). Used by streaming ingest.
+    pub fn addTokenized(self: *Self, tokens: []const byte_tokenizer.Token, doc_len: u32) !u32 {
+        const doc_id: u32 = @intCast(self.doc_lengths.items.len);
+
+        try self.doc_lengths.append(doc_len);
+        self.total_tokens += doc_len;
+
+        for (tokens) |token| {
             const entry = try self.term_postings.getOrPut(token.hash);
             if (!entry.found_existing) {
                 entry.value_ptr.* = ManagedArrayList(TempPosting).init(self.allocator);
@@ -259,7 +332,10 @@ pub const CompactIndexBuilder = struct {
     }
 
     /// Build the index
+    /// Docs superseded by a re-added key are dropped from the postings.
     pub fn build(self: *Self) !CompactIndex {
+        try self.keys.dropSuperseded(&self.term_postings);
+
         var index = CompactIndex.init(self.allocator);
 
         // Copy document metadata
@@ -304,6 +380,9 @@ pub const CompactIndexBuilder = struct {
             });
         }
 
+        std.mem.swap(keys_mod.KeyStore, &index.keys, &self.keys);
+        try self.doc_values.seal(@intCast(self.doc_lengths.items.len));
+        std.mem.swap(docvalues_mod.DocValues, &index.doc_values, &self.doc_values);
         return index;
     }
 };
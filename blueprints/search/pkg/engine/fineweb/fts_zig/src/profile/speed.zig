@@ -20,6 +20,9 @@ const byte_tokenizer = @import("../tokenizer/byte.zig");
 const scorer = @import("../search/scorer.zig");
 const query_mod = @import("../search/query.zig");
 const collector_mod = @import("../search/collector.zig");
+const keys_mod = @import("../index/keys.zig");
+const docvalues_mod = @import("../index/docvalues.zig");
+const filter_mod = @import("../search/filter.zig");
 
 /// Posting list entry (uncompressed for speed)
 pub const Posting = struct {
@@ -52,6 +55,10 @@ pub const SpeedIndex = struct {
     bm25: scorer.BM25Scorer,
     /// Total tokens across all docs
     total_tokens: u64,
+    /// External document keys (empty unless keyed documents were added)
+    keys: keys_mod.KeyStore,
+    /// Per-document attributes for filtering and sorting
+    doc_values: docvalues_mod.DocValues,
     /// Index is finalized (no more additions)
     finalized: bool,
 
@@ -64,6 +71,8 @@ pub const SpeedIndex = struct {
             .docs = ManagedArrayList(DocMeta).init(allocator),
             .bm25 = scorer.BM25Scorer.init(.{}, 0, 0),
             .total_tokens = 0,
+            .keys = keys_mod.KeyStore.init(allocator),
+            .doc_values = docvalues_mod.DocValues.init(allocator),
             .finalized = false,
         };
     }
@@ -75,6 +84,8 @@ pub const SpeedIndex = struct {
         }
         self.terms.deinit();
         self.docs.deinit();
+        self.keys.deinit();
+        self.doc_values.deinit();
     }
 
     /// Get number of documents
@@ -103,6 +114,8 @@ pub const SpeedIndex = struct {
         // Doc metadata
         total += self.docs.items.len * @sizeOf(DocMeta);
 
+        total += self.keys.memoryUsage();
+        total += self.doc_values.memoryUsage();
         return total;
     }
 
@@ -124,6 +137,62 @@ pub const SpeedIndex = struct {
         return self.searchMultiTerm(query.terms, limit);
     }
 
+    /// Search with doc-values filters and/or a field sort (see search/filter.zig)
+    /// Rejected doc-values blocks are skipped with a binary search.
+    pub fn searchWith(self: *Self, query_text: []const u8, limit: usize, opts: filter_mod.Options) ![]collector_mod.SearchResult {
+        if (opts.isDefault()) return self.search(query_text, limit);
+
+        var plan = try filter_mod.Plan.compile(&self.doc_values, opts);
+        var query = try query_mod.parse(self.allocator, query_text);
+        defer query.deinit();
+
+        var coll = filter_mod.RankedCollector.init(self.allocator, &plan, limit);
+        defer coll.deinit();
+
+        if (query.terms.len == 1) {
+            if (self.terms.get(query.terms[0].hash)) |term_data| {
+                try self.scanFiltered(term_data, &plan, &coll);
+            }
+        } else if (query.terms.len > 1) {
+            var acc = filter_mod.ScoreAccumulator.init(self.allocator);
+            defer acc.deinit();
+            for (query.terms) |term| {
+                const term_data = self.terms.get(term.hash) orelse continue;
+                try self.scanFiltered(term_data, &plan, &acc);
+            }
+            try acc.drainInto(&coll);
+        }
+        return coll.results();
+    }
+
+    /// Score the postings of `term_data` that pass `plan` into `sink`
+    fn scanFiltered(self: *Self, term_data: TermData, plan: *filter_mod.Plan, sink: anytype) !void {
+        const postings = term_data.postings;
+        var i: usize = 0;
+        while (i < postings.len) {
+            const posting = postings[i];
+            if (!plan.accept(posting.doc_id)) {
+                const next = plan.skipTarget(posting.doc_id) orelse break;
+                i = if (next == posting.doc_id + 1) i + 1 else lowerBound(postings, i + 1, next);
+                continue;
+            }
+            const doc_meta = self.docs.items[posting.doc_id];
+            try sink.push(posting.doc_id, self.bm25.score(posting.freq, doc_meta.length, term_data.idf));
+            i += 1;
+        }
+    }
+
+    /// First index >= `from` whose doc ID is >= `doc_id`
+    fn lowerBound(postings: []const Posting, from: usize, doc_id: u32) usize {
+        var lo = from;
+        var hi = postings.len;
+        while (lo < hi) {
+            const mid = lo + (hi - lo) / 2;
+            if (postings[mid].doc_id < doc_id) lo = mid + 1 else hi = mid;
+        }
+        return lo;
+    }
+
     fn searchSingleTerm(self: *Self, term_hash: u64, limit: usize) ![]collector_mod.SearchResult {
         const term_data = self.terms.get(term_hash) orelse {
             return &[_]collector_mod.SearchResult{};
@@ -195,6 +264,10 @@ pub const SpeedIndexBuilder = struct {
     doc_lengths: ManagedArrayList(u32),
     /// Total tokens
     total_tokens: u64,
+    /// External document keys (empty unless keyed documents were added)
+    keys: keys_mod.KeyStore,
+    /// Per-document attributes for filtering and sorting
+    doc_values: docvalues_mod.DocValues,
 
     const Self = @This();
 
@@ -204,6 +277,8 @@ pub const SpeedIndexBuilder = struct {
             .term_postings = std.AutoHashMap(u64, ManagedArrayList(Posting)).init(allocator),
             .doc_lengths = ManagedArrayList(u32).init(allocator),
             .total_tokens = 0,
+            .keys = keys_mod.KeyStore.init(allocator),
+            .doc_values = docvalues_mod.DocValues.init(allocator),
         };
     }
 
@@ -214,12 +289,12 @@ pub const SpeedIndexBuilder = struct {
         }
         self.term_postings.deinit();
         self.doc_lengths.deinit();
+        self.keys.deinit();
+        self.doc_values.deinit();
     }
 
     /// Add a document to the index
     pub fn addDocument(self: *Self, text: []const u8) !u32 {
-        const doc_id: u32 = @intCast(self.doc_lengths.items.len);
-
         // Tokenize
         var token_buf: [8192]byte_tokenizer.Token = undefined;
         var agg_buf: [4096]byte_tokenizer.Token = undefined;
@@ -227,12 +302,28 @@ pub const SpeedIndexBuilder = struct {
         const tokenizer = byte_tokenizer.ByteTokenizer.init(.{ .lowercase = true });
         const result = byte_tokenizer.tokenizeAndAggregate(&tokenizer, text, &token_buf, &agg_buf);
 
+        return self.addTokenized(result.tokens, result.doc_len);
+    }
+
+    /// Add a document with an external key (URL, UUID, ...).
+    /// Keys move into the built index: `keys.get(doc_id)` / `keys.find(key)`.
+    pub fn addDocumentKeyed(self: *Self, key: []const u8, text: []const u8) !u32 {
+        const doc_id = try self.addDocument(text);
+        try self.keys.append(doc_id, key);
+        return doc_id;
+    }
+
+    /// Add a document that was already tokenized and aggregated
+    /// (one token per distinct term, `freq` set). Used by streaming ingest.
+    pub fn addTokenized(self: *Self, tokens: []const byte_tokenizer.Token, doc_len: u32) !u32 {
+        const doc_id: u32 = @intCast(self.doc_lengths.items.len);
+
         // Store document length
-        try self.doc_lengths.append(result.doc_len);
-        self.total_tokens += result.doc_len;
+        try self.doc_lengths.append(doc_len);
+        self.total_tokens += doc_len;
 
         // Add to posting lists
-        for (result.tokens) |token| {
+        for (tokens) |token| {
             const entry = try self.term_postings.getOrPut(token.hash);
             if (!entry.found_existing) {
                 entry.value_ptr.* = ManagedArrayList(Posting).init(self.allocator);
@@ -247,7 +338,10 @@ pub const SpeedIndexBuilder = struct {
     }
 
     /// Build the final index
+    /// Docs superseded by a re-added key are dropped from the postings.
     pub fn build(self: *Self) !SpeedIndex {
+        try self.keys.dropSuperseded(&self.term_postings);
+
         var index = SpeedIndex.init(self.allocator);
 
         // Copy document metadata
@@ -277,6 +371,9 @@ pub const SpeedIndexBuilder = struct {
         }
 
         index.finalized = true;
+        std.mem.swap(keys_mod.KeyStore, &index.keys, &self.keys);
+        try self.doc_values.seal(@intCast(self.doc_lengths.items.len));
+        std.mem.swap(docvalues_mod.DocValues, &index.doc_values, &self.doc_values);
         return index;
     }
 };
@@ -337,3 +434,56 @@ test "speed index empty query" {
 
     try std.testing.expectEqual(@as(usize, 0), results.len);
 }
+
+test "speed index filter and field sort" {
+    var builder = SpeedIndexBuilder.init(std.testing.allocator);
+    defer builder.deinit();
+
+    const docs = [_]struct { text: []const u8, lang: []const u8, date: i64 }{
+        .{ .text = "hello world", .lang = "en", .date = 2023 },
+        .{ .text = "xin chao hello", .lang = "vi", .date = 2024 },
+        .{ .text = "hello hello vietnam", .lang = "vi", .date = 2021 },
+    };
+    for (docs) |d| {
+        const doc_id = try builder.addDocument(d.text);
+        try builder.doc_values.setString("lang", doc_id, d.lang);
+        try builder.doc_values.setInt("year", doc_id, d.date);
+    }
+
+    var index = try builder.build();
+    defer index.deinit();
+
+    const filter = [_]filter_mod.Clause{.{ .field = "lang", .op = .{ .string_eq = "vi" } }};
+    const results = try index.searchWith("hello", 10, .{
+        .filter = &filter,
+        .sort = .{ .field = .{ .name = "year" } },
+    });
+    defer index.allocator.free(results);
+
+    try std.testing.expectEqual(@as(usize, 2), results.len);
+    try std.testing.expectEqual(@as(u32, 1), results[0].doc_id);
+    try std.testing.expectEqual(@as(u32, 2), results[1].doc_id);
+}
+
+test "speed index drops superseded keys" {
+    var builder = SpeedIndexBuilder.init(std.testing.allocator);
+    defer builder.deinit();
+
+    _ = try builder.addDocumentKeyed("a", "hello stale");
+    _ = try builder.addDocumentKeyed("b", "hello world");
+    _ = try builder.addDocumentKeyed("a", "hello fresh");
+
+    var index = try builder.build();
+    defer index.deinit();
+
+    const results = try index.search("hello", 10);
+    defer index.allocator.free(results);
+    try std.testing.expectEqual(@as(usize, 2), results.len);
+    for (results) |r| try std.testing.expect(r.doc_id != 0);
+
+    // A term only the superseded doc had is gone
+    const stale = try index.search("stale", 10);
+    defer index.allocator.free(stale);
+    try std.testing.expectEqual(@as(usize, 0), stale.len);
+    try std.testing.expectEqual(@as(?u32, 2), index.keys.find("a"));
+}
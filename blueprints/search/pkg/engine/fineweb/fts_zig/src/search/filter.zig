@@ -0,0 +1,373 @@
+//! Doc-values filters and field sorting pushed into posting traversal
+//!   - A filter is a conjunction of clauses (numeric range, string equality)
+//!   - Clauses are checked per doc-values block first: blocks whose min/max
+//!     rule a clause out are skipped, blocks entirely inside every clause
+//!     accept docs without decoding values
+//!   - RankedCollector keeps the top-K by BM25, by a field, or by BM25 plus
+//!     a weighted static field
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+const docvalues = @import("../index/docvalues.zig");
+const collector_mod = @import("collector.zig");
+
+const BLOCK_DOCS = docvalues.BLOCK_DOCS;
+
+/// Most clauses in one filter
+pub const MAX_CLAUSES = 8;
+
+/// One filter clause on a doc-values field
+pub const Clause = struct {
+    field: []const u8,
+    op: Op,
+
+    pub const Op = union(enum) {
+        /// Inclusive range on an int field
+        int_range: struct { min: i64, max: i64 },
+        /// Inclusive range on a float field
+        float_range: struct { min: f64, max: f64 },
+        /// Equality on a string field
+        string_eq: []const u8,
+    };
+};
+
+/// Result ordering
+pub const Sort = union(enum) {
+    /// BM25 score, descending
+    score,
+    /// Field value, BM25 breaks ties
+    field: struct { name: []const u8, descending: bool = true },
+    /// BM25 + weight * field value (static rank blending)
+    blend: struct { name: []const u8, weight: f32 },
+};
+
+/// Search options understood by every profile's `searchWith`
+pub const Options = struct {
+    filter: []const Clause = &.{},
+    sort: Sort = .score,
+
+    pub fn isDefault(self: Options) bool {
+        return self.filter.len == 0 and self.sort == .score;
+    }
+};
+
+pub const Error = error{
+    TooManyClauses,
+    UnknownField,
+    /// Clause or sort does not match the field kind
+    FieldKindMismatch,
+};
+
+const BlockState = enum { none, some, all };
+
+const Pred = struct {
+    col: *const docvalues.Column,
+    lo: u64,
+    hi: u64,
+};
+
+/// A filter and sort compiled against one index's doc values
+pub const Plan = struct {
+    preds: [MAX_CLAUSES]Pred = undefined,
+    n_preds: usize = 0,
+    /// Some clause can never match (e.g. unseen string value)
+    empty: bool = false,
+    sort: Sort = .score,
+    sort_col: ?*const docvalues.Column = null,
+    /// Doc-values block of the last `accept`, and its state
+    cached_block: u32 = std.math.maxInt(u32),
+    cached_state: BlockState = .all,
+
+    const Self = @This();
+
+    pub fn compile(dv: *const docvalues.DocValues, opts: Options) Error!Self {
+        if (opts.filter.len > MAX_CLAUSES) return error.TooManyClauses;
+
+        var plan = Self{ .sort = opts.sort };
+        for (opts.filter) |clause| {
+            const col = dv.get(clause.field) orelse return error.UnknownField;
+            var pred = Pred{ .col = col, .lo = 0, .hi = 0 };
+            switch (clause.op) {
+                .int_range => |r| {
+                    if (col.kind != .int) return error.FieldKindMismatch;
+                    pred.lo = docvalues.encodeInt(r.min);
+                    pred.hi = docvalues.encodeInt(r.max);
+                },
+                .float_range => |r| {
+                    if (col.kind != .float) return error.FieldKindMismatch;
+                    pred.lo = docvalues.encodeFloat(r.min);
+                    pred.hi = docvalues.encodeFloat(r.max);
+                },
+                .string_eq => |value| {
+                    if (col.kind != .string) return error.FieldKindMismatch;
+                    const ord = col.ordinal(value) orelse 0;
+                    if (ord == 0) plan.empty = true;
+                    pred.lo = ord;
+                    pred.hi = ord;
+                },
+            }
+            if (pred.lo > pred.hi) plan.empty = true;
+            plan.preds[plan.n_preds] = pred;
+            plan.n_preds += 1;
+        }
+
+        switch (opts.sort) {
+            .score => {},
+            inline .field, .blend => |s| {
+                plan.sort_col = dv.get(s.name) orelse return error.UnknownField;
+            },
+        }
+        return plan;
+    }
+
+    /// True if the filter has no clauses
+    pub inline fn acceptsAll(self: Self) bool {
+        return self.n_preds == 0;
+    }
+
+    fn blockState(self: Self, block: u32) BlockState {
+        var state = BlockState.all;
+        for (self.preds[0..self.n_preds]) |p| {
+            const meta = p.col.blocks[block];
+            if (meta.max < p.lo or meta.min > p.hi) return .none;
+            if (meta.min < p.lo or meta.max > p.hi) state = .some;
+        }
+        return state;
+    }
+
+    /// Whether `doc_id` passes the filter
+    pub inline fn accept(self: *Self, doc_id: u32) bool {
+        if (self.n_preds == 0) return true;
+        if (self.empty) return false;
+
+        const block = doc_id / BLOCK_DOCS;
+        if (block != self.cached_block) {
+            self.cached_block = block;
+            self.cached_state = self.blockState(block);
+        }
+        return switch (self.cached_state) {
+            .none => false,
+            .all => true,
+            .some => self.matchValues(doc_id),
+        };
+    }
+
+    fn matchValues(self: Self, doc_id: u32) bool {
+        for (self.preds[0..self.n_preds]) |p| {
+            const v = p.col.get(doc_id);
+            if (v < p.lo or v > p.hi) return false;
+        }
+        return true;
+    }
+
+    /// Smallest doc ID >= `doc_id` in a block that may pass the filter,
+    /// or null if none. Lets array posting lists jump over rejected blocks.
+    pub fn nextCandidate(self: *Self, doc_id: u32) ?u32 {
+        if (self.n_preds == 0) return doc_id;
+        if (self.empty) return null;
+
+        const block_count = self.preds[0].col.blockCount();
+        var block = doc_id / BLOCK_DOCS;
+        while (block < block_count) : (block += 1) {
+            if (self.blockState(block) != .none) {
+                return if (block == doc_id / BLOCK_DOCS) doc_id else block * BLOCK_DOCS;
+            }
+        }
+        return null;
+    }
+
+    /// Doc ID to continue from after `accept(doc_id)` returned false:
+    /// past the whole block if the block was ruled out, else the next doc
+    pub fn skipTarget(self: *Self, doc_id: u32) ?u32 {
+        if (self.empty) return null;
+        if (self.cached_state != .none) return doc_id + 1;
+        return self.nextCandidate((doc_id / BLOCK_DOCS + 1) * BLOCK_DOCS);
+    }
+
+    /// Whether any doc in [first, last] may pass (for compressed posting
+    /// blocks with known doc ranges). Long ranges are assumed to match.
+    pub fn rangeMayMatch(self: *Self, first: u32, last: u32) bool {
+        if (self.n_preds == 0) return true;
+        if (self.empty) return false;
+
+        const first_block = first / BLOCK_DOCS;
+        const last_block = last / BLOCK_DOCS;
+        if (last_block - first_block >= 64) return true;
+
+        var block = first_block;
+        while (block <= last_block) : (block += 1) {
+            if (self.blockState(block) != .none) return true;
+        }
+        return false;
+    }
+};
+
+/// Sums per-term scores of multi-term queries before ranking
+pub const ScoreAccumulator = struct {
+    scores: std.AutoHashMap(u32, f32),
+
+    const Self = @This();
+
+    pub fn init(allocator: Allocator) Self {
+        return .{ .scores = std.AutoHashMap(u32, f32).init(allocator) };
+    }
+
+    pub fn deinit(self: *Self) void {
+        self.scores.deinit();
+    }
+
+    pub fn push(self: *Self, doc_id: u32, score: f32) !void {
+        const entry = try self.scores.getOrPut(doc_id);
+        if (entry.found_existing) {
+            entry.value_ptr.* += score;
+        } else {
+            entry.value_ptr.* = score;
+        }
+    }
+
+    /// Feed the summed scores to `coll`
+    pub fn drainInto(self: *Self, coll: *RankedCollector) !void {
+        var iter = self.scores.iterator();
+        while (iter.next()) |entry| try coll.push(entry.key_ptr.*, entry.value_ptr.*);
+    }
+};
+
+/// Top-K collector for any `Sort`. Holds at most `limit` entries.
+pub const RankedCollector = struct {
+    allocator: Allocator,
+    plan: *const Plan,
+    heap: std.PriorityQueue(Entry, void, Entry.lessThan),
+    limit: usize,
+
+    const Self = @This();
+
+    const Entry = struct {
+        doc_id: u32,
+        score: f32,
+        /// Primary sort key, larger is better
+        key: f64,
+
+        fn lessThan(_: void, a: Entry, b: Entry) std.math.Order {
+            if (a.key != b.key) return std.math.order(a.key, b.key);
+            if (a.score != b.score) return std.math.order(a.score, b.score);
+            return std.math.order(b.doc_id, a.doc_id);
+        }
+    };
+
+    pub fn init(allocator: Allocator, plan: *const Plan, limit: usize) Self {
+        return .{
+            .allocator = allocator,
+            .plan = plan,
+            .heap = std.PriorityQueue(Entry, void, Entry.lessThan).init(allocator, {}),
+            .limit = limit,
+        };
+    }
+
+    pub fn deinit(self: *Self) void {
+        self.heap.deinit();
+    }
+
+    fn key(self: Self, doc_id: u32, score: f32) f64 {
+        return switch (self.plan.sort) {
+            .score => score,
+            .field => |f| blk: {
+                const v = self.plan.sort_col.?.number(doc_id);
+                break :blk if (f.descending) v else -v;
+            },
+            .blend => |b| score + b.weight * self.plan.sort_col.?.number(doc_id),
+        };
+    }
+
+    /// True once `limit` results are held
+    pub inline fn isFull(self: Self) bool {
+        return self.heap.count() >= self.limit;
+    }
+
+    /// Rank key a new result must beat once full
+    pub inline fn threshold(self: Self) f64 {
+        return if (self.heap.peek()) |min| min.key else -std.math.inf(f64);
+    }
+
+    pub fn push(self: *Self, doc_id: u32, score: f32) !void {
+        if (self.limit == 0) return;
+        const entry = Entry{ .doc_id = doc_id, .score = score, .key = self.key(doc_id, score) };
+        if (self.heap.count() < self.limit) {
+            try self.heap.add(entry);
+        } else if (Entry.lessThan({}, self.heap.peek().?, entry) == .lt) {
+            _ = self.heap.remove();
+            try self.heap.add(entry);
+        }
+    }
+
+    /// Results in rank order; caller owns the slice
+    pub fn results(self: *Self) ![]collector_mod.SearchResult {
+        const out = try self.allocator.alloc(collector_mod.SearchResult, self.heap.count());
+        var i = out.len;
+        while (self.heap.removeOrNull()) |entry| {
+            i -= 1;
+            out[i] = .{ .doc_id = entry.doc_id, .score = entry.score };
+        }
+        return out;
+    }
+};
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+test "filter plan block skipping" {
+    var dv = docvalues.DocValues.init(std.testing.allocator);
+    defer dv.deinit();
+
+    // Dates increase with doc ID, so later blocks fall outside the range
+    for (0..512) |i| {
+        try dv.setInt("date", @intCast(i), @intCast(i));
+        try dv.setString("lang", @intCast(i), if (i % 2 == 0) "en" else "vi");
+    }
+    try dv.seal(512);
+
+    const clauses = [_]Clause{
+        .{ .field = "date", .op = .{ .int_range = .{ .min = 200, .max = 300 } } },
+        .{ .field = "lang", .op = .{ .string_eq = "vi" } },
+    };
+    var plan = try Plan.compile(&dv, .{ .filter = &clauses });
+
+    try std.testing.expect(!plan.accept(5));
+    try std.testing.expect(plan.accept(201));
+    try std.testing.expect(!plan.accept(202));
+    try std.testing.expect(!plan.accept(301));
+    try std.testing.expectEqual(@as(?u32, 128), plan.nextCandidate(3));
+    try std.testing.expectEqual(@as(?u32, null), plan.nextCandidate(384));
+    try std.testing.expect(!plan.rangeMayMatch(0, 127));
+    try std.testing.expect(plan.rangeMayMatch(100, 130));
+
+    const missing = [_]Clause{.{ .field = "lang", .op = .{ .string_eq = "fr" } }};
+    var none = try Plan.compile(&dv, .{ .filter = &missing });
+    try std.testing.expect(!none.accept(1));
+
+    const unknown = [_]Clause{.{ .field = "domain", .op = .{ .string_eq = "x" } }};
+    try std.testing.expectError(error.UnknownField, Plan.compile(&dv, .{ .filter = &unknown }));
+}
+
+test "ranked collector sorts by field" {
+    var dv = docvalues.DocValues.init(std.testing.allocator);
+    defer dv.deinit();
+    try dv.setFloat("quality", 0, 0.2);
+    try dv.setFloat("quality", 1, 0.9);
+    try dv.setFloat("quality", 2, 0.5);
+    try dv.seal(3);
+
+    const plan = try Plan.compile(&dv, .{ .sort = .{ .field = .{ .name = "quality" } } });
+    var coll = RankedCollector.init(std.testing.allocator, &plan, 2);
+    defer coll.deinit();
+
+    try coll.push(0, 9.0);
+    try coll.push(1, 1.0);
+    try coll.push(2, 5.0);
+
+    const results = try coll.results();
+    defer std.testing.allocator.free(results);
+    try std.testing.expectEqual(@as(usize, 2), results.len);
+    try std.testing.expectEqual(@as(u32, 1), results[0].doc_id);
+    try std.testing.expectEqual(@as(u32, 2), results[1].doc_id);
+}